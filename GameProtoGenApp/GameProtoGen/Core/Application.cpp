@@ -28,7 +28,13 @@ namespace gp {
         for (auto* l : m_Layers) l->OnAttach();
 
         while (m_Running) {
-            m_Window->PollEvents();
+            // Inactivo: bloquear en el evento en vez de dibujar a 60 fps
+            const float wait = NextWait();
+            const bool hadInput = wait > 0.f ? m_Window->WaitEvents(wait) : m_Window->PollEvents();
+            if (hadInput) {
+                m_ActiveFrames = std::max(m_ActiveFrames, kSettleFrames);
+                m_IdleWait = kMinIdleWait;
+            }
 
             FlushPending();
 
@@ -49,6 +55,19 @@ namespace gp {
         }
     }
 
+    float Application::NextWait() {
+        if (!m_IdleThrottling || m_WantsClose) return 0.f;
+        if (m_ActiveFrames > 0) { --m_ActiveFrames; return 0.f; }
+        for (auto* l : m_Layers)
+            if (l->WantsFrames()) { m_IdleWait = kMinIdleWait; return 0.f; }
+
+        const float wait = m_IdleWait;
+        m_IdleWait = std::min(m_IdleWait * 2.f, kMaxIdleWait);
+        if (ImGui::GetCurrentContext() && ImGui::GetIO().WantTextInput)
+            return std::min(wait, kTextInputWait);
+        return wait;
+    }
+
     void Application::PushLayer(Layer* layer) {
         m_Layers.emplace_back(layer);
         layer->OnAttach();
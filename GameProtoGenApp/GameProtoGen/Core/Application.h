@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <functional>
+#include <algorithm>
 #include <cstdint>
 
 namespace gp {
@@ -19,6 +20,9 @@ namespace gp {
         virtual void OnDetach() {}
         virtual void OnUpdate(const Timestep&) {}
         virtual void OnGuiRender() {}
+        // true si necesita frames aunque no haya input (Play, resultado async pendiente,
+        // animación). Si ninguna capa los pide, el loop duerme hasta el próximo evento.
+        virtual bool WantsFrames() const { return false; }
     };
 
     class IWindow {
@@ -27,8 +31,9 @@ namespace gp {
         using RawEventCallback = std::function<void(const void* /*sf::Event*/)>;
         virtual ~IWindow() = default;
 
-        // loop
-        virtual void PollEvents() = 0;
+        // loop: true si llegó algún evento
+        virtual bool PollEvents() = 0;
+        virtual bool WaitEvents(float timeoutSec) = 0; // bloquea hasta un evento o el timeout
         virtual void SwapBuffers() = 0;
 
         // callbacks
@@ -68,7 +73,25 @@ namespace gp {
         void SetMode(Mode m) { m_Mode = m; }
         Mode GetMode() const { return m_Mode; }
 
+        // Pedir frames sin input (ej: algo cambió fuera del loop de eventos)
+        void RequestFrames(int frames = 1) { m_ActiveFrames = std::max(m_ActiveFrames, frames); }
+        void SetIdleThrottling(bool on) { m_IdleThrottling = on; }
+
     private:
+        // ---- Ritmo de frames ----
+        // Tras un input se siguen dibujando kSettleFrames frames (hover, popups, animaciones
+        // de ImGui). Después, sin capas ocupadas, se espera un evento con timeout que crece
+        // x2 por frame hasta kMaxIdleWait (el cursor de texto titila a kTextInputWait).
+        static constexpr int kSettleFrames = 10;
+        static constexpr float kMinIdleWait = 1.f / 60.f;
+        static constexpr float kMaxIdleWait = 0.5f;
+        static constexpr float kTextInputWait = 0.1f;
+
+        bool m_IdleThrottling = true;
+        int m_ActiveFrames = kSettleFrames;
+        float m_IdleWait = kMinIdleWait;
+        float NextWait(); // 0 = no esperar (frame activo)
+
         bool m_Running = true;
         bool m_WantsClose = false; 
         IWindow* m_Window = nullptr;
@@ -25,18 +25,32 @@ namespace gp {
         }
     }
 
-    void SFMLWindow::PollEvents() {
-        while (auto ev = m_Window.pollEvent()) {
+    void SFMLWindow::Dispatch(const sf::Event& ev) {
+        if (m_RawCb) m_RawCb(&ev);
 
-            if (m_RawCb) m_RawCb(&*ev);
+        if (ev.is<sf::Event::Closed>()) {
+            if (m_Callback) m_Callback(Event{ Event::Type::Closed });
+        }
+        else if (auto* r = ev.getIf<sf::Event::Resized>()) {
+            if (m_Callback) m_Callback(Event{ Event::Type::Resized, r->size.x, r->size.y });
+        }
+    }
 
-            if (ev->is<sf::Event::Closed>()) {
-                if (m_Callback) m_Callback(Event{ Event::Type::Closed });
-            }
-            else if (auto* r = ev->getIf<sf::Event::Resized>()) {
-                if (m_Callback) m_Callback(Event{ Event::Type::Resized, r->size.x, r->size.y });
-            }
+    bool SFMLWindow::PollEvents() {
+        bool any = false;
+        while (auto ev = m_Window.pollEvent()) {
+            Dispatch(*ev);
+            any = true;
         }
+        return any;
+    }
+
+    bool SFMLWindow::WaitEvents(float timeoutSec) {
+        auto ev = m_Window.waitEvent(sf::seconds(timeoutSec));
+        if (!ev) return false;
+        Dispatch(*ev);
+        PollEvents(); // drenar lo que haya llegado junto
+        return true;
     }
 
     void SFMLWindow::SwapBuffers() {
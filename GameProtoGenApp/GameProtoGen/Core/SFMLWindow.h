@@ -9,7 +9,8 @@ namespace gp {
         explicit SFMLWindow(const WindowProps& props);
         ~SFMLWindow() override = default;
         void SetRawEventCallback(RawEventCallback cb) override { m_RawCb = std::move(cb); }
-        void PollEvents() override;
+        bool PollEvents() override;
+        bool WaitEvents(float timeoutSec) override;
         void SwapBuffers() override;
         void SetEventCallback(EventCallback cb) override { m_Callback = std::move(cb); }
         void* GetNativeHandle() override { return m_Window.getNativeHandle(); }
@@ -21,6 +22,8 @@ namespace gp {
         sf::RenderWindow& Native() { return m_Window; }
 
     private:
+        void Dispatch(const sf::Event& ev);
+
         sf::RenderWindow m_Window;
         EventCallback m_Callback;
         RawEventCallback m_RawCb;
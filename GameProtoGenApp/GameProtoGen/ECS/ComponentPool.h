@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Entity.h"
+
+// Pool de componentes con copy-on-write.
+// Copiar un pool (o una Scene entera) sólo comparte el puntero; el mapa se
+// duplica recién la primera vez que alguien pide acceso mutable mientras
+// está compartido. Las lecturas por referencia const nunca copian.
+//
+// Registro de cambios: cada acceso mutable por id (find/at/[]/emplace/erase) anota
+// ese id; iterar en modo mutable o clear() marca "todo cambió". Índices derivados
+// (ej: SpatialIndex) guardan un Cursor y sólo reprocesan lo anotado desde entonces.
+// El registro está acotado: si crece de más se descarta la mitad más vieja; sólo un
+// lector que quedó tan atrás tiene que reconstruir.
+//
+// KeysRevision() cambia sólo cuando un id entra o sale del pool (no al editar valores
+// ni al iterar), para quien sólo necesita saber "quién tiene el componente".
+template <typename T>
+class ComponentPool {
+public:
+    using Map = std::unordered_map<EntityID, T>;
+    using iterator = typename Map::iterator;
+    using const_iterator = typename Map::const_iterator;
+    using value_type = typename Map::value_type;
+
+    ComponentPool() : m_Data(std::make_shared<Map>()) {}
+    // Una copia comparte datos pero es otro pool para los cursores (uid nuevo)
+    ComponentPool(const ComponentPool& o) : m_Data(o.m_Data) {}
+    ComponentPool& operator=(const ComponentPool& o) {
+        m_Data = o.m_Data;
+        m_Uid = NextUid();
+        ++m_KeysRev;
+        MarkAll();
+        return *this;
+    }
+
+    // ---- Lectura (no dispara copia) ----
+    const_iterator find(EntityID id) const { return m_Data->find(id); }
+    const_iterator begin() const { return m_Data->cbegin(); }
+    const_iterator end() const { return m_Data->cend(); }
+    bool contains(EntityID id) const { return m_Data->find(id) != m_Data->end(); }
+    std::size_t count(EntityID id) const { return m_Data->count(id); }
+    const T& at(EntityID id) const { return m_Data->at(id); }
+    std::size_t size() const { return m_Data->size(); }
+    bool empty() const { return m_Data->empty(); }
+
+    // ---- Escritura (copia el pool si está compartido) ----
+    iterator find(EntityID id) { Touch(id); return Mut().find(id); }
+    iterator begin() { MarkAll(); return Mut().begin(); }
+    iterator end() { return Mut().end(); }
+    T& at(EntityID id) { Touch(id); return Mut().at(id); }
+    T& operator[](EntityID id) {
+        Touch(id);
+        Map& m = Mut();
+        const std::size_t before = m.size();
+        T& v = m[id];
+        if (m.size() != before) ++m_KeysRev;
+        return v;
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        auto r = Mut().emplace(std::forward<Args>(args)...);
+        Touch(r.first->first);
+        if (r.second) ++m_KeysRev;
+        return r;
+    }
+
+    std::size_t erase(EntityID id) {
+        if (!contains(id)) return 0; // no separar el pool si no hay nada que borrar
+        Touch(id);
+        ++m_KeysRev;
+        return Mut().erase(id);
+    }
+
+    void clear() {
+        if (!empty()) ++m_KeysRev;
+        MarkAll();
+        if (IsShared()) m_Data = std::make_shared<Map>();
+        else            m_Data->clear();
+    }
+
+    void reserve(std::size_t n) { Mut().reserve(n); }
+
+    // true si otra Scene (ej: el snapshot de Play) comparte estos datos
+    bool IsShared() const { return m_Data.use_count() > 1; }
+
+    // ---- Registro de cambios ----
+    struct Cursor {
+        std::uint64_t pool = 0, seq = 0;
+        bool operator==(const Cursor&) const = default;
+    };
+    Cursor Head() const { return { m_Uid, m_Seq }; }
+    std::uint64_t KeysRevision() const { return m_KeysRev; }
+
+    // Llama f(id) por cada id anotado desde 'c' (puede repetir) y avanza el cursor.
+    // false: el cursor es de otro pool o quedó atrás de un "todo cambió" -> reconstruir.
+    template <typename F>
+    bool ForEachChangeSince(Cursor& c, F&& f) const {
+        const bool ok = c.pool == m_Uid && c.seq >= m_LogStart && c.seq <= m_Seq;
+        if (ok)
+            for (std::uint64_t s = c.seq; s < m_Seq; ++s) f(m_Log[(std::size_t)(s - m_LogStart)]);
+        c = Head();
+        return ok;
+    }
+
+private:
+    Map& Mut() {
+        if (m_Data.use_count() > 1) m_Data = std::make_shared<Map>(*m_Data);
+        return *m_Data;
+    }
+
+    static std::uint64_t NextUid() {
+        static std::atomic<std::uint64_t> s_Next{ 1 };
+        return s_Next++;
+    }
+
+    void Touch(EntityID id) {
+        if (m_Log.size() >= 1024 + 2 * m_Data->size()) { // acotar memoria: tirar la mitad vieja
+            const std::size_t drop = m_Log.size() / 2;
+            m_Log.erase(m_Log.begin(), m_Log.begin() + (std::ptrdiff_t)drop);
+            m_LogStart += drop;
+        }
+        m_Log.push_back(id);
+        ++m_Seq;
+    }
+
+    void MarkAll() {
+        m_Log.clear();
+        m_LogStart = ++m_Seq;
+    }
+
+    std::shared_ptr<Map> m_Data;
+    std::uint64_t m_Uid = NextUid();
+    std::vector<EntityID> m_Log;     // ids tocados desde m_LogStart
+    std::uint64_t m_LogStart = 0;    // seq del primer elemento de m_Log
+    std::uint64_t m_Seq = 0;         // seq del próximo cambio
+    std::uint64_t m_KeysRev = 0;     // altas/bajas de ids
+};
@@ -0,0 +1,297 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <nlohmann/json.hpp>
+#include "Scene.h"
+
+// Reflexión de componentes en tiempo de compilación.
+// Cada componente se describe una sola vez (nombre, pool en la Scene y campos con
+// flags); el serializer, ecs.get/ecs.set de Lua, el Inspector y las ops del chat se
+// generan recorriendo esa descripción. Los nombres se resuelven a un TypeId (índice
+// en Reflect::Components) en compilación; en runtime (Lua/JSON) la búsqueda es sobre
+// una tabla fija y el despacho por TypeId es por tabla de punteros, sin strcmp en cadena.
+namespace Reflect {
+
+    using TypeId = std::uint8_t;
+    inline constexpr TypeId kInvalidType = 0xFF;
+
+    enum FieldFlags : std::uint8_t {
+        kSave      = 1 << 0, // se persiste (SceneSerializer / payload del chat)
+        kLua       = 1 << 1, // visible en ecs.get / ecs.set
+        kEdit      = 1 << 2, // widget genérico en el Inspector
+        kOmitEmpty = 1 << 3, // strings: no se escribe si está vacío
+    };
+    inline constexpr std::uint8_t kAll = kSave | kLua | kEdit;
+
+    // Pistas para el widget del Inspector
+    struct EditHint {
+        const char* label = nullptr; // título del campo (nullptr = nombre del campo)
+        float speed = 1.f;
+        float min = 0.f, max = 0.f;  // min == max: sin límite
+        const char* unit = nullptr;
+        const char* tooltip = nullptr;
+    };
+
+    template <class C, class M>
+    struct Field {
+        using Class = C;
+        using Member = M;
+        std::string_view name; // clave en JSON y Lua
+        M C::* member;
+        std::uint8_t flags;
+        EditHint hint;
+    };
+
+    template <class C, class M>
+    constexpr Field<C, M> MakeField(std::string_view name, M C::* member, std::uint8_t flags, EditHint hint = {}) {
+        return { name, member, flags, hint };
+    }
+
+    // Sin definición: un tipo no reflejado no compila en ForEachField/TypeIdOf
+    template <class T> struct Component;
+
+    template <> struct Component<Transform> {
+        static constexpr std::string_view name = "Transform";
+        static constexpr const char* title = "Transform";
+        static constexpr auto pool = &Scene::transforms;
+        static constexpr auto fields = std::make_tuple(
+            MakeField("position", &Transform::position, kAll, { "Posición:", 1.f, 0.f, 0.f, "px" }),
+            MakeField("scale", &Transform::scale, kAll, { "Escala:", 0.01f, 0.01f, 10.f }),
+            MakeField("rotation", &Transform::rotationDeg, kAll, { "Rotación:", 0.5f, -360.f, 360.f, "grados" }));
+    };
+
+    template <> struct Component<Sprite> {
+        static constexpr std::string_view name = "Sprite";
+        static constexpr const char* title = "Sprite";
+        static constexpr auto pool = &Scene::sprites;
+        static constexpr auto fields = std::make_tuple(
+            MakeField("size", &Sprite::size, kAll, { "Tamaño:", 1.f, 1.f, 4096.f, "px" }),
+            MakeField("color", &Sprite::color, kAll, { "Color:" }));
+    };
+
+    template <> struct Component<Collider> {
+        static constexpr std::string_view name = "Collider";
+        static constexpr const char* title = "Collider";
+        static constexpr auto pool = &Scene::colliders;
+        static constexpr auto fields = std::make_tuple(
+            MakeField("halfExtents", &Collider::halfExtents, kSave | kLua),
+            MakeField("offset", &Collider::offset, kSave | kLua),
+            MakeField("isTrigger", &Collider::isTrigger, kAll,
+                { "Disparador (trigger)", 1.f, 0.f, 0.f, nullptr, "No colisión física; solo eventos." }));
+    };
+
+    template <> struct Component<Physics2D> {
+        static constexpr std::string_view name = "Physics2D";
+        static constexpr const char* title = "Física";
+        static constexpr auto pool = &Scene::physics;
+        static constexpr auto fields = std::make_tuple(
+            MakeField("velocity", &Physics2D::velocity, kSave | kLua),
+            MakeField("gravity", &Physics2D::gravity, kAll, { "Gravedad:", 10.f, 0.f, 10000.f, "px/s²" }),
+            MakeField("gravityEnabled", &Physics2D::gravityEnabled, kAll, { "Gravedad activa" }),
+            MakeField("onGround", &Physics2D::onGround, kLua)); // estado de runtime: no se persiste
+    };
+
+    template <> struct Component<PlayerController> {
+        static constexpr std::string_view name = "PlayerController";
+        static constexpr const char* title = "Jugador";
+        static constexpr auto pool = &Scene::playerControllers;
+        static constexpr auto fields = std::make_tuple(
+            MakeField("moveSpeed", &PlayerController::moveSpeed, kAll, { "Speed Velocity", 5.f, 0.f, 5000.f }),
+            MakeField("jumpSpeed", &PlayerController::jumpSpeed, kAll, { "Jump Force", 5.f, 0.f, 5000.f }));
+    };
+
+    // Texture2D y Script tienen editores propios en el Inspector (file pickers, preview)
+    template <> struct Component<Texture2D> {
+        static constexpr std::string_view name = "Texture2D";
+        static constexpr const char* title = "Texture2D";
+        static constexpr auto pool = &Scene::textures;
+        static constexpr auto fields = std::make_tuple(
+            MakeField("path", &Texture2D::path, kSave | kLua | kOmitEmpty));
+    };
+
+    template <> struct Component<Script> {
+        static constexpr std::string_view name = "Script";
+        static constexpr const char* title = "Script";
+        static constexpr auto pool = &Scene::scripts;
+        static constexpr auto fields = std::make_tuple(
+            MakeField("path", &Script::path, kSave | kOmitEmpty),
+            MakeField("inlineCode", &Script::inlineCode, kSave | kOmitEmpty));
+        // 'loaded' es estado de runtime: sin flags, no se persiste ni se expone
+    };
+
+    template <> struct Component<RenderLayer> {
+        static constexpr std::string_view name = "RenderLayer";
+        static constexpr const char* title = "Capa de render";
+        static constexpr auto pool = &Scene::renderLayers;
+        static constexpr auto fields = std::make_tuple(
+            MakeField("layer", &RenderLayer::layer, kAll, { "Capa:", 0.1f, -100.f, 100.f, nullptr, "Capas más altas se dibujan encima." }),
+            MakeField("z", &RenderLayer::z, kAll, { "Z:", 0.1f, 0.f, 0.f, nullptr, "Orden dentro de la capa." }));
+    };
+
+    // Orden = TypeId. Agregar al final para no cambiar IDs existentes.
+    using Components = std::tuple<Transform, Sprite, Collider, Physics2D, PlayerController, Texture2D, Script, RenderLayer>;
+    inline constexpr std::size_t kComponentCount = std::tuple_size_v<Components>;
+
+    namespace detail {
+        template <class T, class Tuple> struct IndexOf;
+        template <class T, class... Ts> struct IndexOf<T, std::tuple<Ts...>> {
+            static constexpr TypeId value = [] {
+                constexpr bool match[] = { std::is_same_v<T, Ts>... };
+                for (std::size_t i = 0; i < sizeof...(Ts); ++i)
+                    if (match[i]) return static_cast<TypeId>(i);
+                return kInvalidType;
+            }();
+        };
+
+        // Sólo se usan los tipos: nunca se construye un Components{}
+        template <class Tuple> struct Each;
+        template <class... Ts> struct Each<std::tuple<Ts...>> {
+            template <class F> static constexpr void Run(F& f) { (f(std::type_identity<Ts>{}), ...); }
+            template <template <class> class Fn> static constexpr auto Table() { return std::array{ &Fn<Ts>::Call... }; }
+        };
+
+        template <class Tuple> struct Names;
+        template <class... Ts> struct Names<std::tuple<Ts...>> {
+            static constexpr std::array<std::string_view, sizeof...(Ts)> value{ Component<Ts>::name... };
+        };
+    }
+
+    template <class T>
+    inline constexpr TypeId TypeIdOf = detail::IndexOf<T, Components>::value;
+
+    inline constexpr auto kNames = detail::Names<Components>::value;
+
+    constexpr TypeId IdOf(std::string_view name) {
+        for (std::size_t i = 0; i < kNames.size(); ++i)
+            if (kNames[i] == name) return static_cast<TypeId>(i);
+        return kInvalidType;
+    }
+
+    constexpr std::string_view NameOf(TypeId id) {
+        return id < kNames.size() ? kNames[id] : std::string_view{};
+    }
+
+    static_assert(IdOf("Sprite") == TypeIdOf<Sprite>);
+    static_assert(NameOf(TypeIdOf<Script>) == "Script");
+
+    // f(std::type_identity<T>{}) por cada componente, en orden de TypeId
+    template <class F>
+    constexpr void ForEachComponent(F&& f) {
+        detail::Each<Components>::Run(f);
+    }
+
+    // f(field) por cada campo del componente T
+    template <class T, class F>
+    constexpr void ForEachField(F&& f) {
+        std::apply([&](const auto&... field) { (f(field), ...); }, Component<T>::fields);
+    }
+
+    template <class T> ComponentPool<T>& PoolOf(Scene& s) { return s.*Component<T>::pool; }
+    template <class T> const ComponentPool<T>& PoolOf(const Scene& s) { return s.*Component<T>::pool; }
+
+    // Tabla de despacho por TypeId: una función especializada por componente.
+    // Uso: Dispatch<Fn>()[id](args...), con Fn<T>::Call estático.
+    template <template <class> class Fn>
+    constexpr auto Dispatch() {
+        return detail::Each<Components>::template Table<Fn>();
+    }
+
+    // Igualdad por campos reflejados (el estado sin descriptor, ej. Script::loaded, no cuenta)
+    template <class T>
+    bool Equal(const T& a, const T& b) {
+        bool eq = true;
+        ForEachField<T>([&](const auto& f) { eq = eq && (a.*f.member == b.*f.member); });
+        return eq;
+    }
+
+    // ---------------- JSON ----------------
+    // Formato histórico de escena: vec2 como [x, y], color como {r,g,b,a}.
+
+    inline nlohmann::json ValueToJson(int v) { return v; }
+    inline nlohmann::json ValueToJson(float v) { return v; }
+    inline nlohmann::json ValueToJson(bool v) { return v; }
+    inline nlohmann::json ValueToJson(const std::string& v) { return v; }
+    inline nlohmann::json ValueToJson(const sf::Vector2f& v) { return { v.x, v.y }; }
+    inline nlohmann::json ValueToJson(const sf::Color& c) { return { {"r", c.r}, {"g", c.g}, {"b", c.b}, {"a", c.a} }; }
+
+    // double → int sin UB (el cast de un valor fuera de rango o NaN lo es): NaN/inf no se
+    // aplican y lo que no entra en un int se satura. Lo usan JSON y Lua.
+    inline void AssignSaturated(double d, int& v) {
+        if (!std::isfinite(d)) return;
+        constexpr double lo = static_cast<double>(std::numeric_limits<int>::min());
+        constexpr double hi = static_cast<double>(std::numeric_limits<int>::max());
+        v = static_cast<int>(std::clamp(d, lo, hi));
+    }
+    // Canal de color con el mismo criterio, recortado a 0..255 (NaN/inf: 255)
+    inline std::uint8_t ColorChannel(double d) {
+        int v = 255;
+        AssignSaturated(d, v);
+        return static_cast<std::uint8_t>(std::clamp(v, 0, 255));
+    }
+
+    // Tolerantes: si el tipo no coincide se deja el valor como estaba
+    inline void ValueFromJson(const nlohmann::json& j, int& v) { if (j.is_number()) AssignSaturated(j.get<double>(), v); }
+    inline void ValueFromJson(const nlohmann::json& j, float& v) { if (j.is_number()) v = j.get<float>(); }
+    inline void ValueFromJson(const nlohmann::json& j, bool& v) { if (j.is_boolean()) v = j.get<bool>(); }
+    inline void ValueFromJson(const nlohmann::json& j, std::string& v) { if (j.is_string()) v = j.get<std::string>(); }
+    inline void ValueFromJson(const nlohmann::json& j, sf::Vector2f& v) {
+        if (j.is_array() && j.size() >= 2 && j[0].is_number() && j[1].is_number())
+            v = { j[0].get<float>(), j[1].get<float>() };
+    }
+    inline void ValueFromJson(const nlohmann::json& j, sf::Color& c) {
+        if (!j.is_object()) return;
+        auto ch = [&](const char* k) {
+            return j.contains(k) && j[k].is_number() ? ColorChannel(j[k].get<double>()) : std::uint8_t{ 255 };
+        };
+        c = sf::Color(ch("r"), ch("g"), ch("b"), ch("a"));
+    }
+
+    template <class T>
+    nlohmann::json ToJson(const T& comp) {
+        nlohmann::json j = nlohmann::json::object();
+        ForEachField<T>([&](const auto& f) {
+            if (!(f.flags & kSave)) return;
+            const auto& v = comp.*f.member;
+            if constexpr (std::is_same_v<std::decay_t<decltype(v)>, std::string>)
+                if ((f.flags & kOmitEmpty) && v.empty()) return;
+            j[std::string(f.name)] = ValueToJson(v);
+        });
+        return j;
+    }
+
+    // Aplica sólo las claves presentes ('mask' filtra qué campos se aceptan)
+    template <class T>
+    void PatchFromJson(const nlohmann::json& j, T& comp, std::uint8_t mask = kSave) {
+        if (!j.is_object()) return;
+        ForEachField<T>([&](const auto& f) {
+            if (!(f.flags & mask)) return;
+            if (auto it = j.find(f.name); it != j.end())
+                ValueFromJson(*it, comp.*f.member);
+        });
+    }
+
+    namespace detail {
+        template <class T> struct PatchFn {
+            static bool Call(Scene& s, EntityID id, const nlohmann::json& j, std::uint8_t mask) {
+                PatchFromJson(j, PoolOf<T>(s)[id], mask);
+                return true;
+            }
+        };
+    }
+
+    // Por TypeId (JSON del chat): crea el componente si no existe
+    inline bool PatchFromJson(Scene& s, TypeId type, EntityID id, const nlohmann::json& j, std::uint8_t mask = kSave) {
+        static constexpr auto table = Dispatch<detail::PatchFn>();
+        if (type >= table.size()) return false;
+        return table[type](s, id, j, mask);
+    }
+
+} // namespace Reflect
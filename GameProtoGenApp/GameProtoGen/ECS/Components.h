@@ -37,6 +37,12 @@ struct PlayerController {
     float jumpSpeed = 900.f;  // px/s (hacia arriba = negativo si y+ va hacia abajo)
 };
 
+// Orden de dibujo explícito. Sin este componente: capa 0, z 0, orden de creación.
+struct RenderLayer {
+    int layer = 0;   // capas más altas se dibujan encima
+    float z = 0.f;   // orden dentro de la capa; a igual z se agrupa por textura
+};
+
 struct Script {
     std::string path;       // Ruta a .lua 
     std::string inlineCode; // Código embebido 
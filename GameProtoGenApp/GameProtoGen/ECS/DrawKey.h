@@ -0,0 +1,31 @@
+#pragma once
+#include <cmath>
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "Scene.h"
+
+// Clave de orden de dibujo: (capa, z, textura, orden de creación). RenderQueue dibuja
+// en este orden y SpatialIndex lo usa para decidir qué entidad está más arriba.
+struct DrawKey {
+    std::int32_t layer = 0;
+    float z = 0.f;
+    std::uint64_t texture = 0; // hash de Texture2D.path; 0 = sin agrupar
+    std::uint64_t order = 0;   // creciente en el orden de Scene::Entities()
+    auto operator<=>(const DrawKey&) const = default;
+};
+
+// Capa, z y textura salen de RenderLayer/Texture2D; 'order' lo pone quien llama.
+// La textura sólo cuenta con RenderLayer: sin él manda el orden de creación.
+inline DrawKey DrawKeyOf(const Scene& scene, EntityID id, std::uint64_t order) {
+    DrawKey key;
+    key.order = order;
+    if (auto rl = scene.renderLayers.find(id); rl != scene.renderLayers.end()) {
+        key.layer = rl->second.layer;
+        key.z = std::isfinite(rl->second.z) ? rl->second.z : 0.f; // NaN rompería el orden
+        if (auto tx = scene.textures.find(id); tx != scene.textures.end() && !tx->second.path.empty())
+            key.texture = std::hash<std::string>{}(tx->second.path) | 1;
+    }
+    return key;
+}
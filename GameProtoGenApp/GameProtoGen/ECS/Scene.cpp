@@ -1,14 +1,18 @@
 #include "Scene.h"
+#include <algorithm>
+#include <unordered_set>
 
 Entity Scene::CreateEntity() {
     Entity e{ m_Next++ };
-    m_Entities.push_back(e);
+    MutableEntities().push_back(e);
+    ++m_EntitiesRev;
     return e;
 }
 
 Entity Scene::CreateEntityWithId(EntityID id) {
     Entity e{ id };
-    m_Entities.push_back(e);
+    MutableEntities().push_back(e);
+    ++m_EntitiesRev;
     if (id >= m_Next) m_Next = id + 1; // mantener el contador coherente
     return e;
 }
@@ -23,8 +27,31 @@ void Scene::DestroyEntity(Entity e) {
     physics.erase(e.id);
     scripts.erase(e.id);
     playerControllers.erase(e.id);
-    // borrar de la lista de entidades (O(n))
-    for (auto it = m_Entities.begin(); it != m_Entities.end(); ++it) {
-        if (it->id == e.id) { m_Entities.erase(it); break; }
+    renderLayers.erase(e.id);
+    // borrar de la lista de entidades (O(n)); sin separarla si no está
+    const auto& list = *m_Entities;
+    auto found = std::find_if(list.begin(), list.end(), [&](const Entity& x) { return x.id == e.id; });
+    if (found == list.end()) return;
+    auto& entities = MutableEntities();
+    entities.erase(entities.begin() + (found - list.begin()));
+    ++m_EntitiesRev;
+}
+
+void Scene::DestroyEntities(const std::vector<EntityID>& ids) {
+    if (ids.empty()) return;
+    std::unordered_set<EntityID> doomed(ids.begin(), ids.end());
+    for (EntityID id : doomed) {
+        transforms.erase(id);
+        sprites.erase(id);
+        colliders.erase(id);
+        textures.erase(id);
+        physics.erase(id);
+        scripts.erase(id);
+        playerControllers.erase(id);
+        renderLayers.erase(id);
     }
+    auto& entities = MutableEntities();
+    entities.erase(std::remove_if(entities.begin(), entities.end(),
+        [&](const Entity& e) { return doomed.count(e.id) != 0; }), entities.end());
+    ++m_EntitiesRev;
 }
@@ -1,32 +1,50 @@
 #pragma once
-#include <unordered_map>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <optional>
 #include "Entity.h"
 #include "Components.h"
+#include "ComponentPool.h"
 
 class Scene {
 public:
     Scene() = default;
+    // Sin move propio (como los pools): mover copia, que es barato, y el origen sigue válido
+    Scene(const Scene&) = default;
+    Scene& operator=(const Scene&) = default;
 
     Entity CreateEntity();
     void DestroyEntity(Entity e);
+    void DestroyEntities(const std::vector<EntityID>& ids); // una sola pasada sobre la lista: O(n + k)
 
     // crear entidad con un ID específico (para restaurar desde JSON)
     Entity CreateEntityWithId(EntityID id);
 
-    // Component storage (MVP: maps por tipo)
-    std::unordered_map<EntityID, Transform> transforms;
-    std::unordered_map<EntityID, Sprite> sprites;
-    std::unordered_map<EntityID, Texture2D>   textures;
-    std::unordered_map<EntityID, Collider> colliders;
-    std::unordered_map<EntityID, Physics2D> physics;
-    std::unordered_map<EntityID, PlayerController> playerControllers;
-    std::unordered_map<EntityID, Script> scripts;
+    // Component storage (MVP: maps por tipo, copy-on-write).
+    // Copiar la Scene es O(#pools): los pools y la lista de entidades se comparten y sólo
+    // se duplica lo que después se modifica.
+    ComponentPool<Transform> transforms;
+    ComponentPool<Sprite> sprites;
+    ComponentPool<Texture2D>   textures;
+    ComponentPool<Collider> colliders;
+    ComponentPool<Physics2D> physics;
+    ComponentPool<PlayerController> playerControllers;
+    ComponentPool<Script> scripts;
+    ComponentPool<RenderLayer> renderLayers;
 
-    const std::vector<Entity>& Entities() const { return m_Entities; }
+    const std::vector<Entity>& Entities() const { return *m_Entities; }
+    // Cambia cada vez que se agregan/quitan entidades (el orden de Entities() es el de dibujo)
+    std::uint64_t EntitiesRevision() const { return m_EntitiesRev; }
 
 private:
-    std::vector<Entity> m_Entities;
+    std::shared_ptr<std::vector<Entity>> m_Entities = std::make_shared<std::vector<Entity>>();
+    std::uint64_t m_EntitiesRev = 0;
     EntityID m_Next{ 1 };
+
+    // Copy-on-write como los pools: antes de modificar, separar la lista compartida
+    std::vector<Entity>& MutableEntities() {
+        if (m_Entities.use_count() > 1) m_Entities = std::make_shared<std::vector<Entity>>(*m_Entities);
+        return *m_Entities;
+    }
 };
@@ -0,0 +1,146 @@
+#include "SceneDelta.h"
+#include "Scene.h"
+#include "SceneSerializer.h"
+#include "ComponentReflection.h"
+#include <algorithm>
+#include <functional>
+#include <string>
+
+using json = nlohmann::json;
+
+namespace {
+    std::size_t HashEntity(const json& je) { return std::hash<std::string>{}(je.dump()); }
+}
+
+void SceneDeltaTracker::TrackFrom(const Scene& scene) {
+    m_Scene = &scene;
+    m_Cursors.assign(Reflect::kComponentCount, {});
+    Reflect::ForEachComponent([&](auto t) {
+        using T = typename decltype(t)::type;
+        const auto head = Reflect::PoolOf<T>(scene).Head();
+        m_Cursors[Reflect::TypeIdOf<T>] = { head.pool, head.seq };
+    });
+    m_EntitiesRev = scene.EntitiesRevision();
+    m_Ids.clear();
+    m_Ids.reserve(scene.Entities().size());
+    for (const auto& e : scene.Entities()) m_Ids.insert(e.id);
+}
+
+bool SceneDeltaTracker::CollectDirty(const Scene& scene) {
+    if (m_Scene != &scene || m_Cursors.size() != Reflect::kComponentCount) return false;
+
+    bool ok = true;
+    Reflect::ForEachComponent([&](auto t) {
+        using T = typename decltype(t)::type;
+        PoolCursor& pc = m_Cursors[Reflect::TypeIdOf<T>];
+        typename ComponentPool<T>::Cursor c{ pc.pool, pc.seq };
+        ok = Reflect::PoolOf<T>(scene).ForEachChangeSince(c, [&](EntityID id) { m_Dirty.insert(id); }) && ok;
+        pc = { c.pool, c.seq };
+    });
+
+    // Altas/bajas: sólo ids (sin serializar), y sólo si cambió la lista de entidades
+    if (scene.EntitiesRevision() != m_EntitiesRev) {
+        std::unordered_set<EntityID> ids;
+        ids.reserve(scene.Entities().size());
+        for (const auto& e : scene.Entities()) {
+            ids.insert(e.id);
+            if (!m_Ids.contains(e.id)) m_Dirty.insert(e.id);
+        }
+        for (EntityID id : m_Ids)
+            if (!ids.contains(id)) m_Dirty.insert(id);
+        m_Ids = std::move(ids);
+        m_EntitiesRev = scene.EntitiesRevision();
+    }
+    return ok;
+}
+
+SceneDeltaTracker::Payload SceneDeltaTracker::Build(const Scene& scene) {
+    Payload out;
+    out.isDelta = m_HasBase;
+    m_PendingUpserts.clear();
+    m_PendingRemoved.clear();
+    m_LastDumped = 0;
+
+    if (!m_HasBase) {
+        // Completa: todo se serializa y queda como base al confirmar
+        json entities = json::array();
+        for (const auto& e : scene.Entities()) {
+            json je = SceneSerializer::DumpEntity(scene, e.id);
+            m_PendingUpserts[e.id] = HashEntity(je);
+            entities.push_back(std::move(je));
+        }
+        m_LastDumped = scene.Entities().size();
+        TrackFrom(scene);
+        m_Dirty.clear();
+        m_PendingFull = true;
+        m_HasPending = true;
+        out.body = { {"entities", std::move(entities)} };
+        return out;
+    }
+
+    if (!CollectDirty(scene)) {
+        TrackFrom(scene);
+        for (EntityID id : m_Ids) m_Dirty.insert(id);
+        for (const auto& [id, h] : m_Acked) { (void)h; m_Dirty.insert(id); }
+    }
+
+    // Orden estable por id (el server guarda las entidades ordenadas por id)
+    std::vector<EntityID> dirty(m_Dirty.begin(), m_Dirty.end());
+    std::sort(dirty.begin(), dirty.end());
+
+    json upserts = json::array();
+    json removed = json::array();
+    for (EntityID id : dirty) {
+        const auto acked = m_Acked.find(id);
+        if (!m_Ids.contains(id)) {
+            if (acked != m_Acked.end()) { removed.push_back(id); m_PendingRemoved.push_back(id); }
+            continue;
+        }
+        json je = SceneSerializer::DumpEntity(scene, id);
+        ++m_LastDumped;
+        const std::size_t h = HashEntity(je);
+        if (acked != m_Acked.end() && acked->second == h) continue; // tocada pero igual
+        m_PendingUpserts[id] = h;
+        upserts.push_back(std::move(je));
+    }
+
+    out.body = {
+        {"baseRev", m_Rev},
+        {"upserts", std::move(upserts)},
+        {"removed", std::move(removed)}
+    };
+    m_PendingFull = false;
+    m_HasPending = true;
+    return out;
+}
+
+void SceneDeltaTracker::Acknowledge(std::uint64_t rev) {
+    if (!m_HasPending) return;
+    if (m_PendingFull) {
+        m_Acked = std::move(m_PendingUpserts);
+    }
+    else {
+        for (const auto& [id, h] : m_PendingUpserts) m_Acked[id] = h;
+        for (EntityID id : m_PendingRemoved) m_Acked.erase(id);
+    }
+    // El último Build incluyó todo lo sucio hasta ese momento; lo posterior está en
+    // los registros de los pools, después de los cursores
+    m_Dirty.clear();
+    m_PendingUpserts.clear();
+    m_PendingRemoved.clear();
+    m_HasPending = false;
+    m_Rev = rev;
+    m_HasBase = true;
+}
+
+void SceneDeltaTracker::Invalidate() {
+    m_Acked.clear();
+    m_PendingUpserts.clear();
+    m_PendingRemoved.clear();
+    m_Dirty.clear();
+    m_HasPending = false;
+    m_HasBase = false;
+    m_Rev = 0;
+    m_Scene = nullptr;
+    m_Cursors.clear();
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "Entity.h"
+class Scene;
+
+// Sincronización incremental de la escena con el backend del chat.
+// Guarda un hash por entidad del último estado confirmado por el server
+// (revisión "sceneRev") y en cada request manda sólo lo que cambió desde
+// entonces: entidades nuevas/modificadas (formato de SceneSerializer::Dump)
+// e IDs eliminados. Sin base confirmada, manda la escena completa.
+//
+// Qué cambió sale de los registros de cambios de los pools (un cursor por pool) y de
+// las altas/bajas de entidades: sólo esas entidades se serializan y se comparan con
+// su hash. Si algún cursor no sirve (escena reemplazada, pool iterado en modo mutable,
+// registro recortado) se compara la escena entera, como la primera vez.
+class SceneDeltaTracker {
+public:
+    struct Payload {
+        bool isDelta = false;
+        // full:  { "entities": [...] }                       (== SceneSerializer::Dump)
+        // delta: { "baseRev": N, "upserts": [...], "removed": [ids] }
+        nlohmann::json body;
+    };
+
+    // Arma el payload y deja lo enviado como "pendiente" hasta el ack.
+    Payload Build(const Scene& scene);
+
+    // El server aplicó lo pendiente y quedó en 'rev' -> pasa a ser la base.
+    void Acknowledge(std::uint64_t rev);
+
+    // El server no reconoce la base (reinicio, otra réplica, etc.) -> próximo envío completo.
+    void Invalidate();
+
+    bool HasBase() const { return m_HasBase; }
+    std::uint64_t Revision() const { return m_Rev; }
+    // Entidades serializadas en el último Build (para tests / diagnóstico)
+    std::size_t LastDumped() const { return m_LastDumped; }
+
+private:
+    struct PoolCursor { std::uint64_t pool = 0, seq = 0; };
+
+    // Junta en m_Dirty lo tocado desde el último Build. false: hay que comparar todo.
+    bool CollectDirty(const Scene& scene);
+    void TrackFrom(const Scene& scene); // cursores y set de ids al estado actual
+
+    std::unordered_map<EntityID, std::size_t> m_Acked;   // hash por entidad confirmado
+    // Pendiente de ack: upserts (id -> hash) y bajas; full = reemplaza m_Acked entero
+    std::unordered_map<EntityID, std::size_t> m_PendingUpserts;
+    std::vector<EntityID> m_PendingRemoved;
+    bool m_PendingFull = false;
+    std::uint64_t m_Rev = 0;
+    bool m_HasBase = false;
+    bool m_HasPending = false;
+
+    // Seguimiento de cambios (independiente del ack: lo sucio se acumula hasta confirmar)
+    const Scene* m_Scene = nullptr;
+    std::vector<PoolCursor> m_Cursors;
+    std::uint64_t m_EntitiesRev = 0;
+    std::unordered_set<EntityID> m_Ids;     // entidades de la escena en el último Build
+    std::unordered_set<EntityID> m_Dirty;   // tocadas desde el último ack
+    std::size_t m_LastDumped = 0;
+};
@@ -1,79 +1,55 @@
 #include "SceneSerializer.h"
 #include "Scene.h"
 #include "Components.h"
+#include "ComponentReflection.h"
 #include <nlohmann/json.hpp>
 #include <fstream>
 
 using json = nlohmann::json;
 
-static json color_to_json(const sf::Color& c) {
-    return { {"r", c.r}, {"g", c.g}, {"b", c.b}, {"a", c.a} };
+static json dump_entity(const Scene& scene, EntityID id) {
+    json je;
+    je["id"] = id;
+
+    Reflect::ForEachComponent([&](auto tag) {
+        using T = typename decltype(tag)::type;
+        const auto& pool = Reflect::PoolOf<T>(scene);
+        if (auto it = pool.find(id); it != pool.end()) {
+            json jc = Reflect::ToJson(it->second);
+            if (!jc.empty()) je[std::string(Reflect::Component<T>::name)] = std::move(jc); // solo si hay algo que persistir
+        }
+    });
+    return je;
 }
-static sf::Color color_from_json(const json& j) {
-    return sf::Color(j.value("r", 255), j.value("g", 255), j.value("b", 255), j.value("a", 255));
+
+// Una entidad de "entities" -> Scene (preserva el id del archivo)
+static void load_entity(Scene& scene, const json& je) {
+    Entity e;
+    if (je.contains("id") && (je["id"].is_number_unsigned() || je["id"].is_number_integer())) {
+        // Tomamos el id del archivo y lo preservamos
+        const EntityID wanted = je["id"].get<EntityID>();
+        if (wanted > 0) e = scene.CreateEntityWithId(wanted);
+        else            e = scene.CreateEntity(); // fallback defensivo
+    }
+    else {
+        e = scene.CreateEntity(); // si no había id en el JSON
+    }
+    const EntityID id = e.id;
+
+    // Campos sin kSave (Physics2D.onGround, Script.loaded) quedan en su default:
+    // on_spawn se vuelve a correr en runtime
+    Reflect::ForEachComponent([&](auto tag) {
+        using T = typename decltype(tag)::type;
+        if (auto it = je.find(Reflect::Component<T>::name); it != je.end())
+            Reflect::PatchFromJson(*it, Reflect::PoolOf<T>(scene)[id]);
+    });
 }
 
 static json dump_impl(const Scene& scene) {
     json j;
     j["entities"] = json::array();
-
     for (auto& e : scene.Entities()) {
-        const auto id = e.id;
-        json je;
-        je["id"] = id;
-
-        if (auto it = scene.transforms.find(id); it != scene.transforms.end()) {
-            const auto& t = it->second;
-            je["Transform"] = {
-                {"position", {t.position.x, t.position.y}},
-                {"scale",    {t.scale.x, t.scale.y}},
-                {"rotation", t.rotationDeg}
-            };
-        }
-        if (auto it = scene.sprites.find(id); it != scene.sprites.end()) {
-            const auto& s = it->second;
-            je["Sprite"] = {
-                {"size",  {s.size.x, s.size.y}},
-                {"color", color_to_json(s.color)}
-            };
-        }
-        if (auto it = scene.colliders.find(id); it != scene.colliders.end()) {
-            const auto& c = it->second;
-            je["Collider"] = {
-                {"halfExtents", {c.halfExtents.x, c.halfExtents.y}},
-                {"offset",      {c.offset.x, c.offset.y}},
-                {"isTrigger",   c.isTrigger}
-            };
-        }
-        if (auto it = scene.physics.find(id); it != scene.physics.end()) {
-            const auto& p = it->second;
-            je["Physics2D"] = {
-                {"velocity", {p.velocity.x, p.velocity.y}},
-                {"gravity", p.gravity},
-                {"gravityEnabled", p.gravityEnabled}
-            };
-        }
-        if (auto it = scene.playerControllers.find(id); it != scene.playerControllers.end()) {
-            const auto& pc = it->second;
-            je["PlayerController"] = {
-                {"moveSpeed", pc.moveSpeed},
-                {"jumpSpeed", pc.jumpSpeed}
-            };
-        }
-        if (auto it = scene.textures.find(id); it != scene.textures.end()) {
-            const auto& tx = it->second;
-            if (!tx.path.empty()) {
-                je["Texture2D"] = { {"path", tx.path} };
-            }
-        }
-        if (auto it = scene.scripts.find(id); it != scene.scripts.end()) {
-            const auto& sc = it->second;
-            nlohmann::json js;
-            if (!sc.path.empty())       js["path"] = sc.path;
-            if (!sc.inlineCode.empty()) js["inlineCode"] = sc.inlineCode;
-            if (!js.empty())            je["Script"] = js; // solo si hay algo que persistir
-        }
-        j["entities"].push_back(je);
+        j["entities"].push_back(dump_entity(scene, e.id));
     }
     return j;
 }
@@ -91,142 +67,20 @@ bool SceneSerializer::Load(Scene& scene, const std::string& path) {
     if (!ifs) return false;
     json j; ifs >> j;
 
-    // Reiniciar escena
-    scene = Scene{};
-
-    for (auto& je : j["entities"]) {
-        Entity e;
-        if (je.contains("id") && (je["id"].is_number_unsigned() || je["id"].is_number_integer())) {
-            // Tomamos el id del archivo y lo preservamos
-            const EntityID wanted = je["id"].get<EntityID>();
-            if (wanted > 0) e = scene.CreateEntityWithId(wanted);
-            else            e = scene.CreateEntity(); // fallback defensivo
-        }
-        else {
-            e = scene.CreateEntity(); // si no había id en el JSON
-        }
-        const EntityID id = e.id;
-
-        if (je.contains("Transform")) {
-            auto& t = scene.transforms[id];
-            auto jt = je["Transform"];
-            t.position = { jt["position"][0].get<float>(), jt["position"][1].get<float>() };
-            t.scale = { jt["scale"][0].get<float>(), jt["scale"][1].get<float>() };
-            t.rotationDeg = jt["rotation"].get<float>();
-        }
-        if (je.contains("Sprite")) {
-            auto& s = scene.sprites[id];
-            auto js = je["Sprite"];
-            s.size = { js["size"][0].get<float>(), js["size"][1].get<float>() };
-            s.color = color_from_json(js["color"]);
-        }
-        if (je.contains("Collider")) {
-            auto& c = scene.colliders[id];
-            auto jc = je["Collider"];
-            c.halfExtents = { jc["halfExtents"][0].get<float>(), jc["halfExtents"][1].get<float>() };
-            c.offset = { jc["offset"][0].get<float>(), jc["offset"][1].get<float>() };
-            c.isTrigger = jc.value("isTrigger", false);
-        }
-        if (je.contains("Physics2D")) {
-            auto& p = scene.physics[id];
-            auto jp = je["Physics2D"];
-            p.velocity = { jp["velocity"][0].get<float>(), jp["velocity"][1].get<float>() };
-            p.gravity = jp.value("gravity", 2000.f);
-            p.gravityEnabled = jp.value("gravityEnabled", true);
-            p.onGround = false;
-        }
-        if (je.contains("PlayerController")) {
-            auto& pc = scene.playerControllers[id];
-            auto jpc = je["PlayerController"];
-            pc.moveSpeed = jpc.value("moveSpeed", 500.f);
-            pc.jumpSpeed = jpc.value("jumpSpeed", 900.f);
-        }
-        if (je.contains("Texture2D")) {
-            auto& tx = scene.textures[id];
-            auto jx = je["Texture2D"];
-            if (jx.contains("path") && jx["path"].is_string())
-                tx.path = jx["path"].get<std::string>();
-        }
-        if (je.contains("Script")) {
-            auto& sc = scene.scripts[id];
-            const auto& js = je["Script"];
-            sc.path = js.value("path", "");
-            sc.inlineCode = js.value("inlineCode", "");
-            sc.loaded = false; // fuerza re-ejecutar on_spawn en runtime
-        }
-    }
-    return true;
+    return LoadFromJson(scene, j);
 }
 
 nlohmann::json SceneSerializer::Dump(const Scene& scene) {
     return dump_impl(scene);
 }
 
+nlohmann::json SceneSerializer::DumpEntity(const Scene& scene, EntityID id) {
+    return dump_entity(scene, id);
+}
+
 bool SceneSerializer::LoadFromJson(Scene& scene, const nlohmann::json& j) {
     if (!j.contains("entities") || !j["entities"].is_array()) return false;
-    // Versión en memoria equivalente a Load()
     scene = Scene{};
-    for (auto& je : j["entities"]) {
-        Entity e;
-        if (je.contains("id") && (je["id"].is_number_unsigned() || je["id"].is_number_integer())) {
-            // Tomamos el id del archivo y lo preservamos
-            const EntityID wanted = je["id"].get<EntityID>();
-            if (wanted > 0) e = scene.CreateEntityWithId(wanted);
-            else            e = scene.CreateEntity(); // fallback defensivo
-        }
-        else {
-            e = scene.CreateEntity(); // si no había id en el JSON
-        }
-        const EntityID id = e.id;
-
-
-        if (je.contains("Transform")) {
-            auto& t = scene.transforms[id];
-            auto jt = je["Transform"];
-            t.position = { jt["position"][0].get<float>(), jt["position"][1].get<float>() };
-            t.scale = { jt["scale"][0].get<float>(), jt["scale"][1].get<float>() };
-            t.rotationDeg = jt["rotation"].get<float>();
-        }
-        if (je.contains("Sprite")) {
-            auto& s = scene.sprites[id];
-            auto js = je["Sprite"];
-            s.size = { js["size"][0].get<float>(), js["size"][1].get<float>() };
-            s.color = color_from_json(js["color"]);
-        }
-        if (je.contains("Collider")) {
-            auto& c = scene.colliders[id];
-            auto jc = je["Collider"];
-            c.halfExtents = { jc["halfExtents"][0].get<float>(), jc["halfExtents"][1].get<float>() };
-            c.offset = { jc["offset"][0].get<float>(), jc["offset"][1].get<float>() };
-            c.isTrigger = jc.value("isTrigger", false);
-        }
-        if (je.contains("Physics2D")) {
-            auto& p = scene.physics[id];
-            auto jp = je["Physics2D"];
-            p.velocity = { jp["velocity"][0].get<float>(), jp["velocity"][1].get<float>() };
-            p.gravity = jp.value("gravity", 2000.f);
-            p.gravityEnabled = jp.value("gravityEnabled", true);
-            p.onGround = false;
-        }
-        if (je.contains("PlayerController")) {
-            auto& pc = scene.playerControllers[id];
-            auto jpc = je["PlayerController"];
-            pc.moveSpeed = jpc.value("moveSpeed", 500.f);
-            pc.jumpSpeed = jpc.value("jumpSpeed", 900.f);
-        }
-        if (je.contains("Texture2D")) {
-            auto& tx = scene.textures[id];
-            auto jx = je["Texture2D"];
-            if (jx.contains("path") && jx["path"].is_string())
-                tx.path = jx["path"].get<std::string>();
-        }
-        if (je.contains("Script")) {
-            auto& sc = scene.scripts[id];
-            const auto& js = je["Script"];
-            sc.path = js.value("path", "");
-            sc.inlineCode = js.value("inlineCode", "");
-            sc.loaded = false;
-        }
-    }
+    for (auto& je : j["entities"]) load_entity(scene, je);
     return true;
 }
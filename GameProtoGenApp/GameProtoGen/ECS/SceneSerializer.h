@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <nlohmann/json.hpp>
+#include "Entity.h"
 class Scene;
 
 class SceneSerializer {
@@ -11,5 +12,6 @@ public:
 
     // (de)serialización en memoria
     static nlohmann::json Dump(const Scene& scene);
+    static nlohmann::json DumpEntity(const Scene& scene, EntityID id); // un elemento de "entities"
     static bool LoadFromJson(Scene& scene, const nlohmann::json& j);
 };
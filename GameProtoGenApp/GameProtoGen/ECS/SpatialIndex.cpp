@@ -0,0 +1,223 @@
+#include "SpatialIndex.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    bool Intersects(const sf::FloatRect& a, const sf::FloatRect& b) {
+        return a.position.x <= b.position.x + b.size.x && a.position.x + a.size.x >= b.position.x &&
+               a.position.y <= b.position.y + b.size.y && a.position.y + a.size.y >= b.position.y;
+    }
+
+    bool Contains(const sf::FloatRect& r, const sf::Vector2f& p) {
+        return p.x >= r.position.x && p.x <= r.position.x + r.size.x &&
+               p.y >= r.position.y && p.y <= r.position.y + r.size.y;
+    }
+}
+
+std::optional<sf::FloatRect> SpatialIndex::ComputeAABB(const Scene& scene, EntityID id) {
+    auto itT = scene.transforms.find(id);
+    if (itT == scene.transforms.end()) return std::nullopt;
+
+    const Transform& t = itT->second;
+    const sf::Vector2f scaleAbs{ std::abs(t.scale.x), std::abs(t.scale.y) };
+    sf::Vector2f he{ 0.f, 0.f };
+    sf::Vector2f offset{ 0.f, 0.f };
+
+    if (auto itS = scene.sprites.find(id); itS != scene.sprites.end()) {
+        he = { itS->second.size.x * scaleAbs.x * 0.5f, itS->second.size.y * scaleAbs.y * 0.5f };
+    }
+    else if (auto itC = scene.colliders.find(id); itC != scene.colliders.end()) {
+        he = { itC->second.halfExtents.x * scaleAbs.x, itC->second.halfExtents.y * scaleAbs.y };
+        offset = itC->second.offset;
+    }
+    else {
+        return std::nullopt;
+    }
+    if (he.x <= 0.f || he.y <= 0.f) return std::nullopt;
+
+    const sf::Vector2f center = t.position + offset;
+    return sf::FloatRect({ center.x - he.x, center.y - he.y }, { he.x * 2.f, he.y * 2.f });
+}
+
+int SpatialIndex::CellOf(float v) const {
+    return (int)std::floor(v / m_CellSize);
+}
+
+void SpatialIndex::Clear() {
+    m_Cells.clear();
+    m_Items.clear();
+    m_Big.clear();
+    m_Rank.clear();
+    m_RankRev = ~0ull;
+    m_RlCursor = {};
+    m_TxCursor = {};
+    m_Scene = nullptr;
+    m_TfCursor = {};
+    m_SpCursor = {};
+    m_ColCursor = {};
+}
+
+void SpatialIndex::Rebuild(const Scene& scene) {
+    Clear();
+    m_Scene = &scene;
+    m_TfCursor = scene.transforms.Head();
+    m_SpCursor = scene.sprites.Head();
+    m_ColCursor = scene.colliders.Head();
+
+    m_Items.reserve(scene.transforms.size());
+    for (const auto& [id, _] : scene.transforms)
+        if (auto box = ComputeAABB(scene, id)) Insert(id, *box);
+    SyncRank(scene);
+}
+
+void SpatialIndex::Sync(const Scene& scene) {
+    if (m_Scene != &scene) { Rebuild(scene); return; }
+
+    std::vector<EntityID> dirty;
+    auto collect = [&](EntityID id) { dirty.push_back(id); };
+    bool ok = scene.transforms.ForEachChangeSince(m_TfCursor, collect);
+    ok = scene.sprites.ForEachChangeSince(m_SpCursor, collect) && ok;
+    ok = scene.colliders.ForEachChangeSince(m_ColCursor, collect) && ok;
+    if (!ok) { Rebuild(scene); return; }
+
+    if (!dirty.empty()) {
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+        for (EntityID id : dirty) Refresh(scene, id);
+    }
+    SyncRank(scene);
+}
+
+void SpatialIndex::Refresh(const Scene& scene, EntityID id) {
+    const auto box = ComputeAABB(scene, id);
+    auto it = m_Items.find(id);
+    if (it != m_Items.end()) {
+        if (box && it->second.box == *box) return; // acceso mutable sin cambio real
+        Remove(id);
+    }
+    if (box) Insert(id, *box);
+}
+
+void SpatialIndex::Insert(EntityID id, const sf::FloatRect& box) {
+    Item item;
+    item.box = box;
+    const int x0 = CellOf(box.position.x), x1 = CellOf(box.position.x + box.size.x);
+    const int y0 = CellOf(box.position.y), y1 = CellOf(box.position.y + box.size.y);
+
+    if ((std::int64_t)(x1 - x0 + 1) * (y1 - y0 + 1) > kMaxCellsPerItem) {
+        item.big = true;
+        m_Big.push_back(id);
+    }
+    else {
+        item.x0 = x0; item.x1 = x1; item.y0 = y0; item.y1 = y1;
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+                m_Cells[CellKey(x, y)].push_back(id);
+    }
+    m_Items[id] = item;
+}
+
+void SpatialIndex::Remove(EntityID id) {
+    auto it = m_Items.find(id);
+    if (it == m_Items.end()) return;
+    const Item& item = it->second;
+
+    auto unlink = [id](std::vector<EntityID>& v) {
+        auto pos = std::find(v.begin(), v.end(), id);
+        if (pos != v.end()) { *pos = v.back(); v.pop_back(); }
+    };
+    if (item.big) unlink(m_Big);
+    for (int y = item.y0; y <= item.y1; ++y)
+        for (int x = item.x0; x <= item.x1; ++x) {
+            auto c = m_Cells.find(CellKey(x, y));
+            if (c == m_Cells.end()) continue;
+            unlink(c->second);
+            if (c->second.empty()) m_Cells.erase(c);
+        }
+    m_Items.erase(it);
+}
+
+// Crear/borrar entidades renumera el orden; cambiar RenderLayer o Texture2D sólo
+// recalcula la clave de esas entidades. Moverlas no toca el rango.
+void SpatialIndex::SyncRank(const Scene& scene) {
+    bool full = m_RankRev != scene.EntitiesRevision();
+    std::vector<EntityID> dirty;
+    if (!full) {
+        auto collect = [&](EntityID id) { dirty.push_back(id); };
+        const bool ok = scene.renderLayers.ForEachChangeSince(m_RlCursor, collect);
+        full = !(scene.textures.ForEachChangeSince(m_TxCursor, collect) && ok);
+    }
+    if (!full) {
+        for (EntityID id : dirty)
+            if (auto it = m_Rank.find(id); it != m_Rank.end()) it->second = DrawKeyOf(scene, id, it->second.order);
+        return;
+    }
+
+    m_RankRev = scene.EntitiesRevision();
+    m_RlCursor = scene.renderLayers.Head();
+    m_TxCursor = scene.textures.Head();
+    const auto& entities = scene.Entities();
+    m_Rank.clear();
+    m_Rank.reserve(entities.size());
+    for (std::size_t i = 0; i < entities.size(); ++i) m_Rank[entities[i].id] = DrawKeyOf(scene, entities[i].id, i + 1);
+}
+
+DrawKey SpatialIndex::RankOf(EntityID id) const {
+    auto it = m_Rank.find(id);
+    return it != m_Rank.end() ? it->second : DrawKey{};
+}
+
+std::vector<EntityID> SpatialIndex::Query(const sf::FloatRect& box) const {
+    std::vector<EntityID> out;
+    const std::uint32_t stamp = ++m_Stamp;
+
+    auto consider = [&](EntityID id) {
+        const Item& item = m_Items.at(id);
+        if (item.stamp == stamp) return;
+        item.stamp = stamp;
+        if (Intersects(item.box, box)) out.push_back(id);
+    };
+
+    const int x0 = CellOf(box.position.x), x1 = CellOf(box.position.x + box.size.x);
+    const int y0 = CellOf(box.position.y), y1 = CellOf(box.position.y + box.size.y);
+    const std::int64_t cells = (std::int64_t)(x1 - x0 + 1) * (y1 - y0 + 1);
+
+    if (cells > (std::int64_t)m_Cells.size()) {
+        // Caja más grande que lo ocupado: recorrer las celdas existentes
+        for (const auto& [key, ids] : m_Cells) {
+            const int cx = (int)(std::int32_t)(key >> 32), cy = (int)(std::int32_t)(key & 0xFFFFFFFFu);
+            if (cx < x0 || cx > x1 || cy < y0 || cy > y1) continue;
+            for (EntityID id : ids) consider(id);
+        }
+    }
+    else {
+        for (int y = y0; y <= y1; ++y)
+            for (int x = x0; x <= x1; ++x)
+                if (auto c = m_Cells.find(CellKey(x, y)); c != m_Cells.end())
+                    for (EntityID id : c->second) consider(id);
+    }
+    for (EntityID id : m_Big) consider(id);
+
+    std::sort(out.begin(), out.end(), [&](EntityID a, EntityID b) { return RankOf(a) > RankOf(b); });
+    return out;
+}
+
+EntityID SpatialIndex::PickTopmost(const sf::Vector2f& p) const {
+    EntityID best = 0;
+    DrawKey bestRank;
+    auto consider = [&](EntityID id) {
+        if (!Contains(m_Items.at(id).box, p)) return;
+        const DrawKey r = RankOf(id);
+        if (!best || r > bestRank) { best = id; bestRank = r; }
+    };
+
+    if (auto c = m_Cells.find(CellKey(CellOf(p.x), CellOf(p.y))); c != m_Cells.end())
+        for (EntityID id : c->second) consider(id);
+    for (EntityID id : m_Big) consider(id);
+    return best;
+}
+
+const sf::FloatRect* SpatialIndex::Bounds(EntityID id) const {
+    auto it = m_Items.find(id);
+    return it != m_Items.end() ? &it->second.box : nullptr;
+}
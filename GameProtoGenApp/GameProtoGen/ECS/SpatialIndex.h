@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <SFML/Graphics/Rect.hpp>
+#include "DrawKey.h"
+#include "Scene.h"
+
+// Índice espacial (grilla hash uniforme) sobre la AABB de mundo de cada entidad.
+// Se mantiene incrementalmente: Sync() lee el registro de cambios de transforms,
+// sprites y colliders y sólo recalcula las entidades tocadas. Escena nueva, copia
+// (snapshot de Play) o iteración mutable de un pool -> reconstrucción completa.
+//
+// AABB = tamaño del Sprite * |scale| centrado en la posición; sin Sprite, el Collider
+// (halfExtents * |scale| + offset). La rotación no se considera (igual que el picking).
+//
+// Consultas: O(celdas cubiertas + hits). Entidades enormes (que cubrirían demasiadas
+// celdas, ej: el suelo) van a una lista aparte que se recorre siempre.
+//
+// "Más arriba" = mayor DrawKey, el mismo orden que usa RenderQueue (capa, z, textura,
+// creación). Sólo difiere de lo dibujado entre estáticas de un mismo chunk horneado
+// que se solapan entre celdas.
+class SpatialIndex {
+public:
+    explicit SpatialIndex(float cellSize = 128.f) : m_CellSize(cellSize) {}
+
+    void Sync(const Scene& scene);
+    void Rebuild(const Scene& scene);
+    void Clear();
+
+    // Entidades cuya AABB intersecta 'box' (bordes inclusive), la de más arriba primero
+    std::vector<EntityID> Query(const sf::FloatRect& box) const;
+    // La de más arriba (última en orden de dibujo) que contiene 'p'; 0 si ninguna
+    EntityID PickTopmost(const sf::Vector2f& p) const;
+    // AABB indexada; nullptr si la entidad no tiene forma
+    const sf::FloatRect* Bounds(EntityID id) const;
+
+    std::size_t Size() const { return m_Items.size(); }
+
+    static std::optional<sf::FloatRect> ComputeAABB(const Scene& scene, EntityID id);
+
+private:
+    struct Item {
+        sf::FloatRect box;
+        int x0 = 0, y0 = 0, x1 = -1, y1 = -1; // rango de celdas (vacío si 'big')
+        bool big = false;
+        mutable std::uint32_t stamp = 0;      // dedup en consultas
+    };
+
+    static constexpr int kMaxCellsPerItem = 256;
+
+    float m_CellSize;
+    std::unordered_map<std::uint64_t, std::vector<EntityID>> m_Cells;
+    std::unordered_map<EntityID, Item> m_Items;
+    std::vector<EntityID> m_Big;
+    mutable std::uint32_t m_Stamp = 0;
+
+    // Orden de dibujo para resolver "la de más arriba"; 'order' = posición en Entities()
+    std::unordered_map<EntityID, DrawKey> m_Rank;
+    std::uint64_t m_RankRev = ~0ull;
+    ComponentPool<RenderLayer>::Cursor m_RlCursor;
+    ComponentPool<Texture2D>::Cursor m_TxCursor;
+
+    // Cursores sobre el registro de cambios de cada pool
+    ComponentPool<Transform>::Cursor m_TfCursor;
+    ComponentPool<Sprite>::Cursor m_SpCursor;
+    ComponentPool<Collider>::Cursor m_ColCursor;
+    const Scene* m_Scene = nullptr;
+
+    static std::uint64_t CellKey(int x, int y) {
+        return ((std::uint64_t)(std::uint32_t)x << 32) | (std::uint32_t)y;
+    }
+    int CellOf(float v) const;
+
+    void Insert(EntityID id, const sf::FloatRect& box);
+    void Remove(EntityID id);
+    void Refresh(const Scene& scene, EntityID id);
+    void SyncRank(const Scene& scene);
+    DrawKey RankOf(EntityID id) const;
+};
@@ -11,6 +11,7 @@
 #include "Net/ApiClient.h"
 #include <filesystem>
 #include <Systems/Renderer2D.h>
+#include <Systems/ScriptCache.h>
 #include <Auth/TokenManager.h>
 #include "Auth/OidcClient.h"
 #include "Editor/LauncherLayer.h"
@@ -84,12 +85,16 @@ public:
         static ImGuiConsoleSink s_sink;
         Log::SetSink(&s_sink);
 
+        // Bytecode de los scripts entre sesiones (clave = contenido)
+        ScriptCache::SetDiskDir("Saves/LuaCache");
+
         // ApiClient (HTTPS con tu backend en 7223)
         //auto client = std::make_shared<ApiClient>("https://localhost:7223");
         auto client = std::make_shared<ApiClient>("https://ca-game-protogen.purplehill-2f1636cc.brazilsouth.azurecontainerapps.io");
         client->SetVerifySsl(true);
         client->UseHttps(true);
         client->SetTimeouts(10, 180, 30);
+        client->SetRequestCompression(true); // el backend acepta Content-Encoding: gzip
 
         // Split de contextos:
         // - EditorContext: auth, API, selección, flags de play
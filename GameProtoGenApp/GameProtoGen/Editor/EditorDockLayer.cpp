@@ -8,6 +8,9 @@
 #include "ECS/SceneSerializer.h"
 #include "ECS/Components.h"
 #include "Systems/Renderer2D.h"
+#include "Runtime/AssetStore.h"
+#include "Runtime/AssetPack.h"
+#include "Systems/ScriptCache.h"
 #include "Auth/OidcClient.h"
 #include "Net/ApiClient.h"
 #include "Auth/TokenManager.h"
@@ -25,6 +28,7 @@
 #include <imgui.h>
 #include <imgui_internal.h>
 #include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
 
 #include <nlohmann/json.hpp>
 #include <Auth/JwtDisplayName.h>
@@ -120,124 +124,84 @@ namespace {
         return std::nullopt;
     }
 
-    // Normaliza y devuelve el subpath relativo a Assets si corresponde.
-    // Si el archivo no está dentro de Assets, retorna std::nullopt.
-    static std::optional<std::filesystem::path> RelToAssets(const std::filesystem::path& pAbs) {
-        std::error_code ec;
-        auto assets = std::filesystem::weakly_canonical(GetAssetsRoot(), ec);
-        auto abs = std::filesystem::weakly_canonical(pAbs, ec);
-        if (ec) return std::nullopt;
+    static std::string ReadFileBytes(const std::filesystem::path& p) {
+        std::ifstream ifs(p, std::ios::binary);
+        if (!ifs) return {};
+        std::ostringstream ss; ss << ifs.rdbuf();
+        return ss.str();
+    }
 
-        // ¿abs comienza con assets?
-        auto mismatch = std::mismatch(assets.begin(), assets.end(), abs.begin(), abs.end());
-        if (mismatch.first == assets.end()) {
-            return std::filesystem::relative(abs, assets, ec);
+    // Empaqueta la escena y los assets que usa en <outDir>/game.gppak: texturas ya
+    // decodificadas a RGBA8 y scripts precompilados (ScriptCache), para que el Player
+    // arranque con un solo open+mmap. Los nombres lógicos se resuelven por el AssetStore
+    // (contenido idéntico, un solo blob). Deja assets_manifest.json con lo
+    // empaquetado/faltante.
+    static bool WriteGamePack(const Scene& scene, const std::filesystem::path& outDir) {
+        const auto packPath = outDir / "game.gppak";
+        AssetPack::Writer pak;
+        if (!pak.Open(packPath.string())) {
+            Log::Error("[EXPORT] ERROR: " + pak.Error());
+            return false;
         }
-        return std::nullopt;
-    }
 
-    struct AssetRef {
-        std::filesystem::path abs;     // ruta absoluta real
-        std::filesystem::path rel;     // ruta relativa dentro de Assets (ej: Textures/foo.png)
-        std::string reason;            // "texture" | "script" | "sprite"
-    };
-
-    // Recolecta texturas/scripts (y opcionalmente sprites con imagePath) referenciados en la escena, sólo si están bajo Assets/.
-    static std::vector<AssetRef> CollectUsedAssets(const Scene& scene) {
-        std::vector<AssetRef> out;
-        std::unordered_set<std::string> dedup;
-
-        auto try_add = [&](const std::filesystem::path& raw, const std::string& reason) {
-            auto absOpt = ResolveAssetPath(raw);
-            if (!absOpt) {
-                Log::Info(std::string("[EXPORT] skip (no existe): ") + raw.string());
-                return;
-            }
-            const auto& abs = *absOpt;
+        const std::string sceneJson = SceneSerializer::Dump(scene).dump();
+        pak.Add("scene.json", sceneJson);
 
-            if (auto rel = RelToAssets(abs)) {
-                auto key = (rel->generic_string() + "|" + reason);
-                if (!dedup.insert(key).second) return;
-                Log::Info(std::string("[EXPORT] + ") + reason + "  " + rel->generic_string());
-                out.push_back(AssetRef{ abs, *rel, reason });
+        nlohmann::json manifest = nlohmann::json::object();
+        manifest["packed"] = nlohmann::json::array();
+        manifest["missing"] = nlohmann::json::array();
+        auto report = [&](const std::string& name, const std::string& kind, const std::string& status) {
+            nlohmann::json row{ { "name", name }, { "kind", kind }, { "status", status } };
+            if (status == "ok") {
+                Log::Info("[EXPORT] + " + kind + "  " + name);
+                manifest["packed"].push_back(std::move(row));
             }
             else {
-                Log::Info(std::string("[EXPORT] skip (fuera de Assets): ") + abs.string());
+                Log::Error("[EXPORT] Missing: " + name + " (" + status + ")");
+                manifest["missing"].push_back(std::move(row));
             }
             };
 
+        std::unordered_set<std::string> seen;
+
         // 1) Texturas
         for (const auto& [id, tex] : scene.textures) {
             (void)id;
-            if (tex.path.empty()) continue;
-            try_add(tex.path, "texture");
+            if (tex.path.empty() || !seen.insert(tex.path).second) continue;
+            const auto file = ResolveAssetPath(AssetStore::Resolve(tex.path));
+            sf::Image img;
+            if (!file || !img.loadFromFile(*file)) { report(tex.path, "texture", "no se pudo leer"); continue; }
+            const auto size = img.getSize();
+            const std::string_view pixels(reinterpret_cast<const char*>(img.getPixelsPtr()), (std::size_t)size.x * size.y * 4);
+            if (!pak.Add(tex.path, pixels, AssetPack::Kind::Rgba8, size.x, size.y)) break;
+            report(tex.path, "texture", "ok");
         }
 
-        // 2) Scripts
+        // 2) Scripts (si no compila va el fuente: el error se ve al correr, como en el editor)
         for (const auto& [id, sc] : scene.scripts) {
             (void)id;
-            if (sc.path.empty()) continue;
-            try_add(sc.path, "script");
-        }
-
-        return out;
-    }
-
-    // Exporta sólo los assets usados preservando subcarpetas bajo Assets/.
-    // Devuelve una lista de faltantes para log/manifest.
-    static std::vector<std::filesystem::path> CopyUsedAssetsOnly(
-        const Scene& scene, const std::filesystem::path& outDir) {
-
-        std::vector<std::filesystem::path> missing;
-        const auto dstRoot = outDir / "Assets";
-
-        std::error_code mkec;
-        std::filesystem::create_directories(dstRoot, mkec);
-
-        auto used = CollectUsedAssets(scene);
-
-        // Fallback opcional: si no detectamos nada y querés evitar carpeta vacía
-        bool kExportCopyAllIfEmpty = true;
-        if (used.empty() && kExportCopyAllIfEmpty) {
-            std::error_code ec;
-            std::filesystem::copy(
-                GetAssetsRoot(), dstRoot,
-                std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing, ec);
-            if (ec) Log::Error(std::string("[EXPORT] Fallback copy all Assets/ error: ") + ec.message());
-            else    Log::Info("[EXPORT] Fallback: no refs → se copió Assets/ completo.");
-            return {};
-        }
-
-        nlohmann::json manifest = nlohmann::json::object();
-        manifest["copied"] = nlohmann::json::array();
-        manifest["missing"] = nlohmann::json::array();
-
-        for (const auto& a : used) {
-            std::error_code ec;
-            const auto dst = dstRoot / a.rel; // preserva estructura relativa
-            std::filesystem::create_directories(dst.parent_path(), ec);
-            if (!ec) {
-                std::filesystem::copy_file(a.abs, dst,
-                    std::filesystem::copy_options::overwrite_existing, ec);
-            }
-
-            nlohmann::json row;
-            row["source"] = a.abs.generic_string();
-            row["dest"] = dst.generic_string();
-            row["reason"] = a.reason;
-
-            if (ec) {
-                row["status"] = std::string("error: ") + ec.message();
-                manifest["missing"].push_back(row);
-                missing.push_back(a.abs);
+            if (sc.path.empty() || !seen.insert(sc.path).second) continue;
+            const auto file = ResolveAssetPath(AssetStore::Resolve(sc.path));
+            const std::string source = file ? ReadFileBytes(*file) : std::string();
+            if (source.empty()) { report(sc.path, "script", "no se pudo leer"); continue; }
+
+            std::string err;
+            if (const std::string* bytecode = ScriptCache::Get(source, sc.path, err)) {
+                if (!pak.Add(sc.path, *bytecode, AssetPack::Kind::LuaBytecode)) break;
             }
             else {
-                row["status"] = "ok";
-                manifest["copied"].push_back(row);
+                Log::Error("[EXPORT] " + sc.path + " no compila: " + err);
+                if (!pak.Add(sc.path, source)) break;
             }
+            report(sc.path, "script", "ok");
         }
 
-        // dump manifest
+        if (!pak.Finish()) {
+            Log::Error("[EXPORT] ERROR escribiendo game.gppak: " + pak.Error());
+            return false;
+        }
+        Log::Info("[EXPORT] game.gppak: " + std::to_string(pak.BytesWritten() / 1024) + " KB");
+
         try {
             std::ofstream mf(outDir / "assets_manifest.json");
             mf << manifest.dump(2);
@@ -245,8 +209,7 @@ namespace {
         catch (...) {
             // ignoramos errores del manifest
         }
-
-        return missing;
+        return true;
     }
 
     // ====== SAVE/LOAD ======
@@ -375,7 +338,8 @@ namespace {
 
         bool ok = SceneSerializer::Load(*scx.scene, projPath);
         FixSceneAfterLoad();
-        Renderer2D::ClearTextureCache();
+        Renderer2D::RevalidateTextures();
+        edx.history.Clear(); // los deltas apuntan a la escena anterior
 
         auto now = system_clock::now();
         std::time_t t = system_clock::to_time_t(now);
@@ -392,6 +356,44 @@ namespace {
         Log::Info(oss.str());
     }
 
+    // ---- Undo / Redo ----
+    // Entidades recién creadas = un paso de historial
+    static void RecordCreated(const char* label, const Scene& scene, const std::vector<EntityID>& ids) {
+        auto& history = EditorContext::Get().history;
+        auto tx = history.Begin(label);
+        for (EntityID id : ids) tx.TouchNew(id);
+        history.Commit(tx, scene);
+    }
+
+    // Tras deshacer/rehacer la selección puede apuntar a entidades que ya no existen
+    static void DropDeadSelection(const Scene& scene) {
+        auto& edx = EditorContext::Get();
+        if (edx.selected && !scene.transforms.contains(edx.selected.id)) edx.selected = {};
+        std::erase_if(edx.multiSelected, [&](EntityID id) { return !scene.transforms.contains(id); });
+    }
+
+    static void DoUndo() {
+        auto& scx = SceneContext::Get();
+        auto& history = EditorContext::Get().history;
+        if (!scx.scene || !history.CanUndo()) return;
+        const std::string label = history.UndoLabel();
+        if (history.Undo(*scx.scene)) {
+            DropDeadSelection(*scx.scene);
+            Log::Info("[UNDO] " + label);
+        }
+    }
+
+    static void DoRedo() {
+        auto& scx = SceneContext::Get();
+        auto& history = EditorContext::Get().history;
+        if (!scx.scene || !history.CanRedo()) return;
+        const std::string label = history.RedoLabel();
+        if (history.Redo(*scx.scene)) {
+            DropDeadSelection(*scx.scene);
+            Log::Info("[REDO] " + label);
+        }
+    }
+
     static Entity SpawnBox(Scene& scene,
         const sf::Vector2f& pos,
         const sf::Vector2f& size,
@@ -455,6 +457,11 @@ namespace {
             scene.textures[dst.id] = it->second;
         }
 
+        // Capa de render
+        if (auto it = scene.renderLayers.find(src.id); it != scene.renderLayers.end()) {
+            scene.renderLayers[dst.id] = it->second;
+        }
+
         // Script (respeta path o inlineCode; fuerza reload)
         if (auto it = scene.scripts.find(src.id); it != scene.scripts.end()) {
             Script sc = it->second;      // copia completa (path e inlineCode)
@@ -515,15 +522,9 @@ namespace {
             return;
         }
 
-        // 2) Guardar escena
-        {
-            std::filesystem::path sceneOut = outDir / "scene.json";
-            bool ok = SceneSerializer::Save(*scx.scene, sceneOut.string());
-            if (!ok) {
-                Log::Error("[EXPORT] ERROR guardando scene.json");
-                return;
-            }
-        }
+        // 2) Escena + assets en un solo archivo
+        LogAssetsRoot();
+        if (!WriteGamePack(*scx.scene, outDir)) return;
 
         // 3) Copiar ejecutable del Player
 #ifdef _WIN32
@@ -618,25 +619,9 @@ namespace {
         }
 #endif
 
-        // 5) Copiar Assets (filtrados)
-        {
-            LogAssetsRoot();
-            auto missing = CopyUsedAssetsOnly(*scx.scene, outDir);
-
-            if (missing.empty()) {
-                Log::Info("[EXPORT] Assets filtrados copiados correctamente.");
-            }
-            else {
-                Log::Info("[EXPORT] Algunos assets referenciados no se copiaron (ver assets_manifest.json).");
-                for (const auto& m : missing) {
-                    Log::Error(std::string("[EXPORT] Missing/Outside-Assets: ") + m.string());
-                }
-            }
-        }
-
-        // 6) Mensaje final
+        // 5) Mensaje final
         Log::Info(std::string("[EXPORT] OK: carpeta lista en  ") + outDir.string());
-        Log::Info("           Para correr, ejecutá GameProtoGenPlayer (toma scene.json local).");
+        Log::Info("           Para correr, ejecutá GameProtoGenPlayer (toma game.gppak local).");
     }
 } // namespace
 // ====================== Fin Helpers ======================
@@ -681,6 +666,15 @@ void EditorDockLayer::OnGuiRender() {
             ImGui::EndMenu();
         }
 
+        if (ImGui::BeginMenu("Editar", !playing)) {
+            auto& history = EditorContext::Get().history;
+            const std::string undoLabel = history.CanUndo() ? "Deshacer " + history.UndoLabel() : "Deshacer";
+            const std::string redoLabel = history.CanRedo() ? "Rehacer " + history.RedoLabel() : "Rehacer";
+            if (ImGui::MenuItem(undoLabel.c_str(), "Ctrl+Z", false, history.CanUndo())) DoUndo();
+            if (ImGui::MenuItem(redoLabel.c_str(), "Ctrl+Y", false, history.CanRedo())) DoRedo();
+            ImGui::EndMenu();
+        }
+
         if (ImGui::BeginMenu("GameObjects", !playing)) {
             auto& scx = SceneContext::Get();
             auto& edx = EditorContext::Get();
@@ -689,6 +683,7 @@ void EditorDockLayer::OnGuiRender() {
                 if (scx.scene) {
                     const sf::Vector2f spawnPos = scx.cameraCenter;
                     Entity e = SpawnBox(*scx.scene, spawnPos, { 100.f, 100.f });
+                    RecordCreated("Crear cuadrado", *scx.scene, { e.id });
                     edx.selected = e;
                 }
             }
@@ -696,6 +691,7 @@ void EditorDockLayer::OnGuiRender() {
                 if (scx.scene) {
                     const sf::Vector2f spawnPos = scx.cameraCenter;
                     Entity e = SpawnPlatform(*scx.scene, spawnPos, { 200.f, 50.f });
+                    RecordCreated("Crear plataforma", *scx.scene, { e.id });
                     edx.selected = e;
                 }
             }
@@ -705,6 +701,7 @@ void EditorDockLayer::OnGuiRender() {
                 if (ImGui::MenuItem("Duplicar seleccionado", "Ctrl+D")) {
                     Entity newE = DuplicateEntity(*scx.scene, edx.selected, { 16.f,16.f });
                     if (newE) {
+                        RecordCreated("Duplicar", *scx.scene, { newE.id });
                         edx.selected = newE;
                         edx.requestSelectTool = true;
                     }
@@ -779,9 +776,19 @@ void EditorDockLayer::OnGuiRender() {
         if (io.KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_S, false)) DoSave();
         if (io.KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_O, false)) DoLoad();
 
+        // Ctrl+Z deshacer; Ctrl+Y o Ctrl+Shift+Z rehacer (no mientras se escribe en un campo)
+        if (io.KeyCtrl && !io.WantTextInput) {
+            if (ImGui::IsKeyPressed(ImGuiKey_Z, true)) {
+                if (io.KeyShift) DoRedo();
+                else DoUndo();
+            }
+            if (ImGui::IsKeyPressed(ImGuiKey_Y, true)) DoRedo();
+        }
+
         if (io.KeyCtrl && ImGui::IsKeyPressed(ImGuiKey_N, false)) {
             if (scx.scene) {
                 Entity e = SpawnBox(*scx.scene, scx.cameraCenter, { 100.f, 100.f });
+                RecordCreated("Crear cuadrado", *scx.scene, { e.id });
                 edx.selected = e;
             }
         }
@@ -821,6 +828,7 @@ void EditorDockLayer::OnGuiRender() {
             }
 
             if (copies.empty()) return;
+            RecordCreated("Duplicar", *scx.scene, copies);
 
             // 3) Actualizar selección: dejar seleccionadas SOLO las copias nuevas
             edx.multiSelected.clear();
@@ -854,10 +862,11 @@ void EditorDockLayer::OnGuiRender() {
                 if (!IsPlayer(*scx.scene, edx.selected)) toDelete.push_back(edx.selected.id);
             }
 
-            // 2) Borrar
-            for (EntityID id : toDelete) {
-                scx.scene->DestroyEntity(Entity{ id }); // o DestroyEntity(id) según tu firma
-            }
+            // 2) Borrar (una sola pasada; una sola entrada de undo)
+            auto tx = edx.history.Begin("Eliminar");
+            for (EntityID id : toDelete) tx.Touch(*scx.scene, id);
+            scx.scene->DestroyEntities(toDelete);
+            edx.history.Commit(tx, *scx.scene);
 
             // 3) Limpiar TODA la selección (sin fallback)
             edx.selected = {};
@@ -11,6 +11,8 @@
 #include "Auth/TokenManager.h"
 #include "Net/ApiClient.h"
 #include "Editor/EditorDockLayer.h"
+#include "Runtime/GameRunner.h"
+#include "Runtime/AssetWatcher.h"
 
 #include <imgui.h>
 #include <filesystem>
@@ -218,11 +220,13 @@ void LauncherLayer::EnterEditor() {
     auto& scx = SceneContext::Get();
     auto& edx = EditorContext::Get();
 
+    edx.history.Clear(); // escena nueva o cargada: historial vacío
+
     // cargar existente o sembrar nuevo
     if (!m_selected.empty() && exists(m_selected)) {
         if (!scx.scene) scx.scene = std::make_shared<Scene>();
         SceneSerializer::Load(*scx.scene, m_selected);
-        Renderer2D::ClearTextureCache();
+        Renderer2D::RevalidateTextures();
         edx.projectPath = m_selected; // usar este archivo como proyecto actual
     }
     else {
@@ -238,6 +242,13 @@ void LauncherLayer::EnterEditor() {
         SceneSerializer::Save(*scx.scene, edx.projectPath);
     }
 
+    // Hot-reload de texturas/scripts editados a mano mientras el editor está abierto
+    if (!AssetWatcher::Active()) {
+        std::error_code ec;
+        std::filesystem::create_directories("Assets", ec);
+        GameRunner::WatchAssets("Assets");
+    }
+
     app.SetMode(gp::Application::Mode::Editor);
     auto& win = static_cast<gp::SFMLWindow&>(app.Window());
     win.SetMaximized(true);
@@ -15,77 +15,14 @@
 #include <fstream>
 #include <vector>
 #include <filesystem>
+#include <mutex>
 #include "ViewportPanel.h"
 #include "Systems/Renderer2D.h"
+#include "Runtime/AssetStore.h"
 #include "Core/Log.h"
 
 using json = nlohmann::json;
 
-static bool SaveTextToFile(const std::string& outPath, const std::string& text) {
-    try {
-        std::filesystem::create_directories(std::filesystem::path(outPath).parent_path());
-        std::ofstream ofs(outPath, std::ios::binary);
-        if (!ofs) return false;
-        ofs.write(text.data(), static_cast<std::streamsize>(text.size()));
-        return ofs.good();
-    }
-    catch (...) { return false; }
-}
-
-// ---------------- base64 decode helper (con soporte de padding '=') ----------------
-static std::vector<unsigned char> Base64Decode(const std::string& input) {
-    // -1: inválido/ignorar, -2: '=' padding
-    static const int8_t DT[256] = {
-        /* 0..15  */ -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-        /* 16..31 */ -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-        /* 32..47 */ -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,62, -1,-1,-1,63,
-        /* 48..63 */ 52,53,54,55,56,57,58,59,60,61,-1,-1,-1,-2,-1,-1,
-        /* 64..79 */ -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,
-        /* 80..95 */ 15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,-1,
-        /* 96..111*/ -1,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,
-        /*112..127*/ 41,42,43,44,45,46,47,48,49,50,51,-1,-1,-1,-1,-1,
-        /*128..255*/ -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
-                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
-    };
-
-    std::vector<unsigned char> out;
-    out.reserve(input.size() * 3 / 4);
-    int val = 0, valb = -8;
-    for (unsigned char c : input) {
-        int d = DT[c];
-        if (d == -1) continue;   // ignora espacios/chars inválidos
-        if (d == -2) break;      // '=' padding -> fin
-        val = (val << 6) | d;
-        valb += 6;
-        if (valb >= 0) {
-            out.push_back(static_cast<unsigned char>((val >> valb) & 0xFF));
-            valb -= 8;
-        }
-    }
-    return out;
-}
-
-static bool SaveBase64ToFile(const std::string& base64, const std::string& outPath) {
-    try {
-        auto bytes = Base64Decode(base64);
-        if (bytes.empty()) return false;
-        std::filesystem::create_directories(std::filesystem::path(outPath).parent_path());
-        std::ofstream ofs(outPath, std::ios::binary);
-        if (!ofs) return false;
-        ofs.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
-        return ofs.good();
-    }
-    catch (...) {
-        return false;
-    }
-}
-
 // --- Helpers locales para dibujar iconos como botón  ---
 static ImVec2 FitIconHeight(const sf::Texture& tex, float btnH) {
     const auto size = tex.getSize();
@@ -125,45 +62,6 @@ static bool IconButtonFromTexture(const char* id,
     return pressed;
 }
 
-// ------------------------- helpers de color -------------------------
-static inline bool is_hex_digit(char c) {
-    return std::isxdigit(static_cast<unsigned char>(c)) != 0;
-}
-static sf::Color ColorFromHexString(const std::string& in) {
-    std::string s = in;
-    if (!s.empty() && s[0] == '#') s.erase(0, 1);
-    if (!(s.size() == 6 || s.size() == 8)) return sf::Color(60, 60, 70, 255);
-    if (!std::all_of(s.begin(), s.end(), is_hex_digit)) return sf::Color(60, 60, 70, 255);
-    auto hexByte = [&](size_t pos) -> std::uint8_t {
-        return static_cast<std::uint8_t>(std::stoul(s.substr(pos, 2), nullptr, 16));
-        };
-    std::uint8_t r = hexByte(0);
-    std::uint8_t g = hexByte(2);
-    std::uint8_t b = hexByte(4);
-    std::uint8_t a = (s.size() == 8) ? hexByte(6) : 255;
-    return sf::Color(r, g, b, a);
-}
-static sf::Color TryParseColor(const json& j, const sf::Color& fallback = sf::Color(60, 60, 70, 255)) {
-    if (j.contains("colorHex") && j["colorHex"].is_string()) return ColorFromHexString(j["colorHex"].get<std::string>());
-    if (j.contains("color") && j["color"].is_object()) {
-        const auto& c = j["color"];
-        auto clamp255 = [](int v) { return std::clamp(v, 0, 255); };
-        int r = c.value("r", 255), g = c.value("g", 255), b = c.value("b", 255), a = c.value("a", 255);
-        return sf::Color((std::uint8_t)clamp255(r), (std::uint8_t)clamp255(g), (std::uint8_t)clamp255(b), (std::uint8_t)clamp255(a));
-    }
-    return fallback;
-}
-// ------------------------- helper entity id -------------------------
-static uint32_t GetEntityId(const nlohmann::json& j) {
-    if (!j.contains("entity") || j["entity"].is_null()) return 0;
-    const auto& v = j["entity"];
-    if (v.is_number_unsigned()) return v.get<uint32_t>();
-    if (v.is_number_integer()) { int vi = v.get<int>(); return vi > 0 ? static_cast<uint32_t>(vi) : 0; }
-    if (v.is_number_float()) { double vf = v.get<double>(); return vf >= 0.0 ? static_cast<uint32_t>(std::round(vf)) : 0; }
-    if (v.is_string()) { try { return static_cast<uint32_t>(std::stoul(v.get<std::string>())); } catch (...) { return 0; } }
-    return 0;
-}
-
 // ========================= ChatPanel =========================
 
 ChatPanel::ChatPanel(std::shared_ptr<ApiClient> client)
@@ -213,9 +111,15 @@ void ChatPanel::OnGuiRender() {
     ImGui::PopItemWidth();
 
     ImGui::SameLine();
-    ImGui::BeginDisabled(m_Busy || m_Input.empty());
-    if (ImGui::Button(m_Busy ? "Enviando..." : "Enviar")) send = true;
-    ImGui::EndDisabled();
+    if (m_Busy) {
+        // La request sigue en la cola/worker del ApiClient: se aborta y la burbuja muestra "Cancelado"
+        if (ImGui::Button("Cancelar") && m_Cancel) *m_Cancel = true;
+    }
+    else {
+        ImGui::BeginDisabled(m_Input.empty());
+        if (ImGui::Button("Enviar")) send = true;
+        ImGui::EndDisabled();
+    }
 
     if (hasAnySel) {
         ImGui::Dummy(ImVec2(0, ImGui::GetStyle().ItemSpacing.y * 0.25f));
@@ -233,192 +137,249 @@ void ChatPanel::OnGuiRender() {
         SendCurrentPrompt();
     }
 
+    // ----- Descargas de assets terminadas -----
+    if (!m_Downloads.empty()) PollDownloads();
+
     // ----- Pool de la futura (si hay) -----
     if (m_Busy && m_Fut.valid()) {
         using namespace std::chrono_literals;
         if (m_Fut.wait_for(0ms) == std::future_status::ready) {
             auto res = m_Fut.get();
-            m_Busy = false;
-            if (m_TypingIndex >= 0 && m_TypingIndex < (int)m_History.size()) {
-                auto& typingBubble = m_History[m_TypingIndex];
-                typingBubble.typing = false;
 
-                if (!res.ok()) {
-                    typingBubble.text = std::string("Error: ") + res.error;
-                }
-                else {
-                    const nlohmann::json& root = *res.data;
-                    const std::string kind = root.value("kind", "");
-
-                    Log::Info("[DBG]: " + kind);
-
-                    if (kind == "ops") {
-                        OpCounts c = ApplyOpsFromJson(root);
-                        typingBubble.text = "Listo: "
-                            + std::to_string(c.created) + " creadas, "
-                            + std::to_string(c.modified) + " modificadas, "
-                            + std::to_string(c.removed) + " eliminadas.";
-                    }
-                    else if (kind == "text") {
-                        typingBubble.text = root.value("message", "");
-                    }
-                    else if (kind == "asset") {
-                        const std::string fileName = root.value("fileName", "asset.png");
-                        const std::string data = root.value("data", "");
-                        std::string safeName = fileName;
-                        for (char& ch : safeName) {
-                            if (ch == '/' || ch == '\\' || ch == ':' || ch == '*' ||
-                                ch == '?' || ch == '"' || ch == '<' || ch == '>' || ch == '|') ch = '_';
-                        }
-                        const std::string outPath = "Assets/Generated/" + safeName;
-                        if (!data.empty() && SaveBase64ToFile(data, outPath)) {
-                            typingBubble.text = std::string("Imagen guardada en:\n") + std::filesystem::absolute(outPath).string();
-                            Log::Info(std::string("[ASSET] Guardado: ") + outPath);
-                        }
-                        else {
-                            typingBubble.text = "No pude guardar la imagen (payload incompleto o base64 inválido).";
-                            Log::Error("[ASSET] ERROR al guardar la imagen.");
-                        }
-                    }
-                    else if (kind == "script") {
-                        const std::string fileName = root.value("fileName", "script.lua");
-                        const std::string code = root.value("code", "");
-
-                        std::string safeName = fileName;
-                        for (char& ch : safeName) {
-                            if (ch == '/' || ch == '\\' || ch == ':' || ch == '*' || ch == '?' ||
-                                ch == '"' || ch == '<' || ch == '>' || ch == '|') ch = '_';
-                        }
-                        const std::string outPath = "Assets/Scripts/" + safeName;
-
-                        if (!code.empty() && SaveTextToFile(outPath, code)) {
-                            typingBubble.text = std::string("Script guardado en:\n")
-                                + std::filesystem::absolute(outPath).string()
-                                + "\n(No asignado a ninguna entidad.)";
-                            Log::Info(std::string("[SCRIPT] Guardado: ") + outPath);
-                        }
-                        else {
-                            typingBubble.text = "No pude guardar el script (payload vacío o error de escritura).";
-                            Log::Error("[SCRIPT] ERROR al guardar script.");
-                        }
-                    }
-                    else if (kind == "bundle") {
-                        OpCounts total{};
-                        std::vector<std::string> texts;
-
-                        // 1) Guardar assets
-                        if (root.contains("items") && root["items"].is_array()) {
-                            for (const auto& it : root["items"]) {
-                                const std::string ik = it.value("kind", "");
-                                if (ik == "asset") {
-                                    const std::string fileName = it.value("fileName", "asset.png");
-                                    const std::string data = it.value("data", "");
-                                    std::string safeName = fileName;
-                                    for (char& ch : safeName) {
-                                        if (ch == '/' || ch == '\\' || ch == ':' || ch == '*' ||
-                                            ch == '?' || ch == '"' || ch == '<' || ch == '>' || ch == '|') ch = '_';
-                                    }
-                                    const std::string outPath = "Assets/Generated/" + safeName;
-                                    if (!data.empty() && SaveBase64ToFile(data, outPath)) {
-                                        Log::Info(std::string("[ASSET] Guardado: ") + outPath);
-                                    }
-                                    else {
-                                        Log::Error("[ASSET] ERROR al guardar: " + outPath);
-                                    }
-                                }
-                                if (ik == "script") {
-                                    const std::string fileName = it.value("fileName", "script.lua");
-                                    const std::string code = it.value("code", "");
-                                    std::string safeName = fileName;
-                                    for (char& ch : safeName) {
-                                        if (ch == '/' || ch == '\\' || ch == ':' || ch == '*' || ch == '?' ||
-                                            ch == '"' || ch == '>' || ch == '<' || ch == '|') ch = '_';
-                                    }
-                                    const std::string outPath = "Assets/Scripts/" + safeName;
-                                    if (!code.empty() && SaveTextToFile(outPath, code)) {
-                                        Log::Info(std::string("[SCRIPT] Guardado: ") + outPath);
-                                        // Asignación automática
-                                        auto& scx = SceneContext::Get();
-                                        auto& edx2 = EditorContext::Get();
-                                        EntityID target = 0;
-                                        if (edx2.selected) target = edx2.selected.id;
-                                        else if (scx.scene && !scx.scene->playerControllers.empty())
-                                            target = scx.scene->playerControllers.begin()->first;
-                                        if (!target && scx.scene) {
-                                            Entity e = scx.scene->CreateEntity();
-                                            scx.scene->transforms[e.id] = Transform{ scx.cameraCenter, {1.f,1.f}, 0.f };
-                                            scx.scene->sprites[e.id] = Sprite{ {64.f,64.f}, sf::Color(255,255,255,255) };
-                                            scx.scene->colliders[e.id] = Collider{ {32.f,32.f}, {0.f,0.f} };
-                                            target = e.id;
-                                            edx2.selected = e;
-                                        }
-                                        if (scx.scene && target) {
-                                            auto& sc = scx.scene->scripts[target];
-                                            sc.path = outPath;
-                                            sc.inlineCode.clear();
-                                            sc.loaded = false;
-                                        }
-                                    }
-                                    else {
-                                        Log::Error("[SCRIPT] ERROR al guardar (bundle).");
-                                    }
-                                }
-                            }
-                        }
-
-                        // 2) Aplicar ops + textos
-                        if (root.contains("items") && root["items"].is_array()) {
-                            for (const auto& it : root["items"]) {
-                                const std::string ik = it.value("kind", "");
-                                if (ik == "ops") {
-                                    OpCounts c = ApplyOpsFromJson(it);
-                                    total.created += c.created;
-                                    total.modified += c.modified;
-                                    total.removed += c.removed;
-                                }
-                                else if (ik == "text") {
-                                    texts.push_back(it.value("message", ""));
-                                }
-                            }
-                        }
-
-                        // 3) Mensaje final
-                        if (total.created || total.modified || total.removed) {
-                            typingBubble.text = "Listo: "
-                                + std::to_string(total.created) + " creadas, "
-                                + std::to_string(total.modified) + " modificadas, "
-                                + std::to_string(total.removed) + " eliminadas.";
-                            for (auto& t : texts) if (!t.empty()) m_History.push_back({ Role::Assistant, t, false });
-                        }
-                        else {
-                            if (!texts.empty()) typingBubble.text = texts.front();
-                            for (size_t i = 1; i < texts.size(); ++i)
-                                if (!texts[i].empty()) m_History.push_back({ Role::Assistant, texts[i], false });
-                            if (texts.empty()) typingBubble.text = "No hubo cambios ni mensajes.";
-                        }
-                    }
-                    else {
-                        if (root.contains("ops")) {
-                            OpCounts c = ApplyOpsFromJson(root);
-                            typingBubble.text = "Listo: "
-                                + std::to_string(c.created) + " creadas, "
-                                + std::to_string(c.modified) + " modificadas, "
-                                + std::to_string(c.removed) + " eliminadas.";
-                        }
-                        else {
-                            typingBubble.text = root.dump();
-                        }
-                    }
-                }
+            // Confirmación de la revisión de escena que quedó en el server
+            if (res.sceneRev) m_SceneSync.Acknowledge(*res.sceneRev);
+            else              m_SceneSync.Invalidate(); // server sin soporte de delta -> siempre completa
+
+            // 409: el server perdió nuestra base -> reenviar la misma request con la escena completa
+            if (res.resync && !m_ResyncTried && !m_Cancel->load()) {
+                Log::Info("[CHAT] scene resync requested by server, resending full scene");
+                m_ResyncTried = true;
+                DispatchPending();
+                ImGui::End();
+                return;
+            }
+
+            // Server sin endpoint de streaming: seguir con respuestas completas
+            if (m_Streaming && res.httpStatus == 404 && !m_Cancel->load()) {
+                Log::Info("[CHAT] /chat/command/stream not available, falling back to full responses");
+                m_UseStreaming = false;
+                DispatchPending();
+                ImGui::End();
+                return;
             }
-            m_TypingIndex = -1;
-            m_RequestScrollToBottom = true;
+
+            // Respuesta completa: decodificar/guardar/validar en el pipeline, no en este frame
+            if (!m_Streaming && res.ok()) m_Pipeline->Submit(std::move(*res.data));
+            m_Result = std::move(res);
         }
     }
 
+    // ----- Aplicar a la Scene lo que el pipeline ya preparó (con presupuesto por frame) -----
+    PumpPipeline();
+
+    // La request termina cuando llegó el resultado y no queda nada por aplicar
+    if (m_Result && !m_Commit.active && m_Pipeline->Idle()) FinishRequest();
+
     ImGui::End();
 }
 
+// ---------- Aplicación de respuestas ----------
+
+void ChatPanel::PumpPipeline() {
+    using Clock = std::chrono::steady_clock;
+    const auto deadline = Clock::now() + std::chrono::microseconds(kCommitBudgetUs);
+    bool applied = false;
+
+    for (;;) {
+        if (!m_Commit.active) {
+            if (!m_Pipeline->Poll(m_Commit.resp)) break;
+            StartCommit();
+        }
+        if (!CommitOps(deadline)) break; // quedan ops: siguen el próximo frame
+
+        m_Commit.active = false;
+        applied = true;
+
+        const OpCounts c{ (int)m_Commit.created.size(), (int)m_Commit.modified.size(), (int)m_Commit.removed.size() };
+        const PreparedResponse& pr = m_Commit.resp;
+        if (!m_Streaming) {
+            m_FinalText = FinishResponse(pr, c); // puede agregar burbujas
+        }
+        else if (pr.kind == "delta") {
+            m_StreamText += pr.message;
+        }
+        else if (pr.kind == "ops") {
+            // Cada batch se aplica apenas llega
+            m_StreamOps.created += c.created;
+            m_StreamOps.modified += c.modified;
+            m_StreamOps.removed += c.removed;
+        }
+        else if (pr.kind != "done") {
+            // text / asset / script / bundle: mismo tratamiento que la respuesta completa
+            const std::string msg = FinishResponse(pr, c);
+            if (!msg.empty()) {
+                if (!m_StreamText.empty()) m_StreamText += "\n\n";
+                m_StreamText += msg;
+            }
+        }
+
+        if (Clock::now() >= deadline) break;
+    }
+
+    if (applied && m_Streaming && m_TypingIndex >= 0 && m_TypingIndex < (int)m_History.size()) {
+        auto& bubble = m_History[m_TypingIndex];
+        bubble.text = StreamBubbleText();
+        bubble.typing = bubble.text.empty(); // "..." hasta el primer contenido
+    }
+    if (applied) m_RequestScrollToBottom = true;
+}
+
+// Parte no-op de una respuesta preparada: logs, descargas y scripts del bundle
+void ChatPanel::StartCommit() {
+    m_Commit.active = true;
+    m_Commit.next = 0;
+    m_Commit.created.clear();
+    m_Commit.modified.clear();
+    m_Commit.removed.clear();
+
+    PreparedResponse& pr = m_Commit.resp;
+    for (const auto& l : pr.logs) {
+        if (l.error) Log::Error(l.text);
+        else         Log::Info(l.text);
+    }
+
+    // Con hash conocido se baja directo al blob del AssetStore (si ya existe no hay descarga)
+    for (const auto& d : pr.downloads) {
+        const std::string dest = d.sha256.empty() ? d.path : AssetStore::BlobPath(d.sha256, d.path);
+        m_Downloads.push_back({ m_Client->DownloadAssetAsync(d.assetId, dest, d.sha256), d.path, !d.sha256.empty() });
+    }
+
+    // Asignación automática de scripts del bundle: seleccionado, jugador o entidad nueva
+    for (const auto& path : pr.assignScripts) {
+        auto& scx = SceneContext::Get();
+        auto& edx = EditorContext::Get();
+        EntityID target = 0;
+        if (edx.selected) target = edx.selected.id;
+        else if (scx.scene && !scx.scene->playerControllers.empty())
+            target = scx.scene->playerControllers.begin()->first;
+        if (!target && scx.scene) {
+            Entity e = scx.scene->CreateEntity();
+            UndoTx().TouchNew(e.id);
+            scx.scene->transforms[e.id] = Transform{ scx.cameraCenter, {1.f,1.f}, 0.f };
+            scx.scene->sprites[e.id] = Sprite{ {64.f,64.f}, sf::Color(255,255,255,255) };
+            scx.scene->colliders[e.id] = Collider{ {32.f,32.f}, {0.f,0.f} };
+            target = e.id;
+            edx.selected = e;
+        }
+        if (scx.scene && target) {
+            UndoTx().Touch(*scx.scene, target);
+            auto& sc = scx.scene->scripts[target];
+            sc.path = path;
+            sc.inlineCode.clear();
+            sc.loaded = false;
+        }
+    }
+}
+
+bool ChatPanel::CommitOps(std::chrono::steady_clock::time_point deadline) {
+    const auto& ops = m_Commit.resp.ops;
+    if (m_Commit.next < ops.size()) {
+        auto& scx = SceneContext::Get();
+        if (!scx.scene) scx.scene = std::make_shared<Scene>();
+    }
+    while (m_Commit.next < ops.size()) {
+        ApplyOp(ops[m_Commit.next++]);
+        // Listas enormes: cortar al agotar el presupuesto y seguir en el próximo frame
+        if ((m_Commit.next % 64) == 0 && m_Commit.next < ops.size() &&
+            std::chrono::steady_clock::now() >= deadline)
+            return false;
+    }
+    return true;
+}
+
+// Texto de la burbuja para una respuesta ya aplicada
+std::string ChatPanel::FinishResponse(const PreparedResponse& pr, const OpCounts& c) {
+    auto listo = [](const OpCounts& k) {
+        return "Listo: "
+            + std::to_string(k.created) + " creadas, "
+            + std::to_string(k.modified) + " modificadas, "
+            + std::to_string(k.removed) + " eliminadas.";
+    };
+
+    if (pr.kind == "ops") return listo(c);
+    if (pr.kind != "bundle") return pr.message;
+
+    std::string out;
+    if (c.created || c.modified || c.removed) {
+        out = listo(c);
+        for (auto& t : pr.texts) if (!t.empty()) m_History.push_back({ Role::Assistant, t, false });
+    }
+    else {
+        if (!pr.texts.empty()) out = pr.texts.front();
+        for (size_t i = 1; i < pr.texts.size(); ++i)
+            if (!pr.texts[i].empty()) m_History.push_back({ Role::Assistant, pr.texts[i], false });
+        if (pr.texts.empty()) out = "No hubo cambios ni mensajes.";
+    }
+    return out;
+}
+
+void ChatPanel::FinishRequest() {
+    const ApiClient::Result res = std::move(*m_Result);
+    m_Result.reset();
+    m_Busy = false;
+
+    if (m_UndoTx) {
+        auto& scx = SceneContext::Get();
+        auto& history = EditorContext::Get().history;
+        if (scx.scene) history.Commit(*m_UndoTx, *scx.scene);
+        else history.Cancel(*m_UndoTx);
+        m_UndoTx.reset();
+    }
+
+    if (m_TypingIndex >= 0 && m_TypingIndex < (int)m_History.size()) {
+        // Lo que ya se aplicó durante el stream queda; el estado final va a continuación
+        const std::string partial = m_Streaming ? StreamBubbleText() : std::string();
+        const std::string sep = partial.empty() ? "" : "\n\n";
+
+        std::string text;
+        if (res.cancelled)       text = partial + sep + "Cancelado.";
+        else if (!res.ok())      text = partial + sep + "Error: " + res.error;
+        else if (m_Streaming)    text = partial.empty() ? "No hubo cambios ni mensajes." : partial;
+        else                     text = std::move(m_FinalText);
+
+        auto& typingBubble = m_History[m_TypingIndex];
+        typingBubble.typing = false;
+        typingBubble.text = std::move(text);
+    }
+    m_FinalText.clear();
+    m_TypingIndex = -1;
+    m_RequestScrollToBottom = true;
+}
+
+void ChatPanel::PollDownloads() {
+    using namespace std::chrono_literals;
+    for (auto it = m_Downloads.begin(); it != m_Downloads.end();) {
+        if (it->fut.wait_for(0ms) != std::future_status::ready) { ++it; continue; }
+
+        ApiClient::DownloadResult r = it->fut.get();
+        if (r.ok && it->toStore) AssetStore::Link(it->path, r.sha256);
+        if (r.ok) {
+            // Si una op ya apuntaba a este path, la textura se vuelve a cargar del archivo nuevo
+            Renderer2D::InvalidateTexture(it->path);
+            Log::Info("[ASSET] Guardado: " + it->path + " (" + std::to_string(r.bytes) + " bytes"
+                + (r.cached ? ", ya estaba en disco)" : ")"));
+            m_History.push_back({ Role::Assistant,
+                std::string("Imagen guardada en:\n") + std::filesystem::absolute(r.path).string(), false });
+        }
+        else if (!r.cancelled) {
+            Log::Error("[ASSET] ERROR al descargar " + it->path + ": " + r.error);
+            m_History.push_back({ Role::Assistant, "No pude descargar la imagen: " + r.error, false });
+        }
+        m_RequestScrollToBottom = true;
+        it = m_Downloads.erase(it);
+    }
+}
+
 // Enviar: agrega burbuja del usuario + burbuja de "..." del asistente y dispara la request
 void ChatPanel::SendCurrentPrompt() {
     // 1) Usuario
@@ -430,15 +391,8 @@ void ChatPanel::SendCurrentPrompt() {
     m_RequestScrollToBottom = true;
 
     // 3) Disparar request
-    m_Busy = true;
-
-    auto& scx = SceneContext::Get();
     auto& edx = EditorContext::Get();
 
-    nlohmann::json sceneJson = scx.scene
-        ? SceneSerializer::Dump(*scx.scene)
-        : nlohmann::json::object();
-
     // Scope de edición: solo si el checkbox está activo
     std::vector<uint32_t> selectedIds;
     if (m_OnlySelectedScope) {
@@ -452,13 +406,63 @@ void ChatPanel::SendCurrentPrompt() {
     }
     // Nota: si el checkbox NO está tildado, 'selectedIds' queda vacío a propósito.
 
-    // Enviar (el ApiClient omite "selected" si selectedIds está vacío)
-    m_Fut = m_Client->SendCommandAsync(m_Input, sceneJson, std::move(selectedIds));
+    m_PendingPrompt = m_Input;
+    m_PendingSelected = std::move(selectedIds);
+    m_ResyncTried = false;
+    m_Cancel = ApiClient::MakeCancelToken();
+    DispatchPending();
 
     // 4) limpiar input
     m_Input.clear();
 }
 
+void ChatPanel::DispatchPending() {
+    m_Busy = true;
+    m_Streaming = m_UseStreaming;
+    m_StreamText.clear();
+    m_StreamOps = {};
+
+    auto& scx = SceneContext::Get();
+    if (m_ResyncTried) m_SceneSync.Invalidate();
+
+    SceneDeltaTracker::Payload payload;
+    if (scx.scene) {
+        payload = m_SceneSync.Build(*scx.scene);
+    }
+    else {
+        m_SceneSync.Invalidate();
+        payload.body = nlohmann::json::object();
+    }
+
+    // Enviar (el ApiClient omite "selected" si está vacío)
+    if (m_Streaming) {
+        // El callback corre en el worker del ApiClient: pasa directo al pipeline y
+        // PumpPipeline lo aplica en el UI thread, en el mismo orden en que llegó
+        m_Fut = m_Client->StreamCommandAsync(m_PendingPrompt, std::move(payload.body),
+            m_PendingSelected, payload.isDelta, m_Cancel,
+            [pipe = m_Pipeline](const nlohmann::json& ev) { pipe->Submit(ev); });
+    }
+    else {
+        m_Fut = m_Client->SendCommandAsync(m_PendingPrompt, std::move(payload.body),
+            m_PendingSelected, payload.isDelta, m_Cancel);
+    }
+}
+
+// ---------- Streaming ----------
+
+std::string ChatPanel::StreamBubbleText() const {
+    std::string text = m_StreamText;
+    const OpCounts& c = m_StreamOps;
+    if (c.created || c.modified || c.removed) {
+        if (!text.empty()) text += "\n\n";
+        text += "Listo: "
+            + std::to_string(c.created) + " creadas, "
+            + std::to_string(c.modified) + " modificadas, "
+            + std::to_string(c.removed) + " eliminadas.";
+    }
+    return text;
+}
+
 
 void ChatPanel::RenderHistory() {
 
@@ -582,210 +586,132 @@ void ChatPanel::RenderHistory() {
     }
 }
 
-// Aplica ops + devuelve conteo (creadas / modificadas / eliminadas)
-ChatPanel::OpCounts ChatPanel::ApplyOpsFromJson(const json& resp) {
-    OpCounts counts;
-
-    // --- Caso especial: asset suelto (por compatibilidad si alguien llama a esta función) ---
-    if (resp.contains("kind") && resp["kind"].is_string() && resp["kind"] == "asset") {
-        std::string fname = resp.value("fileName", "asset.png");
-        std::string data = resp.value("data", "");
-        // sanitizar nombre
-        for (char& ch : fname) {
-            if (ch == '/' || ch == '\\' || ch == ':' || ch == '*' ||
-                ch == '?' || ch == '"' || ch == '<' || ch == '>' || ch == '|') ch = '_';
-        }
-        if (!data.empty()) {
-            std::string outPath = "Assets/Generated/" + fname;
-            if (SaveBase64ToFile(data, outPath)) {
-                Log::Info("[ASSET] Guardada imagen: " + outPath);
-            }
-            else {
-                Log::Error("[ASSET] ERROR al guardar: " + outPath);
-            }
-        }
-        return counts; // no hay ops
-    }
-
-    // --- Procesamiento normal de ops ---
-    if (!resp.contains("ops") || !resp["ops"].is_array()) return counts;
-
-    auto& scx = SceneContext::Get();
-    if (!scx.scene) scx.scene = std::make_shared<Scene>();
-
-    // Conjuntos para coalescer por entidad
-    std::unordered_set<uint32_t> created, modified, removed;
-
-    for (auto& op : resp["ops"]) {
-        std::string type = op.value("op", "");
-
-        if (type == "spawn_box") {
-            auto pos = op["pos"];
-            auto size = op["size"];
-            sf::Color col = TryParseColor(op, sf::Color(60, 60, 70, 255));
-
-            Entity e = scx.scene->CreateEntity();
-            scx.scene->transforms[e.id] = Transform{ {pos[0].get<float>(), pos[1].get<float>()}, {1.f,1.f}, 0.f };
-            scx.scene->sprites[e.id] = Sprite{ {size[0].get<float>(), size[1].get<float>()}, col };
-            scx.scene->colliders[e.id] = Collider{ {size[0].get<float>() * 0.5f, size[1].get<float>() * 0.5f}, {0.f,0.f} };
-
-            // Textura opcional directa en la op (por compat con algunos synthesizers)
-            if (op.contains("texturePath") && op["texturePath"].is_string()) {
-                scx.scene->textures[e.id] = Texture2D{ op["texturePath"].get<std::string>() };
-                Renderer2D::InvalidateTexture(op["texturePath"].get<std::string>());
-            }
-
-            if (op.contains("isTrigger") && op["isTrigger"].is_boolean()) {
-                scx.scene->colliders[e.id].isTrigger = op["isTrigger"].get<bool>();
-            }
+UndoStack::Transaction& ChatPanel::UndoTx() {
+    if (!m_UndoTx) m_UndoTx = EditorContext::Get().history.Begin("Chat IA");
+    return *m_UndoTx;
+}
 
-            created.insert(e.id);
+// Aplica una op ya validada; los conjuntos de m_Commit coalescen por entidad
+void ChatPanel::ApplyOp(const PreparedOp& op) {
+    auto& scene = *SceneContext::Get().scene;
+    auto& created = m_Commit.created;
+    auto& modified = m_Commit.modified;
+    auto& removed = m_Commit.removed;
+    const uint32_t id = op.id;
+
+    // Guardar el "antes" para undo (sólo la primera vez que la request toca la entidad)
+    if (op.kind != PreparedOp::Kind::SpawnBox) UndoTx().Touch(scene, id);
+
+    switch (op.kind) {
+    case PreparedOp::Kind::SpawnBox: {
+        Entity e = scene.CreateEntity();
+        UndoTx().TouchNew(e.id);
+        scene.transforms[e.id] = Transform{ op.pos, {1.f,1.f}, 0.f };
+        scene.sprites[e.id] = Sprite{ op.size, op.color };
+        scene.colliders[e.id] = Collider{ op.size * 0.5f, {0.f,0.f} };
+
+        if (!op.path.empty()) {
+            scene.textures[e.id] = Texture2D{ op.path };
+            Renderer2D::InvalidateTexture(op.path);
         }
-        else if (type == "set_transform") {
-            uint32_t id = GetEntityId(op);
-            if (id && scx.scene->transforms.contains(id)) {
-                auto& t = scx.scene->transforms[id];
-
-                if (op.contains("position") && !op["position"].is_null()) {
-                    auto p = op["position"];
-                    t.position = { p[0].get<float>(), p[1].get<float>() };
-                }
+        if (op.isTrigger) scene.colliders[e.id].isTrigger = *op.isTrigger;
 
-                if (op.contains("size") && !op["size"].is_null() && scx.scene->sprites.contains(id)) {
-                    auto s = op["size"];
-                    float w = std::max(1.f, s[0].get<float>());
-                    float h = std::max(1.f, s[1].get<float>());
-                    scx.scene->sprites[id].size = { w, h };
-                }
-
-                if (op.contains("scale") && !op["scale"].is_null()) {
-                    auto s = op["scale"];
-                    float sx = s[0].get<float>(), sy = s[1].get<float>();
-                    bool looksLikeSize = (std::fabs(sx) > 10.f) || (std::fabs(sy) > 10.f);
-                    if (looksLikeSize && scx.scene->sprites.contains(id)) {
-                        float w = std::max(1.f, sx), h = std::max(1.f, sy);
-                        scx.scene->sprites[id].size = { w, h };
-                        t.scale = { 1.f, 1.f };
-                    }
-                    else {
-                        auto clampScale = [](float v) { return std::clamp(v, 0.05f, 10.f); };
-                        t.scale = { clampScale(sx), clampScale(sy) };
-                    }
-                }
+        created.insert(e.id);
+        break;
+    }
+    case PreparedOp::Kind::SetTransform: {
+        if (!scene.transforms.contains(id)) break;
+        auto& t = scene.transforms[id];
 
-                if (op.contains("rotation") && !op["rotation"].is_null()) {
-                    t.rotationDeg = op["rotation"].get<float>();
-                }
+        if (op.position) t.position = *op.position;
 
-                if (created.count(id) == 0) modified.insert(id);
-            }
+        if (op.newSize && scene.sprites.contains(id)) {
+            scene.sprites[id].size = { std::max(1.f, op.newSize->x), std::max(1.f, op.newSize->y) };
         }
-        else if (type == "set_component") {
-            uint32_t id = GetEntityId(op);
-            std::string comp = op.value("component", "");
-
-            if (id && comp == "Sprite" && scx.scene->sprites.contains(id) && op.contains("value")) {
-                auto& sp = scx.scene->sprites[id];
-                const auto& value = op["value"];
 
-                if (value.contains("colorHex") && value["colorHex"].is_string()) {
-                    sp.color = ColorFromHexString(value["colorHex"].get<std::string>());
-                }
-                else if (value.contains("color") && value["color"].is_object()) {
-                    auto c = value["color"];
-                    auto clamp255 = [](int v) { return std::clamp(v, 0, 255); };
-                    sp.color = sf::Color(
-                        (std::uint8_t)clamp255(c.value("r", 255)),
-                        (std::uint8_t)clamp255(c.value("g", 255)),
-                        (std::uint8_t)clamp255(c.value("b", 255)),
-                        (std::uint8_t)clamp255(c.value("a", 255))
-                    );
-                }
-
-                if (value.contains("size") && value["size"].is_array() && value["size"].size() >= 2) {
-                    float w = std::max(1.f, value["size"][0].get<float>());
-                    float h = std::max(1.f, value["size"][1].get<float>());
-                    sp.size = { w, h };
-                }
-
-                if (created.count(id) == 0) modified.insert(id);
+        if (op.scale) {
+            const float sx = op.scale->x, sy = op.scale->y;
+            bool looksLikeSize = (std::fabs(sx) > 10.f) || (std::fabs(sy) > 10.f);
+            if (looksLikeSize && scene.sprites.contains(id)) {
+                scene.sprites[id].size = { std::max(1.f, sx), std::max(1.f, sy) };
+                t.scale = { 1.f, 1.f };
             }
-            else if (id && comp == "Texture2D" && op.contains("value") && op["value"].is_object()) {
-                auto& scene = *scx.scene;
-                const auto& value = op["value"];
-                if (value.contains("path") && value["path"].is_string()) {
-                    std::string newPath = value["path"].get<std::string>();
-
-                    auto& tex = scene.textures[id];
-                    std::string oldPath = tex.path;
-                    tex.path = newPath;
-
-                    // invalidar caché para forzar recarga (old y new)
-                    if (!oldPath.empty() && oldPath != newPath)
-                        Renderer2D::InvalidateTexture(oldPath);
-                    Renderer2D::InvalidateTexture(newPath);
-
-                    if (created.count(id) == 0) modified.insert(id);
-                }
-            }
-            else if (id && comp == "Script" && op.contains("value") && op["value"].is_object()) {
-                // asignación de script por path (simétrico a Texture2D)
-                auto& scene = *scx.scene;
-                const auto& value = op["value"];
-                if (value.contains("path") && value["path"].is_string()) {
-                    std::string newPath = value["path"].get<std::string>();
-
-                    auto& sc = scene.scripts[id];
-                    std::string oldPath = sc.path;
-                    sc.path = newPath;
-                    sc.inlineCode.clear(); // preferimos archivo si vino path
-                    sc.loaded = false;     // forzar recarga desde disco
-
-                    if (created.count(id) == 0) modified.insert(id);
-                }
+            else {
+                auto clampScale = [](float v) { return std::clamp(v, 0.05f, 10.f); };
+                t.scale = { clampScale(sx), clampScale(sy) };
             }
-            else if (id && comp == "Collider" && op.contains("value") && op["value"].is_object()) {
-                auto& scene = *scx.scene;
-
-                // Asegurar que exista el collider con defaults
-                if (!scene.colliders.contains(id)) {
-                    sf::Vector2f he{ 16.f,16.f };
-                    if (scene.sprites.contains(id)) {
-                        auto sz = scene.sprites[id].size;
-                        he = { std::max(1.f, sz.x * 0.5f), std::max(1.f, sz.y * 0.5f) };
-                    }
-                    scene.colliders[id] = Collider{ he, {0.f,0.f} };
-                }
-
-                auto& col = scene.colliders[id];
-                const auto& value = op["value"];
+        }
 
-                if (value.contains("isTrigger") && value["isTrigger"].is_boolean()) {
-                    col.isTrigger = value["isTrigger"].get<bool>();
-                    if (created.count(id) == 0) modified.insert(id);
-                }
+        if (op.rotation) t.rotationDeg = *op.rotation;
 
-                // Ignorar cualquier otro campo (offset/halfExtents) si viniera por error
-            }
-}
-        else if (type == "remove_entity") {
-            uint32_t id = GetEntityId(op);
-            if (id && scx.scene) {
-                scx.scene->DestroyEntity(Entity{ id });
-
-                // limpiar selección si apunta a la entidad eliminada (EditorContext)
-                auto& edx = EditorContext::Get();
-                if (edx.selected.id == id) edx.selected = {};
-
-                created.erase(id);
-                modified.erase(id);
-                removed.insert(id);
+        if (created.count(id) == 0) modified.insert(id);
+        break;
+    }
+    case PreparedOp::Kind::SetSprite: {
+        if (!scene.sprites.contains(id)) break;
+        auto& sp = scene.sprites[id];
+        if (op.newColor) sp.color = *op.newColor;
+        if (op.newSize) sp.size = { std::max(1.f, op.newSize->x), std::max(1.f, op.newSize->y) };
+        if (created.count(id) == 0) modified.insert(id);
+        break;
+    }
+    case PreparedOp::Kind::SetTexture: {
+        auto& tex = scene.textures[id];
+        std::string oldPath = tex.path;
+        tex.path = op.path;
+
+        // invalidar caché para forzar recarga (old y new)
+        if (!oldPath.empty() && oldPath != op.path)
+            Renderer2D::InvalidateTexture(oldPath);
+        Renderer2D::InvalidateTexture(op.path);
+
+        if (created.count(id) == 0) modified.insert(id);
+        break;
+    }
+    case PreparedOp::Kind::SetScript: {
+        // asignación de script por path (simétrico a Texture2D)
+        auto& sc = scene.scripts[id];
+        sc.path = op.path;
+        sc.inlineCode.clear(); // preferimos archivo si vino path
+        sc.loaded = false;     // forzar recarga desde disco
+
+        if (created.count(id) == 0) modified.insert(id);
+        break;
+    }
+    case PreparedOp::Kind::SetCollider: {
+        // Asegurar que exista el collider con defaults
+        if (!scene.colliders.contains(id)) {
+            sf::Vector2f he{ 16.f,16.f };
+            if (scene.sprites.contains(id)) {
+                auto sz = scene.sprites[id].size;
+                he = { std::max(1.f, sz.x * 0.5f), std::max(1.f, sz.y * 0.5f) };
             }
+            scene.colliders[id] = Collider{ he, {0.f,0.f} };
+        }
+        if (op.isTrigger) {
+            scene.colliders[id].isTrigger = *op.isTrigger;
+            if (created.count(id) == 0) modified.insert(id);
         }
+        break;
     }
+    case PreparedOp::Kind::SetComponent: {
+        // Sólo sobre entidades existentes; agrega el componente si no lo tenía
+        if (!scene.transforms.contains(id)) break;
+        Reflect::PatchFromJson(scene, op.component, id, op.value);
+        if (created.count(id) == 0) modified.insert(id);
+        break;
+    }
+    case PreparedOp::Kind::RemoveEntity: {
+        scene.DestroyEntity(Entity{ id });
+
+        // limpiar selección si apunta a la entidad eliminada (EditorContext)
+        auto& edx = EditorContext::Get();
+        if (edx.selected.id == id) edx.selected = {};
 
-    counts.created = (int)created.size();
-    counts.modified = (int)modified.size();
-    counts.removed = (int)removed.size();
-    return counts;
+        created.erase(id);
+        modified.erase(id);
+        removed.insert(id);
+        break;
+    }
+    }
 }
@@ -1,9 +1,15 @@
 #pragma once
 #include "Core/Application.h"
 #include "Net/ApiClient.h"
+#include "ECS/SceneDelta.h"
+#include "Editor/ResponsePipeline.h"
+#include "Editor/UndoStack.h"
+#include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
 #include <future>
+#include <unordered_set>
 #include <vector>
 
 class ChatPanel : public gp::Layer {
@@ -11,6 +17,10 @@ public:
     explicit ChatPanel(std::shared_ptr<ApiClient> client);
 
     void OnGuiRender() override;
+    // Request en vuelo, descargas o ops por aplicar: seguir dibujando aunque no haya input
+    bool WantsFrames() const override {
+        return m_Busy || m_Commit.active || !m_Downloads.empty() || !m_Pipeline->Idle();
+    }
 
 private:
     // ---- Modelo de mensajes (chat) ----
@@ -33,13 +43,66 @@ private:
     bool m_FocusInputNextFrame = false;
     bool m_OnlySelectedScope = false; // false = aplicar a todos los multi; true = solo al enfocado
 
+    // Sync incremental de escena: sólo se manda lo que cambió desde la última revisión confirmada
+    SceneDeltaTracker m_SceneSync;
+    std::string m_PendingPrompt;              // se guarda para reenviar con escena completa si hay 409
+    std::vector<uint32_t> m_PendingSelected;
+    bool m_ResyncTried = false;
+    ApiClient::CancelToken m_Cancel; // botón "Cancelar" mientras m_Busy
+
     // Render
     void RenderHistory();
 
     // Lógica de respuesta
     struct OpCounts { int created = 0, modified = 0, removed = 0; };
-    OpCounts ApplyOpsFromJson(const nlohmann::json& resp);
+
+    // ---- Pipeline de respuestas ----
+    // Decodificar assets, escribir archivos y validar ops corre en el hilo del pipeline
+    // (también los eventos de streaming). En el UI thread sólo queda aplicar las ops a
+    // la Scene, con un presupuesto de tiempo por frame para listas enormes.
+    static constexpr int kCommitBudgetUs = 3000;
+
+    struct CommitState {
+        bool active = false;
+        PreparedResponse resp;
+        std::size_t next = 0; // próxima op a aplicar
+        std::unordered_set<uint32_t> created, modified, removed; // coalescer por entidad
+    };
+
+    std::shared_ptr<ResponsePipeline> m_Pipeline = std::make_shared<ResponsePipeline>();
+    CommitState m_Commit;
+    std::optional<ApiClient::Result> m_Result; // resultado de red; se cierra cuando no queda nada por aplicar
+    std::string m_FinalText;                   // no-streaming: texto de la respuesta aplicada
+    std::optional<UndoStack::Transaction> m_UndoTx; // una request = una entrada de undo (aunque se aplique en varios frames)
+
+    void PumpPipeline();
+    void StartCommit();
+    bool CommitOps(std::chrono::steady_clock::time_point deadline); // false: quedan ops para el próximo frame
+    void ApplyOp(const PreparedOp& op);
+    UndoStack::Transaction& UndoTx(); // abre m_UndoTx en la primera modificación
+    std::string FinishResponse(const PreparedResponse& pr, const OpCounts& c); // texto de la burbuja
+    void FinishRequest();
+
+    // ---- Assets ----
+    // Los assets por referencia se bajan en un worker del ApiClient
+    struct AssetDownload {
+        std::future<ApiClient::DownloadResult> fut;
+        std::string path;      // nombre lógico (Texture2D.path)
+        bool toStore = false;  // se bajó al blob del AssetStore: registrar path -> hash al terminar
+    };
+    std::vector<AssetDownload> m_Downloads;
+
+    void PollDownloads();
+
+    // ---- Streaming ----
+    bool m_UseStreaming = true;  // se apaga si el server no tiene /chat/command/stream
+    bool m_Streaming = false;    // la request en curso es streaming
+    std::string m_StreamText;    // deltas + mensajes recibidos
+    OpCounts m_StreamOps;        // ops aplicadas durante el stream
+
+    std::string StreamBubbleText() const;
 
     // Helpers
     void SendCurrentPrompt();
+    void DispatchPending(); // arma el payload de escena (full/delta) y dispara la request
 };
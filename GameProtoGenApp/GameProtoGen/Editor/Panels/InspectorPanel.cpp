@@ -2,6 +2,7 @@
 #include "Runtime/SceneContext.h"
 #include "Runtime/EditorContext.h"
 #include "ECS/Components.h"
+#include "ECS/ComponentReflection.h"
 #include "Editor/EditorFonts.h"
 #include "Systems/Renderer2D.h"
 #include <imgui_stdlib.h>
@@ -14,29 +15,22 @@
 #include "tinyfiledialogs.h"
 #include <filesystem>
 #include <unordered_set>
+#include <utility>
 
 static bool EntityExists(const Scene& scene, EntityID id) {
-    return scene.transforms.contains(id) ||
-        scene.sprites.contains(id) ||
-        scene.colliders.contains(id) ||
-        scene.scripts.contains(id) ||
-        scene.physics.contains(id) ||
-        scene.playerControllers.contains(id);
+    bool found = false;
+    Reflect::ForEachComponent([&](auto tag) {
+        found = found || Reflect::PoolOf<typename decltype(tag)::type>(scene).contains(id);
+    });
+    return found;
 }
 
 // Recorre todas las “fuentes” de entidades y arma un set de IDs vivos
 static std::vector<EntityID> GatherAllEntityIds(const Scene& scene) {
     std::unordered_set<EntityID> set;
-    set.reserve(scene.transforms.size() + scene.sprites.size() + scene.colliders.size() +
-        scene.scripts.size() + scene.physics.size() + scene.playerControllers.size());
-
-    auto add = [&](auto const& map) { for (auto& kv : map) set.insert(kv.first); };
-    add(scene.transforms);
-    add(scene.sprites);
-    add(scene.colliders);
-    add(scene.scripts);
-    add(scene.physics);
-    add(scene.playerControllers);
+    Reflect::ForEachComponent([&](auto tag) {
+        for (auto& kv : Reflect::PoolOf<typename decltype(tag)::type>(scene)) set.insert(kv.first);
+    });
 
     std::vector<EntityID> ids(set.begin(), set.end());
     std::sort(ids.begin(), ids.end());
@@ -158,7 +152,8 @@ static void DrawTexture2DEditor(Scene& scene, Entity e) {
             return;
         }
 
-        auto& tex = scene.textures[e.id];
+        // Copia: mirar la textura no cuenta como modificación (redibujo a demanda, CoW)
+        Texture2D tex = std::as_const(scene).textures.at(e.id);
         std::string originalPath = tex.path;
 
         {
@@ -262,8 +257,10 @@ static void DrawTexture2DEditor(Scene& scene, Entity e) {
             }
         }
 
-        if (tex.path != originalPath && !originalPath.empty())
-            Renderer2D::InvalidateTexture(originalPath);
+        if (tex.path != originalPath) {
+            scene.textures[e.id] = tex;
+            if (!originalPath.empty()) Renderer2D::InvalidateTexture(originalPath);
+        }
 
         ImGui::EndDisabled();
     }
@@ -361,18 +358,119 @@ static void DrawScriptEditor(Scene& scene, Entity e) {
     ImGui::PopID();
 }
 
-static void DrawColliderSection(Scene& scene, Entity e) {
-    if (!e) return;
+// ---- Widgets generados desde ECS/ComponentReflection.h (campos con kEdit) ----
+static void BeginFieldTable(const char* id) {
+    ImGui::BeginTable(id, 3, ImGuiTableFlags_SizingStretchProp);
+    ImGui::TableSetupColumn("lbl", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("inp", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("unit", ImGuiTableColumnFlags_WidthFixed);
+}
+
+static bool DragRow(const char* axis, const char* id, float& v, const Reflect::EditHint& h) {
+    ImGui::TableNextRow();
+    if (axis) { ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted(axis); }
+    ImGui::TableSetColumnIndex(1); ImGui::SetNextItemWidth(-FLT_MIN);
+    const bool changed = ImGui::DragFloat(id, &v, h.speed, h.min, h.max);
+    if (h.unit) { ImGui::TableSetColumnIndex(2); ImGui::TextUnformatted(h.unit); }
+    return changed;
+}
+
+static void FieldHeading(const char* label) {
+    ImGui::PushFont(EditorFonts::H2);
+    ImGui::TextUnformatted(label);
+    ImGui::PopFont();
+}
+
+static bool EditValue(const char* label, float& v, const Reflect::EditHint& h) {
+    FieldHeading(label);
+    BeginFieldTable("tbl_f");
+    const bool changed = DragRow(nullptr, "##v", v, h);
+    ImGui::EndTable();
+    return changed;
+}
+
+static bool EditValue(const char* label, int& v, const Reflect::EditHint& h) {
+    FieldHeading(label);
+    ImGui::SetNextItemWidth(-FLT_MIN);
+    const bool changed = ImGui::DragInt("##i", &v, h.speed, (int)h.min, (int)h.max);
+    if (h.tooltip && ImGui::IsItemHovered(ImGuiHoveredFlags_DelayShort))
+        ImGui::SetTooltip("%s", h.tooltip);
+    return changed;
+}
 
+static bool EditValue(const char* label, sf::Vector2f& v, const Reflect::EditHint& h) {
+    FieldHeading(label);
+    BeginFieldTable("tbl_v2");
+    bool changed = DragRow("X", "##x", v.x, h);
+    changed |= DragRow("Y", "##y", v.y, h);
+    ImGui::EndTable();
+    return changed;
+}
+
+static bool EditValue(const char* label, bool& v, const Reflect::EditHint& h) {
+    const bool changed = ImGui::Checkbox(label, &v);
+    if (h.tooltip && ImGui::IsItemHovered(ImGuiHoveredFlags_DelayShort))
+        ImGui::SetTooltip("%s", h.tooltip);
+    return changed;
+}
+
+static bool EditValue(const char* label, std::string& v, const Reflect::EditHint&) {
+    FieldHeading(label);
+    ImGui::SetNextItemWidth(-FLT_MIN);
+    return ImGui::InputText("##str", &v);
+}
+
+static bool EditValue(const char* label, sf::Color& c, const Reflect::EditHint&) {
+    FieldHeading(label);
+    float col[4] = { c.r / 255.f, c.g / 255.f, c.b / 255.f, c.a / 255.f };
+    ImGui::SetNextItemWidth(-FLT_MIN);
+    if (!ImGui::ColorEdit4("##color", col)) return false;
+    auto clamp01 = [](float v) { return std::clamp(v, 0.f, 1.f); };
+    c = sf::Color(
+        (std::uint8_t)(clamp01(col[0]) * 255.f),
+        (std::uint8_t)(clamp01(col[1]) * 255.f),
+        (std::uint8_t)(clamp01(col[2]) * 255.f),
+        (std::uint8_t)(clamp01(col[3]) * 255.f)
+    );
+    return true;
+}
+
+// RenderLayer es opcional (sin él: capa 0, z 0); sus campos los dibuja el editor reflejado
+static void DrawRenderLayerAdder(Scene& scene, Entity e) {
+    if (std::as_const(scene).renderLayers.contains(e.id)) return;
+    if (ImGui::Button("Agregar capa de render", ImVec2(-FLT_MIN, 0)))
+        scene.renderLayers[e.id] = RenderLayer{};
+}
+
+// Se edita una copia y se escribe en el pool sólo si cambió: mirar la entidad no
+// separa pools compartidos (copy-on-write) con el snapshot de Play.
+template <class T>
+static void DrawReflectedComponent(Scene& scene, EntityID id) {
+    const auto& pool = Reflect::PoolOf<T>(std::as_const(scene));
+    auto it = pool.find(id);
+    if (it == pool.end()) return;
+
+    bool editable = false;
+    Reflect::ForEachField<T>([&](const auto& f) { editable |= (f.flags & Reflect::kEdit) != 0; });
+    if (!editable) return;
+
+    ImGui::PushID(Reflect::Component<T>::title);
     ImGui::PushFont(EditorFonts::H1);
-    ImGui::SeparatorText("Collider");
+    ImGui::SeparatorText(Reflect::Component<T>::title);
     ImGui::PopFont();
 
-    auto& c = scene.colliders[e.id];
+    T value = it->second;
+    bool changed = false;
+    Reflect::ForEachField<T>([&](const auto& f) {
+        if (!(f.flags & Reflect::kEdit)) return;
+        const std::string name(f.name);
+        ImGui::PushID(name.c_str());
+        changed |= EditValue(f.hint.label ? f.hint.label : name.c_str(), value.*f.member, f.hint);
+        ImGui::PopID();
+    });
+    if (changed) Reflect::PoolOf<T>(scene).at(id) = value;
 
-    ImGui::Checkbox("Disparador (trigger)", &c.isTrigger);
-    if (ImGui::IsItemHovered(ImGuiHoveredFlags_DelayShort))
-        ImGui::SetTooltip("No colisión física; solo eventos.");
+    ImGui::PopID();
 }
 
 void InspectorPanel::OnGuiRender() {
@@ -422,7 +520,10 @@ void InspectorPanel::OnGuiRender() {
             if (doDelete) {
                 if (scx.scene && edx.selected && !isPlayer) {
                     const EntityID old = edx.selected.id;
+                    auto tx = edx.history.Begin("Eliminar entidad");
+                    tx.Touch(*scx.scene, old);
                     scx.scene->DestroyEntity(edx.selected);
+                    edx.history.Commit(tx, *scx.scene);
                     edx.selected = PickFallbackSelection(*scx.scene, old);
                     ImGui::EndTable();
                     ImGui::End();
@@ -435,152 +536,22 @@ void InspectorPanel::OnGuiRender() {
     }
 
     if (scx.scene) {
-        // Transform
-        if (auto it = scx.scene->transforms.find(e.id); it != scx.scene->transforms.end()) {
-            auto& t = it->second;
-
-            ImGui::PushFont(EditorFonts::H1);
-            ImGui::SeparatorText("Transform");
-            ImGui::PopFont();
-
-            ImGui::PushFont(EditorFonts::H2);
-            ImGui::TextUnformatted("Posición:");
-            ImGui::PopFont();
-            if (ImGui::BeginTable("tbl_pos", 3, ImGuiTableFlags_SizingStretchProp)) {
-                ImGui::TableSetupColumn("lbl", ImGuiTableColumnFlags_WidthFixed);
-                ImGui::TableSetupColumn("inp", ImGuiTableColumnFlags_WidthStretch);
-                ImGui::TableSetupColumn("unit", ImGuiTableColumnFlags_WidthFixed);
-
-                ImGui::TableNextRow();
-                ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted("X");
-                ImGui::TableSetColumnIndex(1); ImGui::SetNextItemWidth(-FLT_MIN);
-                ImGui::DragFloat("##posx", &t.position.x, 1.f);
-                ImGui::TableSetColumnIndex(2); ImGui::TextUnformatted("px");
-
-                ImGui::TableNextRow();
-                ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted("Y");
-                ImGui::TableSetColumnIndex(1); ImGui::SetNextItemWidth(-FLT_MIN);
-                ImGui::DragFloat("##posy", &t.position.y, 1.f);
-                ImGui::TableSetColumnIndex(2); ImGui::TextUnformatted("px");
-
-                ImGui::EndTable();
-            }
-
-            ImGui::PushFont(EditorFonts::H2);
-            ImGui::TextUnformatted("Escala:");
-            ImGui::PopFont();
-            if (ImGui::BeginTable("tbl_scale", 3, ImGuiTableFlags_SizingStretchProp)) {
-                ImGui::TableSetupColumn("lbl", ImGuiTableColumnFlags_WidthFixed);
-                ImGui::TableSetupColumn("inp", ImGuiTableColumnFlags_WidthStretch);
-                ImGui::TableSetupColumn("unit", ImGuiTableColumnFlags_WidthFixed);
-
-                ImGui::TableNextRow();
-                ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted("X");
-                ImGui::TableSetColumnIndex(1); ImGui::SetNextItemWidth(-FLT_MIN);
-                ImGui::DragFloat("##scalex", &t.scale.x, 0.01f, 0.01f, 10.f);
-
-                ImGui::TableNextRow();
-                ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted("Y");
-                ImGui::TableSetColumnIndex(1); ImGui::SetNextItemWidth(-FLT_MIN);
-                ImGui::DragFloat("##scaley", &t.scale.y, 0.01f, 0.01f, 10.f);
-
-                ImGui::EndTable();
-            }
-
-            ImGui::PushFont(EditorFonts::H2);
-            ImGui::TextUnformatted("Rotación:");
-            ImGui::PopFont();
-            if (ImGui::BeginTable("tbl_rot", 3, ImGuiTableFlags_SizingStretchProp)) {
-                ImGui::TableSetupColumn("lbl", ImGuiTableColumnFlags_WidthFixed);
-                ImGui::TableSetupColumn("inp", ImGuiTableColumnFlags_WidthStretch);
-                ImGui::TableSetupColumn("unit", ImGuiTableColumnFlags_WidthFixed);
-
-                ImGui::TableNextRow();
-                ImGui::TableSetColumnIndex(1); ImGui::SetNextItemWidth(-FLT_MIN);
-                ImGui::DragFloat("##rot", &t.rotationDeg, 0.5f, -360.f, 360.f);
-                ImGui::TableSetColumnIndex(2); ImGui::TextUnformatted("grados");
-
-                ImGui::EndTable();
-            }
-        }
-
-        if (auto it = scx.scene->sprites.find(e.id); it != scx.scene->sprites.end()) {
-            auto& s = it->second;
-
-            ImGui::PushFont(EditorFonts::H2);
-            ImGui::TextUnformatted("Tamaño:");
-            ImGui::PopFont();
-            if (ImGui::BeginTable("tbl_size", 3, ImGuiTableFlags_SizingStretchProp)) {
-                ImGui::TableSetupColumn("lbl", ImGuiTableColumnFlags_WidthFixed);
-                ImGui::TableSetupColumn("inp", ImGuiTableColumnFlags_WidthStretch);
-                ImGui::TableSetupColumn("unit", ImGuiTableColumnFlags_WidthFixed);
-
-                ImGui::TableNextRow();
-                ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted("Ancho");
-                ImGui::TableSetColumnIndex(1); ImGui::SetNextItemWidth(-FLT_MIN);
-                ImGui::DragFloat("##ancho", &s.size.x, 1.f, 1.f, 4096.f);
-                ImGui::TableSetColumnIndex(2); ImGui::TextUnformatted("px");
-
-                ImGui::TableNextRow();
-                ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted("Alto");
-                ImGui::TableSetColumnIndex(1); ImGui::SetNextItemWidth(-FLT_MIN);
-                ImGui::DragFloat("##alto", &s.size.y, 1.f, 1.f, 4096.f);
-                ImGui::TableSetColumnIndex(2); ImGui::TextUnformatted("px");
-
-                ImGui::EndTable();
-            }
-
-            ImGui::PushFont(EditorFonts::H2);
-            ImGui::TextUnformatted("Color:");
-            ImGui::PopFont();
-            float col[4] = { s.color.r / 255.f, s.color.g / 255.f, s.color.b / 255.f, s.color.a / 255.f };
-            ImGui::SetNextItemWidth(-FLT_MIN);
-            if (ImGui::ColorEdit4("##color", col)) {
-                auto clamp01 = [](float v) { return std::clamp(v, 0.f, 1.f); };
-                s.color = sf::Color(
-                    (std::uint8_t)(clamp01(col[0]) * 255.f),
-                    (std::uint8_t)(clamp01(col[1]) * 255.f),
-                    (std::uint8_t)(clamp01(col[2]) * 255.f),
-                    (std::uint8_t)(clamp01(col[3]) * 255.f)
-                );
-            }
-        }
-
-        if (scx.scene && edx.selected) {
-            DrawColliderSection(*scx.scene, edx.selected);
-            DrawTexture2DEditor(*scx.scene, edx.selected);
-            DrawScriptEditor(*scx.scene, edx.selected);
-        }
-
-        // Jugador
-        if (scx.scene->playerControllers.contains(e.id)) {
-            ImGui::PushFont(EditorFonts::H1);
-            ImGui::SeparatorText("Jugador");
-            ImGui::PopFont();
-
-            auto& pc = scx.scene->playerControllers[e.id];
-
-            ImGui::PushFont(EditorFonts::H2);
-            ImGui::TextUnformatted("Parámetros de control:");
-            ImGui::PopFont();
-
-            if (ImGui::BeginTable("tbl_player", 2, ImGuiTableFlags_SizingStretchProp)) {
-                ImGui::TableSetupColumn("lbl", ImGuiTableColumnFlags_WidthFixed);
-                ImGui::TableSetupColumn("inp", ImGuiTableColumnFlags_WidthStretch);
-
-                ImGui::TableNextRow();
-                ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted("Speed Velocity");
-                ImGui::TableSetColumnIndex(1); ImGui::SetNextItemWidth(-FLT_MIN);
-                ImGui::DragFloat("##movespeed", &pc.moveSpeed, 5.f, 0.f, 5000.f, "%.1f");
-
-                ImGui::TableNextRow();
-                ImGui::TableSetColumnIndex(0); ImGui::TextUnformatted("Jump Force");
-                ImGui::TableSetColumnIndex(1); ImGui::SetNextItemWidth(-FLT_MIN);
-                ImGui::DragFloat("##jumpspeed", &pc.jumpSpeed, 5.f, 0.f, 5000.f, "%.1f");
-
-                ImGui::EndTable();
-            }
-        }
+        // Una transacción por frame; Commit sólo apila si algo cambió. Los drags sobre
+        // la misma entidad se coalescen en una entrada (clave = id). En Play no se
+        // registra: al salir se restaura el snapshot.
+        auto tx = edx.history.Begin("Inspector", /*coalesceKey*/ (std::uint64_t)e.id + 1);
+        if (!playing) tx.Touch(*scx.scene, e.id);
+
+        Reflect::ForEachComponent([&](auto tag) {
+            using T = typename decltype(tag)::type;
+            DrawReflectedComponent<T>(*scx.scene, e.id);
+        });
+
+        DrawRenderLayerAdder(*scx.scene, e);
+        DrawTexture2DEditor(*scx.scene, e);
+        DrawScriptEditor(*scx.scene, e);
+
+        edx.history.Commit(tx, *scx.scene);
     }
 
     ImGui::End();
@@ -2,6 +2,8 @@
 #include "Runtime/SceneContext.h"
 #include "Runtime/EditorContext.h"
 #include "Runtime/GameRunner.h"
+#include "Systems/Renderer2D.h"
+#include "Systems/ScriptSystem.h"
 
 #include <imgui.h>
 #include <imgui_internal.h>
@@ -9,6 +11,7 @@
 #include <optional>
 #include <cmath>
 #include <algorithm>
+#include <utility>
 #include "ECS/SceneSerializer.h"
 #include <filesystem>
 
@@ -58,90 +61,59 @@ void ViewportPanel::EnsureRT() {
 
         // Publicamos un valor inicial del centro de cámara (EditorContext)
         SceneContext::Get().cameraCenter = m_CamCenter;
-
-        // RT de presentación (flip vertical sólo visual)
-        m_PresentRT = std::make_unique<sf::RenderTexture>(sf::Vector2u{ m_VirtW, m_VirtH });
-        m_PresentRT->setSmooth(true);
-        sf::View pv;
-        pv.setSize(sf::Vector2f(static_cast<float>(m_VirtW), static_cast<float>(m_VirtH)));
-        pv.setCenter(sf::Vector2f(static_cast<float>(m_VirtW) * 0.5f,
-            static_cast<float>(m_VirtH) * 0.5f));
-        m_PresentRT->setView(pv);
+        m_LastRender.reset();
     }
 }
 
-// --- AABB por entidad en coordenadas de mundo ---
-sf::FloatRect ViewportPanel::EntityWorldAABB(EntityID id) const {
+ViewportPanel::RenderKey ViewportPanel::MakeRenderKey() const {
     auto& scx = SceneContext::Get();
-    if (!scx.scene) return sf::FloatRect({ 0.f, 0.f }, { 0.f, 0.f });
-    if (!scx.scene->transforms.contains(id)) return sf::FloatRect({ 0.f, 0.f }, { 0.f, 0.f });
-
-    const auto& t = scx.scene->transforms.at(id);
-    const sf::Vector2f scaleAbs{ std::abs(t.scale.x), std::abs(t.scale.y) };
-
-    sf::Vector2f he{ 0.f, 0.f };
-    sf::Vector2f offset{ 0.f, 0.f };
-
-    if (auto itS = scx.scene->sprites.find(id); itS != scx.scene->sprites.end()) {
-        he = {
-            (itS->second.size.x * scaleAbs.x) * 0.5f,
-            (itS->second.size.y * scaleAbs.y) * 0.5f
-        };
-    }
-    else if (auto itC = scx.scene->colliders.find(id); itC != scx.scene->colliders.end()) {
-        he = {
-            itC->second.halfExtents.x * scaleAbs.x,
-            itC->second.halfExtents.y * scaleAbs.y
-        };
-        offset = itC->second.offset;
-    }
-    else {
-        return sf::FloatRect({ 0.f, 0.f }, { 0.f, 0.f });
+    auto& edx = EditorContext::Get();
+    RenderKey k;
+    k.camera = m_CamCenter;
+    k.textureRev = Renderer2D::Revision();
+    k.selected = edx.selected.id;
+    k.multiCount = edx.multiSelected.size();
+    for (EntityID id : edx.multiSelected) k.multiHash ^= id * 2654435761u; // independiente del orden
+    if (const Scene* scene = scx.scene.get()) {
+        k.scene = scene;
+        k.transforms = scene->transforms.Head();
+        k.sprites = scene->sprites.Head();
+        k.textures = scene->textures.Head();
+        k.colliders = scene->colliders.Head();
+        k.renderLayers = scene->renderLayers.Head();
+        k.entitiesRev = scene->EntitiesRevision();
+        k.physicsKeys = scene->physics.KeysRevision(); // estática vs dinámica (orden de capas)
+        k.scriptKeys = scene->scripts.KeysRevision();
     }
-
-    const sf::Vector2f center = t.position + offset;
-    const sf::Vector2f min{ center.x - he.x, center.y - he.y };
-    const sf::Vector2f size{ he.x * 2.f, he.y * 2.f }; // (max - min)
-
-    return sf::FloatRect(min, size);
+    return k;
 }
 
-std::vector<EntityID> ViewportPanel::PickEntitiesInAABB(const sf::FloatRect& box) const {
-    std::vector<EntityID> out;
+const SpatialIndex* ViewportPanel::Index() const {
     auto& scx = SceneContext::Get();
-    if (!scx.scene) return out;
-
-    // Precalcular bordes del box pedido
-    const float boxLeft = box.position.x;
-    const float boxTop = box.position.y;
-    const float boxRight = box.position.x + box.size.x;
-    const float boxBottom = box.position.y + box.size.y;
-
-    const auto& entities = scx.scene->Entities();
-    for (auto it = entities.rbegin(); it != entities.rend(); ++it) {
-        const EntityID id = it->id;
-
-        const sf::FloatRect aabb = EntityWorldAABB(id);
-        if (aabb.size.x <= 0.f || aabb.size.y <= 0.f) continue;
-
-        const float aLeft = aabb.position.x;
-        const float aTop = aabb.position.y;
-        const float aRight = aabb.position.x + aabb.size.x;
-        const float aBottom = aabb.position.y + aabb.size.y;
+    if (!scx.scene) return nullptr;
+    m_Index.Sync(std::as_const(*scx.scene));
+    return &m_Index;
+}
 
-        const bool intersects =
-            (aLeft <= boxRight) && (aRight >= boxLeft) &&
-            (aTop <= boxBottom) && (aBottom >= boxTop);
+// --- AABB por entidad en coordenadas de mundo ---
+sf::FloatRect ViewportPanel::EntityWorldAABB(EntityID id) const {
+    const SpatialIndex* idx = Index();
+    const sf::FloatRect* r = idx ? idx->Bounds(id) : nullptr;
+    return r ? *r : sf::FloatRect({ 0.f, 0.f }, { 0.f, 0.f });
+}
 
-        if (intersects) out.push_back(id);
-    }
-    return out;
+std::vector<EntityID> ViewportPanel::PickEntitiesInAABB(const sf::FloatRect& box) const {
+    const SpatialIndex* idx = Index();
+    return idx ? idx->Query(box) : std::vector<EntityID>{};
 }
 
 void ViewportPanel::OnUpdate(const gp::Timestep& dt) {
     auto& scx = SceneContext::Get();
     if (!scx.scene) return;
 
+    // También en edición: la textura recargada se ve sin entrar en Play
+    GameRunner::ApplyAssetChanges(*scx.scene);
+
     if (m_Playing) {
         GameRunner::Step(*scx.scene, dt.dt);
     }
@@ -173,6 +145,7 @@ void ViewportPanel::OnGuiRender() {
         auto& edx = EditorContext::Get();
 
         // reset gestos
+        if (m_Gesture) { edx.history.Cancel(*m_Gesture); m_Gesture.reset(); }
         m_Dragging = false;
         m_DragEntity = 0;
         m_Panning = false;
@@ -182,17 +155,14 @@ void ViewportPanel::OnGuiRender() {
         const bool toPlay = !m_Playing;
         if (toPlay) {
             if (!scx.scene) return;
-            // snapshot profundo
+            // Snapshot copy-on-write: O(#pools). Sólo se duplican los pools
+            // que la simulación modifique; el resto queda compartido.
             edx.runtime.sceneBackup = std::make_shared<Scene>(*scx.scene);
             edx.runtime.cameraBackup = m_CamCenter;
             edx.runtime.selectedBackup = edx.selected;
-            std::string path = edx.projectPath;
 
-            if (!SceneSerializer::Save(*scx.scene, edx.projectPath)) {
-                AppendLog(std::string("❌ No se pudo guardar la escena en: ") + path);
-                // No entrar en Play si no se pudo guardar
-                return;
-            }
+            // gameReset() reinicia desde este snapshot en vez de guardar/releer disco
+            GameRunner::SetResetSnapshot(edx.runtime.sceneBackup);
 
             GameRunner::EnterPlay(*scx.scene);
             m_Playing = true;
@@ -201,7 +171,9 @@ void ViewportPanel::OnGuiRender() {
         }
         else {
             if (scx.scene) GameRunner::ExitPlay(*scx.scene);
+            GameRunner::SetResetSnapshot(nullptr);
 
+            // Restaurar: la escena de Play se descarta junto con los pools que modificó
             if (edx.runtime.sceneBackup) {
                 scx.scene = edx.runtime.sceneBackup;
                 edx.runtime.sceneBackup.reset();
@@ -287,6 +259,21 @@ void ViewportPanel::OnGuiRender() {
         if (ImGui::IsKeyPressed(ImGuiKey_4)) m_Tool = Tool::Scale;
     }
     ImGui::EndDisabled();
+
+    // GC de Lua (sólo en Play)
+    if (m_Playing) {
+        const ScriptVM::GcStats& gc = Systems::ScriptSystem::GetGcStats();
+        ImGui::SameLine(0.f, 24.f);
+        ImGui::AlignTextToFramePadding();
+        ImGui::TextDisabled("Lua %zu KB | GC %.2f ms (max %.2f)", gc.kb, gc.lastMs, gc.maxMs);
+        if (ImGui::IsItemHovered()) {
+            ImGui::BeginTooltip();
+            ImGui::TextUnformatted("Scripts más caros (ms por llamada)");
+            for (const auto& c : Systems::ScriptSystem::TopCosts(8))
+                ImGui::Text("id %u   %.3f (último %.3f)", (unsigned)c.id, c.avgMs, c.lastMs);
+            ImGui::EndTooltip();
+        }
+    }
     ImGui::EndChild();
 
     // ───────────────────────── Viewport area ───────────────────────────
@@ -305,9 +292,7 @@ void ViewportPanel::OnGuiRender() {
 
     EnsureRT();
 
-    if (m_RT && m_PresentRT) {
-        // 1) Dibujar escena en RT principal
-        m_RT->clear(sf::Color(30, 30, 35));
+    if (m_RT) {
         if (scx.scene) {
             // Cámara: en play sigue al player; en pausa usa m_CamCenter
             sf::Vector2f desiredCenter = m_CamCenter;
@@ -327,55 +312,43 @@ void ViewportPanel::OnGuiRender() {
             m_RT->setView(v);
 
             scx.cameraCenter = m_CamCenter;
+        }
 
-            // Grilla SOLO en pausa/edición
-            if (!m_Playing) DrawGrid(*m_RT);
+        // 1) Dibujar escena en el RT (en Play siempre; en pausa sólo si algo cambió)
+        RenderKey key = MakeRenderKey();
+        bool redraw = m_Playing || !m_RedrawOnDemand || !m_LastRender || !(*m_LastRender == key);
+        // Sin redibujo igual hay que subir texturas ya decodificadas (Draw lo hace solo)
+        if (!redraw && Renderer2D::PumpTextureUploads()) {
+            key = MakeRenderKey();
+            redraw = true;
+        }
+        if (redraw) {
+            m_RT->clear(sf::Color(30, 30, 35));
+            if (scx.scene) {
+                // Grilla SOLO en pausa/edición
+                if (!m_Playing) DrawGrid(*m_RT);
 
-            // Objetos
-            GameRunner::Render(*scx.scene, *m_RT, m_CamCenter, { m_VirtW, m_VirtH });
+                // Objetos
+                GameRunner::Render(*scx.scene, *m_RT, m_CamCenter, { m_VirtW, m_VirtH });
 
-            // Gizmos de selección (simple y múltiple) SOLO en pausa
-            if (!m_Playing) {
-                // seleccionado simple
-                if (edx.selected) {
+                // Gizmos de selección (simple y múltiple) SOLO en pausa
+                if (!m_Playing && (edx.selected || !edx.multiSelected.empty()))
                     DrawSelectionGizmos(*m_RT);
-                }
-                // seleccionados múltiples (usar AABB helper)
-                if (!edx.multiSelected.empty()) {
-                    for (auto id : edx.multiSelected) {
-                        sf::FloatRect r = EntityWorldAABB(id);
-                        if (r.size.x <= 0.f || r.size.y <= 0.f) continue;
-
-                        sf::RectangleShape box;
-                        box.setSize(sf::Vector2f{ r.size.x, r.size.y });
-                        box.setOrigin({ 0.f, 0.f });
-                        box.setPosition(r.position);
-                        box.setFillColor(sf::Color(0, 0, 0, 0));
-                        box.setOutlineColor(sf::Color(120, 200, 255)); // multi: celeste
-                        box.setOutlineThickness(2.f);
-                        m_RT->draw(box);
-                    }
-                }
             }
+            m_RT->display();
+            m_LastRender = key;
         }
-        m_RT->display();
-
-        // 2) Espejo vertical a RT de presentación
-        m_PresentRT->clear(sf::Color::Black);
-        sf::Sprite spr(m_RT->getTexture());
-        spr.setScale(sf::Vector2f{ 1.f, -1.f });
-        spr.setPosition(sf::Vector2f{ 0.f, static_cast<float>(m_VirtH) });
-        m_PresentRT->draw(spr);
-        m_PresentRT->display();
 
-        // 3) Mostrar con letterboxing
+        // 2) Mostrar con letterboxing. La textura de un RenderTexture queda invertida
+        //    en Y para OpenGL: se corrige con las UV en vez de una pasada extra.
         ImVec2 imgSize{ targetW, targetH };
         ImVec2 cur = ImGui::GetCursorPos();
         ImVec2 offset{ (avail.x - imgSize.x) * 0.5f, (availForImageY - imgSize.y) * 0.5f };
         if (offset.x < 0) offset.x = 0;
         if (offset.y < 0) offset.y = 0;
         ImGui::SetCursorPos(ImVec2(cur.x + offset.x, cur.y + offset.y));
-        ImGui::Image(m_PresentRT->getTexture(), imgSize);
+        const auto texId = static_cast<ImTextureID>(m_RT->getTexture().getNativeHandle());
+        ImGui::Image(texId, imgSize, ImVec2(0.f, 1.f), ImVec2(1.f, 0.f));
 
         // --- Picking / Drag / Pan / Marquee ---
         ImVec2   imgMin = ImGui::GetItemRectMin();
@@ -439,6 +412,7 @@ void ViewportPanel::OnGuiRender() {
                             m_Rotating = true;
                             m_Dragging = false;
                             m_DragEntity = hit;
+                            BeginGesture("Rotar", { hit });
 
                             auto& t = scx.scene->transforms[hit];
                             sf::Vector2f center = t.position;
@@ -524,6 +498,7 @@ void ViewportPanel::OnGuiRender() {
                                 m_Scaling = true;
                                 m_Dragging = false;
                                 m_DragEntity = hit;
+                                BeginGesture("Escalar", { hit });
 
                                 m_ScaleStartMouse = world - center;
                                 m_ScaleStartLen = std::max(1e-3f, std::sqrt(m_ScaleStartMouse.x * m_ScaleStartMouse.x + m_ScaleStartMouse.y * m_ScaleStartMouse.y));
@@ -687,6 +662,7 @@ void ViewportPanel::OnGuiRender() {
                                     m_DragOffset = scx.scene->transforms[hit].position - world;
                                     s_GroupDragging = false;
                                     s_LastWorld = world;
+                                    BeginGesture("Mover", { hit });
                                     AppendLog("Seleccionado entity id=" + std::to_string(hit));
                                 }
                             }
@@ -715,6 +691,8 @@ void ViewportPanel::OnGuiRender() {
                                 if (!s_GroupDragging && (std::fabs(io.MouseDelta.x) > 0.0f || std::fabs(io.MouseDelta.y) > 0.0f)) {
                                     s_GroupDragging = true;
                                     s_LastWorld = world;
+                                    BeginGesture("Mover grupo",
+                                        std::vector<EntityID>(edx.multiSelected.begin(), edx.multiSelected.end()));
 
                                     // ⬇️ reset de acumuladores de snap
                                     s_GroupStartWorld = world;
@@ -869,6 +847,13 @@ void ViewportPanel::OnGuiRender() {
         ImGui::TextUnformatted("Creando RenderTextures...");
     }
 
+    // Cerrar el gesto al soltar (aunque se suelte fuera del viewport): una entrada de undo
+    if (m_Gesture && !ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
+        if (scx.scene) edx.history.Commit(*m_Gesture, *scx.scene);
+        else edx.history.Cancel(*m_Gesture);
+        m_Gesture.reset();
+    }
+
     // Separación mínima antes de la consola
     ImGui::Dummy(ImVec2(0, 6.0f));
 
@@ -881,6 +866,15 @@ void ViewportPanel::OnGuiRender() {
 
 // --------------------------- Picking / utilidades ---------------------------
 
+void ViewportPanel::BeginGesture(const char* label, const std::vector<EntityID>& ids) {
+    auto& scx = SceneContext::Get();
+    auto& history = EditorContext::Get().history;
+    if (!scx.scene) return;
+    if (m_Gesture) history.Commit(*m_Gesture, *scx.scene); // gesto anterior sin soltar
+    m_Gesture = history.Begin(label);
+    for (EntityID id : ids) m_Gesture->Touch(*scx.scene, id);
+}
+
 std::optional<sf::Vector2f> ViewportPanel::ScreenToWorld(ImVec2 mouse, ImVec2 imgMin, ImVec2 imgMax) const {
     if (!m_RT) return std::nullopt;
 
@@ -902,90 +896,39 @@ std::optional<sf::Vector2f> ViewportPanel::ScreenToWorld(ImVec2 mouse, ImVec2 im
 }
 
 EntityID ViewportPanel::PickEntityAt(const sf::Vector2f& worldPos) const {
-    auto& scx = SceneContext::Get();
-    if (!scx.scene) return 0;
-
-    const auto& entities = scx.scene->Entities();
-    for (auto it = entities.rbegin(); it != entities.rend(); ++it) {
-        EntityID id = it->id;
-        if (!scx.scene->transforms.contains(id)) continue;
-
-        const auto& t = scx.scene->transforms.at(id);
-
-        sf::Vector2f he{ 0.f, 0.f };
-        sf::Vector2f offset{ 0.f, 0.f };
-
-        sf::Vector2f scaleAbs{ std::abs(t.scale.x), std::abs(t.scale.y) };
-        if (auto itS = scx.scene->sprites.find(id); itS != scx.scene->sprites.end()) {
-            he = { (itS->second.size.x * scaleAbs.x) * 0.5f,
-                   (itS->second.size.y * scaleAbs.y) * 0.5f };
-        }
-        else if (auto itC = scx.scene->colliders.find(id); itC != scx.scene->colliders.end()) {
-            he = { itC->second.halfExtents.x * scaleAbs.x,
-                   itC->second.halfExtents.y * scaleAbs.y };
-            offset = itC->second.offset;
-        }
-        else {
-            continue;
-        }
-
-        sf::Vector2f center = t.position + offset;
-        sf::Vector2f min = { center.x - he.x, center.y - he.y };
-        sf::Vector2f max = { center.x + he.x, center.y + he.y };
-
-        if (worldPos.x >= min.x && worldPos.x <= max.x &&
-            worldPos.y >= min.y && worldPos.y <= max.y) {
-            return id;
-        }
-    }
-    return 0;
+    const SpatialIndex* idx = Index();
+    return idx ? idx->PickTopmost(worldPos) : 0;
 }
 
 // --------------------------- Gizmos / dibujo ---------------------------
 
 void ViewportPanel::DrawSelectionGizmos(sf::RenderTarget& rt) const {
-    auto& scx = SceneContext::Get();
     auto& edx = EditorContext::Get();
-    if (!scx.scene) return;
-
-    auto drawOne = [&](EntityID id) {
-        if (!scx.scene->transforms.contains(id)) return;
+    const SpatialIndex* idx = Index();
+    if (!idx) return;
 
-        const auto& t = scx.scene->transforms.at(id);
-        sf::Vector2f he{ 0.f,0.f };
-        sf::Vector2f offset{ 0.f,0.f };
-        sf::Vector2f scaleAbs{ std::abs(t.scale.x), std::abs(t.scale.y) };
-
-        if (auto itS = scx.scene->sprites.find(id); itS != scx.scene->sprites.end()) {
-            he = { (itS->second.size.x * scaleAbs.x) * 0.5f,
-                   (itS->second.size.y * scaleAbs.y) * 0.5f };
-        }
-        else if (auto itC = scx.scene->colliders.find(id); itC != scx.scene->colliders.end()) {
-            he = { itC->second.halfExtents.x * scaleAbs.x,
-                   itC->second.halfExtents.y * scaleAbs.y };
-            offset = itC->second.offset;
-        }
-        else return;
+    // Culling contra la vista: con selecciones grandes sólo se dibuja lo visible
+    const sf::View& view = rt.getView();
+    const sf::FloatRect visible(view.getCenter() - view.getSize() * 0.5f, view.getSize());
 
-        sf::RectangleShape box;
-        box.setSize(sf::Vector2f{ he.x * 2.f, he.y * 2.f });
-        box.setOrigin(he);
-        box.setPosition(t.position + offset);
-        box.setFillColor(sf::Color(0, 0, 0, 0));
+    sf::RectangleShape box;
+    box.setFillColor(sf::Color(0, 0, 0, 0));
+    box.setOutlineThickness(2.f);
 
+    auto drawOne = [&](EntityID id, bool isPrimary) {
+        const sf::FloatRect* r = idx->Bounds(id);
+        if (!r || !visible.findIntersection(*r)) return;
+        box.setSize(r->size);
+        box.setPosition(r->position);
         // primaria en dorado, resto en celeste
-        bool isPrimary = (edx.selected && edx.selected.id == id);
         box.setOutlineColor(isPrimary ? sf::Color(255, 220, 80) : sf::Color(80, 200, 255));
-        box.setOutlineThickness(2.f);
         rt.draw(box);
         };
 
-    // primaria
-    if (edx.selected) drawOne(edx.selected.id);
-    // resto
     for (auto id : edx.multiSelected) {
-        if (!edx.selected || edx.selected.id != id) drawOne(id);
+        if (!edx.selected || edx.selected.id != id) drawOne(id, false);
     }
+    if (edx.selected) drawOne(edx.selected.id, true); // primaria arriba
 }
 
 void ViewportPanel::DrawGrid(sf::RenderTarget& rt) const {
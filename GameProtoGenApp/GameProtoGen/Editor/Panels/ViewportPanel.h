@@ -1,6 +1,10 @@
 #pragma once
 #include "Core/Application.h"
 #include "ECS/Entity.h"
+#include "ECS/SpatialIndex.h"
+#include "Editor/UndoStack.h"
+#include "Systems/Renderer2D.h"
+#include "Runtime/AssetWatcher.h"
 #include <memory>
 #include <optional>
 #include <SFML/Graphics.hpp>
@@ -15,15 +19,36 @@ public:
     void OnAttach() override;
     void OnUpdate(const gp::Timestep& dt) override;
     void OnGuiRender() override;
+    bool WantsFrames() const override { return m_Playing || m_Gesture.has_value() || Renderer2D::TexturesPending() || AssetWatcher::Pending(); }
 
     // ---------- Consola ----------
     static void AppendLog(const std::string& line);
     void DrawConsole(float height); // dibuja la consola al final del panel
 
 private:
-    // Render targets
+    // Render target (se presenta directo: el flip vertical va en las UV de ImGui::Image)
     std::unique_ptr<sf::RenderTexture> m_RT;
-    std::unique_ptr<sf::RenderTexture> m_PresentRT;
+
+    // Redibujo a demanda: en pausa m_RT sólo se vuelve a renderizar si cambió algo
+    // de lo que se ve (escena, cámara, selección, texturas cargadas).
+    struct RenderKey {
+        const Scene* scene = nullptr;
+        ComponentPool<Transform>::Cursor transforms;
+        ComponentPool<Sprite>::Cursor sprites;
+        ComponentPool<Texture2D>::Cursor textures;
+        ComponentPool<Collider>::Cursor colliders; // AABB de gizmos sin Sprite
+        ComponentPool<RenderLayer>::Cursor renderLayers;
+        std::uint64_t entitiesRev = 0, textureRev = 0;
+        std::uint64_t physicsKeys = 0, scriptKeys = 0;
+        sf::Vector2f camera;
+        EntityID selected = 0;
+        std::size_t multiCount = 0;
+        EntityID multiHash = 0;
+        bool operator==(const RenderKey&) const = default;
+    };
+    bool m_RedrawOnDemand = true;
+    std::optional<RenderKey> m_LastRender; // vacío = redibujar sí o sí
+    RenderKey MakeRenderKey() const;
     sf::Clock m_Clock;
 
     // Resolución virtual fija (16:9)
@@ -37,6 +62,7 @@ private:
     bool m_Playing = false;       // arranca en pausa
     bool m_Panning = false;       // pan de cámara en pausa
     bool m_Dragging = false;      // arrastre de entidad en pausa
+    std::optional<UndoStack::Transaction> m_Gesture; // undo del gesto en curso (mover/rotar/escalar)
     bool m_Rotating = false;
     bool m_Scaling = false;
 
@@ -66,17 +92,23 @@ private:
     // Picking / utilidades
     std::optional<sf::Vector2f> ScreenToWorld(ImVec2 mouse, ImVec2 imgMin, ImVec2 imgMax) const;
     EntityID PickEntityAt(const sf::Vector2f& worldPos) const;
+    void BeginGesture(const char* label, const std::vector<EntityID>& ids); // abre m_Gesture y toca ids
 
     // Gizmos / dibujo
     void DrawGrid(sf::RenderTarget& rt) const;
 
-    void DrawSelectionGizmos(sf::RenderTarget& rt) const; // reemplaza a DrawSelectionGizmo
+    void DrawSelectionGizmos(sf::RenderTarget& rt) const; // primaria + multi, sólo lo visible
     // AABB del entity en coordenadas de mundo (retorna {0,0,0,0} si no hay shape)
     sf::FloatRect EntityWorldAABB(EntityID id) const;
 
     // Devuelve todos los entities cuya AABB intersecta con 'box' (mundo)
     std::vector<EntityID> PickEntitiesInAABB(const sf::FloatRect& box) const;
 
+    // Índice espacial compartido por picking, marquee y gizmos; se sincroniza
+    // (incremental) antes de cada consulta. Es caché: mutable.
+    mutable SpatialIndex m_Index;
+    const SpatialIndex* Index() const; // nullptr sin escena
+
     // Toolbar
     bool IconButtonPlayPause();
     bool IconButtonSelect(bool active);
@@ -0,0 +1,381 @@
+#include "ResponsePipeline.h"
+#include "Runtime/AssetStore.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <string_view>
+#include <utility>
+
+using json = nlohmann::json;
+
+// Lo generado va al AssetStore: outPath queda como nombre lógico (Script.path /
+// Texture2D.path) y el contenido se guarda una sola vez por hash
+static bool SaveTextToStore(const std::string& outPath, const std::string& text) {
+    try {
+        return !AssetStore::Put(outPath, text).empty();
+    }
+    catch (...) { return false; }
+}
+
+// ---------------- base64 decode helper (con soporte de padding '=') ----------------
+static std::vector<unsigned char> Base64Decode(const std::string& input) {
+    // -1: inválido/ignorar, -2: '=' padding
+    static const int8_t DT[256] = {
+        /* 0..15  */ -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+        /* 16..31 */ -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+        /* 32..47 */ -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,62, -1,-1,-1,63,
+        /* 48..63 */ 52,53,54,55,56,57,58,59,60,61,-1,-1,-1,-2,-1,-1,
+        /* 64..79 */ -1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9,10,11,12,13,14,
+        /* 80..95 */ 15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,-1,
+        /* 96..111*/ -1,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,
+        /*112..127*/ 41,42,43,44,45,46,47,48,49,50,51,-1,-1,-1,-1,-1,
+        /*128..255*/ -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+                     -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+    };
+
+    std::vector<unsigned char> out;
+    out.reserve(input.size() * 3 / 4);
+    int val = 0, valb = -8;
+    for (unsigned char c : input) {
+        int d = DT[c];
+        if (d == -1) continue;   // ignora espacios/chars inválidos
+        if (d == -2) break;      // '=' padding -> fin
+        val = (val << 6) | d;
+        valb += 6;
+        if (valb >= 0) {
+            out.push_back(static_cast<unsigned char>((val >> valb) & 0xFF));
+            valb -= 8;
+        }
+    }
+    return out;
+}
+
+static bool SaveBase64ToStore(const std::string& base64, const std::string& outPath) {
+    try {
+        auto bytes = Base64Decode(base64);
+        if (bytes.empty()) return false;
+        const std::string_view view(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        return !AssetStore::Put(outPath, view).empty();
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+// ------------------------- helpers de color -------------------------
+static inline bool is_hex_digit(char c) {
+    return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+}
+static sf::Color ColorFromHexString(const std::string& in) {
+    std::string s = in;
+    if (!s.empty() && s[0] == '#') s.erase(0, 1);
+    if (!(s.size() == 6 || s.size() == 8)) return sf::Color(60, 60, 70, 255);
+    if (!std::all_of(s.begin(), s.end(), is_hex_digit)) return sf::Color(60, 60, 70, 255);
+    auto hexByte = [&](size_t pos) -> std::uint8_t {
+        return static_cast<std::uint8_t>(std::stoul(s.substr(pos, 2), nullptr, 16));
+        };
+    std::uint8_t r = hexByte(0);
+    std::uint8_t g = hexByte(2);
+    std::uint8_t b = hexByte(4);
+    std::uint8_t a = (s.size() == 8) ? hexByte(6) : 255;
+    return sf::Color(r, g, b, a);
+}
+static sf::Color TryParseColor(const json& j, const sf::Color& fallback = sf::Color(60, 60, 70, 255)) {
+    if (j.contains("colorHex") && j["colorHex"].is_string()) return ColorFromHexString(j["colorHex"].get<std::string>());
+    if (j.contains("color") && j["color"].is_object()) {
+        const auto& c = j["color"];
+        auto clamp255 = [](int v) { return std::clamp(v, 0, 255); };
+        int r = c.value("r", 255), g = c.value("g", 255), b = c.value("b", 255), a = c.value("a", 255);
+        return sf::Color((std::uint8_t)clamp255(r), (std::uint8_t)clamp255(g), (std::uint8_t)clamp255(b), (std::uint8_t)clamp255(a));
+    }
+    return fallback;
+}
+// ------------------------- helper entity id -------------------------
+static std::uint32_t GetEntityId(const nlohmann::json& j) {
+    if (!j.contains("entity") || j["entity"].is_null()) return 0;
+    const auto& v = j["entity"];
+    if (v.is_number_unsigned()) return v.get<std::uint32_t>();
+    if (v.is_number_integer()) { int vi = v.get<int>(); return vi > 0 ? static_cast<std::uint32_t>(vi) : 0; }
+    if (v.is_number_float()) { double vf = v.get<double>(); return vf >= 0.0 ? static_cast<std::uint32_t>(std::round(vf)) : 0; }
+    if (v.is_string()) { try { return static_cast<std::uint32_t>(std::stoul(v.get<std::string>())); } catch (...) { return 0; } }
+    return 0;
+}
+
+static std::string SanitizeFileName(std::string name) {
+    for (char& ch : name) {
+        if (ch == '/' || ch == '\\' || ch == ':' || ch == '*' ||
+            ch == '?' || ch == '"' || ch == '<' || ch == '>' || ch == '|') ch = '_';
+    }
+    return name;
+}
+
+static sf::Vector2f Vec2(const json& a) {
+    return { a.at(0).get<float>(), a.at(1).get<float>() };
+}
+
+// Una op del JSON -> PreparedOp. false si la op no se reconoce o no se aplicaría.
+// Tira json::exception si los campos tienen tipos inválidos.
+static bool PrepareOp(const json& op, PreparedOp& out) {
+    const std::string type = op.value("op", "");
+    out = PreparedOp{};
+
+    if (type == "spawn_box") {
+        out.kind = PreparedOp::Kind::SpawnBox;
+        out.pos = Vec2(op.at("pos"));
+        out.size = Vec2(op.at("size"));
+        out.color = TryParseColor(op, sf::Color(60, 60, 70, 255));
+        // Textura opcional directa en la op (por compat con algunos synthesizers)
+        if (op.contains("texturePath") && op["texturePath"].is_string())
+            out.path = op["texturePath"].get<std::string>();
+        if (op.contains("isTrigger") && op["isTrigger"].is_boolean())
+            out.isTrigger = op["isTrigger"].get<bool>();
+        return true;
+    }
+    if (type == "set_transform") {
+        out.kind = PreparedOp::Kind::SetTransform;
+        out.id = GetEntityId(op);
+        if (!out.id) return false;
+        if (op.contains("position") && !op["position"].is_null()) out.position = Vec2(op["position"]);
+        if (op.contains("size") && !op["size"].is_null())         out.newSize = Vec2(op["size"]);
+        if (op.contains("scale") && !op["scale"].is_null())       out.scale = Vec2(op["scale"]);
+        if (op.contains("rotation") && !op["rotation"].is_null()) out.rotation = op["rotation"].get<float>();
+        return true;
+    }
+    if (type == "set_component") {
+        out.id = GetEntityId(op);
+        const std::string comp = op.value("component", "");
+        if (!out.id || !op.contains("value")) return false;
+        const auto& value = op["value"];
+
+        const Reflect::TypeId typeId = Reflect::IdOf(comp);
+        switch (typeId) {
+        case Reflect::TypeIdOf<Sprite>:
+            out.kind = PreparedOp::Kind::SetSprite;
+            if (value.contains("colorHex") && value["colorHex"].is_string()) {
+                out.newColor = ColorFromHexString(value["colorHex"].get<std::string>());
+            }
+            else if (value.contains("color") && value["color"].is_object()) {
+                const auto& c = value["color"];
+                auto clamp255 = [](int v) { return std::clamp(v, 0, 255); };
+                out.newColor = sf::Color(
+                    (std::uint8_t)clamp255(c.value("r", 255)),
+                    (std::uint8_t)clamp255(c.value("g", 255)),
+                    (std::uint8_t)clamp255(c.value("b", 255)),
+                    (std::uint8_t)clamp255(c.value("a", 255)));
+            }
+            if (value.contains("size") && value["size"].is_array() && value["size"].size() >= 2)
+                out.newSize = Vec2(value["size"]);
+            return true;
+
+        case Reflect::TypeIdOf<Texture2D>:
+        case Reflect::TypeIdOf<Script>:
+            if (!value.is_object() || !value.contains("path") || !value["path"].is_string()) return false;
+            out.kind = typeId == Reflect::TypeIdOf<Script> ? PreparedOp::Kind::SetScript : PreparedOp::Kind::SetTexture;
+            out.path = value["path"].get<std::string>();
+            return true;
+
+        case Reflect::TypeIdOf<Collider>:
+            if (!value.is_object()) return false;
+            out.kind = PreparedOp::Kind::SetCollider;
+            // Sólo isTrigger: offset/halfExtents se ignoran si vinieran por error
+            if (value.contains("isTrigger") && value["isTrigger"].is_boolean())
+                out.isTrigger = value["isTrigger"].get<bool>();
+            return true;
+
+        case Reflect::kInvalidType:
+            return false;
+
+        default:
+            // Transform, Physics2D, PlayerController: sólo campos persistibles, tipos validados al aplicar
+            if (!value.is_object()) return false;
+            out.kind = PreparedOp::Kind::SetComponent;
+            out.component = typeId;
+            out.value = value;
+            return true;
+        }
+    }
+    if (type == "remove_entity") {
+        out.kind = PreparedOp::Kind::RemoveEntity;
+        out.id = GetEntityId(op);
+        return out.id != 0;
+    }
+    return false;
+}
+
+static void PrepareOps(const json& resp, PreparedResponse& pr) {
+    if (!resp.contains("ops") || !resp["ops"].is_array()) return;
+    pr.ops.reserve(pr.ops.size() + resp["ops"].size());
+    for (const auto& op : resp["ops"]) {
+        PreparedOp p;
+        try {
+            if (PrepareOp(op, p)) pr.ops.push_back(std::move(p));
+        }
+        catch (const json::exception&) {
+            ++pr.skippedOps;
+        }
+    }
+    if (pr.skippedOps)
+        pr.logs.push_back({ true, "[CHAT] " + std::to_string(pr.skippedOps) + " op(s) con JSON inválido descartadas" });
+}
+
+// Asset suelto o dentro de un bundle. Devuelve el texto para la burbuja.
+static std::string PrepareAsset(const json& item, PreparedResponse& pr) {
+    const std::string outPath = "Assets/Generated/" + SanitizeFileName(item.value("fileName", "asset.png"));
+
+    // Referencia: el binario lo baja el ApiClient (se dispara al aplicar, en el UI thread)
+    const std::string assetId = item.value("assetId", "");
+    if (!assetId.empty()) {
+        pr.downloads.push_back({ assetId, item.value("sha256", ""), outPath });
+        pr.logs.push_back({ false, "[ASSET] Descargando " + assetId + " -> " + outPath });
+        return "Descargando imagen: " + outPath;
+    }
+
+    // Compatibilidad: servers que todavía mandan el PNG en base64 dentro del JSON
+    const std::string data = item.value("data", "");
+    if (!data.empty() && SaveBase64ToStore(data, outPath)) {
+        pr.logs.push_back({ false, "[ASSET] Guardado: " + outPath });
+        return std::string("Imagen guardada en:\n") + std::filesystem::absolute(AssetStore::Resolve(outPath)).string();
+    }
+    pr.logs.push_back({ true, "[ASSET] ERROR al guardar: " + outPath });
+    return "No pude guardar la imagen (payload incompleto o base64 inválido).";
+}
+
+// Guarda el script y devuelve el nombre lógico ("" si falló)
+static std::string PrepareScript(const json& item, PreparedResponse& pr) {
+    const std::string outPath = "Assets/Scripts/" + SanitizeFileName(item.value("fileName", "script.lua"));
+    const std::string code = item.value("code", "");
+    if (!code.empty() && SaveTextToStore(outPath, code)) {
+        pr.logs.push_back({ false, "[SCRIPT] Guardado: " + outPath });
+        return outPath;
+    }
+    pr.logs.push_back({ true, "[SCRIPT] ERROR al guardar script: " + outPath });
+    return {};
+}
+
+PreparedResponse ResponsePipeline::Prepare(const json& root) {
+    PreparedResponse pr;
+    pr.kind = root.value("kind", "");
+
+    if (pr.kind == "delta") {
+        pr.message = root.value("text", "");
+    }
+    else if (pr.kind == "done") {
+        // fin del stream; el cierre lo marca el future
+    }
+    else if (pr.kind == "ops") {
+        PrepareOps(root, pr);
+    }
+    else if (pr.kind == "text") {
+        pr.message = root.value("message", "");
+    }
+    else if (pr.kind == "asset") {
+        pr.message = PrepareAsset(root, pr);
+    }
+    else if (pr.kind == "script") {
+        const std::string path = PrepareScript(root, pr);
+        pr.message = path.empty()
+            ? "No pude guardar el script (payload vacío o error de escritura)."
+            : std::string("Script guardado en:\n")
+                + std::filesystem::absolute(AssetStore::Resolve(path)).string()
+                + "\n(No asignado a ninguna entidad.)";
+    }
+    else if (pr.kind == "bundle") {
+        if (root.contains("items") && root["items"].is_array()) {
+            // 1) assets y scripts primero (las ops del bundle pueden referenciarlos)
+            for (const auto& it : root["items"]) {
+                const std::string ik = it.value("kind", "");
+                if (ik == "asset") PrepareAsset(it, pr);
+                else if (ik == "script") {
+                    const std::string path = PrepareScript(it, pr);
+                    if (!path.empty()) pr.assignScripts.push_back(path);
+                }
+            }
+            // 2) ops + textos
+            for (const auto& it : root["items"]) {
+                const std::string ik = it.value("kind", "");
+                if (ik == "ops")       PrepareOps(it, pr);
+                else if (ik == "text") pr.texts.push_back(it.value("message", ""));
+            }
+        }
+    }
+    else if (root.contains("ops")) {
+        pr.kind = "ops";
+        PrepareOps(root, pr);
+    }
+    else {
+        pr.message = root.dump();
+    }
+    return pr;
+}
+
+// ---------------- Worker ----------------
+
+ResponsePipeline::ResponsePipeline() {
+    m_Worker = std::thread([this] { WorkerLoop(); });
+}
+
+ResponsePipeline::~ResponsePipeline() {
+    {
+        std::lock_guard<std::mutex> lk(m_Mx);
+        m_Stop = true;
+    }
+    m_Cv.notify_all();
+    if (m_Worker.joinable()) m_Worker.join();
+}
+
+void ResponsePipeline::Submit(json resp) {
+    {
+        std::lock_guard<std::mutex> lk(m_Mx);
+        m_In.push_back(std::move(resp));
+    }
+    m_Cv.notify_one();
+}
+
+bool ResponsePipeline::Poll(PreparedResponse& out) {
+    std::lock_guard<std::mutex> lk(m_Mx);
+    if (m_Out.empty()) return false;
+    out = std::move(m_Out.front());
+    m_Out.pop_front();
+    return true;
+}
+
+bool ResponsePipeline::Idle() const {
+    std::lock_guard<std::mutex> lk(m_Mx);
+    return m_In.empty() && m_Out.empty() && !m_Working;
+}
+
+void ResponsePipeline::WorkerLoop() {
+    for (;;) {
+        json resp;
+        {
+            std::unique_lock<std::mutex> lk(m_Mx);
+            m_Cv.wait(lk, [this] { return m_Stop || !m_In.empty(); });
+            if (m_Stop) return;
+            resp = std::move(m_In.front());
+            m_In.pop_front();
+            m_Working = true;
+        }
+
+        PreparedResponse pr;
+        try {
+            pr = Prepare(resp);
+        }
+        catch (const std::exception& e) {
+            pr = PreparedResponse{};
+            pr.kind = "text";
+            pr.message = std::string("Respuesta inválida: ") + e.what();
+            pr.logs.push_back({ true, "[CHAT] " + pr.message });
+        }
+
+        std::lock_guard<std::mutex> lk(m_Mx);
+        m_Out.push_back(std::move(pr));
+        m_Working = false;
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <nlohmann/json.hpp>
+#include "ECS/ComponentReflection.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Op de escena ya validada: números y strings extraídos del JSON, sin tocar la Scene.
+// El UI thread sólo la aplica (ChatPanel::CommitOps).
+struct PreparedOp {
+    enum class Kind : std::uint8_t {
+        SpawnBox,      // pos, size, color, path (texturePath opcional), isTrigger
+        SetTransform,  // position, size, scale, rotation
+        SetSprite,     // color, size
+        SetTexture,    // path
+        SetScript,     // path
+        SetCollider,   // isTrigger (crea el collider si no existe)
+        SetComponent,  // component + value: resto de componentes reflejados, por Reflect::PatchFromJson
+        RemoveEntity
+    };
+
+    Kind kind = Kind::SpawnBox;
+    std::uint32_t id = 0;
+
+    sf::Vector2f pos{};
+    sf::Vector2f size{};
+    sf::Color color{};
+
+    std::optional<sf::Vector2f> position;
+    std::optional<sf::Vector2f> newSize;
+    std::optional<sf::Vector2f> scale;
+    std::optional<float> rotation;
+    std::optional<sf::Color> newColor;
+    std::optional<bool> isTrigger;
+    std::string path;
+
+    Reflect::TypeId component = Reflect::kInvalidType;
+    nlohmann::json value; // SetComponent: campos a aplicar (formato de SceneSerializer)
+};
+
+// Respuesta (o evento de stream) procesada fuera del UI thread: assets decodificados y
+// guardados, scripts escritos, ops validadas. Lo que queda es O(ops) sobre la Scene.
+struct PreparedResponse {
+    struct Download {
+        std::string assetId;
+        std::string sha256;
+        std::string path; // nombre lógico (Assets/Generated/...)
+    };
+    struct LogLine {
+        bool error = false;
+        std::string text;
+    };
+
+    std::string kind;                       // ops | text | asset | script | bundle | delta | done | ...
+    std::vector<PreparedOp> ops;
+    std::vector<Download> downloads;        // assets por referencia: se disparan en el UI thread
+    std::vector<std::string> assignScripts; // bundle: scripts guardados para asignar a la entidad objetivo
+    std::vector<std::string> texts;         // bundle: mensajes de texto
+    std::string message;                    // texto de burbuja ya resuelto (text/asset/script/delta/fallback)
+    std::vector<LogLine> logs;              // el sink de Log no es thread-safe: se emiten al aplicar
+    int skippedOps = 0;                     // ops descartadas por JSON inválido
+};
+
+// Etapa de preparación en un hilo propio. Submit() se puede llamar desde cualquier hilo
+// (ej: callback de streaming del ApiClient); Poll() devuelve en orden FIFO.
+class ResponsePipeline {
+public:
+    ResponsePipeline();
+    ~ResponsePipeline();
+
+    ResponsePipeline(const ResponsePipeline&) = delete;
+    ResponsePipeline& operator=(const ResponsePipeline&) = delete;
+
+    void Submit(nlohmann::json resp);
+    bool Poll(PreparedResponse& out);
+    bool Idle() const; // nada en cola, en proceso ni listo para Poll
+
+    // Trabajo pesado de una respuesta (público para tests)
+    static PreparedResponse Prepare(const nlohmann::json& resp);
+
+private:
+    void WorkerLoop();
+
+    mutable std::mutex m_Mx;
+    std::condition_variable m_Cv;
+    std::deque<nlohmann::json> m_In;
+    std::deque<PreparedResponse> m_Out;
+    bool m_Working = false;
+    bool m_Stop = false;
+    std::thread m_Worker;
+};
@@ -0,0 +1,222 @@
+#include "UndoStack.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    bool IsAlive(const Scene& scene, EntityID id) {
+        bool alive = false;
+        Reflect::ForEachComponent([&](auto tag) {
+            alive = alive || Reflect::PoolOf<typename decltype(tag)::type>(scene).contains(id);
+        });
+        return alive;
+    }
+
+    UndoStack::EntitySnapshot Capture(const Scene& scene, EntityID id) {
+        UndoStack::EntitySnapshot snap;
+        Reflect::ForEachComponent([&](auto tag) {
+            using T = typename decltype(tag)::type;
+            const auto& pool = Reflect::PoolOf<T>(scene);
+            if (auto it = pool.find(id); it != pool.end())
+                std::get<std::optional<T>>(snap) = it->second;
+        });
+        return snap;
+    }
+
+    // Índice de tipo dentro de AnyComponent (0 = monostate)
+    std::size_t TypeIndex(const UndoStack::ComponentDelta& d) {
+        return std::max(d.before.index(), d.after.index());
+    }
+
+    template <class T> struct EraseFn {
+        static void Call(Scene& s, EntityID id) { Reflect::PoolOf<T>(s).erase(id); }
+    };
+
+    // Escribe 'value' (o borra el componente si es monostate)
+    void Restore(Scene& scene, EntityID id, std::size_t typeIndex, const UndoStack::AnyComponent& value) {
+        static constexpr auto erase = Reflect::Dispatch<EraseFn>();
+        std::visit([&](const auto& c) {
+            using C = std::decay_t<decltype(c)>;
+            if constexpr (std::is_same_v<C, std::monostate>) erase[typeIndex - 1](scene, id);
+            else Reflect::PoolOf<C>(scene)[id] = c;
+        }, value);
+    }
+
+    std::size_t StringBytes(const UndoStack::AnyComponent& v) {
+        if (auto* t = std::get_if<Texture2D>(&v)) return t->path.capacity();
+        if (auto* s = std::get_if<Script>(&v)) return s->path.capacity() + s->inlineCode.capacity();
+        return 0;
+    }
+}
+
+UndoStack::Transaction UndoStack::Begin(std::string label, std::uint64_t coalesceKey) {
+    Transaction tx;
+    tx.m_Label = std::move(label);
+    tx.m_CoalesceKey = coalesceKey;
+    ++m_Pending;
+    return tx;
+}
+
+void UndoStack::Transaction::Touch(const Scene& scene, EntityID id) {
+    if (!id) return;
+    auto [it, inserted] = m_Before.try_emplace(id);
+    if (!inserted) return;
+    it->second = { IsAlive(scene, id), Capture(scene, id) };
+    m_Order.push_back(id);
+}
+
+void UndoStack::Transaction::TouchNew(EntityID id) {
+    if (!id) return;
+    if (m_Before.try_emplace(id).second) m_Order.push_back(id); // snapshot vacío, no viva
+}
+
+void UndoStack::Cancel(Transaction& tx) {
+    if (m_Pending > 0) --m_Pending;
+    tx = Transaction{};
+}
+
+bool UndoStack::Commit(Transaction& tx, const Scene& scene) {
+    if (m_Pending > 0) --m_Pending;
+    Transaction open = std::move(tx);
+    tx = Transaction{};
+
+    Entry e;
+    e.label = std::move(open.m_Label);
+    e.coalesceKey = open.m_CoalesceKey;
+    e.stamp = Clock::now();
+
+    for (EntityID id : open.m_Order) {
+        const auto& [aliveBefore, before] = open.m_Before[id];
+        const bool aliveAfter = IsAlive(scene, id);
+        if (aliveBefore != aliveAfter) e.entities.push_back({ id, aliveBefore, aliveAfter });
+
+        Reflect::ForEachComponent([&](auto tag) {
+            using T = typename decltype(tag)::type;
+            const auto& b = std::get<std::optional<T>>(before);
+            const auto& pool = Reflect::PoolOf<T>(scene);
+            auto it = pool.find(id);
+            const bool hasAfter = it != pool.end();
+
+            if (!b && !hasAfter) return;
+            if (b && hasAfter && Reflect::Equal(*b, it->second)) return;
+
+            ComponentDelta d;
+            d.id = id;
+            if (b) d.before = *b;
+            if (hasAfter) d.after = it->second;
+            e.components.push_back(std::move(d));
+        });
+    }
+
+    if (e.entities.empty() && e.components.empty()) return false;
+    Push(std::move(e));
+    return true;
+}
+
+void UndoStack::Push(Entry e) {
+    // Nueva edición: lo deshecho ya no se puede rehacer
+    for (const auto& r : m_Redo) m_Bytes -= r.bytes;
+    m_Redo.clear();
+
+    // Coalescer con la entrada de arriba (mismo gesto continuo)
+    if (e.coalesceKey && !m_Undo.empty()) {
+        Entry& top = m_Undo.back();
+        if (top.coalesceKey == e.coalesceKey && e.stamp - top.stamp < kCoalesceWindow) {
+            std::unordered_map<std::uint64_t, std::size_t> index; // (id, tipo) -> delta en 'top'
+            index.reserve(top.components.size());
+            for (std::size_t i = 0; i < top.components.size(); ++i)
+                index[(std::uint64_t)top.components[i].id << 8 | TypeIndex(top.components[i])] = i;
+
+            for (auto& d : e.components) {
+                auto it = index.find((std::uint64_t)d.id << 8 | TypeIndex(d));
+                if (it != index.end()) top.components[it->second].after = std::move(d.after);
+                else top.components.push_back(std::move(d));
+            }
+            for (const auto& ed : e.entities) {
+                auto it = std::find_if(top.entities.begin(), top.entities.end(),
+                    [&](const EntityDelta& x) { return x.id == ed.id; });
+                if (it != top.entities.end()) it->aliveAfter = ed.aliveAfter;
+                else top.entities.push_back(ed);
+            }
+            top.stamp = e.stamp;
+            m_Bytes -= top.bytes;
+            top.bytes = EstimateBytes(top);
+            m_Bytes += top.bytes;
+            Trim();
+            return;
+        }
+    }
+
+    e.bytes = EstimateBytes(e);
+    m_Bytes += e.bytes;
+    m_Undo.push_back(std::move(e));
+    Trim();
+}
+
+void UndoStack::Trim() {
+    while (m_Undo.size() > 1 && (m_Bytes > m_MaxBytes || m_Undo.size() > m_MaxEntries)) {
+        m_Bytes -= m_Undo.front().bytes;
+        m_Undo.pop_front();
+    }
+}
+
+std::size_t UndoStack::EstimateBytes(const Entry& e) {
+    std::size_t n = sizeof(Entry) + e.label.capacity()
+        + e.entities.capacity() * sizeof(EntityDelta)
+        + e.components.capacity() * sizeof(ComponentDelta);
+    for (const auto& d : e.components) n += StringBytes(d.before) + StringBytes(d.after);
+    return n;
+}
+
+void UndoStack::Apply(Scene& scene, const Entry& e, bool forward) {
+    // 1) Revivir entidades (conservan su id: los deltas las referencian)
+    std::vector<EntityID> destroy;
+    for (const auto& ed : e.entities) {
+        const bool target = forward ? ed.aliveAfter : ed.aliveBefore;
+        if (target && !IsAlive(scene, ed.id)) scene.CreateEntityWithId(ed.id);
+        else if (!target) destroy.push_back(ed.id);
+    }
+
+    // 2) Componentes
+    for (const auto& d : e.components)
+        Restore(scene, d.id, TypeIndex(d), forward ? d.after : d.before);
+
+    // 3) Quitar de la lista de entidades en una sola pasada
+    scene.DestroyEntities(destroy);
+}
+
+bool UndoStack::Undo(Scene& scene) {
+    if (m_Pending || m_Undo.empty()) return false; // no deshacer en medio de un gesto
+    Entry e = std::move(m_Undo.back());
+    m_Undo.pop_back();
+    Apply(scene, e, /*forward*/ false);
+    m_Redo.push_back(std::move(e));
+    return true;
+}
+
+bool UndoStack::Redo(Scene& scene) {
+    if (m_Pending || m_Redo.empty()) return false;
+    Entry e = std::move(m_Redo.back());
+    m_Redo.pop_back();
+    Apply(scene, e, /*forward*/ true);
+    e.coalesceKey = 0; // no fusionar ediciones nuevas con algo rehecho
+    m_Undo.push_back(std::move(e));
+    return true;
+}
+
+const std::string& UndoStack::UndoLabel() const {
+    static const std::string empty;
+    return m_Undo.empty() ? empty : m_Undo.back().label;
+}
+
+const std::string& UndoStack::RedoLabel() const {
+    static const std::string empty;
+    return m_Redo.empty() ? empty : m_Redo.back().label;
+}
+
+void UndoStack::Clear() {
+    m_Undo.clear();
+    m_Redo.clear();
+    m_Bytes = 0;
+}
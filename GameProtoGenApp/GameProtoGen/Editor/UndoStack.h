@@ -0,0 +1,103 @@
+#pragma once
+#include "ECS/ComponentReflection.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+// Undo/redo del editor con deltas por componente (no copias de escena).
+// Una edición es una transacción: Begin() -> Touch(id) antes de modificar cada entidad
+// -> Commit(). Al cerrar se compara el estado "antes" de lo tocado con el actual y sólo
+// se guardan los componentes que cambiaron: memoria y tiempo O(cambiado), no O(escena).
+//
+//   auto& h = EditorContext::Get().history;
+//   auto tx = h.Begin("Mover");  tx.Touch(scene, id);  ...modificar...  h.Commit(tx, scene);
+//
+// La transacción la guarda quien edita: un gesto del viewport y una respuesta del chat
+// aplicada en varios frames pueden estar abiertas a la vez sin pisarse.
+//
+// Gestos continuos (drag de inspector) se coalescen pasando la misma 'coalesceKey':
+// si la entrada de arriba tiene esa clave y es reciente, se fusiona en vez de apilar.
+class UndoStack {
+public:
+    // Un componente cualquiera (o ausente). Generado desde Reflect::Components.
+    template <class Tuple> struct VariantOf;
+    template <class... Ts> struct VariantOf<std::tuple<Ts...>> {
+        using type = std::variant<std::monostate, Ts...>;
+        using snapshot = std::tuple<std::optional<Ts>...>;
+    };
+    using AnyComponent = VariantOf<Reflect::Components>::type;
+    using EntitySnapshot = VariantOf<Reflect::Components>::snapshot;
+
+    struct ComponentDelta {
+        EntityID id = 0;
+        AnyComponent before, after; // monostate = la entidad no tenía el componente
+    };
+    struct EntityDelta {
+        EntityID id = 0;
+        bool aliveBefore = false, aliveAfter = false;
+    };
+    struct Entry {
+        std::string label;
+        std::uint64_t coalesceKey = 0;
+        std::chrono::steady_clock::time_point stamp;
+        std::vector<EntityDelta> entities;     // creadas / eliminadas
+        std::vector<ComponentDelta> components;
+        std::size_t bytes = 0;
+    };
+
+    // ---- Transacción ----
+    class Transaction {
+    public:
+        void Touch(const Scene& scene, EntityID id); // captura el "antes" (sólo la primera vez)
+        void TouchNew(EntityID id);                  // entidad recién creada: "antes" = no existía
+        bool Empty() const { return m_Order.empty(); }
+
+    private:
+        friend class UndoStack;
+        std::string m_Label;
+        std::uint64_t m_CoalesceKey = 0;
+        std::unordered_map<EntityID, std::pair<bool, EntitySnapshot>> m_Before; // viva + componentes
+        std::vector<EntityID> m_Order;                                          // orden de Touch
+    };
+
+    Transaction Begin(std::string label, std::uint64_t coalesceKey = 0);
+    bool Commit(Transaction& tx, const Scene& scene); // false si no cambió nada (no se apila)
+    void Cancel(Transaction& tx);
+    bool Pending() const { return m_Pending > 0; }     // transacciones abiertas
+
+    // ---- Historial ----
+    bool Undo(Scene& scene);
+    bool Redo(Scene& scene);
+    bool CanUndo() const { return !m_Undo.empty(); }
+    bool CanRedo() const { return !m_Redo.empty(); }
+    const std::string& UndoLabel() const;
+    const std::string& RedoLabel() const;
+    void Clear(); // escena nueva/cargada: los deltas ya no aplican
+
+    // Presupuesto: se descartan las entradas más viejas al pasarse (siempre queda la última)
+    void SetBudget(std::size_t maxBytes, std::size_t maxEntries) { m_MaxBytes = maxBytes; m_MaxEntries = maxEntries; }
+    std::size_t Bytes() const { return m_Bytes; }
+    std::size_t Size() const { return m_Undo.size(); }
+
+    static constexpr auto kCoalesceWindow = std::chrono::milliseconds(1000);
+
+private:
+    int m_Pending = 0;
+    std::deque<Entry> m_Undo;
+    std::vector<Entry> m_Redo;
+    std::size_t m_Bytes = 0;
+    std::size_t m_MaxBytes = 64ull * 1024 * 1024;
+    std::size_t m_MaxEntries = 256;
+
+    static void Apply(Scene& scene, const Entry& e, bool forward);
+    static std::size_t EstimateBytes(const Entry& e);
+    void Push(Entry e);
+    void Trim();
+};
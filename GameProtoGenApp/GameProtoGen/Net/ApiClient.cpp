@@ -1,7 +1,18 @@
 #include "ApiClient.h"
+#include "Gzip.h"
+#include "ChatStream.h"
 #include <cpr/cpr.h>
 #include <nlohmann/json.hpp>
-#include <algorithm>   // std::max
+#include <algorithm>   // std::max, std::find
+#include <picosha2.h>
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <system_error>
 #include <utility>
 
 using json = nlohmann::json;
@@ -29,139 +40,530 @@ std::string ApiClient::BuildUrl(const std::string& path) const {
     return scheme + hostport + JoinPath(m_BasePath, path);
 }
 
-std::optional<json> ApiClient::SendCommand(const std::string& prompt,
-    const json& scene,
-    const std::vector<uint32_t>& selected,
-    std::string* err) {
-    // Preflight proactivo (opcional)
-    if (m_OnPreflight) m_OnPreflight();
+ApiClient::WireBody ApiClient::EncodeBody(const json& req) const {
+    WireBody w;
+    w.bytes = req.dump(); // compacto, sin indentación
 
-    const std::string url = BuildUrl("/chat/command");
-    json req;
-    req["prompt"] = prompt;
-    req["scene"]  = scene;
-    if (!selected.empty()) 
-        req["selected"] = selected;
-
-    const long xfer_ms =
-        static_cast<long>((std::max)(m_ReadTimeoutSec, m_WriteTimeoutSec)) * 1000L;
+    if (m_CompressRequests && w.bytes.size() >= m_CompressMinBytes && GzipSupported()) {
+        std::string gz;
+        if (GzipCompress(w.bytes, gz) && gz.size() < w.bytes.size()) {
+            w.bytes = std::move(gz);
+            w.gzip = true;
+        }
+    }
+    return w;
+}
 
-    auto build_hdr = [this]() {
+namespace {
+    cpr::Header MakeHeader(const std::string& token, bool gzip) {
         cpr::Header hdr{ {"Content-Type","application/json"} };
-        if (!m_AccessToken.empty()) {
-            hdr["Authorization"] = "Bearer " + m_AccessToken;
-        }
+        if (gzip) hdr["Content-Encoding"] = "gzip";
+        if (!token.empty()) hdr["Authorization"] = "Bearer " + token;
         return hdr;
-        };
+    }
 
-    cpr::Response res = cpr::Post(
-        cpr::Url{ url },
-        build_hdr(),
-        cpr::Body{ req.dump() },
-        cpr::ConnectTimeout{ m_ConnectTimeoutSec * 1000 },
-        cpr::Timeout{ xfer_ms },
-        cpr::VerifySsl{ m_VerifySsl }
-    );
-
-    // Retry una sola vez si 401: intentar refresh y reintentar
-    if (res.status_code == 401 && m_OnRefresh) {
-        if (auto newTok = m_OnRefresh()) {
-            m_AccessToken = *newTok;
-            res = cpr::Post(
-                cpr::Url{ url },
-                build_hdr(),
-                cpr::Body{ req.dump() },
-                cpr::ConnectTimeout{ m_ConnectTimeoutSec * 1000 },
-                cpr::Timeout{ xfer_ms },
-                cpr::VerifySsl{ m_VerifySsl }
-            );
-        }
-    }
-
-    if (res.error.code != cpr::ErrorCode::OK) {
-        if (err) *err = res.error.message;
-        return std::nullopt;
+    // Reusa la sesión del worker: curl mantiene la conexión abierta entre requests
+    cpr::Response PostBody(cpr::Session& s, const std::string& url, const std::string& token,
+        const std::string& bytes, bool gzip, int connect_ms, long xfer_ms, bool verify,
+        const ApiClient::CancelToken& cancel) {
+        s.SetUrl(cpr::Url{ url });
+        s.SetHeader(MakeHeader(token, gzip));
+        s.SetBody(cpr::Body{ bytes });
+        s.SetAcceptEncoding(cpr::AcceptEncoding{ { cpr::AcceptEncodingMethods::gzip, cpr::AcceptEncodingMethods::deflate } });
+        s.SetConnectTimeout(cpr::ConnectTimeout{ connect_ms });
+        s.SetTimeout(cpr::Timeout{ xfer_ms });
+        s.SetVerifySsl(cpr::VerifySsl{ verify });
+        s.SetHttpVersion(cpr::HttpVersion{ cpr::HttpVersionCode::VERSION_2_0_TLS }); // HTTP/2 si el server lo ofrece
+        s.SetProgressCallback(cpr::ProgressCallback{
+            [cancel](auto, auto, auto, auto, auto) -> bool { return !cancel->load(); } });
+        return s.Post();
+    }
+
+    std::shared_ptr<json> MakeChatRequest(std::string prompt, json scene,
+        std::vector<uint32_t> selected, bool sceneIsDelta) {
+        auto req = std::make_shared<json>();
+        (*req)["prompt"] = std::move(prompt);
+        (*req)[sceneIsDelta ? "sceneDelta" : "scene"] = std::move(scene);
+        if (!selected.empty())
+            (*req)["selected"] = std::move(selected);
+        return req;
+    }
+
+    ApiClient::Result CancelledResult() {
+        ApiClient::Result r;
+        r.cancelled = true;
+        r.error = "Cancelled";
+        return r;
+    }
+
+    // Para Job::fail: run pudo haber resuelto la promise antes de tirar
+    template <class R>
+    void SetIfPending(std::promise<R>& p, R r) {
+        try { p.set_value(std::move(r)); }
+        catch (const std::future_error&) {}
+    }
+
+    ApiClient::Result FailedResult(std::string what) {
+        ApiClient::Result r;
+        r.error = "Request failed: " + what;
+        return r;
+    }
+
+    // Código de la línea de estado "HTTP/1.1 200 OK" / "HTTP/2 200"; 0 si no es una
+    long ParseStatusLine(std::string_view h) {
+        if (h.rfind("HTTP/", 0) != 0) return 0;
+        const auto sp = h.find(' ');
+        if (sp == std::string_view::npos) return 0;
+        return std::strtol(std::string(h.substr(sp + 1, 3)).c_str(), nullptr, 10);
+    }
+
+    // SHA-256 (hex) de un archivo en disco; vacío si no se puede leer
+    std::string Sha256OfFile(const std::filesystem::path& p) {
+        std::ifstream in(p, std::ios::binary);
+        if (!in) return {};
+        picosha2::hash256_one_by_one hasher;
+        std::array<char, 64 * 1024> buf{};
+        while (in.read(buf.data(), buf.size()) || in.gcount() > 0) {
+            hasher.process(buf.data(), buf.data() + in.gcount());
+            if (in.eof()) break;
+        }
+        hasher.finish();
+        return picosha2::get_hash_hex_string(hasher);
+    }
+
+    std::string ToLowerHex(std::string s) {
+        for (auto& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return s;
+    }
+
+    // "X-Scene-Rev: 123" (HTTP/2 manda los nombres en minúscula)
+    bool ParseSceneRevHeader(std::string_view line, std::uint64_t& out) {
+        constexpr std::string_view name = "x-scene-rev:";
+        if (line.size() <= name.size()) return false;
+        for (std::size_t i = 0; i < name.size(); ++i)
+            if (std::tolower(static_cast<unsigned char>(line[i])) != name[i]) return false;
+        const std::string value(line.substr(name.size()));
+        char* end = nullptr;
+        out = std::strtoull(value.c_str(), &end, 10);
+        return end != value.c_str();
+    }
+}
+
+// ---------------- Cola + workers ----------------
+
+void ApiClient::Enqueue(Job job) {
+    if (!job.cancel) job.cancel = MakeCancelToken();
+    {
+        std::lock_guard<std::mutex> lk(m_QueueMx);
+        if (m_Workers.empty()) {
+            for (int i = 0; i < m_MaxConcurrency; ++i)
+                m_Workers.emplace_back([this] { WorkerLoop(); });
+        }
+        m_Queue.push_back(std::move(job));
     }
-    if (res.status_code == 200) {
-        try { return json::parse(res.text); }
-        catch (const std::exception& e) {
-            if (err) *err = std::string("Invalid JSON: ") + e.what();
-            return std::nullopt;
+    m_QueueCv.notify_one();
+}
+
+void ApiClient::WorkerLoop() {
+    // Una sesión por canal (ver Channel); se crean al primer uso
+    std::array<std::shared_ptr<cpr::Session>, 3> sessions;
+
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lk(m_QueueMx);
+            m_QueueCv.wait(lk, [this] { return m_Stop || !m_Queue.empty(); });
+            if (m_Stop) {
+                std::deque<Job> left;
+                left.swap(m_Queue);
+                lk.unlock();
+                for (auto& j : left) j.drop();
+                return;
+            }
+            job = std::move(m_Queue.front());
+            m_Queue.pop_front();
+            m_InFlight.push_back(job.cancel);
+        }
+
+        if (job.cancel->load()) job.drop();
+        else {
+            auto& s = sessions[static_cast<std::size_t>(job.channel)];
+            if (!s) s = std::make_shared<cpr::Session>();
+            // Una excepción (bad_alloc, callback del usuario, cpr) no puede matar el worker
+            // ni dejar el future colgado: se entrega al job y la sesión se descarta, porque
+            // pudo quedar con callbacks apuntando a locals del run que tiró
+            std::optional<std::string> failure;
+            try { job.run(*s); }
+            catch (const std::exception& e) { failure = e.what(); }
+            catch (...) { failure = "unknown exception"; }
+            if (failure) {
+                s.reset();
+                job.fail(std::move(*failure));
+            }
         }
+
+        std::lock_guard<std::mutex> lk(m_QueueMx);
+        m_InFlight.erase(std::find(m_InFlight.begin(), m_InFlight.end(), job.cancel));
+    }
+}
+
+void ApiClient::CancelAll() {
+    std::deque<Job> dropped;
+    {
+        std::lock_guard<std::mutex> lk(m_QueueMx);
+        dropped.swap(m_Queue);
+        for (auto& c : m_InFlight) *c = true;
     }
-    if (err) *err = "HTTP status " + std::to_string(res.status_code);
-    return std::nullopt;
+    for (auto& j : dropped) j.drop();
+}
+
+// ---------------- Chat ----------------
+
+std::optional<json> ApiClient::SendCommand(const std::string& prompt,
+    const json& scene,
+    const std::vector<uint32_t>& selected,
+    std::string* err) {
+    // Misma cola/sesiones que la versión async; acá sólo se espera el resultado
+    Result r = SendCommandAsync(prompt, scene, selected).get();
+    if (!r.ok()) {
+        if (err) *err = r.error;
+        return std::nullopt;
+    }
+    return std::move(r.data);
 }
 
 std::future<ApiClient::Result> ApiClient::SendCommandAsync(std::string prompt,
     json scene,
-    std::vector<uint32_t> selected) {
+    std::vector<uint32_t> selected,
+    bool sceneIsDelta,
+    CancelToken cancel) {
     const std::string url = BuildUrl("/chat/command");
     const int connect_ms = m_ConnectTimeoutSec * 1000;
     const long xfer_ms =
         static_cast<long>((std::max)(m_ReadTimeoutSec, m_WriteTimeoutSec)) * 1000L;
     const bool verify = m_VerifySsl;
 
-    auto make_hdr = [this]() {
-        cpr::Header hdr{ {"Content-Type","application/json"} };
-        if (!m_AccessToken.empty()) {
-            hdr["Authorization"] = "Bearer " + m_AccessToken;
-        }
-        return hdr;
-        };
-
-    json req;
-    req["prompt"] = std::move(prompt);
-    req["scene"] = std::move(scene);
-    if (!selected.empty())
-        req["selected"] = selected;
-
-    std::string body = req.dump();
+    auto req = MakeChatRequest(std::move(prompt), std::move(scene), std::move(selected), sceneIsDelta);
 
     // Preflight proactivo fuera del hilo (opcional)
     if (m_OnPreflight) m_OnPreflight();
 
-    auto async_resp = cpr::PostAsync(
-        cpr::Url{ url },
-        make_hdr(),
-        cpr::Body{ body },
-        cpr::ConnectTimeout{ connect_ms },
-        cpr::Timeout{ xfer_ms },
-        cpr::VerifySsl{ verify }
-    );
-
-    return std::async(std::launch::async,
-        [ar = std::move(async_resp), this, url, connect_ms, xfer_ms, verify, body, make_hdr]() mutable -> Result {
-            Result r;
-
-            cpr::Response res = ar.get();  // <-- .get()
-
-            // Retry una vez si 401
-            if (res.status_code == 401 && m_OnRefresh) {
-                if (auto newTok = m_OnRefresh()) {
-                    m_AccessToken = *newTok;
-                    res = cpr::Post(
-                        cpr::Url{ url },
-                        make_hdr(),
-                        cpr::Body{ body },
-                        cpr::ConnectTimeout{ connect_ms },
-                        cpr::Timeout{ xfer_ms },
-                        cpr::VerifySsl{ verify }
-                    );
-                }
+    if (!cancel) cancel = MakeCancelToken();
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto fut = promise->get_future();
+
+    Job job;
+    job.cancel = cancel;
+    job.drop = [promise] { promise->set_value(CancelledResult()); };
+    job.fail = [promise](std::string what) { SetIfPending(*promise, FailedResult(std::move(what))); };
+    // dump + gzip + envío en el worker: el UI thread sólo arma el json
+    job.run = [this, promise, req, url, connect_ms, xfer_ms, verify, cancel](cpr::Session& session) {
+        Result r;
+
+        WireBody wire = EncodeBody(*req);
+        cpr::Response res = PostBody(session, url, AccessToken(), wire.bytes, wire.gzip,
+            connect_ms, xfer_ms, verify, cancel);
+
+        // Server sin descompresión de requests (415): reintentar plano y no volver a comprimir.
+        // Un 400 es un error del pedido en sí y no dice nada del gzip: se informa tal cual.
+        // (sin Log acá: el sink de la consola no es thread-safe)
+        if (wire.gzip && res.status_code == 415) {
+            m_CompressRequests = false;
+            wire = EncodeBody(*req);
+            res = PostBody(session, url, AccessToken(), wire.bytes, wire.gzip,
+                connect_ms, xfer_ms, verify, cancel);
+        }
+
+        // Retry una vez si 401
+        if (res.status_code == 401 && m_OnRefresh && !cancel->load()) {
+            if (auto newTok = m_OnRefresh()) {
+                SetAccessToken(*newTok);
+                res = PostBody(session, url, AccessToken(), wire.bytes, wire.gzip,
+                    connect_ms, xfer_ms, verify, cancel);
             }
+        }
 
-            if (res.error.code != cpr::ErrorCode::OK) {
-                r.error = res.error.message;
-                return r;
+        r.httpStatus = res.status_code;
+        if (cancel->load()) {
+            r = CancelledResult();
+        }
+        else if (res.error.code != cpr::ErrorCode::OK) {
+            r.error = res.error.message;
+        }
+        else {
+            if (auto it = res.header.find("X-Scene-Rev"); it != res.header.end()) {
+                try { r.sceneRev = std::stoull(it->second); }
+                catch (...) {}
             }
+
             if (res.status_code == 200) {
                 try { r.data = json::parse(res.text); }
                 catch (const std::exception& e) { r.error = std::string("Invalid JSON: ") + e.what(); }
             }
+            else if (res.status_code == 409) {
+                r.resync = true;
+                r.error = "Scene out of sync (HTTP 409)";
+            }
             else {
                 r.error = "HTTP status " + std::to_string(res.status_code);
             }
-            return r;
-        });
+        }
+        promise->set_value(std::move(r));
+    };
+
+    Enqueue(std::move(job));
+    return fut;
+}
+
+std::future<ApiClient::Result> ApiClient::StreamCommandAsync(std::string prompt,
+    json scene,
+    std::vector<uint32_t> selected,
+    bool sceneIsDelta,
+    CancelToken cancel,
+    StreamEventFn onEvent) {
+    const std::string url = BuildUrl("/chat/command/stream");
+    const int connect_ms = m_ConnectTimeoutSec * 1000;
+    const long xfer_ms =
+        static_cast<long>((std::max)(m_ReadTimeoutSec, m_WriteTimeoutSec)) * 1000L;
+    const bool verify = m_VerifySsl;
+
+    auto req = MakeChatRequest(std::move(prompt), std::move(scene), std::move(selected), sceneIsDelta);
+
+    if (m_OnPreflight) m_OnPreflight();
+
+    if (!cancel) cancel = MakeCancelToken();
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto fut = promise->get_future();
+
+    Job job;
+    job.cancel = cancel;
+    job.channel = Channel::Stream;
+    job.drop = [promise] { promise->set_value(CancelledResult()); };
+    job.fail = [promise](std::string what) { SetIfPending(*promise, FailedResult(std::move(what))); };
+    job.run = [this, promise, req, url, connect_ms, xfer_ms, verify, cancel, onEvent = std::move(onEvent)](cpr::Session& session) {
+        // Estado del intento actual (los reintentos por gzip/401 arrancan de cero)
+        long status = 0;
+        std::string errBody;
+        std::optional<std::uint64_t> rev;
+        ChatStreamParser parser(onEvent);
+
+        // Los callbacks capturan locals por referencia: sólo se invocan dentro de PostBody
+        // de este job, y el próximo job de streaming los reemplaza antes de su Post.
+        session.SetHeaderCallback(cpr::HeaderCallback{ [&](const auto& line, intptr_t) -> bool {
+            const std::string_view h(line);
+            if (long code = ParseStatusLine(h)) {
+                // Línea de estado (puede venir un "100 Continue" antes de la real)
+                status = code;
+            }
+            else if (std::uint64_t v = 0; ParseSceneRevHeader(h, v)) {
+                rev = v;
+            }
+            return !cancel->load();
+        } });
+        session.SetWriteCallback(cpr::WriteCallback{ [&](const auto& data, intptr_t) -> bool {
+            if (cancel->load()) return false; // aborta la transferencia
+            const std::string_view chunk(data);
+            if (status == 200) parser.Feed(chunk);
+            else if (errBody.size() < 4096) errBody.append(chunk.data(), chunk.size());
+            return true;
+        } });
+
+        auto attempt = [&](const WireBody& wire) {
+            status = 0;
+            errBody.clear();
+            rev.reset();
+            return PostBody(session, url, AccessToken(), wire.bytes, wire.gzip,
+                connect_ms, xfer_ms, verify, cancel);
+        };
+
+        WireBody wire = EncodeBody(*req);
+        cpr::Response res = attempt(wire);
+
+        // Igual que en SendCommandAsync: sólo 415 apaga el gzip
+        if (wire.gzip && status == 415) {
+            m_CompressRequests = false;
+            wire = EncodeBody(*req);
+            res = attempt(wire);
+        }
+
+        if (status == 401 && m_OnRefresh && !cancel->load()) {
+            if (auto newTok = m_OnRefresh()) {
+                SetAccessToken(*newTok);
+                res = attempt(wire);
+            }
+        }
+
+        Result r;
+        r.httpStatus = status;
+        if (cancel->load()) {
+            r = CancelledResult();
+        }
+        else if (res.error.code != cpr::ErrorCode::OK) {
+            r.error = res.error.message;
+        }
+        else if (status == 200) {
+            parser.Finish();
+            r.sceneRev = rev;
+            r.data = json{ {"kind", "stream"}, {"events", parser.EventCount()} };
+        }
+        else if (status == 409) {
+            r.resync = true;
+            r.error = "Scene out of sync (HTTP 409)";
+        }
+        else {
+            r.error = "HTTP status " + std::to_string(status);
+        }
+        promise->set_value(std::move(r));
+    };
+
+    Enqueue(std::move(job));
+    return fut;
+}
+
+// ---------------- Assets ----------------
+
+std::future<ApiClient::DownloadResult> ApiClient::DownloadAssetAsync(std::string assetId,
+    std::string destPath,
+    std::string expectedSha256,
+    CancelToken cancel) {
+    const std::string url = BuildUrl("/assets/" + assetId);
+    const int connect_ms = m_ConnectTimeoutSec * 1000;
+    const long xfer_ms =
+        static_cast<long>((std::max)(m_ReadTimeoutSec, m_WriteTimeoutSec)) * 1000L;
+    const bool verify = m_VerifySsl;
+    expectedSha256 = ToLowerHex(std::move(expectedSha256));
+
+    if (!cancel) cancel = MakeCancelToken();
+    auto promise = std::make_shared<std::promise<DownloadResult>>();
+    auto fut = promise->get_future();
+
+    Job job;
+    job.cancel = cancel;
+    job.channel = Channel::Download;
+    job.drop = [promise, destPath] {
+        DownloadResult r;
+        r.path = destPath;
+        r.cancelled = true;
+        r.error = "Cancelled";
+        promise->set_value(std::move(r));
+    };
+    job.fail = [promise, destPath](std::string what) {
+        DownloadResult r;
+        r.path = destPath;
+        r.error = "Download failed: " + what;
+        SetIfPending(*promise, std::move(r));
+    };
+    job.run = [this, promise, url, destPath, expectedSha256, connect_ms, xfer_ms, verify, cancel](cpr::Session& session) {
+        namespace fs = std::filesystem;
+        DownloadResult r;
+        r.path = destPath;
+
+        const fs::path dest(destPath);
+        const fs::path part = fs::path(destPath + ".part");
+        std::error_code ec;
+
+        // Mismo contenido ya en disco (ej: el asset se pidió dos veces): no bajar de nuevo
+        if (!expectedSha256.empty() && fs::exists(dest, ec) && Sha256OfFile(dest) == expectedSha256) {
+            r.ok = true;
+            r.cached = true;
+            r.sha256 = expectedSha256;
+            r.bytes = static_cast<std::uint64_t>(fs::file_size(dest, ec));
+            promise->set_value(std::move(r));
+            return;
+        }
+
+        if (dest.has_parent_path()) fs::create_directories(dest.parent_path(), ec);
+
+        long status = 0;
+        std::ofstream out;
+        picosha2::hash256_one_by_one hasher;
+        std::uint64_t written = 0;
+        bool writeFailed = false;
+
+        // Igual que en streaming: los callbacks viven sólo durante el Get de este job
+        session.SetHeaderCallback(cpr::HeaderCallback{ [&](const auto& line, intptr_t) -> bool {
+            if (long code = ParseStatusLine(std::string_view(line))) status = code;
+            return !cancel->load();
+        } });
+        session.SetWriteCallback(cpr::WriteCallback{ [&](const auto& data, intptr_t) -> bool {
+            if (cancel->load()) return false;
+            if (status != 200) return true; // cuerpo de error: se descarta
+            const std::string_view chunk(data);
+            out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            if (!out) { writeFailed = true; return false; }
+            hasher.process(chunk.begin(), chunk.end());
+            written += chunk.size();
+            return true;
+        } });
+
+        auto attempt = [&]() {
+            status = 0;
+            written = 0;
+            hasher.init();
+            out.close();
+            out.clear();
+            out.open(part, std::ios::binary | std::ios::trunc);
+
+            cpr::Header hdr;
+            if (const std::string tok = AccessToken(); !tok.empty())
+                hdr["Authorization"] = "Bearer " + tok;
+            session.SetUrl(cpr::Url{ url });
+            session.SetHeader(hdr);
+            session.SetConnectTimeout(cpr::ConnectTimeout{ connect_ms });
+            session.SetTimeout(cpr::Timeout{ xfer_ms });
+            session.SetVerifySsl(cpr::VerifySsl{ verify });
+            session.SetHttpVersion(cpr::HttpVersion{ cpr::HttpVersionCode::VERSION_2_0_TLS });
+            session.SetProgressCallback(cpr::ProgressCallback{
+                [cancel](auto, auto, auto, auto, auto) -> bool { return !cancel->load(); } });
+            if (!out) { writeFailed = true; return cpr::Response{}; }
+            return session.Get();
+        };
+
+        cpr::Response res = attempt();
+        if (status == 401 && m_OnRefresh && !cancel->load()) {
+            if (auto newTok = m_OnRefresh()) {
+                SetAccessToken(*newTok);
+                res = attempt();
+            }
+        }
+        out.close();
+
+        if (cancel->load()) {
+            r.cancelled = true;
+            r.error = "Cancelled";
+        }
+        else if (writeFailed) {
+            r.error = "No se pudo escribir " + part.string();
+        }
+        else if (res.error.code != cpr::ErrorCode::OK) {
+            r.error = res.error.message;
+        }
+        else if (status != 200) {
+            r.error = "HTTP status " + std::to_string(status);
+        }
+        else {
+            hasher.finish();
+            r.sha256 = picosha2::get_hash_hex_string(hasher);
+            r.bytes = written;
+            if (!expectedSha256.empty() && r.sha256 != expectedSha256) {
+                r.error = "Hash no coincide (esperado " + expectedSha256 + ", recibido " + r.sha256 + ")";
+            }
+            else {
+                fs::rename(part, dest, ec);
+                if (ec) {
+                    // Windows no pisa destinos existentes con rename
+                    fs::remove(dest, ec);
+                    fs::rename(part, dest, ec);
+                }
+                if (ec) r.error = "No se pudo mover a " + destPath + ": " + ec.message();
+                else    r.ok = true;
+            }
+        }
+
+        if (!r.ok) fs::remove(part, ec);
+        promise->set_value(std::move(r));
+    };
+
+    Enqueue(std::move(job));
+    return fut;
 }
@@ -3,18 +3,50 @@
 #include <optional>
 #include <future>
 #include <utility>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 #include <functional>  
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace cpr { class Session; }
 
 class ApiClient {
 public:
     explicit ApiClient(std::string host = "127.0.0.1", int port = 5559)
         : m_Host(std::move(host)), m_Port(port) {
     }
+    ~ApiClient() {
+        {
+            std::lock_guard<std::mutex> lk(m_QueueMx);
+            m_Stop = true;
+            for (auto& c : m_InFlight) *c = true; // abortar lo que esté en vuelo
+        }
+        m_QueueCv.notify_all();
+        for (auto& t : m_Workers) if (t.joinable()) t.join();
+    }
+
+    ApiClient(const ApiClient&) = delete;
+    ApiClient& operator=(const ApiClient&) = delete;
+
+    // Cancelación cooperativa: si se pone en true, la request se descarta de la cola
+    // o se aborta en vuelo (progress callback de curl).
+    using CancelToken = std::shared_ptr<std::atomic<bool>>;
+    static CancelToken MakeCancelToken() { return std::make_shared<std::atomic<bool>>(false); }
 
     struct Result {
         std::optional<nlohmann::json> data;
         std::string error;
+        std::optional<std::uint64_t> sceneRev; // header X-Scene-Rev: revisión de escena que quedó en el server
+        bool resync = false;                   // 409: el server no tiene la base del delta -> reenviar completa
+        bool cancelled = false;
+        long httpStatus = 0;
         bool ok() const { return data.has_value() && error.empty(); }
     };
 
@@ -29,9 +61,47 @@ public:
         const std::vector<uint32_t>& selected = {},
         std::string* errMsg = nullptr);
 
+    // sceneIsDelta: 'scene' es un delta de SceneDeltaTracker (se envía como "sceneDelta")
+    // La request se encola y la atiende un worker con sesión HTTP persistente (keep-alive).
     std::future<Result> SendCommandAsync(std::string prompt,
         nlohmann::json scene,
-        std::vector<uint32_t> selected = {});
+        std::vector<uint32_t> selected = {},
+        bool sceneIsDelta = false,
+        CancelToken cancel = nullptr);
+
+    // Streaming (POST /chat/command/stream, NDJSON o SSE). 'onEvent' se llama desde el worker
+    // con cada objeto apenas llega ({"kind":"delta","text"}, {"kind":"ops",...}, ...).
+    // El future se resuelve cuando termina el stream; 'data' queda en {"kind":"stream","events":N}.
+    using StreamEventFn = std::function<void(const nlohmann::json&)>;
+    std::future<Result> StreamCommandAsync(std::string prompt,
+        nlohmann::json scene,
+        std::vector<uint32_t> selected,
+        bool sceneIsDelta,
+        CancelToken cancel,
+        StreamEventFn onEvent);
+
+    // Descarga binaria de un asset generado (GET /assets/{id}). Se escribe en streaming a
+    // "<destPath>.part" mientras se calcula el SHA-256; si coincide con 'expectedSha256'
+    // (hex, opcional) se renombra a destPath. Si destPath ya existe con ese hash no se baja.
+    struct DownloadResult {
+        bool ok = false;
+        std::string path;
+        std::string sha256;       // hash del archivo final
+        std::uint64_t bytes = 0;
+        bool cached = false;      // ya estaba en disco con el mismo hash
+        bool cancelled = false;
+        std::string error;
+    };
+    std::future<DownloadResult> DownloadAssetAsync(std::string assetId,
+        std::string destPath,
+        std::string expectedSha256 = {},
+        CancelToken cancel = nullptr);
+
+    // Cantidad de workers (= requests simultáneas = sesiones abiertas). Tomar efecto antes del primer envío.
+    void SetMaxConcurrency(int n) { m_MaxConcurrency = n < 1 ? 1 : n; }
+
+    // Cancela todo lo que esté en cola o en vuelo
+    void CancelAll();
 
     void SetTimeouts(int connectSec, int readSec, int writeSec) {
         m_ConnectTimeoutSec = connectSec; // tiempo máximo para establecer la conexión
@@ -42,13 +112,24 @@ public:
     void SetBasePath(std::string basePath) { m_BasePath = std::move(basePath); }
     void UseHttps(bool on) { m_UseHttps = on; }
     void SetVerifySsl(bool verify) { m_VerifySsl = verify; }
-    void SetAccessToken(std::string token) { m_AccessToken = std::move(token); }
+    void SetAccessToken(std::string token) {
+        std::lock_guard<std::mutex> lk(m_TokenMx);
+        m_AccessToken = std::move(token);
+    }
+
+    // gzip del body (Content-Encoding) a partir de 'minBytes'. Las respuestas comprimidas
+    // se aceptan siempre (Accept-Encoding) y las descomprime curl.
+    void SetRequestCompression(bool on, std::size_t minBytes = 1024) {
+        m_CompressRequests = on;
+        m_CompressMinBytes = minBytes;
+    }
 
 private:
     std::string m_Host;
     int m_Port;
     std::string m_BasePath = "/api";
-    std::string m_AccessToken;
+    std::string m_AccessToken;        // se lee desde los workers
+    mutable std::mutex m_TokenMx;
 
     RefreshFn  m_OnRefresh;    
     PreflightFn m_OnPreflight; 
@@ -60,6 +141,45 @@ private:
     bool m_UseHttps = false;
     bool m_VerifySsl = true;
 
+    std::atomic<bool> m_CompressRequests{ false }; // se apaga solo si el server rechaza gzip
+    std::size_t m_CompressMinBytes = 1024;
+
+    // Body listo para mandar (dump compacto + gzip opcional). Se arma en el hilo de la request.
+    struct WireBody {
+        std::string bytes;
+        bool gzip = false;
+    };
+    WireBody EncodeBody(const nlohmann::json& req) const;
+
+    std::string AccessToken() const {
+        std::lock_guard<std::mutex> lk(m_TokenMx);
+        return m_AccessToken;
+    }
+
+    // ---- Cola de requests + workers (cada uno con su cpr::Session reutilizable) ----
+    // Cada canal usa su propia sesión en el worker: streaming y descargas instalan
+    // write/header callbacks, y un GET no debe heredar el body de un POST anterior.
+    enum class Channel { Request, Stream, Download };
+
+    struct Job {
+        std::function<void(cpr::Session&)> run; // hace la request y resuelve su promise
+        std::function<void()> drop;             // resuelve la promise como cancelada sin ejecutar
+        std::function<void(std::string)> fail;  // resuelve la promise con error si run tiró
+        CancelToken cancel;
+        Channel channel = Channel::Request;
+    };
+
+    void Enqueue(Job job);
+    void WorkerLoop();
+
+    std::mutex m_QueueMx;
+    std::condition_variable m_QueueCv;
+    std::deque<Job> m_Queue;
+    std::vector<std::thread> m_Workers; // se crean con el primer Enqueue
+    std::vector<CancelToken> m_InFlight;
+    bool m_Stop = false;
+    int m_MaxConcurrency = 2;
+
     std::string BuildUrl(const std::string& path) const;
     static std::string JoinPath(const std::string& a, const std::string& b);
 };
@@ -0,0 +1,69 @@
+#include "ChatStream.h"
+
+void ChatStreamParser::Feed(std::string_view chunk) {
+    m_Buf.append(chunk.data(), chunk.size());
+
+    std::size_t start = 0;
+    for (;;) {
+        const std::size_t nl = m_Buf.find('\n', start);
+        if (nl == std::string::npos) break;
+        HandleLine(std::string_view(m_Buf).substr(start, nl - start));
+        start = nl + 1;
+    }
+    m_Buf.erase(0, start);
+}
+
+void ChatStreamParser::Finish() {
+    if (!m_Buf.empty()) {
+        std::string rest;
+        rest.swap(m_Buf);
+        HandleLine(rest);
+    }
+    if (!m_SseData.empty()) {
+        std::string data;
+        data.swap(m_SseData);
+        Dispatch(data);
+    }
+}
+
+void ChatStreamParser::HandleLine(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+    // SSE: línea vacía cierra el evento
+    if (line.empty()) {
+        if (!m_SseData.empty()) {
+            std::string data;
+            data.swap(m_SseData);
+            Dispatch(data);
+        }
+        return;
+    }
+
+    if (line.rfind("data:", 0) == 0) {
+        line.remove_prefix(5);
+        if (!line.empty() && line.front() == ' ') line.remove_prefix(1);
+        if (!m_SseData.empty()) m_SseData.push_back('\n');
+        m_SseData.append(line.data(), line.size());
+        return;
+    }
+
+    // Resto de campos SSE (comentarios, event:, id:, retry:) no nos interesan
+    if (line.front() == ':' || line.rfind("event:", 0) == 0 ||
+        line.rfind("id:", 0) == 0 || line.rfind("retry:", 0) == 0)
+        return;
+
+    // NDJSON
+    Dispatch(line);
+}
+
+void ChatStreamParser::Dispatch(std::string_view payload) {
+    if (payload == "[DONE]") return;
+
+    nlohmann::json ev = nlohmann::json::parse(payload.begin(), payload.end(), nullptr, false);
+    if (ev.is_discarded() || !ev.is_object()) {
+        ++m_Bad;
+        return;
+    }
+    ++m_Events;
+    if (m_OnEvent) m_OnEvent(ev);
+}
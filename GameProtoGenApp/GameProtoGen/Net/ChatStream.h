@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+// Parser incremental de respuestas de chat en streaming.
+// Acepta NDJSON (un objeto JSON por línea) y SSE ("data: {...}" + línea vacía).
+// Los chunks pueden cortar líneas por la mitad: se bufferea hasta el '\n'.
+class ChatStreamParser {
+public:
+    using EventFn = std::function<void(const nlohmann::json&)>;
+
+    explicit ChatStreamParser(EventFn onEvent) : m_OnEvent(std::move(onEvent)) {}
+
+    void Feed(std::string_view chunk);
+    void Finish(); // procesa lo que haya quedado sin '\n' final
+
+    std::size_t EventCount() const { return m_Events; }
+    std::size_t BadLines() const { return m_Bad; } // líneas que no eran JSON (se ignoran)
+
+private:
+    void HandleLine(std::string_view line);
+    void Dispatch(std::string_view payload);
+
+    EventFn m_OnEvent;
+    std::string m_Buf;
+    std::string m_SseData; // SSE: varias líneas data: forman un evento
+    std::size_t m_Events = 0;
+    std::size_t m_Bad = 0;
+};
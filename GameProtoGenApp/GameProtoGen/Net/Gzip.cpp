@@ -0,0 +1,30 @@
+#include "Gzip.h"
+
+#if GP_HAS_ZLIB
+#include <zlib.h>
+
+bool GzipSupported() { return true; }
+
+bool GzipCompress(const std::string& in, std::string& out, int level) {
+    z_stream zs{};
+    // 15 bits de ventana + 16 => header/trailer gzip en vez de zlib
+    if (deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    out.resize(deflateBound(&zs, static_cast<uLong>(in.size())) + 18);
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    zs.avail_in = static_cast<uInt>(in.size());
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = static_cast<uInt>(out.size());
+
+    const int rc = deflate(&zs, Z_FINISH);
+    deflateEnd(&zs);
+    if (rc != Z_STREAM_END) { out.clear(); return false; }
+
+    out.resize(zs.total_out);
+    return true;
+}
+#else
+bool GzipSupported() { return false; }
+bool GzipCompress(const std::string&, std::string& out, int) { out.clear(); return false; }
+#endif
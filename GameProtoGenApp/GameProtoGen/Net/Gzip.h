@@ -0,0 +1,7 @@
+#pragma once
+#include <string>
+
+// Compresión gzip (RFC 1952) para bodies HTTP.
+// Si el build no tiene zlib, GzipSupported() es false y GzipCompress falla.
+bool GzipSupported();
+bool GzipCompress(const std::string& in, std::string& out, int level = 6);
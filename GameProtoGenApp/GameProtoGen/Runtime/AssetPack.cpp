@@ -0,0 +1,359 @@
+#include "AssetPack.h"
+#include "AssetStore.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#if GP_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+    constexpr char kMagic[8] = { 'G', 'P', 'P', 'A', 'K', 0, 0, 0 };
+    constexpr std::uint32_t kVersion = 1;
+
+    // Little-endian tal cual está en memoria (todas las plataformas que exportamos)
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+        std::uint64_t indexOffset;
+        std::uint64_t indexSize;
+    };
+    static_assert(sizeof(Header) == 32);
+
+    const char* KindName(AssetPack::Kind k) {
+        switch (k) {
+        case AssetPack::Kind::Rgba8:       return "rgba8";
+        case AssetPack::Kind::LuaBytecode: return "luac";
+        default:                           return "raw";
+        }
+    }
+
+    AssetPack::Kind KindFromName(const std::string& s) {
+        if (s == "rgba8") return AssetPack::Kind::Rgba8;
+        if (s == "luac")  return AssetPack::Kind::LuaBytecode;
+        return AssetPack::Kind::Raw;
+    }
+
+    std::uint64_t Rgba8Size(std::uint32_t width, std::uint32_t height) {
+        return std::uint64_t{ width } * height * 4;
+    }
+
+    std::string NormalizeName(std::string name) {
+        std::replace(name.begin(), name.end(), '\\', '/');
+        return name;
+    }
+
+    bool Deflate(std::string_view in, std::string& out) {
+#if GP_HAS_ZLIB
+        uLongf len = compressBound(static_cast<uLong>(in.size()));
+        out.resize(len);
+        if (compress2(reinterpret_cast<Bytef*>(out.data()), &len,
+                      reinterpret_cast<const Bytef*>(in.data()), static_cast<uLong>(in.size()), 6) != Z_OK)
+            return false;
+        out.resize(len);
+        return true;
+#else
+        (void)in; (void)out;
+        return false;
+#endif
+    }
+
+    bool Inflate(std::string_view in, std::size_t rawSize, std::string& out) {
+#if GP_HAS_ZLIB
+        out.resize(rawSize);
+        uLongf len = static_cast<uLongf>(rawSize);
+        if (uncompress(reinterpret_cast<Bytef*>(out.data()), &len,
+                       reinterpret_cast<const Bytef*>(in.data()), static_cast<uLong>(in.size())) != Z_OK)
+            return false;
+        return len == rawSize;
+#else
+        (void)in; (void)rawSize; (void)out;
+        return false; // pack escrito por un build con zlib
+#endif
+    }
+
+    // ---- Archivo montado ----
+    const char* s_Data = nullptr;
+    std::size_t s_Size = 0;
+#ifdef _WIN32
+    HANDLE s_MapHandle = nullptr;
+#endif
+    std::vector<AssetPack::Entry> s_Blobs;
+    std::unordered_map<std::string, std::size_t> s_Names;
+
+    bool MapFile(const std::string& file) {
+#ifdef _WIN32
+        HANDLE f = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (f == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz{};
+        if (!GetFileSizeEx(f, &sz) || sz.QuadPart == 0) { CloseHandle(f); return false; }
+        HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(f); // el mapeo mantiene el archivo abierto
+        if (!m) return false;
+        const void* p = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+        if (!p) { CloseHandle(m); return false; }
+        s_MapHandle = m;
+        s_Data = static_cast<const char*>(p);
+        s_Size = static_cast<std::size_t>(sz.QuadPart);
+#else
+        const int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st {};
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) { close(fd); return false; }
+        void* p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd); // el mapeo sigue válido
+        if (p == MAP_FAILED) return false;
+        s_Data = static_cast<const char*>(p);
+        s_Size = static_cast<std::size_t>(st.st_size);
+#endif
+        return true;
+    }
+
+    void UnmapFile() {
+        if (!s_Data) return;
+#ifdef _WIN32
+        UnmapViewOfFile(s_Data);
+        CloseHandle(s_MapHandle);
+        s_MapHandle = nullptr;
+#else
+        munmap(const_cast<char*>(s_Data), s_Size);
+#endif
+        s_Data = nullptr;
+        s_Size = 0;
+    }
+
+    bool ParseIndex() {
+        if (s_Size < sizeof(Header)) return false;
+        Header h;
+        std::memcpy(&h, s_Data, sizeof h);
+        if (std::memcmp(h.magic, kMagic, sizeof kMagic) != 0 || h.version != kVersion) return false;
+        if (h.indexOffset > s_Size || h.indexSize > s_Size - h.indexOffset) return false;
+
+        const json j = json::parse(s_Data + h.indexOffset, s_Data + h.indexOffset + h.indexSize, nullptr, false);
+        if (!j.is_object() || !j.contains("blobs") || !j.contains("names")) return false;
+        const json& blobs = j["blobs"];
+        const json& names = j["names"];
+        if (!blobs.is_array() || !names.is_object()) return false;
+
+        // Índice dañado: un campo con otro tipo no monta (value()/get() lanzarían)
+        auto number = [](const json& b, const char* key, std::uint64_t def, std::uint64_t& out) {
+            if (!b.contains(key)) { out = def; return true; }
+            if (!b[key].is_number_unsigned()) return false;
+            out = b[key].get<std::uint64_t>();
+            return true;
+        };
+        auto text = [](const json& b, const char* key, const char* def, std::string& out) {
+            if (!b.contains(key)) { out = def; return true; }
+            if (!b[key].is_string()) return false;
+            out = b[key].get<std::string>();
+            return true;
+        };
+
+        for (const auto& b : blobs) {
+            if (!b.is_object()) return false;
+            AssetPack::Entry e;
+            e.index = s_Blobs.size();
+            std::uint64_t width = 0, height = 0;
+            std::string codec, kind;
+            if (!number(b, "offset", 0, e.offset) || !number(b, "size", 0, e.size) ||
+                !number(b, "rawSize", e.size, e.rawSize) || !number(b, "width", 0, width) ||
+                !number(b, "height", 0, height) || !text(b, "codec", "none", codec) || !text(b, "kind", "raw", kind))
+                return false;
+            if (width > UINT32_MAX || height > UINT32_MAX) return false;
+            e.deflate = codec == "deflate";
+            e.kind = KindFromName(kind);
+            e.width = static_cast<std::uint32_t>(width);
+            e.height = static_cast<std::uint32_t>(height);
+            if (e.offset > s_Size || e.size > s_Size - e.offset) return false; // truncado
+            // El loader sube los píxeles tal cual con width/height: tienen que cerrar
+            if (e.kind == AssetPack::Kind::Rgba8 && e.rawSize != Rgba8Size(e.width, e.height)) return false;
+            s_Blobs.push_back(e);
+        }
+        for (auto it = names.begin(); it != names.end(); ++it) {
+            if (!it.value().is_number_unsigned()) return false;
+            const std::uint64_t idx = it.value().get<std::uint64_t>();
+            if (idx >= s_Blobs.size()) return false;
+            s_Names[it.key()] = static_cast<std::size_t>(idx);
+        }
+        return true;
+    }
+}
+
+// ---------------- Writer ----------------
+bool AssetPack::Writer::Fail(std::string msg) {
+    m_Error = std::move(msg);
+    m_Out.close();
+    std::error_code ec;
+    fs::remove(m_File + ".tmp", ec);
+    return false;
+}
+
+bool AssetPack::Writer::Open(const std::string& outFile) {
+    m_File = outFile;
+    m_Blobs.clear();
+    m_ByHash.clear();
+    m_Names.clear();
+    m_Error.clear();
+
+    std::error_code ec;
+    if (fs::path(outFile).has_parent_path()) fs::create_directories(fs::path(outFile).parent_path(), ec);
+    m_Out.open(outFile + ".tmp", std::ios::binary | std::ios::trunc);
+    if (!m_Out) return Fail("no se pudo crear " + outFile + ".tmp");
+
+    const Header h{}; // se completa en Finish
+    m_Out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    m_Pos = sizeof h;
+    return true;
+}
+
+bool AssetPack::Writer::Add(const std::string& name, std::string_view bytes, Kind kind,
+                            std::uint32_t width, std::uint32_t height, bool compress) {
+    if (!m_Out.is_open()) return false;
+
+    if (kind == Kind::Rgba8 && bytes.size() != Rgba8Size(width, height)) {
+        m_Error = name + ": rgba8 de " + std::to_string(bytes.size()) + " bytes no es " +
+                  std::to_string(width) + "x" + std::to_string(height);
+        return false;
+    }
+
+    // Mismos bytes con otras dimensiones son otra textura: el tamaño es parte de la clave
+    std::string key = AssetStore::HashBytes(bytes) + KindName(kind);
+    if (kind == Kind::Rgba8) key += ":" + std::to_string(width) + "x" + std::to_string(height);
+    if (auto it = m_ByHash.find(key); it != m_ByHash.end()) {
+        m_Names[NormalizeName(name)] = it->second;
+        return true;
+    }
+
+    std::string packed;
+    const bool deflate = compress && Deflate(bytes, packed) && packed.size() <= bytes.size() - bytes.size() / 8;
+    const std::string_view data = deflate ? std::string_view(packed) : bytes;
+
+    static const char kZeros[kAlign] = {};
+    const std::size_t pad = (kAlign - m_Pos % kAlign) % kAlign;
+    m_Out.write(kZeros, static_cast<std::streamsize>(pad));
+    m_Pos += pad;
+
+    Entry e;
+    e.index = m_Blobs.size();
+    e.offset = m_Pos;
+    e.size = data.size();
+    e.rawSize = bytes.size();
+    e.deflate = deflate;
+    e.kind = kind;
+    e.width = width;
+    e.height = height;
+    m_Out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!m_Out) return Fail("error escribiendo " + name);
+    m_Pos += data.size();
+
+    m_Blobs.push_back(e);
+    m_ByHash.emplace(key, e.index);
+    m_Names[NormalizeName(name)] = e.index;
+    return true;
+}
+
+bool AssetPack::Writer::Finish() {
+    if (!m_Out.is_open()) return false;
+
+    json blobs = json::array();
+    for (const auto& e : m_Blobs) {
+        json b{ { "offset", e.offset }, { "size", e.size }, { "rawSize", e.rawSize },
+                { "codec", e.deflate ? "deflate" : "none" }, { "kind", KindName(e.kind) } };
+        if (e.kind == Kind::Rgba8) { b["width"] = e.width; b["height"] = e.height; }
+        blobs.push_back(std::move(b));
+    }
+    json names = json::object();
+    for (const auto& [name, idx] : m_Names) names[name] = idx;
+    const std::string index = json{ { "blobs", std::move(blobs) }, { "names", std::move(names) } }.dump();
+
+    Header h{};
+    std::memcpy(h.magic, kMagic, sizeof kMagic);
+    h.version = kVersion;
+    h.indexOffset = m_Pos;
+    h.indexSize = index.size();
+    m_Out.write(index.data(), static_cast<std::streamsize>(index.size()));
+    m_Pos += index.size();
+    m_Out.seekp(0);
+    m_Out.write(reinterpret_cast<const char*>(&h), sizeof h);
+    m_Out.close();
+    if (!m_Out) return Fail("error escribiendo el índice");
+
+    std::error_code ec;
+    fs::rename(m_File + ".tmp", m_File, ec);
+    if (ec) {
+        fs::remove(m_File, ec);
+        fs::rename(m_File + ".tmp", m_File, ec);
+    }
+    if (ec) return Fail("no se pudo renombrar a " + m_File + ": " + ec.message());
+    return true;
+}
+
+// ---------------- Lectura ----------------
+bool AssetPack::Mount(const std::string& file) {
+    Unmount();
+    if (!MapFile(file)) return false;
+    if (!ParseIndex()) { Unmount(); return false; }
+    return true;
+}
+
+void AssetPack::Unmount() {
+    UnmapFile();
+    s_Blobs.clear();
+    s_Names.clear();
+}
+
+bool AssetPack::Mounted() {
+    return s_Data != nullptr;
+}
+
+const AssetPack::Entry* AssetPack::Find(const std::string& name) {
+    if (!s_Data) return nullptr;
+    auto it = s_Names.find(NormalizeName(name));
+    return it == s_Names.end() ? nullptr : &s_Blobs[it->second];
+}
+
+const AssetPack::Entry* AssetPack::At(std::size_t index) {
+    return index < s_Blobs.size() ? &s_Blobs[index] : nullptr;
+}
+
+bool AssetPack::Read(const Entry& e, std::string& scratch, std::string_view& out) {
+    if (!s_Data) return false;
+    const std::string_view stored(s_Data + e.offset, static_cast<std::size_t>(e.size));
+    if (!e.deflate) { out = stored; return true; }
+    if (!Inflate(stored, static_cast<std::size_t>(e.rawSize), scratch)) return false;
+    out = scratch;
+    return true;
+}
+
+bool AssetPack::ReadCopy(const std::string& name, std::string& out) {
+    const Entry* e = Find(name);
+    if (!e) return false;
+    std::string scratch;
+    std::string_view view;
+    if (!Read(*e, scratch, view)) return false;
+    if (view.data() == scratch.data()) out = std::move(scratch);
+    else out.assign(view);
+    return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Archivo empaquetado de un juego exportado (.gppak).
+//
+//   [Header 32 B] [blob][pad] [blob][pad] ... [índice JSON]
+//
+// Cada blob empieza alineado a kAlign dentro del archivo; el índice mapea el nombre
+// lógico (Texture2D.path / Script.path / "scene.json") a un blob, y nombres con el
+// mismo contenido comparten blob. Los blobs pueden ir comprimidos (deflate, si el build
+// tiene zlib) o crudos: los crudos se leen sin copiar, directo del mapeo.
+//
+// El editor escribe con Writer; el Player monta el archivo una vez (un open + mmap) y
+// lee todo desde ahí. Montado es de sólo lectura: Find/Read se pueden usar desde hilos
+// de trabajo.
+class AssetPack {
+public:
+    static constexpr std::size_t kAlign = 64;
+
+    enum class Kind : std::uint8_t {
+        Raw,         // bytes tal cual (scene.json, scripts sin compilar, ...)
+        Rgba8,       // textura ya decodificada: width * height * 4 bytes
+        LuaBytecode, // chunk precompilado (lua_dump)
+    };
+
+    struct Entry {
+        std::size_t index = 0;      // número de blob (nombres que comparten blob, mismo índice)
+        std::uint64_t offset = 0;
+        std::uint64_t size = 0;     // en el archivo
+        std::uint64_t rawSize = 0;  // descomprimido
+        bool deflate = false;
+        Kind kind = Kind::Raw;
+        std::uint32_t width = 0, height = 0;
+    };
+
+    class Writer {
+    public:
+        bool Open(const std::string& outFile);
+        // Contenido ya visto se registra sin volver a escribirse.
+        // compress: se comprime si el build tiene zlib y ahorra al menos 1/8.
+        bool Add(const std::string& name, std::string_view bytes, Kind kind = Kind::Raw,
+                 std::uint32_t width = 0, std::uint32_t height = 0, bool compress = true);
+        // Escribe el índice y cierra. Se escribe a <outFile>.tmp y se renombra al final.
+        bool Finish();
+
+        const std::string& Error() const { return m_Error; }
+        std::uint64_t BytesWritten() const { return m_Pos; }
+
+    private:
+        bool Fail(std::string msg);
+
+        std::string m_File;
+        std::ofstream m_Out;
+        std::uint64_t m_Pos = 0;
+        std::vector<Entry> m_Blobs;
+        std::unordered_map<std::string, std::size_t> m_ByHash;   // hash -> blob
+        std::unordered_map<std::string, std::size_t> m_Names;    // nombre -> blob
+        std::string m_Error;
+    };
+
+    // ---- Lectura (Player) ----
+    static bool Mount(const std::string& file);
+    static void Unmount();
+    static bool Mounted();
+
+    static const Entry* Find(const std::string& name);
+    static const Entry* At(std::size_t index);
+
+    // Bytes del blob: vista al mapeo si está crudo; si está comprimido se descomprime en
+    // 'scratch' y la vista apunta ahí. La vista vale mientras esté montado (y viva scratch).
+    static bool Read(const Entry& e, std::string& scratch, std::string_view& out);
+    // Copia (descomprimida) del contenido de 'name'
+    static bool ReadCopy(const std::string& name, std::string& out);
+};
@@ -0,0 +1,157 @@
+#include "AssetStore.h"
+#include <nlohmann/json.hpp>
+#include <picosha2.h>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+    std::mutex s_Mx;                                       // Resolve se puede llamar desde workers
+    std::string s_Root = "Assets/Store";
+    std::unordered_map<std::string, std::string> s_Index;  // nombre lógico -> archivo del blob (<hash><ext>)
+    bool s_Loaded = false;
+
+    std::string NormalizeName(std::string name) {
+        std::replace(name.begin(), name.end(), '\\', '/');
+        return name;
+    }
+
+    std::string ExtOf(const std::string& name) {
+        std::string ext = fs::path(name).extension().string();
+        for (auto& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return ext;
+    }
+
+    std::string IndexPath() { return (fs::path(s_Root) / "index.json").string(); }
+
+    // Con s_Mx tomado
+    void EnsureLoaded() {
+        if (s_Loaded) return;
+        s_Loaded = true;
+        s_Index.clear();
+
+        std::ifstream in(IndexPath());
+        if (!in) return;
+        json j = json::parse(in, nullptr, false);
+        if (!j.is_object()) return; // índice roto: se trata como vacío (los blobs siguen en disco)
+        for (auto it = j.begin(); it != j.end(); ++it)
+            if (it.value().is_string()) s_Index[it.key()] = it.value().get<std::string>();
+    }
+
+    bool WriteJsonAtomic(const json& j, const fs::path& out) {
+        std::error_code ec;
+        if (out.has_parent_path()) fs::create_directories(out.parent_path(), ec);
+        const fs::path tmp = out.string() + ".tmp";
+        {
+            std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+            if (!ofs) return false;
+            ofs << j.dump(2);
+            if (!ofs.good()) return false;
+        }
+        fs::rename(tmp, out, ec);
+        if (ec) {
+            fs::remove(out, ec);
+            fs::rename(tmp, out, ec);
+        }
+        return !ec;
+    }
+
+    // Con s_Mx tomado
+    bool SaveIndex() {
+        json j = json::object();
+        for (const auto& [name, blob] : s_Index) j[name] = blob;
+        return WriteJsonAtomic(j, IndexPath());
+    }
+}
+
+void AssetStore::SetRoot(const std::string& root) {
+    std::lock_guard<std::mutex> lk(s_Mx);
+    s_Root = root;
+    s_Loaded = false;
+}
+
+std::string AssetStore::Root() {
+    std::lock_guard<std::mutex> lk(s_Mx);
+    return s_Root;
+}
+
+std::string AssetStore::HashBytes(std::string_view bytes) {
+    return picosha2::hash256_hex_string(bytes.begin(), bytes.end());
+}
+
+std::string AssetStore::BlobPath(const std::string& hash, const std::string& name) {
+    std::lock_guard<std::mutex> lk(s_Mx);
+    return (fs::path(s_Root) / (hash + ExtOf(name))).generic_string();
+}
+
+std::string AssetStore::Put(const std::string& name, std::string_view bytes) {
+    const std::string hash = HashBytes(bytes);
+    const std::string blobPath = BlobPath(hash, name);
+
+    std::error_code ec;
+    if (!fs::exists(blobPath, ec)) {
+        // Se escribe aparte y se renombra: un blob nunca queda a medias con su nombre final
+        fs::create_directories(fs::path(blobPath).parent_path(), ec);
+        const std::string tmp = blobPath + ".tmp";
+        {
+            std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+            if (!ofs) return {};
+            ofs.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            if (!ofs.good()) return {};
+        }
+        fs::rename(tmp, blobPath, ec);
+        if (ec) {
+            fs::remove(tmp, ec);
+            return {};
+        }
+    }
+    // Si ya existía es un duplicado: sólo se agrega el nombre al índice
+
+    return Link(name, hash) ? hash : std::string();
+}
+
+bool AssetStore::Link(const std::string& name, const std::string& hash) {
+    std::lock_guard<std::mutex> lk(s_Mx);
+    EnsureLoaded();
+    const std::string blob = hash + ExtOf(name);
+    std::string& slot = s_Index[NormalizeName(name)];
+    if (slot == blob) return true;
+    slot = blob;
+    return SaveIndex();
+}
+
+std::string AssetStore::Resolve(const std::string& name) {
+    if (name.empty()) return name;
+    std::lock_guard<std::mutex> lk(s_Mx);
+    EnsureLoaded();
+    auto it = s_Index.find(NormalizeName(name));
+    if (it == s_Index.end()) return name;
+    return (fs::path(s_Root) / it->second).generic_string();
+}
+
+std::string AssetStore::HashOf(const std::string& name) {
+    std::lock_guard<std::mutex> lk(s_Mx);
+    EnsureLoaded();
+    auto it = s_Index.find(NormalizeName(name));
+    if (it == s_Index.end()) return {};
+    return fs::path(it->second).stem().string();
+}
+
+bool AssetStore::WriteIndex(const std::vector<std::string>& names, const std::string& outFile) {
+    json j = json::object();
+    {
+        std::lock_guard<std::mutex> lk(s_Mx);
+        EnsureLoaded();
+        for (const auto& n : names) {
+            auto it = s_Index.find(NormalizeName(n));
+            if (it != s_Index.end()) j[it->first] = it->second;
+        }
+    }
+    return WriteJsonAtomic(j, outFile);
+}
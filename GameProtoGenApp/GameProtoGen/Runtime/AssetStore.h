@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Store de assets direccionado por contenido.
+// Los bytes se guardan una sola vez en <root>/<sha256><ext> y <root>/index.json mapea
+// el nombre lógico que usa la escena (Texture2D.path / Script.path, ej:
+// "Assets/Generated/x.png") al blob. Nombres distintos con el mismo contenido comparten
+// el archivo. Lo que no está en el índice (assets puestos a mano) se resuelve a sí mismo.
+// Thread-safe y sin Log (se usa desde hilos de trabajo): los errores vuelven por retorno.
+class AssetStore {
+public:
+    // Carpeta del store (default "Assets/Store"); el índice se vuelve a leer de ahí
+    static void SetRoot(const std::string& root);
+    static std::string Root();
+
+    // Guarda 'bytes' bajo su hash (si no estaba) y registra name -> blob.
+    // Devuelve el hash, o vacío si no se pudo escribir.
+    static std::string Put(const std::string& name, std::string_view bytes);
+
+    // Registra un blob que ya está en disco (ej: descargado directo a BlobPath)
+    static bool Link(const std::string& name, const std::string& hash);
+
+    // Archivo del blob para 'hash', con la extensión del nombre lógico
+    static std::string BlobPath(const std::string& hash, const std::string& name);
+
+    // Archivo real para un nombre lógico (blob si está indexado, si no el mismo nombre)
+    static std::string Resolve(const std::string& name);
+
+    // Hash del contenido si el nombre está indexado; vacío si no
+    static std::string HashOf(const std::string& name);
+
+    static std::string HashBytes(std::string_view bytes);
+
+    // Escribe un índice sólo con 'names' (export: el Player no necesita el resto)
+    static bool WriteIndex(const std::vector<std::string>& names, const std::string& outFile);
+};
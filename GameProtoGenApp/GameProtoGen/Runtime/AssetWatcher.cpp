@@ -0,0 +1,179 @@
+#include "AssetWatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+using WatchClock = std::chrono::steady_clock;
+
+namespace {
+    bool s_Active = false;
+    std::string s_Root;
+    std::vector<std::string> s_Ignore;
+    std::unordered_map<std::string, WatchClock::time_point> s_Burst; // archivo -> último evento
+
+    // "Assets/./Gen/" -> "Assets/Gen": la misma forma que usan los paths de la escena
+    std::string Normalize(const fs::path& p) {
+        std::string s = p.lexically_normal().generic_string();
+        while (s.size() > 1 && s.back() == '/') s.pop_back();
+        return s;
+    }
+
+    bool Ignored(const std::string& dir) {
+        for (const auto& ig : s_Ignore) {
+            if (dir.compare(0, ig.size(), ig) != 0) continue;
+            if (dir.size() == ig.size() || dir[ig.size()] == '/') return true;
+        }
+        return false;
+    }
+
+    void Mark(const std::string& file) {
+        s_Burst[file] = WatchClock::now();
+    }
+
+#ifdef __linux__
+    int s_Fd = -1;
+    std::unordered_map<int, std::string> s_Dirs; // watch -> carpeta
+
+    // reportFiles: carpeta recién creada; lo que se escribió antes de tener el watch
+    // no generó eventos, así que se marca a mano
+    void WatchTree(const std::string& dir, bool reportFiles) {
+        if (Ignored(dir)) return;
+        const int wd = inotify_add_watch(s_Fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (wd < 0) return;
+        s_Dirs[wd] = dir;
+
+        std::error_code ec;
+        for (const auto& ent : fs::directory_iterator(dir, ec)) {
+            std::error_code ecType;
+            const std::string p = Normalize(ent.path());
+            if (ent.is_directory(ecType)) WatchTree(p, reportFiles);
+            else if (reportFiles) Mark(p);
+        }
+    }
+
+    void ReadEvents() {
+        alignas(inotify_event) char buf[8192];
+        for (;;) {
+            const ssize_t n = read(s_Fd, buf, sizeof buf);
+            if (n <= 0) break; // EAGAIN: no hay más
+
+            for (ssize_t off = 0; off < n;) {
+                const auto* ev = reinterpret_cast<const inotify_event*>(buf + off);
+                off += (ssize_t)(sizeof(inotify_event) + ev->len);
+
+                if (ev->mask & IN_IGNORED) { s_Dirs.erase(ev->wd); continue; } // carpeta borrada
+                auto it = s_Dirs.find(ev->wd);
+                if (it == s_Dirs.end() || ev->len == 0) continue;
+
+                const std::string p = it->second + "/" + ev->name;
+                if (ev->mask & IN_ISDIR) {
+                    if (ev->mask & (IN_CREATE | IN_MOVED_TO)) WatchTree(p, true);
+                }
+                // IN_CREATE de un archivo no alcanza: se espera a que lo cierren
+                else if (ev->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                    Mark(p);
+                }
+            }
+        }
+    }
+#else
+    // Sin inotify: se comparan mtimes cada kScanInterval
+    constexpr auto kScanInterval = std::chrono::seconds(1);
+    std::unordered_map<std::string, fs::file_time_type> s_Mtimes;
+    WatchClock::time_point s_NextScan;
+
+    void Scan(bool report) {
+        std::unordered_map<std::string, fs::file_time_type> seen;
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(s_Root, ec);
+             !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            std::error_code ecEntry;
+            const std::string p = Normalize(it->path());
+            if (it->is_directory(ecEntry)) {
+                if (Ignored(p)) it.disable_recursion_pending();
+                continue;
+            }
+            const auto mtime = it->last_write_time(ecEntry);
+            if (ecEntry) continue;
+            auto old = s_Mtimes.find(p);
+            if (report && (old == s_Mtimes.end() || old->second != mtime)) Mark(p);
+            seen.emplace(p, mtime);
+        }
+        s_Mtimes = std::move(seen);
+    }
+#endif
+}
+
+bool AssetWatcher::Start(const std::string& root, const std::vector<std::string>& ignore) {
+    Stop();
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) return false;
+
+    s_Root = Normalize(root);
+    s_Ignore.clear();
+    for (const auto& ig : ignore) s_Ignore.push_back(Normalize(ig));
+
+#ifdef __linux__
+    s_Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (s_Fd < 0) return false;
+    WatchTree(s_Root, false);
+#else
+    Scan(false);
+    s_NextScan = WatchClock::now() + kScanInterval;
+#endif
+    s_Active = true;
+    return true;
+}
+
+void AssetWatcher::Stop() {
+#ifdef __linux__
+    if (s_Fd >= 0) close(s_Fd); // cierra también todos los watches
+    s_Fd = -1;
+    s_Dirs.clear();
+#else
+    s_Mtimes.clear();
+#endif
+    s_Burst.clear();
+    s_Active = false;
+}
+
+bool AssetWatcher::Active() {
+    return s_Active;
+}
+
+std::vector<std::string> AssetWatcher::Poll() {
+    std::vector<std::string> out;
+    if (!s_Active) return out;
+
+    const auto now = WatchClock::now();
+#ifdef __linux__
+    ReadEvents();
+#else
+    if (now >= s_NextScan) {
+        Scan(true);
+        s_NextScan = now + kScanInterval;
+    }
+#endif
+
+    const auto quiet = std::chrono::milliseconds(kDebounceMs);
+    for (auto it = s_Burst.begin(); it != s_Burst.end();) {
+        if (now - it->second >= quiet) {
+            out.push_back(it->first);
+            it = s_Burst.erase(it);
+        }
+        else ++it;
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+bool AssetWatcher::Pending() {
+    return !s_Burst.empty();
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Vigila una carpeta de assets y avisa qué archivos cambiaron en disco.
+// En Linux usa inotify (watches recursivos, no bloqueante); en el resto de las
+// plataformas, un escaneo de mtimes cada ~1 s. Las ráfagas de escrituras sobre un
+// mismo archivo (editores que guardan en varios pasos) se juntan: un archivo sale de
+// Poll() recién cuando lleva kDebounceMs sin eventos.
+// Todo corre en el hilo principal; no hay hilos propios.
+class AssetWatcher {
+public:
+    static constexpr int kDebounceMs = 200;
+
+    // Empieza a vigilar 'root' (ej: "Assets"). Las carpetas en 'ignore' (ej: el
+    // AssetStore, cuyos blobs nunca se reescriben) y sus hijas no se vigilan.
+    static bool Start(const std::string& root, const std::vector<std::string>& ignore = {});
+    static void Stop();
+    static bool Active();
+
+    // Archivos cuya ráfaga terminó, con la ruta como "root/sub/x.png" (mismo formato
+    // que Texture2D.path / Script.path). No bloquea; llamar una vez por frame.
+    static std::vector<std::string> Poll();
+
+    // Hay cambios esperando que termine su ráfaga
+    static bool Pending();
+};
@@ -3,6 +3,7 @@
 #include "ECS/Entity.h"
 #include "Net/ApiClient.h"
 #include "Auth/TokenManager.h"
+#include "Editor/UndoStack.h"
 #include <unordered_set>
 
 // Contexto exclusivo del Editor: auth, APIs, selección, flags de ejecución, etc.
@@ -19,6 +20,7 @@ struct EditorContext {
         Entity selectedBackup{};
     } runtime;
     bool requestSelectTool = false; // pedir pasar a herramienta Select
+    UndoStack history;              // undo/redo de ediciones (viewport, inspector, chat)
 
     static EditorContext& Get() {
         static EditorContext ctx;
@@ -5,8 +5,15 @@
 #include <SFML/Graphics.hpp>
 #include "ECS/SceneSerializer.h"
 #include "Core/Log.h"
+#include "AssetStore.h"
+#include "AssetWatcher.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
 
 std::string s_scenePath = "scene.json";
+static std::shared_ptr<const Scene> s_resetSnapshot;
+static constexpr double kGcBudgetMs = 1.0; // GC de Lua por frame
 
 void GameRunner::SetScenePath(std::string path) { s_scenePath = std::move(path); }
 const std::string& GameRunner::GetScenePath() { return s_scenePath; }
@@ -17,6 +24,8 @@ void GameRunner::Step(Scene& scene, float dt) {
     Systems::ScriptSystem::Update(scene, dt);
     Systems::PhysicsSystem::Update(scene, dt);
     Systems::CollisionSystem::SolveAABB(scene);
+    // Al final: la basura del frame se recolecta en una tajada fija, no donde caiga
+    Systems::ScriptSystem::CollectGarbage(kGcBudgetMs);
 }
 
 void GameRunner::Render(const Scene& scene,
@@ -69,9 +78,9 @@ void GameRunner::ExitPlay(Scene& scene) {
 
     }
 
-    // 4)  cache gráfico: si cambiamos assets durante Play,
-    //    al volver a edición forzás un reload limpio.
-    Renderer2D::ClearTextureCache();
+    // 4)  cache gráfico: si cambiamos assets durante Play, al volver a edición se
+    //    recarga en segundo plano sólo lo que cambió en disco (con watcher ya se hizo).
+    if (!AssetWatcher::Active()) Renderer2D::RevalidateTextures();
 }
 
 bool GameRunner::ReloadFromDisk(Scene& scene) {
@@ -81,8 +90,47 @@ bool GameRunner::ReloadFromDisk(Scene& scene) {
         return false;
     }
     scene = std::move(tmp);
-    Renderer2D::ClearTextureCache();
+    Renderer2D::RevalidateTextures();
     EnterPlay(scene); // rearmar VM/estados para Play
     Log::Info(std::string("[RESET] Reload OK desde: ") + s_scenePath);
     return true;
-}
\ No newline at end of file
+}
+
+void GameRunner::SetResetSnapshot(std::shared_ptr<const Scene> snapshot) {
+    s_resetSnapshot = std::move(snapshot);
+}
+
+bool GameRunner::ResetScene(Scene& scene) {
+    if (!s_resetSnapshot) return ReloadFromDisk(scene);
+
+    // Copia O(#pools): los pools se comparten con el snapshot hasta que se modifiquen
+    scene = *s_resetSnapshot;
+    EnterPlay(scene);
+    Log::Info("[RESET] Reload OK desde snapshot en memoria");
+    return true;
+}
+
+bool GameRunner::WatchAssets(const std::string& root) {
+    if (!AssetWatcher::Start(root, { AssetStore::Root() })) {
+        Log::Info("[HOTRELOAD] Sin watcher para: " + root);
+        return false;
+    }
+    Log::Info("[HOTRELOAD] Vigilando: " + root);
+    return true;
+}
+
+void GameRunner::ApplyAssetChanges(Scene& scene) {
+    for (const std::string& file : AssetWatcher::Poll()) {
+        std::string ext = std::filesystem::path(file).extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+        if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" || ext == ".tga") {
+            Renderer2D::InvalidateTexture(file); // sólo recarga si estaba en uso
+            Log::Info("[HOTRELOAD] Textura: " + file);
+        }
+        else if (ext == ".lua") {
+            const int n = Systems::ScriptSystem::ReloadScript(scene, file);
+            Log::Info("[HOTRELOAD] Script: " + file + " (" + std::to_string(n) + " entidades)");
+        }
+    }
+}
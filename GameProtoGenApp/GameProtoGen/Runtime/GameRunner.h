@@ -1,6 +1,7 @@
 #pragma once
 #include "ECS/Scene.h"
 #include <SFML/Graphics.hpp>
+#include <memory>
 
 class GameRunner {
 public:
@@ -17,4 +18,14 @@ public:
     static void SetScenePath(std::string path);
     static const std::string& GetScenePath();
     static bool ReloadFromDisk(Scene& scene);
+
+    // Snapshot en memoria (copy-on-write) desde el que se reinicia la partida.
+    // Si hay uno, ResetScene lo usa en vez de releer el archivo de escena.
+    static void SetResetSnapshot(std::shared_ptr<const Scene> snapshot);
+    static bool ResetScene(Scene& scene);
+
+    // Hot-reload: vigila 'root' (menos el AssetStore) y, una vez por frame, recarga
+    // sólo la textura o el script que cambió en disco
+    static bool WatchAssets(const std::string& root = "Assets");
+    static void ApplyAssetChanges(Scene& scene);
 };
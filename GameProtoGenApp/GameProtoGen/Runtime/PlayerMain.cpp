@@ -1,9 +1,11 @@
 #include <SFML/Graphics.hpp>
 #include <filesystem>
 #include <iostream>
+#include <memory>
 #include "ECS/Scene.h"
 #include "ECS/SceneSerializer.h"
 #include "Runtime/GameRunner.h"
+#include "Runtime/AssetPack.h"
 #include "Systems/Renderer2D.h"
 
 using std::filesystem::exists;
@@ -27,6 +29,19 @@ static path DetectScenePath(int argc, char** argv) {
     return path("scene.json");
 }
 
+// Juego exportado: game.gppak junto al ejecutable (escena + assets en un solo archivo)
+static path DetectPackPath(char** argv) {
+    path p = path(argv[0]).parent_path() / "game.gppak";
+    if (exists(p)) return p;
+    return path("game.gppak");
+}
+
+static bool LoadSceneFromPack(Scene& scene) {
+    std::string text;
+    if (!AssetPack::ReadCopy("scene.json", text)) return false;
+    return SceneSerializer::LoadFromJson(scene, nlohmann::json::parse(text, nullptr, false));
+}
+
 static sf::Vector2f FindPlayerCenter(const Scene& scene, sf::Vector2f fallback = { 800.f, 450.f }) {
     EntityID playerId = 0;
     if (!scene.playerControllers.empty())
@@ -45,9 +60,19 @@ int main(int argc, char** argv) {
 
     // Carga de escena
     Scene scene;
+    bool fromPack = false;
+    if (argc <= 1) { // con una escena por argv se usa esa (y los assets sueltos)
+        const path packPath = DetectPackPath(argv);
+        if (exists(packPath) && AssetPack::Mount(packPath.string())) {
+            fromPack = LoadSceneFromPack(scene);
+            if (fromPack) GameRunner::SetResetSnapshot(std::make_shared<const Scene>(scene)); // gameReset sin disco
+            else std::cerr << "[PLAYER] " << packPath << " no tiene un scene.json válido\n";
+        }
+    }
+
     const path scenePath = DetectScenePath(argc, argv);
     GameRunner::SetScenePath(scenePath.string());
-    if (!exists(scenePath) || !SceneSerializer::Load(scene, scenePath.string())) {
+    if (!fromPack && (!exists(scenePath) || !SceneSerializer::Load(scene, scenePath.string()))) {
         std::cerr << "[PLAYER] No se pudo cargar la escena desde: " << scenePath << "\n";
         // Semilla mínima
         auto e = scene.CreateEntity();
@@ -63,6 +88,7 @@ int main(int argc, char** argv) {
 
     // Preparar play-state
     GameRunner::EnterPlay(scene);
+    if (!AssetPack::Mounted()) GameRunner::WatchAssets("Assets"); // el .gppak no cambia
 
     sf::Clock clock;
     sf::Vector2f cameraCenter = FindPlayerCenter(scene);
@@ -78,6 +104,7 @@ int main(int argc, char** argv) {
 
         float dt = clock.restart().asSeconds();
 
+        GameRunner::ApplyAssetChanges(scene);
         GameRunner::Step(scene, dt);
 
         sf::Vector2f target = FindPlayerCenter(scene, cameraCenter);
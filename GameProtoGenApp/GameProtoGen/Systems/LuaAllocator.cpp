@@ -0,0 +1,99 @@
+#include "LuaAllocator.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+LuaAllocator::~LuaAllocator() {
+    for (void* p : m_Pages) std::free(p);
+}
+
+void* LuaAllocator::Alloc(void* ud, void* ptr, std::size_t osize, std::size_t nsize) {
+    auto& self = *static_cast<LuaAllocator*>(ud);
+    if (!ptr) osize = 0; // con ptr nulo, osize es el tipo de objeto, no un tamaño
+
+    const std::size_t cap = self.m_Limit - std::min(self.m_Reserve, self.m_Limit);
+    if (nsize > osize && self.m_Limit && self.m_Enforce && self.m_Used - osize + nsize > cap) {
+        ++self.m_Failures;
+        return nullptr;
+    }
+
+    void* out = self.Realloc(ptr, osize, nsize);
+    if (nsize && !out) return nullptr; // malloc/página sin memoria: Lua lo trata como el límite
+
+    self.m_Used = self.m_Used - osize + nsize;
+    self.m_Peak = std::max(self.m_Peak, self.m_Used);
+    return out;
+}
+
+void* LuaAllocator::Realloc(void* ptr, std::size_t osize, std::size_t nsize) {
+    // Dónde vive el bloque lo dice osize, salvo que haya bloques de malloc con tamaño de
+    // clase chica (un achique que no consiguió página): ahí se mira si cae en una página
+    const bool sizedSmall = ptr && osize <= kMaxSmall;
+    const bool oldSmall = sizedSmall && (m_Foreign == 0 || InPages(ptr));
+    const bool oldForeign = sizedSmall && !oldSmall;
+    const bool newSmall = nsize <= kMaxSmall;
+    auto freeOld = [&] {
+        if (oldSmall) { FreeSmall(ptr, ClassOf(osize)); return; }
+        std::free(ptr);
+        if (oldForeign) --m_Foreign;
+    };
+
+    if (nsize == 0) { freeOld(); return nullptr; }
+    if (!ptr) return newSmall ? AllocSmall(ClassOf(nsize)) : std::malloc(nsize);
+
+    if (oldSmall && newSmall && ClassOf(osize) == ClassOf(nsize)) return ptr;
+    if (!oldSmall && !newSmall) {
+        void* out = std::realloc(ptr, nsize);
+        if (out && oldForeign) --m_Foreign;
+        return out;
+    }
+
+    void* out = newSmall ? AllocSmall(ClassOf(nsize)) : std::malloc(nsize);
+    if (!out) {
+        // Achicar no puede fallar. Un bloque chico se queda en su lugar (su clase alcanza
+        // de sobra); uno de malloc sigue en malloc y se cuenta como ajeno a las páginas
+        if (nsize >= osize) return nullptr;
+        if (oldSmall) return ptr;
+        if (!oldForeign) ++m_Foreign;
+        void* shrunk = std::realloc(ptr, nsize);
+        return shrunk ? shrunk : ptr;
+    }
+    std::memcpy(out, ptr, std::min(osize, nsize));
+    freeOld();
+    return out;
+}
+
+bool LuaAllocator::InPages(const void* p) const {
+    const std::less<const void*> less;
+    auto it = std::upper_bound(m_Pages.begin(), m_Pages.end(), p, less);
+    if (it == m_Pages.begin()) return false;
+    const char* page = static_cast<const char*>(*std::prev(it));
+    return less(p, page + kPageSize);
+}
+
+void* LuaAllocator::AllocSmall(std::size_t cls) {
+    if (FreeBlock* b = m_Free[cls]) {
+        m_Free[cls] = b->next;
+        return b;
+    }
+    const std::size_t size = (cls + 1) * kGranule;
+    if (static_cast<std::size_t>(m_BumpEnd - m_Bump) < size) {
+        // El resto de la página vieja (< size) se pierde: menos de kMaxSmall por página
+        void* page = std::malloc(kPageSize);
+        if (!page) return nullptr;
+        // Ordenadas por dirección para InPages (se agregan pocas veces)
+        m_Pages.insert(std::upper_bound(m_Pages.begin(), m_Pages.end(), page, std::less<const void*>{}), page);
+        m_Bump = static_cast<char*>(page);
+        m_BumpEnd = m_Bump + kPageSize;
+    }
+    void* p = m_Bump;
+    m_Bump += size;
+    return p;
+}
+
+void LuaAllocator::FreeSmall(void* p, std::size_t cls) {
+    auto* b = static_cast<FreeBlock*>(p);
+    b->next = m_Free[cls];
+    m_Free[cls] = b;
+}
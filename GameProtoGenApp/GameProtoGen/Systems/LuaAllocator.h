@@ -0,0 +1,76 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// Allocator de un lua_State (lua_newstate / sol::state(panic, &Alloc, this)).
+//
+// Lua pide muchísimos bloques chicos (tablas, closures, strings cortos) y al liberar
+// o redimensionar siempre dice el tamaño viejo, así que no hace falta header por bloque:
+//  - hasta kMaxSmall bytes: clases de kGranule bytes, tomadas de páginas de kPageSize
+//    (bump pointer) y recicladas en una free list por clase. Las páginas se devuelven
+//    recién al destruir el allocator.
+//  - más grandes: malloc/realloc.
+//
+// Lleva la cuenta de lo que el VM tiene pedido y puede tener un límite duro: pasado el
+// límite, los pedidos que crecen fallan (Lua hace una colección de emergencia y, si no
+// alcanza, tira "not enough memory" en el script, que se atrapa como cualquier error).
+// Achicar nunca falla (Lua lo asume).
+//
+// El límite sólo se aplica con Enforce(true), que el VM prende mientras corre código de
+// un script (dentro de un pcall/resume). Fuera de eso pide el host (sol2 armando
+// tablas, lua_newthread, luaL_ref...) sin protección: ahí un error de memoria sería un
+// panic, así que nunca se rechaza. Para que el host tenga lugar, los scripts topan en
+// Limit() - Reserve().
+//
+// Un allocator por VM; no es thread-safe (el VM tampoco).
+class LuaAllocator {
+public:
+    static constexpr std::size_t kGranule = 16;   // alineación de todos los bloques
+    static constexpr std::size_t kMaxSmall = 256;
+    static constexpr std::size_t kPageSize = 64 * 1024;
+
+    LuaAllocator() = default;
+    ~LuaAllocator();
+    LuaAllocator(const LuaAllocator&) = delete;
+    LuaAllocator& operator=(const LuaAllocator&) = delete;
+
+    // Firma de lua_Alloc; ud es el LuaAllocator
+    static void* Alloc(void* ud, void* ptr, std::size_t osize, std::size_t nsize);
+
+    // 0 = sin límite
+    void SetLimit(std::size_t bytes) { m_Limit = bytes; }
+    std::size_t Limit() const { return m_Limit; }
+    void SetReserve(std::size_t bytes) { m_Reserve = bytes; }
+    std::size_t Reserve() const { return m_Reserve; }
+    void Enforce(bool on) { m_Enforce = on; }
+    bool Enforcing() const { return m_Enforce; }
+
+    std::size_t Used() const { return m_Used; }         // bytes pedidos por Lua ahora
+    std::size_t Peak() const { return m_Peak; }
+    std::size_t Reserved() const { return m_Pages.size() * kPageSize; } // páginas del pool
+    std::size_t Failures() const { return m_Failures; } // pedidos rechazados por el límite
+
+private:
+    static constexpr std::size_t kClasses = kMaxSmall / kGranule;
+    static std::size_t ClassOf(std::size_t n) { return (n + kGranule - 1) / kGranule - 1; }
+
+    void* Realloc(void* ptr, std::size_t osize, std::size_t nsize);
+    bool InPages(const void* p) const;
+    void* AllocSmall(std::size_t cls);
+    void FreeSmall(void* p, std::size_t cls);
+
+    struct FreeBlock { FreeBlock* next; };
+    std::array<FreeBlock*, kClasses> m_Free{};
+    std::vector<void*> m_Pages; // ordenadas por dirección
+    std::size_t m_Foreign = 0;  // bloques de malloc con tamaño de clase chica
+    char* m_Bump = nullptr;
+    char* m_BumpEnd = nullptr;
+
+    std::size_t m_Limit = 0;
+    std::size_t m_Reserve = 0;
+    bool m_Enforce = true;
+    std::size_t m_Used = 0;
+    std::size_t m_Peak = 0;
+    std::size_t m_Failures = 0;
+};
@@ -30,15 +30,17 @@ namespace Systems {
     // --- PlayerController: WASD / ←→ + Space ---
     void PlayerControllerSystem::Update(Scene& scene, float dt) {
         (void)dt;
+        const Scene& cscene = scene; // lecturas sin separar pools copy-on-write
 
         // Tomamos el primer entity que tenga PlayerController
         EntityID playerId = 0;
-        for (auto& [id, pc] : scene.playerControllers) {
+        for (auto& [id, pc] : cscene.playerControllers) {
             (void)pc;
             playerId = id;
             break;
         }
         if (!playerId) return;
+        const PlayerController& pc = cscene.playerControllers.at(playerId);
 
         auto itT = scene.transforms.find(playerId);
         auto itP = scene.physics.find(playerId);
@@ -54,12 +56,12 @@ namespace Systems {
         if (sf::Keyboard::isKeyPressed(Key::A) || sf::Keyboard::isKeyPressed(Key::Left))  dir -= 1.f;
         if (sf::Keyboard::isKeyPressed(Key::D) || sf::Keyboard::isKeyPressed(Key::Right)) dir += 1.f;
 
-        float moveSpeed = scene.playerControllers[playerId].moveSpeed;
+        float moveSpeed = pc.moveSpeed;
         t.position.x += dir * moveSpeed * dt;
 
         // Salto (solo si está en el suelo)
         if (sf::Keyboard::isKeyPressed(Key::Space) && ph.onGround) {
-            ph.velocity.y = -scene.playerControllers[playerId].jumpSpeed; // y- hacia arriba
+            ph.velocity.y = -pc.jumpSpeed; // y- hacia arriba
             ph.onGround = false;
         }
     }
@@ -103,18 +105,19 @@ namespace Systems {
 
     // --- Suelo plano en y = groundY ---
     void CollisionSystem::SolveGround(Scene& scene, float groundY) {
+        const Scene& cscene = scene;
         for (auto& [id, ph] : scene.physics) {
             if (!scene.transforms.contains(id) || !scene.colliders.contains(id)) continue;
 
             auto& t = scene.transforms[id];
-            auto& c = scene.colliders[id];
+            const auto& c = cscene.colliders.at(id);
 
             // Escala absoluta (por si hay flips)
             const sf::Vector2f scaleAbs{ std::abs(t.scale.x), std::abs(t.scale.y) };
 
             // Altura efectiva del AABB (prioriza Sprite.size; sino usa Collider.halfExtents)
             float halfY = c.halfExtents.y * scaleAbs.y;
-            if (auto itS = scene.sprites.find(id); itS != scene.sprites.end()) {
+            if (auto itS = cscene.sprites.find(id); itS != cscene.sprites.end()) {
                 halfY = (itS->second.size.y * scaleAbs.y) * 0.5f;
             }
 
@@ -139,18 +142,22 @@ namespace Systems {
         s_currOverlaps.clear();
         s_pendingTriggerEnter.clear(); // vaciar buffer por frame
 
+        // Colliders, sprites y transforms de B sólo se leen: vía const para no
+        // duplicar pools compartidos con el snapshot de Play.
+        const Scene& cscene = scene;
+
         for (auto& [idA, phA] : scene.physics) {
             if (!scene.transforms.contains(idA) || !scene.colliders.contains(idA)) continue;
 
             auto& tA = scene.transforms[idA];
-            auto& cA = scene.colliders[idA];
+            const auto& cA = cscene.colliders.at(idA);
 
-            for (auto& [idB, cB] : scene.colliders) {
+            for (auto& [idB, cB] : cscene.colliders) {
                 if (idA == idB) continue;
                 if (scene.physics.contains(idB)) continue;      // B debe ser estático
                 if (!scene.transforms.contains(idB)) continue;
 
-                auto& tB = scene.transforms[idB];
+                const auto& tB = cscene.transforms.at(idB);
 
                 // ----- A: centro y halfExtents efectivos -----
                 const sf::Vector2f scaleA{ std::abs(tA.scale.x), std::abs(tA.scale.y) };
@@ -158,7 +165,7 @@ namespace Systems {
                     cA.halfExtents.x * scaleA.x,
                     cA.halfExtents.y * scaleA.y
                 };
-                if (auto itSA = scene.sprites.find(idA); itSA != scene.sprites.end()) {
+                if (auto itSA = cscene.sprites.find(idA); itSA != cscene.sprites.end()) {
                     heA.x = (itSA->second.size.x * scaleA.x) * 0.5f;
                     heA.y = (itSA->second.size.y * scaleA.y) * 0.5f;
                 }
@@ -172,7 +179,7 @@ namespace Systems {
                     cBref.halfExtents.x * scaleB.x,
                     cBref.halfExtents.y * scaleB.y
                 };
-                if (auto itSB = scene.sprites.find(idB); itSB != scene.sprites.end()) {
+                if (auto itSB = cscene.sprites.find(idB); itSB != cscene.sprites.end()) {
                     heB.x = (itSB->second.size.x * scaleB.x) * 0.5f;
                     heB.y = (itSB->second.size.y * scaleB.y) * 0.5f;
                 }
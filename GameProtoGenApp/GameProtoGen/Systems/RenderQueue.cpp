@@ -0,0 +1,246 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    std::uint64_t CellOf(const sf::Vector2f& p) {
+        const auto cx = (std::int32_t)std::floor(p.x / RenderQueue::kChunkSize);
+        const auto cy = (std::int32_t)std::floor(p.y / RenderQueue::kChunkSize);
+        return ((std::uint64_t)(std::uint32_t)cx << 32) | (std::uint32_t)cy;
+    }
+}
+
+bool RenderQueue::IsStaticGeometry(const Scene& scene, EntityID id) {
+    return scene.colliders.contains(id) && !scene.physics.contains(id) && !scene.scripts.contains(id);
+}
+
+void RenderQueue::Clear() {
+    m_Scene = nullptr;
+    m_State.clear();
+    m_Dynamic.clear();
+    m_Static.clear();
+    m_Runs.clear();
+    ++m_ChunkSetRev;
+    m_DynRemoved.clear();
+    m_DynAdded.clear();
+    m_StaticAdded.clear();
+    m_Order.clear();
+    m_NextOrder = 1;
+    m_OrderRev = ~0ull;
+    // m_NextVersion no se reinicia: una versión nunca se repite entre chunks
+}
+
+void RenderQueue::Rebuild(const Scene& scene) {
+    Clear();
+    m_Scene = &scene;
+    m_TfCursor = scene.transforms.Head();
+    m_SpCursor = scene.sprites.Head();
+    m_TxCursor = scene.textures.Head();
+    m_RlCursor = scene.renderLayers.Head();
+    m_ColCursor = scene.colliders.Head();
+    m_PhCursor = scene.physics.Head();
+    m_ScrCursor = scene.scripts.Head();
+    m_ColKeys = scene.colliders.KeysRevision();
+    m_PhKeys = scene.physics.KeysRevision();
+    m_ScrKeys = scene.scripts.KeysRevision();
+
+    std::vector<EntityID> ignored;
+    SyncOrder(scene, ignored);
+    m_State.reserve(scene.sprites.size());
+    for (const auto& e : scene.Entities()) Refresh(scene, e.id);
+    ApplyDynamicChanges();
+}
+
+void RenderQueue::Sync(const Scene& scene) {
+    if (m_Scene != &scene) { Rebuild(scene); return; }
+
+    std::vector<EntityID> dirty;
+    SyncOrder(scene, dirty);
+
+    auto collect = [&](EntityID id) { dirty.push_back(id); };
+    bool ok = scene.transforms.ForEachChangeSince(m_TfCursor, collect);
+    ok = scene.sprites.ForEachChangeSince(m_SpCursor, collect) && ok;
+    ok = scene.textures.ForEachChangeSince(m_TxCursor, collect) && ok;
+    ok = scene.renderLayers.ForEachChangeSince(m_RlCursor, collect) && ok;
+
+    // Physics/scripts se iteran en modo mutable cada frame de Play ("todo cambió"),
+    // pero eso no cambia quién los tiene: sólo se miran si cambiaron las claves.
+    auto membership = [&](const auto& pool, auto& cursor, std::uint64_t& keys) {
+        if (cursor.pool == pool.Head().pool && keys == pool.KeysRevision()) { cursor = pool.Head(); return true; }
+        keys = pool.KeysRevision();
+        return pool.ForEachChangeSince(cursor, collect);
+    };
+    ok = membership(scene.colliders, m_ColCursor, m_ColKeys) && ok;
+    ok = membership(scene.physics, m_PhCursor, m_PhKeys) && ok;
+    ok = membership(scene.scripts, m_ScrCursor, m_ScrKeys) && ok;
+    if (!ok) { Rebuild(scene); return; }
+
+    if (dirty.empty()) return;
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+    for (EntityID id : dirty) Refresh(scene, id);
+    ApplyDynamicChanges();
+}
+
+// Scene sólo agrega entidades al final y borrar no altera el orden relativo: alcanza
+// con numerar lo que aparece fuera de secuencia (nuevas o revividas) a continuación.
+void RenderQueue::SyncOrder(const Scene& scene, std::vector<EntityID>& dirty) {
+    if (m_OrderRev == scene.EntitiesRevision()) return;
+    m_OrderRev = scene.EntitiesRevision();
+
+    const auto& entities = scene.Entities();
+    std::uint64_t last = 0;
+    for (const auto& e : entities) {
+        auto [it, inserted] = m_Order.try_emplace(e.id, 0);
+        if (inserted || it->second <= last) {
+            it->second = m_NextOrder++;
+            dirty.push_back(e.id);
+        }
+        last = it->second;
+    }
+
+    // Purgar ids borrados de vez en cuando (los valores vivos no cambian)
+    if (m_Order.size() > 2 * entities.size() + 64) {
+        std::unordered_map<EntityID, std::uint64_t> live;
+        live.reserve(entities.size());
+        for (const auto& e : entities) live.emplace(e.id, m_Order.at(e.id));
+        m_Order = std::move(live);
+    }
+}
+
+void RenderQueue::Refresh(const Scene& scene, EntityID id) {
+    auto it = m_State.find(id);
+    auto itT = scene.transforms.find(id);
+    if (itT == scene.transforms.end() || !scene.sprites.contains(id)) {
+        if (it != m_State.end()) { Unlink(id, it->second); m_State.erase(it); }
+        return;
+    }
+
+    State st;
+    auto o = m_Order.find(id);
+    st.key = DrawKeyOf(scene, id, o != m_Order.end() ? o->second : 0);
+    st.isStatic = IsStaticGeometry(scene, id);
+    if (st.isStatic) st.cell = CellOf(itT->second.position);
+
+    if (it != m_State.end()) {
+        State& old = it->second;
+        if (old.key == st.key && old.isStatic == st.isStatic && old.cell == st.cell) {
+            // Misma posición en la lista: a una dinámica no hay nada que hacerle
+            // (se dibuja en vivo); un chunk estático tiene que rehornearse.
+            if (old.isStatic && old.linked) ChunkAt(old.run, old.cell).version = m_NextVersion++;
+            return;
+        }
+        Unlink(id, old);
+        old = st;
+        Link(id, old);
+    }
+    else {
+        Link(id, m_State.emplace(id, st).first->second);
+    }
+}
+
+RenderQueue::Chunk& RenderQueue::ChunkAt(const RunKey& run, std::uint64_t cell) {
+    auto& cells = m_Runs[run];
+    auto [it, inserted] = cells.try_emplace(cell);
+    if (inserted) ++m_ChunkSetRev;
+    return it->second;
+}
+
+// La corrida depende de la lista dinámica ya actualizada: las estáticas nuevas se
+// enlazan al final de ApplyDynamicChanges.
+void RenderQueue::Link(EntityID id, const State& st) {
+    if (!st.isStatic) { m_DynAdded.push_back({ st.key, id }); return; }
+    m_Static.emplace(st.key, id);
+    m_StaticAdded.push_back(id);
+}
+
+void RenderQueue::Unlink(EntityID id, State& st) {
+    if (!st.isStatic) { m_DynRemoved.insert(id); return; }
+    m_Static.erase(st.key);
+    if (st.linked) Detach(id, st);
+}
+
+// Última dinámica de la misma capa con clave menor: las estáticas se dibujan justo
+// después, agrupadas por z
+RenderQueue::RunKey RenderQueue::RunFor(const Key& key) const {
+    RunKey run;
+    run.layer = key.layer;
+    run.z = key.z;
+    auto it = std::lower_bound(m_Dynamic.begin(), m_Dynamic.end(), Item{ key, 0 });
+    if (it != m_Dynamic.begin() && std::prev(it)->key.layer == key.layer) {
+        run.hasAnchor = true;
+        run.anchor = std::prev(it)->key;
+    }
+    return run;
+}
+
+void RenderQueue::Attach(EntityID id, State& st, const RunKey& run) {
+    Chunk& ch = ChunkAt(run, st.cell);
+    const Item item{ st.key, id };
+    ch.members.insert(std::upper_bound(ch.members.begin(), ch.members.end(), item), item);
+    ch.version = m_NextVersion++;
+    st.linked = true;
+    st.run = run;
+}
+
+void RenderQueue::Detach(EntityID id, State& st) {
+    st.linked = false;
+    auto runIt = m_Runs.find(st.run);
+    if (runIt == m_Runs.end()) return;
+    auto chIt = runIt->second.find(st.cell);
+    if (chIt == runIt->second.end()) return;
+
+    auto& members = chIt->second.members;
+    auto pos = std::find_if(members.begin(), members.end(), [id](const Item& i) { return i.id == id; });
+    if (pos == members.end()) return;
+    members.erase(pos);
+    chIt->second.version = m_NextVersion++;
+    if (members.empty()) {
+        runIt->second.erase(chIt);
+        if (runIt->second.empty()) m_Runs.erase(runIt);
+        ++m_ChunkSetRev;
+    }
+}
+
+// Sólo se ordenan los cambiados; después un merge lineal con la lista ya ordenada.
+// Cada dinámica que entra o sale cambia la corrida de las estáticas que la siguen
+// (hasta la dinámica siguiente de la capa): sólo esas se reubican.
+void RenderQueue::ApplyDynamicChanges() {
+    std::vector<Key> changed;
+    if (!m_DynRemoved.empty()) {
+        std::erase_if(m_Dynamic, [&](const Item& i) {
+            if (m_DynRemoved.count(i.id) == 0) return false;
+            changed.push_back(i.key);
+            return true;
+        });
+        m_DynRemoved.clear();
+    }
+    if (!m_DynAdded.empty()) {
+        std::sort(m_DynAdded.begin(), m_DynAdded.end());
+        for (const auto& item : m_DynAdded) changed.push_back(item.key);
+        const std::size_t mid = m_Dynamic.size();
+        m_Dynamic.insert(m_Dynamic.end(), m_DynAdded.begin(), m_DynAdded.end());
+        std::inplace_merge(m_Dynamic.begin(), m_Dynamic.begin() + (std::ptrdiff_t)mid, m_Dynamic.end());
+        m_DynAdded.clear();
+    }
+
+    for (const Key& k : changed) {
+        auto nextDyn = std::upper_bound(m_Dynamic.begin(), m_Dynamic.end(), Item{ k, 0 });
+        for (auto it = m_Static.upper_bound(k); it != m_Static.end() && it->first.layer == k.layer; ++it) {
+            if (nextDyn != m_Dynamic.end() && nextDyn->key < it->first) break;
+            State& st = m_State.at(it->second);
+            if (!st.linked) continue; // nueva: se enlaza abajo
+            const RunKey run = RunFor(it->first);
+            if (run == st.run) continue;
+            Detach(it->second, st);
+            Attach(it->second, st, run);
+        }
+    }
+
+    for (EntityID id : m_StaticAdded) {
+        auto it = m_State.find(id);
+        if (it == m_State.end() || !it->second.isStatic || it->second.linked) continue;
+        Attach(id, it->second, RunFor(it->second.key));
+    }
+    m_StaticAdded.clear();
+}
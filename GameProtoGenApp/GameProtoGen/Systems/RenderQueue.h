@@ -0,0 +1,135 @@
+#pragma once
+#include <compare>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "ECS/DrawKey.h"
+#include "ECS/Scene.h"
+
+// Lista de dibujo persistente, ordenada por (capa, z, textura, orden de creación).
+// Se mantiene incrementalmente como SpatialIndex: Sync() lee el registro de cambios
+// de los pools y sólo recalcula la clave de las entidades tocadas; las que cambian de
+// clave se sacan y se vuelven a mezclar (merge) en la lista ya ordenada. Sin cambios,
+// Sync() no ordena nada.
+//
+// Geometría estática (Collider sin Physics2D ni Script) no entra en la lista: va a
+// chunks de kChunkSize que Renderer2D hornea; cada chunk tiene una versión que cambia
+// cuando cambia algo de lo que contiene. Los chunks se agrupan en corridas: estáticas
+// de la misma capa y z que caen entre las mismas dos entidades dinámicas en el orden
+// de claves. ForEachInDrawOrder() intercala las corridas en la lista dinámica, así el
+// horneado no altera el orden entre estáticas y dinámicas (un fondo creado antes que
+// el suelo sigue debajo). Dentro de una corrida, las celdas van en orden ascendente.
+//
+// La clave es DrawKey: la textura sólo cuenta para entidades con RenderLayer (a igual
+// z se agrupan por textura); sin RenderLayer se conserva el orden de Scene::Entities().
+class RenderQueue {
+public:
+    static constexpr float kChunkSize = 512.f;
+
+    using Key = DrawKey;
+
+    struct Item {
+        Key key;
+        EntityID id = 0;
+        bool operator<(const Item& o) const { return key < o.key; }
+    };
+
+    struct Chunk {
+        std::vector<Item> members;  // ordenados por clave
+        std::uint64_t version = 0;  // cambia con cualquier cambio de contenido
+    };
+
+    using ChunkMap = std::map<std::uint64_t, Chunk>; // celda -> chunk, en orden
+
+    // Estáticas de 'layer' y 'z' posteriores a la dinámica 'anchor' de la misma capa
+    // (o anteriores a todas, si !hasAnchor) y anteriores a la dinámica siguiente.
+    struct RunKey {
+        std::int32_t layer = 0;
+        bool hasAnchor = false;
+        Key anchor;
+        float z = 0.f;
+        auto operator<=>(const RunKey&) const = default;
+    };
+
+    void Sync(const Scene& scene);
+    void Rebuild(const Scene& scene);
+    void Clear();
+
+    // Entidades dinámicas dibujables, en orden de dibujo
+    const std::vector<Item>& Dynamic() const { return m_Dynamic; }
+    // Chunks estáticos por corrida, en orden de dibujo
+    const std::map<RunKey, ChunkMap>& StaticRuns() const { return m_Runs; }
+    // Cambia cuando se crean o eliminan chunks
+    std::uint64_t ChunkSetRevision() const { return m_ChunkSetRev; }
+
+    // Recorre todo en orden de dibujo: onDynamic(const Item&) por entidad dinámica,
+    // onChunk(const Chunk&) por chunk estático.
+    template <class OnDynamic, class OnChunk>
+    void ForEachInDrawOrder(OnDynamic&& onDynamic, OnChunk&& onChunk) const {
+        std::size_t next = 0;
+        for (const auto& [run, cells] : m_Runs) {
+            for (; next < m_Dynamic.size(); ++next) {
+                const Key& k = m_Dynamic[next].key;
+                if (k.layer > run.layer || (k.layer == run.layer && (!run.hasAnchor || run.anchor < k))) break;
+                onDynamic(m_Dynamic[next]);
+            }
+            for (const auto& [cell, ch] : cells) onChunk(ch);
+        }
+        for (; next < m_Dynamic.size(); ++next) onDynamic(m_Dynamic[next]);
+    }
+
+    static bool IsStaticGeometry(const Scene& scene, EntityID id);
+
+private:
+    struct State {
+        Key key;
+        bool isStatic = false;
+        // Sólo estáticas: celda y corrida donde está enlazada (linked = false mientras
+        // espera que ApplyDynamicChanges le asigne corrida)
+        std::uint64_t cell = 0;
+        bool linked = false;
+        RunKey run;
+    };
+
+    const Scene* m_Scene = nullptr;
+    std::unordered_map<EntityID, State> m_State; // dibujables
+    std::vector<Item> m_Dynamic;
+    std::map<Key, EntityID> m_Static; // todas las estáticas, por clave
+    std::map<RunKey, ChunkMap> m_Runs;
+    std::uint64_t m_ChunkSetRev = 0;
+    std::uint64_t m_NextVersion = 1;
+
+    // Cambios pendientes de la lista dinámica en este Sync
+    std::unordered_set<EntityID> m_DynRemoved;
+    std::vector<Item> m_DynAdded;
+    std::vector<EntityID> m_StaticAdded;
+
+    // Orden de creación: valores crecientes que no se renumeran al borrar entidades,
+    // así las claves ya guardadas siguen siendo comparables con las nuevas.
+    std::unordered_map<EntityID, std::uint64_t> m_Order;
+    std::uint64_t m_NextOrder = 1;
+    std::uint64_t m_OrderRev = ~0ull;
+
+    // Valores: cambian la clave o lo horneado
+    ComponentPool<Transform>::Cursor m_TfCursor;
+    ComponentPool<Sprite>::Cursor m_SpCursor;
+    ComponentPool<Texture2D>::Cursor m_TxCursor;
+    ComponentPool<RenderLayer>::Cursor m_RlCursor;
+    // Pertenencia: de collider/physics/script sólo importa quién lo tiene
+    ComponentPool<Collider>::Cursor m_ColCursor;
+    ComponentPool<Physics2D>::Cursor m_PhCursor;
+    ComponentPool<Script>::Cursor m_ScrCursor;
+    std::uint64_t m_ColKeys = 0, m_PhKeys = 0, m_ScrKeys = 0;
+
+    void SyncOrder(const Scene& scene, std::vector<EntityID>& dirty);
+    void Refresh(const Scene& scene, EntityID id);
+    void Unlink(EntityID id, State& st);
+    void Link(EntityID id, const State& st);
+    void ApplyDynamicChanges();
+    RunKey RunFor(const Key& key) const;
+    void Attach(EntityID id, State& st, const RunKey& run);
+    void Detach(EntityID id, State& st);
+    Chunk& ChunkAt(const RunKey& run, std::uint64_t cell);
+};
@@ -1,77 +1,213 @@
 #include "Renderer2D.h"
 #include "ECS/Scene.h"
 #include "ECS/Components.h"
+#include "RenderQueue.h"
+#include "TextureCache.h"
+#include <algorithm>
+#include <cmath>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 
-static std::unordered_map<std::string, std::shared_ptr<sf::Texture>> s_TexCache;
+// Color plano mientras la textura se decodifica/sube (ver TextureCache)
+static const sf::Color kPlaceholder(110, 110, 120);
 
-static std::shared_ptr<sf::Texture> GetTexture(const std::string& path) {
-    if (path.empty()) return nullptr;
-    if (auto it = s_TexCache.find(path); it != s_TexCache.end()) return it->second;
-    auto tex = std::make_shared<sf::Texture>();
-    if (tex->loadFromFile(path)) {
-        tex->setSmooth(true);
-        s_TexCache[path] = tex;
-        return tex;
-    }
-    return nullptr;
+// 1x1 de kPlaceholder: los tramos horneados se dibujan con él hasta que la textura está
+static const sf::Texture& PlaceholderTexture() {
+    static sf::Texture s_Tex = [] {
+        sf::Image img;
+        img.resize({ 1u, 1u }, kPlaceholder);
+        sf::Texture t;
+        (void)t.loadFromImage(img);
+        return t;
+    }();
+    return s_Tex;
 }
 
 void Renderer2D::ClearTextureCache() {
-    s_TexCache.clear();
+    TextureCache::Clear();
+}
+
+void Renderer2D::RevalidateTextures() {
+    TextureCache::Revalidate();
+}
+
+bool Renderer2D::PumpTextureUploads() {
+    return TextureCache::PumpUploads();
+}
+
+bool Renderer2D::TexturesPending() {
+    return TextureCache::Pending();
+}
+
+void Renderer2D::SetTextureBudget(std::size_t vramBytes, float uploadMsPerFrame) {
+    TextureCache::SetBudget(vramBytes, uploadMsPerFrame);
+}
+
+// ---------------- Capa estática por chunks ----------------
+// RenderQueue mantiene el orden de dibujo y agrupa la geometría de nivel (Collider sin
+// Physics2D ni Script) en chunks por capa. Acá cada chunk se hornea en vertex arrays
+// (un tramo por textura consecutiva, en orden de dibujo) y se dibuja con un draw por
+// tramo. Las UV van normalizadas: que la textura cargue, se recargue o se desaloje no
+// obliga a rehornear; sólo cambia qué se bindea al dibujar.
+namespace {
+    struct StaticBatch {
+        std::string texPath; // vacío = rectángulos de color
+        sf::VertexArray verts{ sf::PrimitiveType::Triangles };
+    };
+
+    struct BakedChunk {
+        std::uint64_t version = 0;
+        std::vector<StaticBatch> batches;
+        sf::FloatRect bounds;
+    };
+}
+
+static RenderQueue s_Queue;
+// Los nodos de un unordered_map no se mueven: el puntero al chunk sirve de clave
+// (si se reusa la dirección, la versión ya no coincide)
+static std::unordered_map<const RenderQueue::Chunk*, BakedChunk> s_Baked;
+static std::uint64_t s_BakedFailRev = ~0ull, s_BakedChunkSetRev = ~0ull;
+
+static void AppendQuad(sf::VertexArray& va, const Transform& tr, const Sprite& sp,
+                       sf::Color color, sf::FloatRect& bounds, bool& first) {
+    // Igual que sf::Sprite/RectangleShape: origen al centro, escala, rotación, posición
+    const sf::Vector2f he{ sp.size.x * tr.scale.x * 0.5f, sp.size.y * tr.scale.y * 0.5f };
+    const float rad = tr.rotationDeg * 3.14159265f / 180.f;
+    const float c = std::cos(rad), s = std::sin(rad);
+    auto world = [&](float lx, float ly) {
+        return sf::Vector2f{ tr.position.x + lx * c - ly * s, tr.position.y + lx * s + ly * c };
+    };
+    const sf::Vector2f p[4] = { world(-he.x, -he.y), world(he.x, -he.y), world(he.x, he.y), world(-he.x, he.y) };
+    const sf::Vector2f uv[4] = { { 0.f, 0.f }, { 1.f, 0.f }, { 1.f, 1.f }, { 0.f, 1.f } };
+
+    for (int i : { 0, 1, 2, 0, 2, 3 }) va.append(sf::Vertex{ p[i], color, uv[i] });
+
+    for (const auto& v : p) {
+        if (first) { bounds = sf::FloatRect(v, { 0.f, 0.f }); first = false; continue; }
+        const float x0 = std::min(bounds.position.x, v.x), y0 = std::min(bounds.position.y, v.y);
+        const float x1 = std::max(bounds.position.x + bounds.size.x, v.x);
+        const float y1 = std::max(bounds.position.y + bounds.size.y, v.y);
+        bounds = sf::FloatRect({ x0, y0 }, { x1 - x0, y1 - y0 });
+    }
+}
+
+static void BakeChunk(const Scene& scene, const RenderQueue::Chunk& ch, BakedChunk& out) {
+    out.version = ch.version;
+    out.batches.clear();
+
+    bool first = true;
+    for (const auto& item : ch.members) {
+        const Transform& tr = scene.transforms.at(item.id);
+        const Sprite& sp = scene.sprites.at(item.id);
+
+        // Textura que no cargó: rectángulo con el color del Sprite (como siempre)
+        std::string texPath;
+        if (auto itX = scene.textures.find(item.id); itX != scene.textures.end() &&
+            TextureCache::Get(itX->second.path).status != TextureCache::Status::Failed)
+            texPath = itX->second.path;
+
+        // Tramo nuevo sólo si cambia la textura: conserva el orden de dibujo
+        if (out.batches.empty() || out.batches.back().texPath != texPath) out.batches.push_back({ texPath, {} });
+        AppendQuad(out.batches.back().verts, tr, sp, texPath.empty() ? sp.color : sf::Color::White, out.bounds, first);
+    }
+    if (first) out.bounds = {};
+}
+
+static bool Intersects(const sf::FloatRect& a, const sf::FloatRect& b) {
+    return a.position.x <= b.position.x + b.size.x && a.position.x + a.size.x >= b.position.x &&
+           a.position.y <= b.position.y + b.size.y && a.position.y + a.size.y >= b.position.y;
+}
+
+static void DrawEntity(const Scene& scene, EntityID id, sf::RenderTarget& target) {
+    auto itT = scene.transforms.find(id);
+    auto itS = scene.sprites.find(id);
+    if (itT == scene.transforms.end() || itS == scene.sprites.end()) return;
+
+    const Transform& tr = itT->second;
+    const Sprite& sp = itS->second;
+
+    // ¿Hay textura? (puede estar cargando: placeholder)
+    TextureCache::Lookup look;
+    if (auto itX = scene.textures.find(id); itX != scene.textures.end()) {
+        look = TextureCache::Get(itX->second.path);
+    }
+
+    if (const sf::Texture* tex = look.tex) {
+        sf::Sprite spr(*tex);
+        // Escalar la textura al tamaño pedido (sp.size), luego aplicar Transform.scale
+        auto texSize = tex->getSize();
+        if (texSize.x == 0 || texSize.y == 0) return;
+        sf::Vector2f baseScale{ sp.size.x / texSize.x, sp.size.y / texSize.y };
+        sf::Vector2f finalScale{
+                        baseScale.x * tr.scale.x,
+                        baseScale.y * tr.scale.y
+                                };
+        spr.setScale(finalScale);
+        spr.setOrigin(sf::Vector2f(texSize) * 0.5f);
+        spr.setPosition(tr.position);
+        spr.setRotation(sf::degrees(tr.rotationDeg));
+        target.draw(spr);
+    }
+    else {
+        sf::RectangleShape rect;
+        rect.setSize(sp.size);
+        rect.setOrigin(sp.size * 0.5f);
+        rect.setPosition(tr.position);
+        rect.setScale(tr.scale);
+        rect.setRotation(sf::degrees(tr.rotationDeg));
+        rect.setFillColor(look.status == TextureCache::Status::Loading ? kPlaceholder : sp.color);
+        target.draw(rect);
+    }
 }
 
 void Renderer2D::Draw(const Scene& scene, sf::RenderTarget& target) {
-    for (const auto& e : scene.Entities()) {
-        auto itT = scene.transforms.find(e.id);
-        auto itS = scene.sprites.find(e.id);
-        if (itT == scene.transforms.end() || itS == scene.sprites.end()) continue;
-
-        const Transform& tr = itT->second;
-        const Sprite& sp = itS->second;
-
-        // ¿Hay textura?
-        std::shared_ptr<sf::Texture> tex;
-        if (auto itX = scene.textures.find(e.id); itX != scene.textures.end()) {
-            tex = GetTexture(itX->second.path);
-        }
-
-        if (tex) {
-            sf::Sprite spr(*tex);
-            // Escalar la textura al tamaño pedido (sp.size), luego aplicar Transform.scale
-            auto texSize = tex->getSize();
-            if (texSize.x == 0 || texSize.y == 0) continue;
-            sf::Vector2f baseScale{ sp.size.x / texSize.x, sp.size.y / texSize.y };
-            sf::Vector2f finalScale{
-                            baseScale.x * tr.scale.x,
-                            baseScale.y * tr.scale.y
-                                    };
-            spr.setScale(finalScale);
-            spr.setOrigin(sf::Vector2f(texSize) * 0.5f);
-            spr.setPosition(tr.position);
-            spr.setRotation(sf::degrees(tr.rotationDeg));
-            target.draw(spr);
-        }
-        else {
-            sf::RectangleShape rect;
-            rect.setSize(sp.size);
-            rect.setOrigin(sp.size * 0.5f);
-            rect.setPosition(tr.position);
-            rect.setScale(tr.scale);
-            rect.setRotation(sf::degrees(tr.rotationDeg));
-            rect.setFillColor(sp.color);
-            target.draw(rect);
-        }
+    TextureCache::PumpUploads();
+    s_Queue.Sync(scene);
+
+    // Alguna textura empezó/dejó de fallar: lo horneado con ella usa otro color
+    if (s_BakedFailRev != TextureCache::FailRevision()) s_Baked.clear();
+    // Chunks eliminados: soltar lo horneado
+    if (s_BakedChunkSetRev != s_Queue.ChunkSetRevision()) {
+        s_BakedChunkSetRev = s_Queue.ChunkSetRevision();
+        std::unordered_set<const RenderQueue::Chunk*> live;
+        for (const auto& [run, cells] : s_Queue.StaticRuns())
+            for (const auto& [cell, ch] : cells) live.insert(&ch);
+        std::erase_if(s_Baked, [&](const auto& kv) { return live.count(kv.first) == 0; });
     }
+
+    const sf::View& view = target.getView();
+    const sf::FloatRect visible = view.getInverseTransform().transformRect(sf::FloatRect({ -1.f, -1.f }, { 2.f, 2.f }));
+
+    // Chunks estáticos intercalados con lo dinámico según el orden de claves
+    s_Queue.ForEachInDrawOrder(
+        [&](const RenderQueue::Item& item) { DrawEntity(scene, item.id, target); },
+        [&](const RenderQueue::Chunk& ch) {
+            BakedChunk& baked = s_Baked[&ch];
+            if (baked.version != ch.version) BakeChunk(scene, ch, baked);
+            if (baked.batches.empty() || !Intersects(baked.bounds, visible)) return;
+            for (const auto& b : baked.batches) {
+                sf::RenderStates states;
+                states.coordinateType = sf::CoordinateType::Normalized;
+                if (!b.texPath.empty()) {
+                    const auto look = TextureCache::Get(b.texPath);
+                    states.texture = look.tex ? look.tex : &PlaceholderTexture();
+                }
+                target.draw(b.verts, states);
+            }
+        });
+
+    s_BakedFailRev = TextureCache::FailRevision(); // fallos detectados al hornear ya incluidos
 }
 
 std::shared_ptr<sf::Texture> Renderer2D::GetTextureCached(const std::string& path) {
-    return GetTexture(path);
+    return TextureCache::GetShared(path);
 }
 
 void Renderer2D::InvalidateTexture(const std::string& path) {
-    if (path.empty()) return;
-    if (auto it = s_TexCache.find(path); it != s_TexCache.end())
-        s_TexCache.erase(it);
+    TextureCache::Invalidate(path);
+}
+
+std::uint64_t Renderer2D::Revision() {
+    return TextureCache::Revision();
 }
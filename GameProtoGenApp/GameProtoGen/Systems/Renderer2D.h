@@ -1,11 +1,30 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
 class Scene;
 
 class Renderer2D {
 public:
+    // Orden: RenderLayer (capa, z) y luego orden de creación (ver RenderQueue). La
+    // geometría estática va horneada por chunks, debajo de lo dinámico de su capa.
+    // Texturas que todavía cargan se dibujan como color plano (ver TextureCache).
     static void Draw(const Scene& scene, sf::RenderTarget& target);
-    static void ClearTextureCache();
+
+    // ---- Texturas (carga asíncrona + LRU; ver Systems/TextureCache.h) ----
+    static void ClearTextureCache();   // descarta todo
+    static void RevalidateTextures();  // recarga en segundo plano lo que cambió en disco
+    // null mientras carga (o si falló); la pide si hace falta
     static std::shared_ptr<sf::Texture> GetTextureCached(const std::string& path);
     static void InvalidateTexture(const std::string& path);
+    // Draw() ya lo hace; llamarlo en frames sin Draw para no frenar las cargas.
+    // true si cambió algo visible.
+    static bool PumpTextureUploads();
+    static bool TexturesPending();
+    static void SetTextureBudget(std::size_t vramBytes, float uploadMsPerFrame);
+
+    // Cambia cuando cambia lo que Draw() mostraría sin tocar la escena (texturas cargadas/invalidadas)
+    static std::uint64_t Revision();
 };
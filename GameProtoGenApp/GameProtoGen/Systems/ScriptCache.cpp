@@ -0,0 +1,157 @@
+#include "ScriptCache.h"
+#include "ScriptVM.h"
+#include "Runtime/AssetStore.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // LRU: s_Order de más reciente a menos; s_Mem apunta a su nodo
+    struct MemEntry {
+        std::string bytecode;
+        std::list<std::string>::iterator order;
+    };
+    std::unordered_map<std::string, MemEntry> s_Mem; // hash -> bytecode
+    std::list<std::string> s_Order;
+    std::size_t s_MemBytes = 0;
+    std::size_t s_MemLimit = ScriptCache::kDefaultMemoryBytes;
+    std::size_t s_DiskLimit = ScriptCache::kDefaultDiskBytes;
+    std::string s_Dir;
+    std::size_t s_Compiles = 0;
+
+    const std::string* Touch(MemEntry& e) {
+        s_Order.splice(s_Order.begin(), s_Order, e.order);
+        return &e.bytecode;
+    }
+
+    // Suelta lo menos usado hasta entrar en el tope; el más reciente (el que se está
+    // devolviendo) queda aunque solo ya lo pase
+    void TrimMemory() {
+        while (s_MemBytes > s_MemLimit && s_Order.size() > 1) {
+            auto it = s_Mem.find(s_Order.back());
+            s_MemBytes -= it->second.bytecode.size();
+            s_Mem.erase(it);
+            s_Order.pop_back();
+        }
+    }
+
+    const std::string* Remember(const std::string& hash, std::string bytecode) {
+        s_Order.push_front(hash);
+        s_MemBytes += bytecode.size();
+        auto& e = s_Mem.emplace(hash, MemEntry{ std::move(bytecode), s_Order.begin() }).first->second;
+        TrimMemory();
+        return &e.bytecode;
+    }
+
+    // Borra .luac (y .tmp huérfanos) con más de kDiskMaxAgeDays; si la carpeta sigue
+    // pasada del tope, los de fecha más vieja primero
+    void PruneDisk(const fs::path& dir) {
+        std::error_code ec;
+        if (!fs::is_directory(dir, ec)) return;
+
+        struct File { fs::path path; fs::file_time_type time; std::uintmax_t size; };
+        std::vector<File> files;
+        std::uintmax_t total = 0;
+        const auto cutoff = fs::file_time_type::clock::now() - std::chrono::hours(24 * ScriptCache::kDiskMaxAgeDays);
+
+        for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            const fs::path& p = it->path();
+            if (p.extension() != ".luac" && p.extension() != ".tmp") continue;
+            if (!it->is_regular_file(ec)) continue;
+            File f{ p, it->last_write_time(ec), it->file_size(ec) };
+            if (ec) { ec.clear(); continue; }
+            if (f.time < cutoff || p.extension() == ".tmp") { fs::remove(p, ec); continue; }
+            total += f.size;
+            files.push_back(std::move(f));
+        }
+        if (total <= s_DiskLimit) return;
+
+        std::sort(files.begin(), files.end(), [](const File& a, const File& b) { return a.time < b.time; });
+        for (const File& f : files) {
+            if (total <= s_DiskLimit) break;
+            if (fs::remove(f.path, ec)) total -= f.size;
+        }
+    }
+
+    std::string ReadAll(const fs::path& p) {
+        std::ifstream ifs(p, std::ios::binary);
+        if (!ifs) return {};
+        std::ostringstream ss; ss << ifs.rdbuf();
+        return ss.str();
+    }
+
+    void WriteAtomic(const fs::path& p, const std::string& bytes) {
+        std::error_code ec;
+        fs::create_directories(p.parent_path(), ec);
+        const fs::path tmp = p.string() + ".tmp";
+        {
+            std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+            if (!ofs) return;
+            ofs.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            if (!ofs.good()) return;
+        }
+        fs::rename(tmp, p, ec);
+        if (ec) fs::remove(tmp, ec); // otro proceso lo escribió: vale igual
+    }
+}
+
+const std::string* ScriptCache::Get(const std::string& source, const std::string& chunkName, std::string& err) {
+    std::string keyed;
+    keyed.reserve(chunkName.size() + 1 + source.size());
+    keyed.append(chunkName).push_back('\0');
+    keyed.append(source);
+    const std::string hash = AssetStore::HashBytes(keyed);
+
+    if (auto it = s_Mem.find(hash); it != s_Mem.end()) return Touch(it->second);
+
+    const fs::path file = s_Dir.empty() ? fs::path() : fs::path(s_Dir) / (hash + ".luac");
+    if (!file.empty()) {
+        std::string bytes = ReadAll(file);
+        if (IsBytecode(bytes) && ScriptVM::CanLoad(bytes, chunkName)) {
+            std::error_code ec;
+            fs::last_write_time(file, fs::file_time_type::clock::now(), ec); // usado: la poda lo respeta
+            return Remember(hash, std::move(bytes));
+        }
+    }
+
+    std::string bytecode;
+    if (!ScriptVM::Compile(source, chunkName, bytecode, err)) return nullptr;
+    ++s_Compiles;
+    if (!file.empty()) WriteAtomic(file, bytecode);
+    return Remember(hash, std::move(bytecode));
+}
+
+void ScriptCache::SetDiskDir(std::string dir) {
+    s_Dir = std::move(dir);
+    if (!s_Dir.empty()) PruneDisk(s_Dir);
+}
+
+void ScriptCache::SetLimits(std::size_t memoryBytes, std::size_t diskBytes) {
+    s_MemLimit = memoryBytes;
+    s_DiskLimit = diskBytes;
+}
+
+void ScriptCache::Clear() {
+    s_Mem.clear();
+    s_Order.clear();
+    s_MemBytes = 0;
+}
+
+std::size_t ScriptCache::MemoryBytes() {
+    return s_MemBytes;
+}
+
+bool ScriptCache::IsBytecode(std::string_view chunk) {
+    return chunk.size() >= 4 && chunk.substr(0, 4) == "\x1bLua"; // LUA_SIGNATURE
+}
+
+std::size_t ScriptCache::Compiles() {
+    return s_Compiles;
+}
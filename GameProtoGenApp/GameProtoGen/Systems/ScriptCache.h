@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Bytecode de scripts Lua, compilado una sola vez por contenido.
+// Clave: sha256 de (nombre del chunk + fuente); el nombre entra porque va en la info de
+// debug (mensajes de error). Primero se busca en memoria, después en disco
+// (<dir>/<hash>.luac, si hay carpeta configurada) y recién ahí se compila.
+// Un .luac de otra versión/build de Lua no carga: se recompila y se pisa.
+// Los dos niveles están acotados: la memoria es un LRU por bytes y la carpeta se poda
+// al configurarla (lo viejo y, si sigue pasada de tamaño, lo menos usado; un acierto
+// en disco renueva la fecha del archivo).
+// Hilo principal.
+class ScriptCache {
+public:
+    static constexpr std::size_t kDefaultMemoryBytes = 16u << 20;
+    static constexpr std::size_t kDefaultDiskBytes = 64u << 20;
+    static constexpr int kDiskMaxAgeDays = 30;
+
+    // Bytecode para 'source', o nullptr si no compila (mensaje en err).
+    // El puntero vale hasta el próximo Get() o Clear() (el LRU puede soltarlo).
+    static const std::string* Get(const std::string& source, const std::string& chunkName, std::string& err);
+
+    // Carpeta del caché en disco; vacío = sólo memoria (default). Poda la carpeta.
+    static void SetDiskDir(std::string dir);
+    // Topes de memoria y disco en bytes; se aplican en el próximo Get/SetDiskDir
+    static void SetLimits(std::size_t memoryBytes, std::size_t diskBytes);
+    // Olvida lo que hay en memoria (el disco queda)
+    static void Clear();
+    static std::size_t MemoryBytes(); // bytecode retenido en memoria
+
+    static bool IsBytecode(std::string_view chunk);
+    static std::size_t Compiles(); // compilaciones hechas (no cuenta aciertos de caché)
+};
@@ -2,11 +2,21 @@
 #include <fstream>
 #include <sstream>
 #include "Core/Log.h"
+#include "Runtime/AssetPack.h"
+#include "Runtime/AssetStore.h"
+#include "Runtime/AssetWatcher.h"
 #include <filesystem>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 using Systems::ScriptSystem;
 
 static ScriptVM* g_vm = nullptr;
+static std::size_t s_MemFailures = 0; // rechazos del límite de memoria ya reportados
+static constexpr double kFrameBudgetMs = 25.0; // total de scripts por frame
+static bool s_FrameOver = false;               // ya se avisó que el frame no alcanza
+static EntityID s_ResumeAt = 0;                // primera entidad que quedó sin presupuesto
 ScriptVM& ScriptSystem::VM() {
     if (!g_vm) g_vm = new ScriptVM();
     return *g_vm;
@@ -19,8 +29,75 @@ static std::string LoadFileUtf8(const std::string& p) {
     return ss.str();
 }
 
+// Código fuente por archivo real: los scripts del AssetStore se resuelven a su blob
+// (nombre = hash), así que entidades con el mismo contenido leen el disco una sola vez.
+static std::unordered_map<std::string, std::string> s_ChunkCache;
+
+// Juego exportado: el chunk (bytecode) sale del .gppak montado, clave "pak:<blob>"
+static const std::string& LoadChunkCached(const std::string& logicalPath) {
+    if (const AssetPack::Entry* e = AssetPack::Find(logicalPath)) {
+        auto [it, inserted] = s_ChunkCache.try_emplace("pak:" + std::to_string(e->index));
+        if (inserted) AssetPack::ReadCopy(logicalPath, it->second);
+        return it->second;
+    }
+
+    const std::string file = AssetStore::Resolve(logicalPath);
+    auto it = s_ChunkCache.find(file);
+    if (it == s_ChunkCache.end())
+        it = s_ChunkCache.emplace(file, LoadFileUtf8(file)).first;
+    return it->second;
+}
+
 void ScriptSystem::ResetVM() {
     if (g_vm) g_vm->Reset();
+    s_ResumeAt = 0;
+    // Sin watcher, Play/Reset vuelve a leer los .lua editados a mano; con watcher,
+    // ReloadScript ya descartó justo los que cambiaron
+    if (!AssetWatcher::Active()) s_ChunkCache.clear();
+}
+
+int ScriptSystem::ReloadScript(Scene& scene, const std::string& file) {
+    const std::string real = AssetStore::Resolve(file);
+    s_ChunkCache.erase(real);
+    if (!g_vm) return 0;
+
+    auto& vm = VM();
+    vm.BindScene(scene);
+    int reloaded = 0;
+    for (const auto& [id, sc] : std::as_const(scene).scripts) {
+        // Sólo lo que ya corrió desde este archivo; el resto lo toma Update al cargarse
+        if (!sc.loaded || !sc.inlineCode.empty() || sc.path.empty() || !vm.HasEnv(id)) continue;
+        if (sc.path != file && AssetStore::Resolve(sc.path) != real) continue;
+
+        const std::string& code = LoadChunkCached(sc.path);
+        if (code.empty()) continue;
+
+        // Mismo environment: las globales del script (estado) sobreviven salvo que el
+        // chunk las reasigne al nivel superior
+        std::string err;
+        if (!vm.RunFor(id, code, sc.path, err)) {
+            Log::Error(std::string("[SCRIPT] Error reload: ") + err);
+            continue;
+        }
+        if (!vm.CallOnReload(id, err)) {
+            Log::Error(std::string("[SCRIPT] Error on_reload: ") + err);
+        }
+        ++reloaded;
+    }
+    return reloaded;
+}
+
+void ScriptSystem::CollectGarbage(double budgetMs) {
+    if (g_vm) g_vm->GcStep(budgetMs);
+}
+
+std::vector<ScriptVM::ScriptCost> ScriptSystem::TopCosts(std::size_t n) {
+    return g_vm ? g_vm->TopCosts(n) : std::vector<ScriptVM::ScriptCost>{};
+}
+
+const ScriptVM::GcStats& ScriptSystem::GetGcStats() {
+    static const ScriptVM::GcStats none{};
+    return g_vm ? g_vm->GetGcStats() : none;
 }
 
 void ScriptSystem::OnTriggerEnter(Scene& scene, EntityID self, EntityID other) {
@@ -35,22 +112,54 @@ void ScriptSystem::OnTriggerEnter(Scene& scene, EntityID self, EntityID other) {
 void ScriptSystem::Update(Scene& scene, float dt) {
     auto& vm = VM();
     vm.BindScene(scene);
+    vm.BeginFrame(kFrameBudgetMs);
+    std::size_t skipped = 0;
 
-    for (auto& [id, sc] : scene.scripts) {
-        if (!scene.transforms.contains(id)) continue; // sólo sobre entidades válidas
+    // gameReset() desde un callback reemplaza scene.scripts (y resetea el VM): el
+    // iterador y 'sc' apuntan al pool viejo, así que el frame termina ahí
+    const unsigned resets = vm.Resets();
+    auto wasReset = [&] {
+        if (vm.Resets() == resets) return false;
+        vm.EndFrame();
+        return true;
+    };
 
-        std::string code;
-        if (!sc.inlineCode.empty())      code = sc.inlineCode;
-        else if (!sc.path.empty())       code = LoadFileUtf8(sc.path);
-        if (code.empty()) continue;
+    // Si el frame anterior no alcanzó, se arranca por la entidad donde se cortó (dando la
+    // vuelta): las del final del mapa no se quedan siempre sin correr
+    auto& scripts = scene.scripts;
+    auto it = s_ResumeAt && std::as_const(scripts).contains(s_ResumeAt) ? scripts.find(s_ResumeAt)
+                                                                          : scripts.begin();
+    s_ResumeAt = 0;
+    for (std::size_t left = scripts.size(); left > 0; --left) {
+        if (it == scripts.end()) it = scripts.begin();
+        auto& [id, sc] = *it++;
+        if (!scene.transforms.contains(id)) continue; // sólo sobre entidades válidas
+        if (vm.IsSuspended(id)) continue;             // el watchdog la cortó
+        if (!vm.FrameBudgetLeft()) {
+            if (!skipped++) s_ResumeAt = id;
+            continue;
+        }
 
         std::string err;
         if (!sc.loaded) {
-            if (!vm.RunFor(id, code, sc.path.empty() ? "<inline>" : sc.path, err)) {
+            const std::string& code =
+                !sc.inlineCode.empty() ? sc.inlineCode :
+                !sc.path.empty()       ? LoadChunkCached(sc.path) : sc.inlineCode;
+            if (code.empty()) continue;
+
+            // Cortado por el presupuesto del frame: queda sin cargar y se reintenta entero
+            // (chunk y on_spawn) en el frame siguiente
+            const bool ran = vm.RunFor(id, code, sc.path.empty() ? "<inline>" : sc.path, err);
+            if (wasReset()) return;
+            if (!ran) {
+                if (vm.FrameCut()) { if (!skipped++) s_ResumeAt = id; continue; }
                 Log::Error(std::string("[SCRIPT] Error run: ") + err);
                 continue;
             }
-            if (!vm.CallOnSpawn(id, err)) {
+            const bool spawned = vm.CallOnSpawn(id, err);
+            if (wasReset()) return;
+            if (!spawned) {
+                if (vm.FrameCut()) { if (!skipped++) s_ResumeAt = id; continue; }
                 Log::Error(std::string("[SCRIPT] Error on_spawn: ") + err);
             }
             else {
@@ -59,8 +168,38 @@ void ScriptSystem::Update(Scene& scene, float dt) {
             sc.loaded = true;
         }
 
-        if (!vm.CallOnUpdate(id, dt, err)) {
+        if (vm.QueueUpdate(id)) continue; // módulo: un solo llamado por script al final
+
+        const bool updated = vm.CallOnUpdate(id, dt, err);
+        if (wasReset()) return;
+        if (!updated && !vm.FrameCut()) {
             Log::Error(std::string("[SCRIPT] Error on_update: ") + err);
         }
     }
+
+    std::vector<std::string> errors;
+    vm.UpdateModules(dt, errors);
+    for (const auto& e : errors) Log::Error(std::string("[SCRIPT] Error on_update: ") + e);
+    if (wasReset()) return;
+
+    // Corrutinas de on_spawn que vencieron (wait / wait_frames / wait_event)
+    errors.clear();
+    vm.Tick(dt, errors);
+    for (const auto& e : errors) Log::Error(std::string("[SCRIPT] Error on_spawn: ") + e);
+    if (wasReset()) return;
+
+    if (!vm.FrameBudgetLeft() && !s_FrameOver)
+        Log::Error("[SCRIPT] Presupuesto de scripts del frame agotado (" +
+                   std::to_string(static_cast<int>(kFrameBudgetMs)) + " ms): " +
+                   std::to_string(skipped) + " entidades quedaron para el frame siguiente");
+    s_FrameOver = !vm.FrameBudgetLeft();
+    vm.EndFrame();
+
+    const LuaAllocator& mem = vm.Memory();
+    if (mem.Failures() != s_MemFailures) {
+        s_MemFailures = mem.Failures();
+        Log::Error("[SCRIPT] Límite de memoria de Lua alcanzado (" +
+                   std::to_string(mem.Limit() / (1024 * 1024)) + " MB, en uso " +
+                   std::to_string(mem.Used() / 1024) + " KB)");
+    }
 }
@@ -8,6 +8,18 @@ namespace Systems {
         static void Update(Scene& scene, float dt);
         static void ResetVM();
 
+        // Hot-reload: el .lua 'file' cambió en disco. Vuelve a correr su chunk para cada
+        // entidad ya cargada que lo usa, conservando su estado (environment o self; un
+        // módulo se corre una vez y se re-enlaza). Sin on_spawn; llama a on_reload si el
+        // script lo define. Devuelve cuántas entidades recargó.
+        static int ReloadScript(Scene& scene, const std::string& file);
+
+        // Trabajo de GC de Lua acotado a budgetMs (fin de frame) y sus estadísticas
+        static void CollectGarbage(double budgetMs);
+        static const ScriptVM::GcStats& GetGcStats();
+        // Scripts más caros (promedio por llamada), para el panel de stats
+        static std::vector<ScriptVM::ScriptCost> TopCosts(std::size_t n);
+
         static void OnTriggerEnter(Scene& scene, EntityID self, EntityID other);
     private:
         static ScriptVM& VM(); // singleton simple
@@ -1,86 +1,623 @@
 #include "ScriptVM.h"
+#include "ScriptCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <sstream>
 #include "Core/Log.h"
 #include "Runtime/GameRunner.h"
+#include "ECS/ComponentReflection.h"
 
-ScriptVM::ScriptVM() : m_L(std::make_unique<sol::state>()) {
+namespace {
+    // Incremental: el automático recién arranca al 400% de lo vivo (respaldo si el juego
+    // asigna más rápido de lo que GcStep alcanza); GcStep arranca al 150%
+    constexpr int kGcAutoPause = 400;
+    constexpr std::size_t kGcFramePause = 150;
+    constexpr std::size_t kGcMinBaseKb = 256; // heaps chicos: no recolectar todos los frames
+}
+
+// ---------------- Bindings generados desde ECS/ComponentReflection.h ----------------
+namespace {
+    sol::object ValueToLua(sol::state& L, int v) { return sol::make_object(L, v); }
+    sol::object ValueToLua(sol::state& L, float v) { return sol::make_object(L, v); }
+    sol::object ValueToLua(sol::state& L, bool v) { return sol::make_object(L, v); }
+    sol::object ValueToLua(sol::state& L, const std::string& v) { return sol::make_object(L, v); }
+    sol::object ValueToLua(sol::state& L, const sf::Vector2f& v) {
+        sol::table t = L.create_table();
+        t["x"] = v.x; t["y"] = v.y;
+        return sol::make_object(L, t);
+    }
+    sol::object ValueToLua(sol::state& L, const sf::Color& c) {
+        sol::table t = L.create_table();
+        t["r"] = c.r; t["g"] = c.g; t["b"] = c.b; t["a"] = c.a;
+        return sol::make_object(L, t);
+    }
+
+    void ValueFromLua(const sol::object& o, int& v) { if (o.is<double>()) Reflect::AssignSaturated(o.as<double>(), v); }
+    void ValueFromLua(const sol::object& o, float& v) { if (o.is<float>()) v = o.as<float>(); }
+    void ValueFromLua(const sol::object& o, bool& v) { if (o.is<bool>()) v = o.as<bool>(); }
+    void ValueFromLua(const sol::object& o, std::string& v) { if (o.is<std::string>()) v = o.as<std::string>(); }
+    void ValueFromLua(const sol::object& o, sf::Vector2f& v) {
+        if (!o.is<sol::table>()) { v = { 0.f, 0.f }; return; }
+        sol::table t = o.as<sol::table>();
+        v = { t.get_or("x", 0.f), t.get_or("y", 0.f) };
+    }
+    void ValueFromLua(const sol::object& o, sf::Color& c) {
+        if (!o.is<sol::table>()) return;
+        sol::table t = o.as<sol::table>();
+        // Fuera de rango se recorta a 0..255 (no da la vuelta)
+        c = sf::Color(
+            Reflect::ColorChannel(t.get_or("r", 255.0)),
+            Reflect::ColorChannel(t.get_or("g", 255.0)),
+            Reflect::ColorChannel(t.get_or("b", 255.0)),
+            Reflect::ColorChannel(t.get_or("a", 255.0)));
+    }
+
+    template <class T> struct LuaGet {
+        static sol::object Call(sol::state& L, const Scene& s, EntityID id) {
+            const auto& pool = Reflect::PoolOf<T>(s); // const: no separa pools compartidos
+            auto it = pool.find(id);
+            if (it == pool.end()) return sol::nil;
+            sol::table out = L.create_table();
+            Reflect::ForEachField<T>([&](const auto& f) {
+                if (f.flags & Reflect::kLua) out[f.name] = ValueToLua(L, it->second.*f.member);
+            });
+            return sol::make_object(L, out);
+        }
+    };
+
+    template <class T> struct LuaSet {
+        static void Call(Scene& s, EntityID id, sol::table v) {
+            auto& c = Reflect::PoolOf<T>(s)[id];
+            Reflect::ForEachField<T>([&](const auto& f) {
+                if (!(f.flags & Reflect::kLua)) return;
+                sol::object o = v[f.name];
+                if (o.valid()) ValueFromLua(o, c.*f.member);
+            });
+        }
+    };
+
+    template <class T> struct LuaFirstWith {
+        static EntityID Call(const Scene& s) {
+            const auto& pool = Reflect::PoolOf<T>(s);
+            return !pool.empty() ? pool.begin()->first : 0u;
+        }
+    };
+
+    // wait*(): ceden (tipo, valor) al scheduler (Tick / CallOnSpawn)
+    enum WaitKind : int { kWaitTime = 1, kWaitFrames, kWaitEvent };
+
+    int YieldWait(lua_State* L, int kind) { // el valor está en el tope
+        if (!lua_isyieldable(L)) return luaL_error(L, "wait/wait_frames/wait_event sólo dentro de on_spawn");
+        lua_pushinteger(L, kind);
+        lua_insert(L, -2);
+        return lua_yield(L, 2);
+    }
+    int LuaWait(lua_State* L) {
+        const lua_Number seconds = luaL_checknumber(L, 1);
+        lua_settop(L, 0);
+        lua_pushnumber(L, seconds);
+        return YieldWait(L, kWaitTime);
+    }
+    int LuaWaitFrames(lua_State* L) {
+        const lua_Integer frames = luaL_optinteger(L, 1, 1);
+        lua_settop(L, 0);
+        lua_pushinteger(L, frames);
+        return YieldWait(L, kWaitFrames);
+    }
+    int LuaWaitEvent(lua_State* L) {
+        luaL_checkstring(L, 1);
+        lua_settop(L, 1);
+        return YieldWait(L, kWaitEvent);
+    }
+
+    // Nombre ("Transform") o TypeId (ecs.types.Transform)
+    Reflect::TypeId LuaTypeId(const sol::object& comp) {
+        if (comp.get_type() == sol::type::number) {
+            const int t = comp.as<int>();
+            return t >= 0 && t < (int)Reflect::kComponentCount ? (Reflect::TypeId)t : Reflect::kInvalidType;
+        }
+        if (comp.get_type() == sol::type::string) return Reflect::IdOf(comp.as<std::string_view>());
+        return Reflect::kInvalidType;
+    }
+}
+
+ScriptVM::ScriptVM()
+    : m_L(std::make_unique<sol::state>(sol::default_at_panic, &LuaAllocator::Alloc, &m_alloc)) {
+    m_alloc.Enforce(false); // sólo mientras corre un script (BeginCall)
+    SetMemoryLimit(kDefaultMemoryLimit);
     auto& L = *m_L;
     L.open_libraries(sol::lib::base, sol::lib::math, sol::lib::table, sol::lib::string);
     RegisterApi();
+
+    // pcall/tostring capturados al crear la VM: un script que los pise no rompe el lote.
+    // mark(id) abre la llamada de cada entidad para el watchdog (false: frame agotado);
+    // mark(0) cierra la última. Arranca en 'start' (desde 0, dando la vuelta) y devuelve
+    // dónde se quedó sin presupuesto (-1 si llegó al final): con un frame que no alcanza
+    // para todo el lote, el siguiente sigue desde ahí y nadie se queda siempre afuera.
+    // Una entidad cortada por el frame (cut()) no es un error: se sigue desde la próxima.
+    sol::protected_function makeLoop = L.safe_script(R"(
+        local pcall, tostring = pcall, tostring
+        return function(mark, cut)
+            return function(list, dt, start)
+                local errs
+                local n = #list
+                for k = 0, n - 1 do
+                    local i = (start + k) % n + 1
+                    local self = list[i]
+                    local f = self.on_update
+                    if f then
+                        if not mark(self.id) then
+                            mark(0)
+                            return errs, i - 1
+                        end
+                        local ok, e = pcall(f, self, dt)
+                        if not ok then
+                            if cut() then
+                                mark(0)
+                                return errs, i % n
+                            end
+                            errs = errs or {}
+                            errs[#errs + 1] = tostring(e)
+                        end
+                    end
+                end
+                mark(0)
+                return errs, -1
+            end
+        end
+    )", "=update_loop").get<sol::protected_function>();
+    m_UpdateLoop = makeLoop(
+        [this](EntityID id) -> bool {
+            if (!id) { EndCall(); return true; }
+            return BeginCall(id);
+        },
+        [this]() { return m_frameCut; }).get<sol::protected_function>();
+
+    // Watchdog: el hook encuentra su VM en el espacio extra del lua_State (las corutinas
+    // lo copian del hilo principal, y también heredan el hook)
+    lua_State* raw = L.lua_state();
+    *static_cast<ScriptVM**>(lua_getextraspace(raw)) = this;
+    lua_sethook(raw, &ScriptVM::BudgetHook, LUA_MASKCOUNT, kHookInstructions);
+
+    SetGcMode(GcMode::Incremental);
 }
 
 ScriptVM::~ScriptVM() = default;
 
+bool ScriptVM::Compile(const std::string& code, const std::string& chunkName, std::string& out, std::string& err) {
+    sol::state L; // sin libs: sólo se compila, no se corre
+    lua_State* raw = L.lua_state();
+    if (luaL_loadbufferx(raw, code.data(), code.size(), chunkName.c_str(), "t") != LUA_OK) {
+        err = lua_tostring(raw, -1);
+        return false;
+    }
+    out.clear();
+    lua_dump(raw, [](lua_State*, const void* p, size_t sz, void* ud) -> int {
+        static_cast<std::string*>(ud)->append(static_cast<const char*>(p), sz);
+        return 0;
+        }, &out, 0);
+    return true;
+}
+
+bool ScriptVM::CanLoad(std::string_view bytecode, const std::string& chunkName) {
+    sol::state L;
+    return luaL_loadbufferx(L.lua_state(), bytecode.data(), bytecode.size(), chunkName.c_str(), "b") == LUA_OK;
+}
+
 void ScriptVM::BindScene(Scene& scene) {
     m_scene = &scene;
 }
 
 void ScriptVM::Reset() {
+    ClearSleepers();
     m_envs.clear();
+    m_modules.clear();
+    m_suspended.clear();
+    m_current = 0;
+    m_batch = nullptr;
+    m_callDeadline = Clock::time_point::max();
+    m_frameCut = false;
+    m_gc.maxMs = 0.0;
+    ++m_resets;
 }
 
-bool ScriptVM::EnsureEnv(EntityID id) {
-    if (m_envs.find(id) != m_envs.end()) return true;
+// ---------------- Corrutinas ----------------
+void ScriptVM::ClearSleepers() {
+    lua_State* L = m_L->lua_state();
+    for (const auto& [ticket, s] : m_sleepers) luaL_unref(L, LUA_REGISTRYINDEX, s.ref);
+    m_sleepers.clear();
+    m_byTime = {};
+    m_byFrame = {};
+    m_byEvent.clear();
+    m_ready.clear();
+}
+
+// 's' ya no está en m_sleepers: si vuelve a dormir entra con ticket nuevo; si termina
+// (o falla) se suelta el hilo
+bool ScriptVM::Resume(Sleeper s, std::string& err) {
+    lua_State* L = m_L->lua_state();
+    if (!BeginCall(s.id)) { // sin presupuesto de frame: sigue en el próximo Tick
+        const std::uint64_t t = m_nextTicket++;
+        m_sleepers.emplace(t, s);
+        m_ready.push_back(t);
+        return true;
+    }
+    const unsigned resets = m_resets;
+    int nres = 0;
+    m_cutYield = false;
+    const int st = lua_resume(s.co, L, s.nargs, &nres);
+    EndCall();
+    s.nargs = 0;
+
+    if (st == LUA_YIELD && m_cutYield && m_resets == resets) {
+        // Cortada por el presupuesto del frame: sigue donde quedó en el próximo Tick
+        m_cutYield = false;
+        lua_pop(s.co, nres);
+        const std::uint64_t t = m_nextTicket++;
+        m_sleepers.emplace(t, s);
+        m_ready.push_back(t);
+        return true;
+    }
+    if (st == LUA_YIELD && m_resets == resets) {
+        const std::uint64_t t = m_nextTicket++;
+        const int kind = nres == 2 ? static_cast<int>(lua_tointeger(s.co, -2)) : 0;
+        if (kind == kWaitTime)
+            m_byTime.push({ m_time + std::max<double>(lua_tonumber(s.co, -1), 0.0), t });
+        else if (kind == kWaitEvent)
+            m_byEvent[lua_tostring(s.co, -1)].push_back(t);
+        else {
+            const lua_Integer frames = kind == kWaitFrames ? lua_tointeger(s.co, -1) : 1;
+            m_byFrame.push({ m_frame + static_cast<std::uint64_t>(std::max<lua_Integer>(frames, 1)), t });
+        }
+        lua_pop(s.co, nres);
+        m_sleepers.emplace(t, s);
+        return true;
+    }
+
+    if (st != LUA_OK && st != LUA_YIELD) {
+        const char* msg = lua_tostring(s.co, -1);
+        err = msg ? msg : "error en corrutina";
+    }
+    luaL_unref(L, LUA_REGISTRYINDEX, s.ref); // terminó, falló o la escena se reinició
+    return st == LUA_OK || st == LUA_YIELD;
+}
 
+void ScriptVM::Tick(float dt, std::vector<std::string>& errors) {
+    m_time += dt;
+    ++m_frame;
+
+    std::vector<std::uint64_t> due;
+    due.swap(m_ready);
+    while (!m_byFrame.empty() && m_byFrame.top().first <= m_frame) {
+        due.push_back(m_byFrame.top().second);
+        m_byFrame.pop();
+    }
+    while (!m_byTime.empty() && m_byTime.top().first <= m_time) {
+        due.push_back(m_byTime.top().second);
+        m_byTime.pop();
+    }
+
+    const unsigned resets = m_resets;
+    for (std::uint64_t t : due) {
+        auto it = m_sleepers.find(t);
+        if (it == m_sleepers.end()) continue;
+        const Sleeper s = it->second;
+        m_sleepers.erase(it);
+
+        const bool alive = m_envs.count(s.id) && !IsSuspended(s.id) &&
+                           (!m_scene || m_scene->scripts.contains(s.id));
+        if (!alive) { luaL_unref(m_L->lua_state(), LUA_REGISTRYINDEX, s.ref); continue; }
+
+        std::string err;
+        if (!Resume(s, err)) errors.push_back(err);
+        if (m_resets != resets) return; // gameReset() desde la corrutina
+    }
+}
+
+void ScriptVM::Emit(const std::string& event) {
+    auto it = m_byEvent.find(event);
+    if (it == m_byEvent.end()) return;
+    m_ready.insert(m_ready.end(), it->second.begin(), it->second.end());
+    m_byEvent.erase(it);
+}
+
+// ---------------- Watchdog ----------------
+void ScriptVM::BudgetHook(lua_State* L, lua_Debug* ar) {
+    ScriptVM* vm = *static_cast<ScriptVM**>(lua_getextraspace(L));
+    const auto now = Clock::now();
+    if (now < vm->m_callDeadline && now < vm->m_frameDeadline) return;
+    // En el cuerpo del loop de UpdateModules no se corta: un error ahí saltearía el
+    // registro de dónde siguió. Corta el mark() de la entidad siguiente.
+    lua_getinfo(L, "S", ar);
+    if (std::strcmp(ar->source, "=update_loop") == 0) return;
+
+    if (now >= vm->m_callDeadline) {
+        // El deadline queda vencido hasta EndCall: un pcall del script no lo esquiva
+        if (vm->m_batch) vm->m_suspended.insert(vm->m_batch->begin(), vm->m_batch->end());
+        else vm->m_suspended.insert(vm->m_current);
+        const double budgetMs = std::chrono::duration<double, std::milli>(vm->m_callDeadline - vm->m_callStart).count();
+        luaL_error(L, "script suspendido: superó el presupuesto de %.1f ms por llamada", budgetMs);
+    }
+    if (now >= vm->m_frameDeadline) {
+        vm->m_frameCut = true;
+        // Corrutina de on_spawn: ceder desde el hook (sin valores) la deja pausada tal
+        // cual; Resume la reencola. En el hilo principal o dentro de una llamada a C no
+        // se puede: error, y el que llamó mira FrameCut()
+        if (lua_isyieldable(L)) {
+            vm->m_cutYield = true;
+            lua_yield(L, 0);
+            return;
+        }
+        luaL_error(L, "presupuesto de scripts del frame agotado");
+    }
+}
+
+void ScriptVM::BeginFrame(double frameBudgetMs) {
+    m_frameCut = false;
+    m_frameDeadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(frameBudgetMs));
+}
+
+void ScriptVM::EndFrame() {
+    m_frameDeadline = Clock::time_point::max();
+}
+
+bool ScriptVM::BeginCall(EntityID id, std::size_t entities) {
+    EndCall();
+    m_frameCut = !FrameBudgetLeft();
+    if (m_frameCut) return false;
+    m_current = id;
+    m_callStart = Clock::now();
+    m_callDeadline = m_callStart + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::milli>(m_callBudgetMs * (double)entities));
+    m_alloc.Enforce(true);
+    return true;
+}
+
+void ScriptVM::EndCall() {
+    m_alloc.Enforce(false);
+    if (!m_current) return;
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - m_callStart).count();
+    const auto record = [this](EntityID id, double v) {
+        auto it = m_envs.find(id);
+        if (it == m_envs.end()) return;
+        it->second.lastMs = v;
+        it->second.avgMs += (v - it->second.avgMs) * 0.1;
+    };
+    if (m_batch) for (EntityID id : *m_batch) record(id, ms / m_batch->size());
+    else record(m_current, ms);
+
+    m_current = 0;
+    m_batch = nullptr;
+    m_callDeadline = Clock::time_point::max();
+}
+
+std::vector<ScriptVM::ScriptCost> ScriptVM::TopCosts(std::size_t n) const {
+    std::vector<ScriptCost> out;
+    out.reserve(m_envs.size());
+    for (const auto& [id, pe] : m_envs) out.push_back({ id, pe.lastMs, pe.avgMs });
+    n = std::min(n, out.size());
+    std::partial_sort(out.begin(), out.begin() + n, out.end(),
+        [](const ScriptCost& a, const ScriptCost& b) { return a.avgMs > b.avgMs; });
+    out.resize(n);
+    return out;
+}
+
+void ScriptVM::SetGcMode(GcMode mode) {
+    lua_State* raw = m_L->lua_state();
+    if (mode == GcMode::Generational) lua_gc(raw, LUA_GCGEN, 0, 0);       // multiplicadores por defecto
+    else                              lua_gc(raw, LUA_GCINC, kGcAutoPause, 0, 0);
+    m_gcMode = mode;
+    m_gcCycle = false;
+    m_gcBaseKb = std::max<std::size_t>(lua_gc(raw, LUA_GCCOUNT, 0), kGcMinBaseKb);
+}
+
+void ScriptVM::GcStep(double budgetMs) {
+    using Clock = std::chrono::steady_clock;
+    lua_State* raw = m_L->lua_state();
+    const auto t0 = Clock::now();
+    m_gc.steps = 0;
+
+    if (m_gcMode == GcMode::Incremental && budgetMs > 0.0) {
+        const std::size_t kb = lua_gc(raw, LUA_GCCOUNT, 0);
+        if (!m_gcCycle && kb * 100 >= m_gcBaseKb * kGcFramePause) m_gcCycle = true;
+
+        const auto deadline = t0 + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(budgetMs));
+        while (m_gcCycle) {
+            ++m_gc.steps;
+            if (lua_gc(raw, LUA_GCSTEP, 0)) { // terminó el ciclo
+                m_gcCycle = false;
+                ++m_gc.cycles;
+                m_gcBaseKb = std::max<std::size_t>(lua_gc(raw, LUA_GCCOUNT, 0), kGcMinBaseKb);
+                break;
+            }
+            if (Clock::now() >= deadline) break;
+        }
+    }
+
+    m_gc.kb = static_cast<std::size_t>(lua_gc(raw, LUA_GCCOUNT, 0));
+    m_gc.lastMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    m_gc.maxMs = std::max(m_gc.maxMs, m_gc.lastMs);
+}
+
+sol::environment ScriptVM::NewEnv(EntityID id) {
     auto& L = *m_L;
     // Environment nuevo que hereda de globals
     sol::environment env(L, sol::create, L.globals());
     env["this_id"] = id;
+    return env;
+}
 
-    m_envs.emplace(id, PerEntity{ std::move(env) });
-    return true;
+void ScriptVM::BindInstance(EntityID id, Module& mod) {
+    PerEntity& pe = m_envs[id];
+    pe.env = sol::environment(); // si era clásico (hot-reload a módulo)
+    pe.module = &mod;
+    if (!pe.self.valid()) {
+        pe.self = m_L->create_table();
+        pe.self["id"] = id;
+    }
+    pe.self[sol::metatable_key] = mod.meta; // recargado: mismo self, funciones nuevas
 }
 
 bool ScriptVM::RunFor(EntityID id, const std::string& code, const std::string& pathHint, std::string& err) {
-    EnsureEnv(id);
     auto& L = *m_L;
+    m_suspended.erase(id); // script nuevo o recargado: otra oportunidad
+    m_frameCut = false;
+
+    const std::string* chunk = &code;
+    if (!ScriptCache::IsBytecode(code)) {
+        chunk = ScriptCache::Get(code, pathHint, err);
+        if (!chunk) return false; // error de sintaxis
+    }
+
+    // Módulo ya cargado: la entidad sólo necesita su self
+    if (auto it = m_modules.find(*chunk); it != m_modules.end()) {
+        BindInstance(id, it->second);
+        return true;
+    }
 
-    sol::protected_function_result r =
-        L.safe_script(code, m_envs[id].env, sol::script_pass_on_error, pathHint.c_str());
+    // Clásico: el environment de la entidad (el que ya tenía, si es una recarga).
+    // Cada corrida carga su propia copia de la función: el _ENV de cada closure queda
+    // atado a su environment.
+    auto itPe = m_envs.find(id);
+    sol::environment env = (itPe != m_envs.end() && itPe->second.env.valid()) ? itPe->second.env : NewEnv(id);
+
+    sol::load_result loaded = L.load(*chunk, pathHint, sol::load_mode::binary);
+    if (!loaded.valid()) {
+        sol::error e = loaded;
+        err = e.what();
+        return false;
+    }
+    sol::protected_function fn = loaded;
+    sol::set_environment(env, fn);
+    if (!BeginCall(id)) { err = "presupuesto de scripts del frame agotado"; return false; }
+    sol::protected_function_result r = fn();
+    EndCall();
     if (!r.valid()) {
         sol::error e = r;
         err = e.what();
         return false;
     }
+
+    if (r.return_count() > 0 && r.get_type() == sol::type::table) {
+        // Módulo: el environment queda como el del módulo (compartido), sin this_id
+        env["this_id"] = sol::lua_nil;
+        Module mod;
+        mod.proto = r.get<sol::table>();
+        mod.meta = L.create_table();
+        mod.meta["__index"] = mod.proto;
+        BindInstance(id, m_modules.emplace(*chunk, std::move(mod)).first->second);
+        return true;
+    }
+
+    PerEntity& pe = m_envs[id];
+    pe.env = env;
+    pe.self = sol::table(); // si era módulo (hot-reload a clásico)
+    pe.module = nullptr;
     return true;
 }
 
-bool ScriptVM::CallOnSpawn(EntityID id, std::string& err) {
+// Busca el callback en self (módulo, vía __index) o en el environment (clásico).
+// Sin script, sin callback, suspendida o sin presupuesto de frame no es error: no se llama.
+template <typename... Args>
+bool ScriptVM::CallHook(EntityID id, const char* name, std::string& err, Args&&... args) {
     auto it = m_envs.find(id);
-    if (it == m_envs.end()) return true;
+    if (it == m_envs.end() || IsSuspended(id)) return true;
+    PerEntity& pe = it->second;
 
-    sol::object f = it->second.env["on_spawn"];
-    if (f.is<sol::protected_function>()) {
-        sol::protected_function pf = f.as<sol::protected_function>();
-        auto res = pf();
-        if (!res.valid()) { sol::error e = res; err = e.what(); return false; }
-    }
+    const bool isModule = pe.self.valid();
+    sol::object f = isModule ? sol::object(pe.self[name]) : sol::object(pe.env[name]);
+    if (!f.is<sol::protected_function>()) return true;
+
+    sol::protected_function pf = f.as<sol::protected_function>();
+    if (!BeginCall(id)) return true;
+    auto res = isModule ? pf(pe.self, std::forward<Args>(args)...) : pf(std::forward<Args>(args)...);
+    EndCall();
+    if (!res.valid()) { sol::error e = res; err = e.what(); return false; }
     return true;
 }
 
-bool ScriptVM::CallOnTriggerEnter(EntityID id, EntityID other, std::string& err) {
+bool ScriptVM::CallOnSpawn(EntityID id, std::string& err) {
     auto it = m_envs.find(id);
-    if (it == m_envs.end()) return true; // si no hay script, no es error
-    sol::object f = it->second.env["on_trigger_enter"];
-    if (f.is<sol::protected_function>()) {
-        sol::protected_function pf = f.as<sol::protected_function>();
-        auto res = pf(other);
-        if (!res.valid()) { sol::error e = res; err = e.what(); return false; }
-    }
-    return true;
+    if (it == m_envs.end() || IsSuspended(id)) return true;
+    PerEntity& pe = it->second;
+
+    const bool isModule = pe.self.valid();
+    sol::object f = isModule ? sol::object(pe.self["on_spawn"]) : sol::object(pe.env["on_spawn"]);
+    if (!f.is<sol::protected_function>()) return true;
+
+    lua_State* L = m_L->lua_state();
+    Sleeper s;
+    s.co = lua_newthread(L); // hereda el hook del watchdog
+    s.ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    s.id = id;
+    f.push(s.co);
+    if (isModule) { pe.self.push(s.co); s.nargs = 1; }
+    return Resume(s, err);
+}
+
+bool ScriptVM::CallOnReload(EntityID id, std::string& err) {
+    return CallHook(id, "on_reload", err);
+}
+
+bool ScriptVM::CallOnTriggerEnter(EntityID id, EntityID other, std::string& err) {
+    return CallHook(id, "on_trigger_enter", err, other);
 }
 
 bool ScriptVM::CallOnUpdate(EntityID id, float dt, std::string& err) {
+    return CallHook(id, "on_update", err, dt);
+}
+
+bool ScriptVM::QueueUpdate(EntityID id) {
     auto it = m_envs.find(id);
-    if (it == m_envs.end()) return true;
+    if (it == m_envs.end() || !it->second.module) return false;
+    if (!IsSuspended(id)) it->second.module->queued.push_back(id);
+    return true;
+}
+
+void ScriptVM::UpdateModules(float dt, std::vector<std::string>& errors) {
+    const unsigned resets = m_resets;
+    for (auto& [key, mod] : m_modules) {
+        if (mod.queued.empty()) continue;
 
-    sol::object f = it->second.env["on_update"];
-    if (f.is<sol::protected_function>()) {
-        sol::protected_function pf = f.as<sol::protected_function>();
-        auto res = pf(dt);
-        if (!res.valid()) { sol::error e = res; err = e.what(); return false; }
+        if (mod.queued != mod.listed) {
+            mod.list = m_L->create_table(static_cast<int>(mod.queued.size()), 0);
+            for (std::size_t i = 0; i < mod.queued.size(); ++i)
+                mod.list[i + 1] = m_envs[mod.queued[i]].self;
+            mod.listed.swap(mod.queued);
+        }
+        mod.queued.clear();
+
+        sol::object all = mod.proto["on_update_all"];
+        if (all.is<sol::protected_function>()) {
+            // Una sola llamada con el presupuesto de todo el lote: si igual se pasa, se
+            // suspende el lote entero
+            if (!BeginCall(mod.listed.front(), mod.listed.size())) continue;
+            m_batch = &mod.listed;
+            auto res = all.as<sol::protected_function>()(mod.list, dt);
+            EndCall();
+            if (m_resets != resets) return; // m_modules se vació: el iterador ya no vale
+            if (!res.valid() && !FrameCut()) { sol::error e = res; errors.push_back(e.what()); }
+            continue;
+        }
+
+        if (!FrameBudgetLeft()) continue;
+        auto res = m_UpdateLoop(mod.list, dt, mod.resume);
+        EndCall(); // si el error salió del loop, la última entidad quedó abierta
+        if (m_resets != resets) return;
+        if (!res.valid()) { // no debería pasar: errores del script quedan en el pcall
+            if (!FrameCut()) { sol::error e = res; errors.push_back(e.what()); }
+            continue;
+        }
+        const int stopped = res.get<int>(1);
+        mod.resume = stopped >= 0 ? stopped : 0;
+        if (res.get_type(0) == sol::type::table) {
+            sol::table errs = res.get<sol::table>(0);
+            for (std::size_t i = 1; i <= errs.size(); ++i) errors.push_back(errs.get<std::string>(i));
+        }
     }
-    return true;
 }
 
 void ScriptVM::RegisterApi() {
@@ -89,9 +626,16 @@ void ScriptVM::RegisterApi() {
 
     L.set_function("gameReset", [this]() -> bool {
         if (!m_scene) return false;
-        return GameRunner::ReloadFromDisk(*m_scene);
+        return GameRunner::ResetScene(*m_scene);
         });
 
+    // Corrutinas: sólo válidas dentro de on_spawn
+    lua_State* raw = L.lua_state();
+    lua_register(raw, "wait", &LuaWait);
+    lua_register(raw, "wait_frames", &LuaWaitFrames);
+    lua_register(raw, "wait_event", &LuaWaitEvent);
+    L.set_function("emit", [this](const std::string& event) { Emit(event); });
+
     L.set_function("print", [&L](sol::variadic_args va) {
         std::ostringstream oss;
         bool first = true;
@@ -126,143 +670,33 @@ void ScriptVM::RegisterApi() {
         if (s) s->DestroyEntity(Entity{ id });
         };
 
+    // Tipos de componente por TypeId: ecs.types.Transform, ... (ecs.get/set aceptan id o nombre)
+    sol::table types = L.create_table();
+    for (std::size_t i = 0; i < Reflect::kNames.size(); ++i)
+        types[Reflect::kNames[i]] = i;
+    L["ecs"]["types"] = types;
+
     // ecs.first_with("Component")
-    L["ecs"]["first_with"] = [this](const std::string& comp) -> EntityID {
-        Scene* s = m_scene;
-        if (!s) return 0;
-        auto has = [&](auto& map) { return !map.empty() ? map.begin()->first : 0u; };
-        if (comp == "Transform")         return has(s->transforms);
-        if (comp == "Sprite")            return has(s->sprites);
-        if (comp == "Collider")          return has(s->colliders);
-        if (comp == "Physics2D")         return has(s->physics);
-        if (comp == "PlayerController")  return has(s->playerControllers);
-        return 0;
+    L["ecs"]["first_with"] = [this](sol::object comp) -> EntityID {
+        static constexpr auto table = Reflect::Dispatch<LuaFirstWith>();
+        const Reflect::TypeId t = LuaTypeId(comp);
+        if (!m_scene || t >= table.size()) return 0;
+        return table[t](*m_scene);
         };
 
     // ecs.get(id,"Component") -> table|nil
-    L["ecs"]["get"] = [this](EntityID id, const std::string& comp) -> sol::object {
-        Scene* s = m_scene;
-        if (!s) return sol::nil;
-
-        auto& L = *m_L;
-        auto to_table_vec2 = [&](sf::Vector2f v) {
-            sol::table t = L.create_table();
-            t["x"] = v.x; t["y"] = v.y;
-            return t;
-            };
-        auto to_table_color = [&](sf::Color c) {
-            sol::table t = L.create_table();
-            t["r"] = c.r; t["g"] = c.g; t["b"] = c.b; t["a"] = c.a;
-            return t;
-            };
-
-        if (comp == "Transform" && s->transforms.contains(id)) {
-            auto& t = s->transforms[id];
-            sol::table out = L.create_table();
-            out["position"] = to_table_vec2(t.position);
-            out["scale"] = to_table_vec2(t.scale);
-            out["rotation"] = t.rotationDeg;
-            return sol::make_object(L, out);
-        }
-        if (comp == "Sprite" && s->sprites.contains(id)) {
-            auto& sp = s->sprites[id];
-            sol::table out = L.create_table();
-            out["size"] = to_table_vec2(sp.size);
-            out["color"] = to_table_color(sp.color);
-            return sol::make_object(L, out);
-        }
-        if (comp == "Collider" && s->colliders.contains(id)) {
-            auto& c = s->colliders[id];
-            sol::table out = L.create_table();
-            out["halfExtents"] = to_table_vec2(c.halfExtents);
-            out["offset"] = to_table_vec2(c.offset);
-            return sol::make_object(L, out);
-        }
-        if (comp == "Physics2D" && s->physics.contains(id)) {
-            auto& p = s->physics[id];
-            sol::table out = L.create_table();
-            out["velocity"] = to_table_vec2(p.velocity);
-            out["gravity"] = p.gravity;
-            out["gravityEnabled"] = p.gravityEnabled;
-            out["onGround"] = p.onGround;
-            return sol::make_object(L, out);
-        }
-        if (comp == "PlayerController" && s->playerControllers.contains(id)) {
-            auto& pc = s->playerControllers[id];
-            sol::table out = L.create_table();
-            out["moveSpeed"] = pc.moveSpeed;
-            out["jumpSpeed"] = pc.jumpSpeed;
-            return sol::make_object(L, out);
-        }
-        return sol::nil;
+    L["ecs"]["get"] = [this](EntityID id, sol::object comp) -> sol::object {
+        static constexpr auto table = Reflect::Dispatch<LuaGet>();
+        const Reflect::TypeId t = LuaTypeId(comp);
+        if (!m_scene || t >= table.size()) return sol::nil;
+        return table[t](*m_L, *m_scene, id);
         };
 
-    // ecs.set(id,"Component", table)
-    L["ecs"]["set"] = [this](EntityID id, const std::string& comp, sol::table v) {
-        Scene* s = m_scene;
-        if (!s) return;
-
-        auto get_vec2 = [&](sol::object obj) -> sf::Vector2f {
-            if (!obj.is<sol::table>()) return { 0.f, 0.f };
-            sol::table t = obj.as<sol::table>();
-            float x = t.get_or("x", 0.f);
-            float y = t.get_or("y", 0.f);
-            return { x, y };
-            };
-
-        if (comp == "Transform") {
-            auto& t = s->transforms[id];
-            sol::object p = v["position"];
-            sol::object sc = v["scale"];
-            sol::object r = v["rotation"];
-            if (p.valid())  t.position = get_vec2(p);
-            if (sc.valid()) t.scale = get_vec2(sc);
-            if (r.valid())  t.rotationDeg = r.as<float>();
-        }
-        else if (comp == "Sprite") {
-            auto& sp = s->sprites[id];
-            sol::object sz = v["size"];
-            sol::object col = v["color"];
-            if (sz.valid()) sp.size = get_vec2(sz);
-            if (col.valid() && col.is<sol::table>()) {
-                sol::table c = col.as<sol::table>();
-                // defaults como unsigned para castear a uint8_t sin warnings
-                unsigned r = c.get_or("r", 255u);
-                unsigned g = c.get_or("g", 255u);
-                unsigned b = c.get_or("b", 255u);
-                unsigned a = c.get_or("a", 255u);
-                sp.color = sf::Color(
-                    static_cast<std::uint8_t>(r),
-                    static_cast<std::uint8_t>(g),
-                    static_cast<std::uint8_t>(b),
-                    static_cast<std::uint8_t>(a)
-                );
-            }
-        }
-        else if (comp == "Collider") {
-            auto& c = s->colliders[id];
-            sol::object he = v["halfExtents"];
-            sol::object off = v["offset"];
-            if (he.valid())  c.halfExtents = get_vec2(he);
-            if (off.valid()) c.offset = get_vec2(off);
-        }
-        else if (comp == "Physics2D") {
-            auto& p = s->physics[id];
-            sol::object vel = v["velocity"];
-            sol::object g = v["gravity"];
-            sol::object ge = v["gravityEnabled"];
-            sol::object og = v["onGround"];
-            if (vel.valid()) p.velocity = get_vec2(vel);
-            if (g.valid())   p.gravity = g.as<float>();
-            if (ge.valid())  p.gravityEnabled = ge.as<bool>();
-            if (og.valid())  p.onGround = og.as<bool>();
-        }
-        else if (comp == "PlayerController") {
-            auto& pc = s->playerControllers[id];
-            sol::object ms = v["moveSpeed"];
-            sol::object js = v["jumpSpeed"];
-            if (ms.valid()) pc.moveSpeed = ms.as<float>();
-            if (js.valid()) pc.jumpSpeed = js.as<float>();
-        }
+    // ecs.set(id,"Component", table): crea el componente si no existe
+    L["ecs"]["set"] = [this](EntityID id, sol::object comp, sol::table v) {
+        static constexpr auto table = Reflect::Dispatch<LuaSet>();
+        const Reflect::TypeId t = LuaTypeId(comp);
+        if (!m_scene || t >= table.size()) return;
+        table[t](*m_scene, id, v);
     };
 }
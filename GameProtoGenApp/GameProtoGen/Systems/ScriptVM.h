@@ -1,9 +1,19 @@
 #pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <queue>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <SFML/System/Vector2.hpp>
 #include "ECS/Scene.h"
+#include "LuaAllocator.h"
 
 #include <sol/sol.hpp>
 
@@ -12,22 +22,181 @@ public:
     ScriptVM();
     ~ScriptVM();
 
+    // Asocia el script a la entidad. El fuente se compila una sola vez por contenido
+    // (ScriptCache); el bytecode (ej: del .gppak) se carga directo.
+    //  - Script módulo (el chunk hace `return M`): se corre una sola vez por VM y cada
+    //    entidad recibe sólo una tabla `self` ({ id = ... }, __index = M); los callbacks
+    //    se llaman como M.on_update(self, dt).
+    //  - Script clásico (sin return): se corre en un environment propio de la entidad
+    //    (global this_id) y los callbacks son globales de ese environment.
+    // Si la entidad ya tenía script, conserva su estado (self / environment): hot-reload.
     bool RunFor(EntityID id, const std::string& code, const std::string& pathHint, std::string& err);
+    // on_spawn corre como corrutina: puede llamar wait(seg), wait_frames(n) o
+    // wait_event(nombre) y sigue desde ahí cuando Tick la despierte. Si el presupuesto del
+    // frame se agota en medio, cede y sigue en el próximo Tick; si no puede ceder (dentro
+    // de una llamada a C) falla con FrameCut() y hay que volver a cargarla.
     bool CallOnSpawn(EntityID id, std::string& err);
+    bool CallOnReload(EntityID id, std::string& err);
+    bool HasEnv(EntityID id) const { return m_envs.count(id) != 0; }
     bool CallOnUpdate(EntityID id, float dt, std::string& err);
+
+    // Update en lote para scripts módulo: QueueUpdate anota la entidad (false si su
+    // script es clásico: llamar CallOnUpdate) y UpdateModules hace un solo llamado a Lua
+    // por módulo: M.on_update_all(selves, dt) si el módulo lo define; si no, un loop en
+    // Lua que llama on_update(self, dt) con pcall por entidad. Los errores vuelven en
+    // 'errors' (uno por entidad que falló, o uno por lote).
+    bool QueueUpdate(EntityID id);
+    void UpdateModules(float dt, std::vector<std::string>& errors);
     void Reset();
+    // Cambia con cada Reset(): un script puede llamar gameReset() (que reemplaza la
+    // escena y resetea el VM) desde cualquier callback; quien itera la escena lo compara
+    unsigned Resets() const { return m_resets; }
     void BindScene(Scene& scene);
     bool CallOnTriggerEnter(EntityID id, EntityID other, std::string& err);
 
+    // ---- Corrutinas ----
+    // Las dormidas no cuestan nada por frame: esperas por tiempo y por frames en min-heaps
+    // (sólo se mira el tope), por evento en listas por nombre. Tick avanza el reloj del
+    // VM y reanuda las que vencieron (y las de eventos emitidos desde el Tick anterior).
+    // Se descartan si la entidad perdió su script o quedó suspendida.
+    void Tick(float dt, std::vector<std::string>& errors);
+    void Emit(const std::string& event); // despierta a los wait_event(event) en el próximo Tick
+    std::size_t Sleeping() const { return m_sleepers.size(); }
+
+    // ---- Presupuesto de tiempo (watchdog) ----
+    // Un hook de conteo (cada kHookInstructions instrucciones) mira el reloj: una llamada
+    // a un script que pasa el presupuesto por llamada se corta con error y la entidad
+    // queda suspendida (no se le llama nada más hasta que se recargue su script o Reset).
+    // on_update_all tiene el presupuesto de una llamada por cada entidad del lote.
+    // Entre BeginFrame y EndFrame además hay un total por frame: agotado, se corta la
+    // llamada en curso (sin suspender a nadie) y el resto espera al frame siguiente.
+    static constexpr int kHookInstructions = 1000;
+    static constexpr double kDefaultCallBudgetMs = 10.0;
+    void SetCallBudget(double ms) { m_callBudgetMs = ms; }
+    void BeginFrame(double frameBudgetMs);
+    void EndFrame();
+    bool FrameBudgetLeft() const { return Clock::now() < m_frameDeadline; }
+    // La última llamada no corrió o se cortó por el presupuesto del frame (no es un error
+    // del script: reintentarla en el frame siguiente)
+    bool FrameCut() const { return m_frameCut; }
+    bool IsSuspended(EntityID id) const { return m_suspended.count(id) != 0; }
+
+    // Costo de los scripts por entidad (última llamada y promedio móvil), de mayor a menor
+    struct ScriptCost { EntityID id = 0; double lastMs = 0.0; double avgMs = 0.0; };
+    std::vector<ScriptCost> TopCosts(std::size_t n) const;
+
+    // ---- Memoria ----
+    // El lua_State usa un LuaAllocator propio (pool por clases de tamaño). Con límite, un
+    // script desbocado recibe "not enough memory" en vez de agotar el proceso. El límite
+    // rige sólo entre BeginCall y EndCall, y los scripts topan kHostReserve antes: lo que
+    // pide el VM por su cuenta (environments, self, hilos de on_spawn) no está protegido
+    // y no puede fallar.
+    static constexpr std::size_t kDefaultMemoryLimit = 128u * 1024 * 1024;
+    static constexpr std::size_t kHostReserve = 1u * 1024 * 1024;
+    void SetMemoryLimit(std::size_t bytes) { // 0 = sin límite
+        m_alloc.SetLimit(bytes);
+        m_alloc.SetReserve(std::min(kHostReserve, bytes / 4));
+    }
+    const LuaAllocator& Memory() const { return m_alloc; }
+
+    // ---- Recolector de basura ----
+    // Incremental (default): el colector automático arranca tarde (pausa alta) y el grueso
+    // del trabajo lo hace GcStep al final de cada frame, en tajadas acotadas por tiempo.
+    // Generacional: colecciones menores cortas a cargo de Lua; no se pueden partir, así
+    // que GcStep sólo actualiza las estadísticas.
+    enum class GcMode { Incremental, Generational };
+    struct GcStats {
+        std::size_t kb = 0;       // memoria en uso del VM
+        double lastMs = 0.0;      // duración del último GcStep
+        double maxMs = 0.0;       // peor GcStep desde el último Reset
+        std::size_t steps = 0;    // pasos del colector en el último GcStep
+        std::size_t cycles = 0;   // ciclos completos hechos por GcStep
+    };
+    void SetGcMode(GcMode mode);
+    GcMode GetGcMode() const { return m_gcMode; }
+    // Avanza el ciclo de GC en curso hasta agotar budgetMs. Empieza un ciclo nuevo sólo
+    // cuando la memoria creció kGcFramePause % sobre lo que quedó vivo en el anterior.
+    void GcStep(double budgetMs);
+    const GcStats& GetGcStats() const { return m_gc; }
+
+    // Precompila 'code' a bytecode (lua_dump, con info de debug para los errores).
+    // RunFor acepta el resultado igual que el fuente.
+    static bool Compile(const std::string& code, const std::string& chunkName, std::string& out, std::string& err);
+    // ¿Este build de Lua carga el bytecode? (versión/formato del header)
+    static bool CanLoad(std::string_view bytecode, const std::string& chunkName);
+
 private:
+    struct Module {
+        sol::table proto; // lo que devolvió el chunk
+        sol::table meta;  // { __index = proto }, compartida por las instancias
+        // Lote de on_update: la tabla Lua se rearma sólo si cambian las entidades
+        std::vector<EntityID> queued, listed;
+        sol::table list;
+        int resume = 0; // índice (desde 0) donde el loop se quedó sin presupuesto
+    };
+
     struct PerEntity {
-        sol::environment env;
+        sol::environment env;     // script clásico
+        sol::table self;          // script módulo
+        Module* module = nullptr; // nodos de m_modules: estables hasta Reset()
+        double lastMs = 0.0, avgMs = 0.0;
     };
 
+    using Clock = std::chrono::steady_clock;
+
+    LuaAllocator m_alloc; // antes que m_L: se destruye después del lua_State
     std::unique_ptr<sol::state> m_L;
     std::unordered_map<EntityID, PerEntity> m_envs;
+    std::unordered_map<std::string, Module> m_modules; // bytecode -> módulo
     Scene* m_scene = nullptr;
+    sol::protected_function m_UpdateLoop; // loop en Lua de UpdateModules
+
+    // Watchdog: una sola "llamada en curso" a la vez (el VM es de un hilo)
+    double m_callBudgetMs = kDefaultCallBudgetMs;
+    Clock::time_point m_frameDeadline = Clock::time_point::max();
+    Clock::time_point m_callDeadline = Clock::time_point::max();
+    Clock::time_point m_callStart{};
+    EntityID m_current = 0;   // 0 = ninguna
+    const std::vector<EntityID>* m_batch = nullptr; // on_update_all: el costo se reparte
+    std::unordered_set<EntityID> m_suspended;
+    bool m_frameCut = false;  // ver FrameCut()
+    bool m_cutYield = false;  // el hook hizo ceder la corrutina en curso por el frame
+    unsigned m_resets = 0; // un script puede llamar gameReset() en medio de UpdateModules
+
+    // Corrutinas: cada una está en una sola de las colas; el hilo se mantiene vivo con
+    // una referencia en el registro
+    struct Sleeper {
+        lua_State* co = nullptr;
+        int ref = 0;
+        EntityID id = 0;
+        int nargs = 0; // argumentos ya apilados (sólo antes del primer resume)
+    };
+    template <typename K>
+    using MinHeap = std::priority_queue<std::pair<K, std::uint64_t>, std::vector<std::pair<K, std::uint64_t>>, std::greater<>>;
+    std::unordered_map<std::uint64_t, Sleeper> m_sleepers; // ticket -> corrutina
+    std::uint64_t m_nextTicket = 1;
+    MinHeap<double> m_byTime;            // (despertar en m_time, ticket)
+    MinHeap<std::uint64_t> m_byFrame;    // (despertar en m_frame, ticket)
+    std::unordered_map<std::string, std::vector<std::uint64_t>> m_byEvent;
+    std::vector<std::uint64_t> m_ready;  // para el próximo Tick
+    double m_time = 0.0;
+    std::uint64_t m_frame = 0;
+
+    GcMode m_gcMode = GcMode::Incremental;
+    GcStats m_gc;
+    bool m_gcCycle = false;       // hay un ciclo de GcStep a medio hacer
+    std::size_t m_gcBaseKb = 0;   // memoria viva al terminar el último ciclo
+
+    bool Resume(Sleeper s, std::string& err);
+    void ClearSleepers();
+
+    bool BeginCall(EntityID id, std::size_t entities = 1); // false: no queda presupuesto de frame
+    void EndCall();
+    static void BudgetHook(lua_State* L, lua_Debug* ar);
 
     void RegisterApi();
-    bool EnsureEnv(EntityID id);
+    sol::environment NewEnv(EntityID id);
+    void BindInstance(EntityID id, Module& mod);
+    template <typename... Args>
+    bool CallHook(EntityID id, const char* name, std::string& err, Args&&... args);
 };
@@ -0,0 +1,313 @@
+#include "TextureCache.h"
+#include "Runtime/AssetPack.h"
+#include "Runtime/AssetStore.h"
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/System/Clock.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // ---- Decodificación en hilos de trabajo ----
+    struct DecodeJob {
+        std::string file;
+        std::uint64_t gen = 0;
+    };
+
+    struct Decoded {
+        std::string file;
+        std::uint64_t gen = 0;
+        sf::Image image;
+        // RGBA8 sin comprimir dentro del .gppak: se sube directo desde el mapeo
+        const std::uint8_t* mapped = nullptr;
+        sf::Vector2u mappedSize;
+        bool ok = false;
+    };
+
+    // Archivos del .gppak montado: "pak:<blob>" (ver FileOf)
+    constexpr std::string_view kPakPrefix = "pak:";
+
+    bool DecodePacked(Decoded& d) {
+        const AssetPack::Entry* e = AssetPack::At(std::stoull(d.file.substr(kPakPrefix.size())));
+        std::string scratch;
+        std::string_view bytes;
+        if (!e || !AssetPack::Read(*e, scratch, bytes)) return false;
+
+        if (e->kind != AssetPack::Kind::Rgba8) // imagen tal cual (png/jpg)
+            return d.image.loadFromMemory(bytes.data(), bytes.size());
+
+        if (bytes.size() != (std::size_t)e->width * e->height * 4) return false;
+        const auto* px = reinterpret_cast<const std::uint8_t*>(bytes.data());
+        if (scratch.empty()) { // sin copia
+            d.mapped = px;
+            d.mappedSize = { e->width, e->height };
+            return true;
+        }
+        d.image.resize({ e->width, e->height }, px);
+        return true;
+    }
+
+    class Decoder {
+    public:
+        ~Decoder() {
+            {
+                std::lock_guard<std::mutex> lk(m_Mx);
+                m_Stop = true;
+                m_Jobs.clear();
+            }
+            m_Cv.notify_all();
+            for (auto& t : m_Workers) t.join();
+        }
+
+        void Push(DecodeJob job) {
+            {
+                std::lock_guard<std::mutex> lk(m_Mx);
+                if (m_Workers.empty()) { // se crean con el primer pedido
+                    const unsigned n = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+                    for (unsigned i = 0; i < n; ++i) m_Workers.emplace_back([this] { WorkerLoop(); });
+                }
+                m_Jobs.push_back(std::move(job));
+            }
+            m_Cv.notify_one();
+        }
+
+        bool TryPop(Decoded& out) {
+            std::lock_guard<std::mutex> lk(m_Mx);
+            if (m_Done.empty()) return false;
+            out = std::move(m_Done.front());
+            m_Done.pop_front();
+            return true;
+        }
+
+    private:
+        void WorkerLoop() {
+            for (;;) {
+                DecodeJob job;
+                {
+                    std::unique_lock<std::mutex> lk(m_Mx);
+                    m_Cv.wait(lk, [this] { return m_Stop || !m_Jobs.empty(); });
+                    if (m_Stop) return;
+                    job = std::move(m_Jobs.front());
+                    m_Jobs.pop_front();
+                }
+                Decoded d;
+                d.file = std::move(job.file);
+                d.gen = job.gen;
+                d.ok = d.file.starts_with(kPakPrefix) ? DecodePacked(d) : d.image.loadFromFile(d.file);
+                std::lock_guard<std::mutex> lk(m_Mx);
+                m_Done.push_back(std::move(d));
+            }
+        }
+
+        std::mutex m_Mx;
+        std::condition_variable m_Cv;
+        std::deque<DecodeJob> m_Jobs;
+        std::deque<Decoded> m_Done;
+        std::vector<std::thread> m_Workers;
+        bool m_Stop = false;
+    };
+
+    Decoder& Workers() {
+        static Decoder s_Decoder;
+        return s_Decoder;
+    }
+
+    // ---- Estado (hilo principal) ----
+    struct Entry {
+        std::shared_ptr<sf::Texture> tex;
+        TextureCache::Status status = TextureCache::Status::Loading;
+        std::uint64_t gen = 0;          // pedido vigente (resultados de otros se descartan)
+        bool inFlight = false;
+        fs::file_time_type mtime{};
+        std::size_t bytes = 0;
+        std::uint64_t lastUse = 0;      // frame
+        std::list<std::string>::iterator lru;
+    };
+
+    std::unordered_map<std::string, Entry> s_Entries;            // archivo -> entrada
+    std::unordered_map<std::string, std::string> s_FileOf;       // nombre lógico -> archivo
+    std::list<std::string> s_Lru;                                // más reciente al frente
+    std::size_t s_Bytes = 0;
+    std::size_t s_InFlight = 0;
+    std::uint64_t s_Frame = 1;
+    std::uint64_t s_NextGen = 1;
+    std::uint64_t s_Revision = 0;
+    std::uint64_t s_FailRevision = 0;
+
+    std::size_t s_BudgetBytes = 512u * 1024u * 1024u;
+    float s_UploadMs = 4.f;
+
+    const std::string& FileOf(const std::string& path) {
+        auto it = s_FileOf.find(path);
+        if (it == s_FileOf.end()) {
+            const AssetPack::Entry* packed = AssetPack::Find(path);
+            it = s_FileOf.emplace(path, packed ? std::string(kPakPrefix) + std::to_string(packed->index)
+                                               : AssetStore::Resolve(path)).first;
+        }
+        return it->second;
+    }
+
+    void Request(const std::string& file, Entry& e) {
+        std::error_code ec;
+        e.mtime = fs::last_write_time(file, ec);
+        e.gen = s_NextGen++;
+        if (!e.inFlight) { e.inFlight = true; ++s_InFlight; }
+        Workers().Push({ file, e.gen });
+    }
+
+    void SetStatus(Entry& e, TextureCache::Status st) {
+        if ((e.status == TextureCache::Status::Failed) != (st == TextureCache::Status::Failed)) ++s_FailRevision;
+        e.status = st;
+    }
+
+    void Drop(std::unordered_map<std::string, Entry>::iterator it) {
+        s_Bytes -= it->second.bytes;
+        s_Lru.erase(it->second.lru);
+        if (it->second.inFlight) --s_InFlight; // su resultado se descarta al llegar
+        s_Entries.erase(it);
+    }
+
+    Entry& Touch(const std::string& path) {
+        const std::string& file = FileOf(path);
+        auto [it, inserted] = s_Entries.try_emplace(file);
+        Entry& e = it->second;
+        if (inserted) {
+            s_Lru.push_front(file);
+            e.lru = s_Lru.begin();
+            Request(file, e);
+        }
+        else if (e.lastUse != s_Frame) {
+            s_Lru.splice(s_Lru.begin(), s_Lru, e.lru);
+        }
+        e.lastUse = s_Frame;
+        return e;
+    }
+
+    void Upload(Decoded& d) {
+        auto it = s_Entries.find(d.file);
+        if (it == s_Entries.end() || it->second.gen != d.gen) return; // desalojada o pedido viejo
+        Entry& e = it->second;
+        e.inFlight = false;
+        --s_InFlight;
+        ++s_Revision;
+
+        auto tex = std::make_shared<sf::Texture>();
+        bool uploaded = false;
+        if (d.ok && d.mapped) {
+            uploaded = tex->resize(d.mappedSize);
+            if (uploaded) tex->update(d.mapped);
+        }
+        else if (d.ok) {
+            uploaded = tex->loadFromImage(d.image);
+        }
+        if (!uploaded) {
+            s_Bytes -= e.bytes;
+            e.bytes = 0;
+            e.tex.reset();
+            SetStatus(e, TextureCache::Status::Failed);
+            return;
+        }
+        tex->setSmooth(true);
+        const auto sz = tex->getSize();
+        s_Bytes -= e.bytes;
+        e.bytes = (std::size_t)sz.x * sz.y * 4;
+        s_Bytes += e.bytes;
+        e.tex = std::move(tex);
+        SetStatus(e, TextureCache::Status::Ready);
+    }
+
+    // Desde lo menos usado; nunca lo usado en el frame anterior (está en pantalla)
+    void Evict() {
+        while (s_Bytes > s_BudgetBytes && !s_Lru.empty()) {
+            auto it = s_Entries.find(s_Lru.back());
+            if (it->second.lastUse + 1 >= s_Frame) break;
+            Drop(it);
+            ++s_Revision;
+        }
+    }
+}
+
+TextureCache::Lookup TextureCache::Get(const std::string& path) {
+    if (path.empty()) return {};
+    Entry& e = Touch(path);
+    return { e.tex.get(), e.status };
+}
+
+std::shared_ptr<sf::Texture> TextureCache::GetShared(const std::string& path) {
+    if (path.empty()) return nullptr;
+    return Touch(path).tex;
+}
+
+bool TextureCache::PumpUploads() {
+    const std::uint64_t before = s_Revision;
+    ++s_Frame;
+
+    sf::Clock clock;
+    Decoded d;
+    while (Workers().TryPop(d)) {
+        Upload(d);
+        if (clock.getElapsedTime().asSeconds() * 1000.f >= s_UploadMs) break;
+    }
+    Evict();
+    return s_Revision != before;
+}
+
+void TextureCache::Invalidate(const std::string& path) {
+    if (path.empty()) return;
+    s_FileOf.erase(path); // el nombre puede apuntar a otro blob
+    const std::string& file = FileOf(path);
+    if (auto it = s_Entries.find(file); it != s_Entries.end()) {
+        Request(file, it->second);
+        ++s_Revision;
+    }
+}
+
+void TextureCache::Revalidate() {
+    s_FileOf.clear();
+    for (auto& [file, e] : s_Entries) {
+        std::error_code ec;
+        const auto mtime = fs::last_write_time(file, ec);
+        if (e.status == Status::Failed || (!e.inFlight && mtime != e.mtime)) Request(file, e);
+    }
+    ++s_Revision;
+}
+
+void TextureCache::Clear() {
+    s_Entries.clear();
+    s_FileOf.clear();
+    s_Lru.clear();
+    s_Bytes = 0;
+    s_InFlight = 0; // los resultados en vuelo se descartan al llegar (no hay entrada)
+    ++s_Revision;
+    ++s_FailRevision;
+}
+
+void TextureCache::SetBudget(std::size_t vramBytes, float uploadMsPerFrame) {
+    s_BudgetBytes = vramBytes;
+    s_UploadMs = std::max(0.f, uploadMsPerFrame);
+}
+
+bool TextureCache::Pending() {
+    return s_InFlight > 0;
+}
+
+std::size_t TextureCache::ResidentBytes() {
+    return s_Bytes;
+}
+
+std::uint64_t TextureCache::Revision() {
+    return s_Revision;
+}
+
+std::uint64_t TextureCache::FailRevision() {
+    return s_FailRevision;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <SFML/Graphics/Texture.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Caché de texturas con carga asíncrona.
+// El PNG se decodifica en hilos de trabajo (sf::Image); la subida a GPU se hace en el
+// hilo de render dentro de PumpUploads(), con un presupuesto de tiempo por frame.
+// Mientras tanto Get() devuelve Loading (el renderer dibuja un placeholder) o, si es
+// una recarga, la versión anterior. Lo residente se desaloja por LRU cuando supera el
+// presupuesto de memoria (sólo lo que no se usó en el último frame).
+//
+// Como el Renderer2D de antes: nombre lógico (Texture2D.path) -> archivo real vía
+// AssetStore; nombres que resuelven al mismo blob comparten textura. Con un .gppak
+// montado (juego exportado) la textura sale de ahí, ya en RGBA8.
+// Todo menos la decodificación corre en el hilo principal.
+class TextureCache {
+public:
+    enum class Status { Loading, Ready, Failed };
+
+    struct Lookup {
+        const sf::Texture* tex = nullptr; // puede ser la versión vieja mientras recarga
+        Status status = Status::Failed;
+    };
+
+    // Pide la carga si hace falta y marca el uso (LRU). path vacío -> Failed.
+    static Lookup Get(const std::string& path);
+    static std::shared_ptr<sf::Texture> GetShared(const std::string& path);
+
+    // Sube lo ya decodificado (al menos uno, después hasta agotar el presupuesto) y
+    // desaloja por LRU. Una vez por frame. true si algo visible cambió.
+    static bool PumpUploads();
+
+    // Recarga en segundo plano (se sigue viendo la versión anterior hasta que esté)
+    static void Invalidate(const std::string& path);
+    // Re-resuelve nombres y recarga lo que cambió en disco o había fallado
+    static void Revalidate();
+    // Descarta todo
+    static void Clear();
+
+    static void SetBudget(std::size_t vramBytes, float uploadMsPerFrame);
+    static bool Pending();              // decodificaciones o subidas en curso
+    static std::size_t ResidentBytes();
+
+    // Cambia cuando cambia lo que se vería (subidas, fallos, invalidaciones)
+    static std::uint64_t Revision();
+    // Cambia cuando una textura pasa a o deja de estar Failed (el renderer dibuja
+    // color plano en vez de textura: lo horneado con ella queda viejo)
+    static std::uint64_t FailRevision();
+};
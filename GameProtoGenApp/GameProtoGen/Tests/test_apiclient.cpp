@@ -1,6 +1,19 @@
 #include <gtest/gtest.h>
 #include "Net/ApiClient.h"
+#include "Net/ChatStream.h"
 #include <nlohmann/json.hpp>
+#include <httplib.h>
+#include <picosha2.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 TEST(ApiClient, BuildUrl) {
     ApiClient c("localhost", 7223);
@@ -20,3 +33,267 @@ TEST(ApiClient, BuildUrl) {
         }()
             );
 }
+
+TEST(ChatStream, ParsesNdjsonAcrossChunks) {
+    std::vector<nlohmann::json> evs;
+    ChatStreamParser p([&](const nlohmann::json& e) { evs.push_back(e); });
+
+    p.Feed("{\"kind\":\"delta\",\"text\":\"Ho");
+    EXPECT_TRUE(evs.empty()); // línea incompleta
+    p.Feed("la\"}\n{\"kind\":\"ops\",\"ops\":[]}\r\nbasura\n");
+    p.Feed("{\"kind\":\"done\"}");
+    p.Finish();
+
+    ASSERT_EQ(evs.size(), 3u);
+    EXPECT_EQ(evs[0]["text"], "Hola");
+    EXPECT_EQ(evs[1]["kind"], "ops");
+    EXPECT_EQ(evs[2]["kind"], "done");
+    EXPECT_EQ(p.BadLines(), 1u);
+}
+
+TEST(ChatStream, ParsesSse) {
+    std::vector<nlohmann::json> evs;
+    ChatStreamParser p([&](const nlohmann::json& e) { evs.push_back(e); });
+
+    p.Feed(": keep-alive\nevent: message\ndata: {\"kind\":\"delta\",\n");
+    p.Feed("data: \"text\":\"x\"}\n\ndata: [DONE]\n\n");
+    p.Finish();
+
+    ASSERT_EQ(evs.size(), 1u);
+    EXPECT_EQ(evs[0]["text"], "x");
+}
+
+// Server local: manda el primer evento y no sigue hasta que el cliente lo recibió,
+// así se comprueba que los eventos llegan antes de que termine la respuesta.
+TEST(ApiClient, StreamDeliversEventsBeforeResponseEnds) {
+    std::promise<void> firstSeen;
+    auto firstSeenFut = firstSeen.get_future().share();
+    bool sawFirstBeforeEnd = false;
+
+    httplib::Server svr;
+    svr.Post("/api/chat/command/stream", [&](const httplib::Request& req, httplib::Response& res) {
+        auto body = nlohmann::json::parse(req.body, nullptr, false);
+        EXPECT_EQ(body.value("prompt", ""), "hola");
+        res.set_header("X-Scene-Rev", "77");
+        res.set_chunked_content_provider("application/x-ndjson",
+            [&](size_t, httplib::DataSink& sink) {
+                const std::string a = "{\"kind\":\"delta\",\"text\":\"Creando\"}\n";
+                sink.write(a.data(), a.size());
+                sawFirstBeforeEnd =
+                    firstSeenFut.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+                const std::string b =
+                    "{\"kind\":\"ops\",\"ops\":[{\"op\":\"spawn_box\"}]}\n{\"kind\":\"done\"}\n";
+                sink.write(b.data(), b.size());
+                sink.done();
+                return true;
+            });
+    });
+    const int port = svr.bind_to_any_port("127.0.0.1");
+    ASSERT_GT(port, 0);
+    std::thread th([&] { svr.listen_after_bind(); });
+
+    std::mutex mx;
+    std::vector<std::string> kinds;
+    {
+        ApiClient c("127.0.0.1", port);
+        c.SetTimeouts(2, 10, 10);
+        auto fut = c.StreamCommandAsync("hola", nlohmann::json::object(), {}, false, nullptr,
+            [&](const nlohmann::json& ev) {
+                std::lock_guard<std::mutex> lk(mx);
+                kinds.push_back(ev.value("kind", ""));
+                if (kinds.size() == 1) firstSeen.set_value();
+            });
+        ApiClient::Result r = fut.get();
+        EXPECT_TRUE(r.ok()) << r.error;
+        ASSERT_TRUE(r.sceneRev.has_value());
+        EXPECT_EQ(*r.sceneRev, 77u);
+    }
+    svr.stop();
+    th.join();
+
+    EXPECT_TRUE(sawFirstBeforeEnd);
+    ASSERT_EQ(kinds.size(), 3u);
+    EXPECT_EQ(kinds[0], "delta");
+    EXPECT_EQ(kinds[1], "ops");
+    EXPECT_EQ(kinds[2], "done");
+}
+
+// Una excepción dentro del job (acá, del refresher de tokens) resuelve el future con
+// error y el worker sigue atendiendo la cola
+TEST(ApiClient, JobExceptionFailsFutureAndWorkerSurvives) {
+    httplib::Server svr;
+    svr.Post("/api/chat/command", [](const httplib::Request& req, httplib::Response& res) {
+        if (req.get_header_value("Authorization").empty()) res.status = 401;
+        else res.set_content("{\"ok\":true}", "application/json");
+    });
+    const int port = svr.bind_to_any_port("127.0.0.1");
+    ASSERT_GT(port, 0);
+    std::thread th([&] { svr.listen_after_bind(); });
+    {
+        ApiClient c("127.0.0.1", port);
+        c.SetTimeouts(2, 10, 10);
+        c.SetTokenRefresher([]() -> std::optional<std::string> { throw std::runtime_error("boom"); });
+
+        ApiClient::Result bad = c.SendCommandAsync("hola", nlohmann::json::object(), {}).get();
+        EXPECT_FALSE(bad.ok());
+        EXPECT_NE(bad.error.find("boom"), std::string::npos);
+
+        c.SetAccessToken("tok");
+        ApiClient::Result good = c.SendCommandAsync("hola", nlohmann::json::object(), {}).get();
+        EXPECT_TRUE(good.ok()) << good.error;
+    }
+    svr.stop();
+    th.join();
+}
+
+// Descarga binaria: el archivo queda en destino sólo si el SHA-256 coincide
+TEST(ApiClient, DownloadAssetVerifiesHash) {
+    std::string png(200 * 1024, '\0');
+    for (size_t i = 0; i < png.size(); ++i) png[i] = static_cast<char>(i * 31);
+    const std::string sha = picosha2::hash256_hex_string(png);
+
+    httplib::Server svr;
+    svr.Get(R"(/api/assets/(\w+))", [&](const httplib::Request& req, httplib::Response& res) {
+        if (req.matches[1] == sha) res.set_content(png, "image/png");
+        else                       res.status = 404;
+    });
+    const int port = svr.bind_to_any_port("127.0.0.1");
+    ASSERT_GT(port, 0);
+    std::thread th([&] { svr.listen_after_bind(); });
+
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "gp_download_test";
+    fs::remove_all(dir);
+    const std::string dest = (dir / "a.png").string();
+    {
+        ApiClient c("127.0.0.1", port);
+        c.SetTimeouts(2, 10, 10);
+
+        ApiClient::DownloadResult ok = c.DownloadAssetAsync(sha, dest, sha).get();
+        EXPECT_TRUE(ok.ok) << ok.error;
+        EXPECT_EQ(ok.bytes, png.size());
+        EXPECT_EQ(ok.sha256, sha);
+        std::ifstream in(dest, std::ios::binary);
+        const std::string got((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(got, png);
+
+        // Mismo hash ya en disco: no vuelve a bajar
+        EXPECT_TRUE(c.DownloadAssetAsync(sha, dest, sha).get().cached);
+
+        // Hash esperado distinto: no deja nada a medias
+        const std::string other = (dir / "b.png").string();
+        ApiClient::DownloadResult bad = c.DownloadAssetAsync(sha, other, std::string(64, '0')).get();
+        EXPECT_FALSE(bad.ok);
+        EXPECT_FALSE(fs::exists(other));
+        EXPECT_FALSE(fs::exists(other + ".part"));
+    }
+    svr.stop();
+    th.join();
+    fs::remove_all(dir);
+}
+
+// Con N workers y N+1 requests lentas, nunca hay más de N en el server a la vez y la
+// que esperó en la cola igual se atiende
+TEST(ApiClient, QueueBoundsConcurrency) {
+    std::atomic<int> inFlight{ 0 }, peak{ 0 }, calls{ 0 };
+    httplib::Server svr;
+    svr.Post("/api/chat/command", [&](const httplib::Request&, httplib::Response& res) {
+        const int now = ++inFlight;
+        for (int p = peak.load(); now > p && !peak.compare_exchange_weak(p, now);) {}
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        ++calls;
+        --inFlight;
+        res.set_content("{\"ok\":true}", "application/json");
+    });
+    const int port = svr.bind_to_any_port("127.0.0.1");
+    ASSERT_GT(port, 0);
+    std::thread th([&] { svr.listen_after_bind(); });
+    {
+        ApiClient c("127.0.0.1", port);
+        c.SetTimeouts(2, 10, 10);
+        c.SetMaxConcurrency(2);
+        std::vector<std::future<ApiClient::Result>> futs;
+        for (int i = 0; i < 3; ++i) futs.push_back(c.SendCommandAsync("hola", nlohmann::json::object(), {}));
+        for (auto& f : futs) {
+            ApiClient::Result r = f.get();
+            EXPECT_TRUE(r.ok()) << r.error;
+        }
+    }
+    svr.stop();
+    th.join();
+
+    EXPECT_EQ(calls.load(), 3);
+    EXPECT_LE(peak.load(), 2);
+}
+
+// Cancelar una request que todavía está en la cola: se resuelve como cancelada y nunca
+// llega al server
+TEST(ApiClient, CancelQueuedJobNeverRuns) {
+    std::promise<void> release;
+    auto releaseFut = release.get_future().share();
+    std::atomic<int> calls{ 0 };
+    httplib::Server svr;
+    svr.Post("/api/chat/command", [&](const httplib::Request&, httplib::Response& res) {
+        ++calls;
+        releaseFut.wait_for(std::chrono::seconds(5));
+        res.set_content("{\"ok\":true}", "application/json");
+    });
+    const int port = svr.bind_to_any_port("127.0.0.1");
+    ASSERT_GT(port, 0);
+    std::thread th([&] { svr.listen_after_bind(); });
+    {
+        ApiClient c("127.0.0.1", port);
+        c.SetTimeouts(2, 10, 10);
+        c.SetMaxConcurrency(1);
+        auto first = c.SendCommandAsync("hola", nlohmann::json::object(), {});
+        auto token = ApiClient::MakeCancelToken();
+        auto queued = c.SendCommandAsync("hola", nlohmann::json::object(), {}, false, token);
+        *token = true; // el único worker sigue ocupado con 'first'
+        release.set_value();
+
+        ApiClient::Result r1 = first.get();
+        EXPECT_TRUE(r1.ok()) << r1.error;
+        ApiClient::Result r2 = queued.get();
+        EXPECT_TRUE(r2.cancelled);
+        EXPECT_FALSE(r2.ok());
+    }
+    svr.stop();
+    th.join();
+
+    EXPECT_EQ(calls.load(), 1);
+}
+
+// Cancelar una request en vuelo: el progress callback de curl la aborta y el future se
+// resuelve sin esperar la respuesta del server
+TEST(ApiClient, CancelRunningJobCompletesFuture) {
+    std::promise<void> entered, release;
+    auto releaseFut = release.get_future().share();
+    httplib::Server svr;
+    svr.Post("/api/chat/command", [&](const httplib::Request&, httplib::Response& res) {
+        entered.set_value();
+        releaseFut.wait_for(std::chrono::seconds(10));
+        res.set_content("{\"ok\":true}", "application/json");
+    });
+    const int port = svr.bind_to_any_port("127.0.0.1");
+    ASSERT_GT(port, 0);
+    std::thread th([&] { svr.listen_after_bind(); });
+    {
+        ApiClient c("127.0.0.1", port);
+        c.SetTimeouts(2, 20, 20);
+        auto token = ApiClient::MakeCancelToken();
+        auto fut = c.SendCommandAsync("hola", nlohmann::json::object(), {}, false, token);
+        EXPECT_EQ(entered.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+
+        *token = true;
+        const bool done = fut.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+        release.set_value(); // antes de cualquier fallo: el handler no puede quedar colgado
+        EXPECT_TRUE(done);
+        if (done) {
+            ApiClient::Result r = fut.get();
+            EXPECT_TRUE(r.cancelled);
+            EXPECT_FALSE(r.ok());
+        }
+    }
+    svr.stop();
+    th.join();
+}
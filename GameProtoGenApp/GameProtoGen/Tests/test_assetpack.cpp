@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "Runtime/AssetPack.h"
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+// Escribir y montar: nombres con el mismo contenido comparten blob, los blobs quedan
+// alineados y lo crudo se lee sin copiar desde el mapeo
+TEST(AssetPack, RoundTripDedupAndAlignment) {
+    const fs::path file = fs::temp_directory_path() / "gp_assetpack_test.gppak";
+    const std::string pixels(16 * 8 * 4, '\x7f');
+    const std::string text(5000, 'a'); // comprimible (si hay zlib)
+
+    AssetPack::Writer w;
+    ASSERT_TRUE(w.Open(file.string())) << w.Error();
+    ASSERT_TRUE(w.Add("scene.json", "{\"entities\":[]}", AssetPack::Kind::Raw, 0, 0, false));
+    ASSERT_TRUE(w.Add("Assets/Generated/a.png", pixels, AssetPack::Kind::Rgba8, 16, 8));
+    ASSERT_TRUE(w.Add("Assets\\Generated\\b.png", pixels, AssetPack::Kind::Rgba8, 16, 8));
+    ASSERT_TRUE(w.Add("Assets/Scripts/c.lua", text));
+    ASSERT_TRUE(w.Finish()) << w.Error();
+
+    ASSERT_TRUE(AssetPack::Mount(file.string()));
+    const AssetPack::Entry* a = AssetPack::Find("Assets/Generated/a.png");
+    const AssetPack::Entry* b = AssetPack::Find("Assets/Generated/b.png");
+    ASSERT_TRUE(a && b);
+    EXPECT_EQ(a->index, b->index);
+    EXPECT_EQ(a->kind, AssetPack::Kind::Rgba8);
+    EXPECT_EQ(a->width, 16u);
+    EXPECT_EQ(a->offset % AssetPack::kAlign, 0u);
+    EXPECT_EQ(AssetPack::Find("Assets/Generated/missing.png"), nullptr);
+
+    std::string scratch;
+    std::string_view view;
+    const AssetPack::Entry* sc = AssetPack::Find("scene.json");
+    ASSERT_TRUE(sc && AssetPack::Read(*sc, scratch, view));
+    EXPECT_EQ(view, "{\"entities\":[]}");
+    EXPECT_TRUE(scratch.empty()); // vista directa al mapeo
+
+    std::string copy;
+    ASSERT_TRUE(AssetPack::ReadCopy("Assets/Scripts/c.lua", copy));
+    EXPECT_EQ(copy, text);
+    ASSERT_TRUE(AssetPack::ReadCopy("Assets/Generated/b.png", copy));
+    EXPECT_EQ(copy, pixels);
+
+    AssetPack::Unmount();
+    EXPECT_FALSE(AssetPack::Mounted());
+    EXPECT_EQ(AssetPack::Find("scene.json"), nullptr);
+    fs::remove(file);
+}
+
+// Archivo que no es un pack (o truncado): no monta
+TEST(AssetPack, RejectsGarbage) {
+    const fs::path file = fs::temp_directory_path() / "gp_assetpack_garbage.gppak";
+    AssetPack::Writer w;
+    ASSERT_TRUE(w.Open(file.string()));
+    ASSERT_TRUE(w.Add("x", std::string(1000, 'x'), AssetPack::Kind::Raw, 0, 0, false));
+    ASSERT_TRUE(w.Finish());
+    fs::resize_file(file, 600); // corta el blob y el índice
+
+    EXPECT_FALSE(AssetPack::Mount(file.string()));
+    EXPECT_FALSE(AssetPack::Mounted());
+    fs::remove(file);
+}
+
+// Rgba8: mismos bytes con otro tamaño no se deduplican, y un índice cuyo width/height no
+// cierra con los bytes no monta
+TEST(AssetPack, Rgba8SizeIsChecked) {
+    const fs::path file = fs::temp_directory_path() / "gp_assetpack_rgba8.gppak";
+    const std::string pixels(16 * 8 * 4, '\x10');
+
+    AssetPack::Writer w;
+    ASSERT_TRUE(w.Open(file.string()));
+    ASSERT_TRUE(w.Add("wide.png", pixels, AssetPack::Kind::Rgba8, 16, 8, false));
+    ASSERT_TRUE(w.Add("tall.png", pixels, AssetPack::Kind::Rgba8, 8, 16, false));
+    EXPECT_FALSE(w.Add("bad.png", pixels, AssetPack::Kind::Rgba8, 16, 16, false));
+    EXPECT_FALSE(w.Error().empty());
+    ASSERT_TRUE(w.Finish()) << w.Error();
+
+    ASSERT_TRUE(AssetPack::Mount(file.string()));
+    const AssetPack::Entry* wide = AssetPack::Find("wide.png");
+    const AssetPack::Entry* tall = AssetPack::Find("tall.png");
+    ASSERT_TRUE(wide && tall);
+    EXPECT_NE(wide->index, tall->index);
+    EXPECT_EQ(tall->width, 8u);
+    EXPECT_EQ(AssetPack::Find("bad.png"), nullptr);
+    AssetPack::Unmount();
+
+    // Mismo largo de índice, otro width: 16x8 -> 61x8
+    std::string bytes;
+    {
+        std::ifstream in(file, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const auto at = bytes.rfind("\"width\":16");
+    ASSERT_NE(at, std::string::npos);
+    bytes.replace(at, 11, "\"width\":61");
+    {
+        std::ofstream out(file, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    EXPECT_FALSE(AssetPack::Mount(file.string()));
+    fs::remove(file);
+}
+
+// Índice con campos de otro tipo (mismo largo, el header sigue valiendo): no monta
+TEST(AssetPack, RejectsCorruptIndex) {
+    const fs::path file = fs::temp_directory_path() / "gp_assetpack_corrupt.gppak";
+    const std::string pixels(10 * 10 * 4, '\x20');
+
+    AssetPack::Writer w;
+    ASSERT_TRUE(w.Open(file.string()));
+    ASSERT_TRUE(w.Add("tile.png", pixels, AssetPack::Kind::Rgba8, 10, 10, false));
+    ASSERT_TRUE(w.Finish()) << w.Error();
+
+    std::string original;
+    {
+        std::ifstream in(file, std::ios::binary);
+        original.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto mountWith = [&](const std::string& from, const std::string& to) {
+        std::string bytes = original;
+        const auto at = bytes.rfind(from);
+        EXPECT_TRUE(at != std::string::npos && from.size() == to.size()) << from;
+        if (at == std::string::npos || from.size() != to.size()) return true;
+        bytes.replace(at, from.size(), to);
+        {
+            std::ofstream out(file, std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        const bool ok = AssetPack::Mount(file.string());
+        AssetPack::Unmount();
+        return ok;
+    };
+
+    EXPECT_TRUE(mountWith("\"width\":10", "\"width\":10"));      // sin cambios monta
+    EXPECT_FALSE(mountWith("\"width\":10", "\"width\":\"\""));   // string
+    EXPECT_FALSE(mountWith("\"height\":10", "\"height\":[]"));   // array
+    EXPECT_FALSE(mountWith("\"tile.png\":0", "\"tile.p\":\"0\"")); // índice de nombre -> string
+    EXPECT_FALSE(mountWith("[{\"codec\"", "[1,{\"cod\""));          // blob que no es objeto
+    fs::remove(file);
+}
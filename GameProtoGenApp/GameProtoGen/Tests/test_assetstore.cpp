@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include "Runtime/AssetStore.h"
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace fs = std::filesystem;
+
+// Mismo contenido bajo dos nombres: un solo blob, ambos nombres resuelven a él
+TEST(AssetStore, DeduplicatesByContent) {
+    const fs::path root = fs::temp_directory_path() / "gp_assetstore_test";
+    fs::remove_all(root);
+    AssetStore::SetRoot(root.generic_string());
+
+    const std::string a = AssetStore::Put("Assets/Generated/a.png", "PNGDATA");
+    const std::string b = AssetStore::Put("Assets/Generated/b.png", "PNGDATA");
+    const std::string c = AssetStore::Put("Assets/Scripts/c.lua", "print(1)");
+    ASSERT_EQ(a.size(), 64u);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+
+    EXPECT_EQ(AssetStore::Resolve("Assets/Generated/a.png"), AssetStore::Resolve("Assets/Generated/b.png"));
+    EXPECT_EQ(AssetStore::Resolve("Assets/Generated/a.png"), AssetStore::BlobPath(a, "x.png"));
+    EXPECT_EQ(AssetStore::Resolve("Assets/Manual/hand.png"), "Assets/Manual/hand.png"); // no indexado
+    EXPECT_EQ(AssetStore::HashOf("Assets\\Generated\\b.png"), a);
+
+    std::size_t blobs = 0;
+    for (const auto& e : fs::directory_iterator(root))
+        if (e.path().filename() != "index.json") ++blobs;
+    EXPECT_EQ(blobs, 2u);
+
+    // El índice persiste
+    AssetStore::SetRoot(root.generic_string());
+    EXPECT_EQ(AssetStore::HashOf("Assets/Scripts/c.lua"), c);
+
+    // Export: sólo los nombres pedidos
+    const fs::path sub = root / "export" / "index.json";
+    ASSERT_TRUE(AssetStore::WriteIndex({ "Assets/Generated/b.png", "Assets/Manual/hand.png" }, sub.string()));
+    std::ifstream in(sub);
+    const auto j = nlohmann::json::parse(in);
+    EXPECT_EQ(j.size(), 1u);
+    EXPECT_TRUE(j.contains("Assets/Generated/b.png"));
+
+    AssetStore::SetRoot("Assets/Store");
+    fs::remove_all(root);
+}
@@ -2,6 +2,10 @@
 #include <gtest/gtest.h>
 #include "Runtime/GameRunner.h"
 #include "ECS/Scene.h"
+#include "Systems/ScriptSystem.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
 
 TEST(GameRunner, SystemsOrderStable) {
     Scene s;
@@ -13,3 +17,61 @@ TEST(GameRunner, SystemsOrderStable) {
     GameRunner::Step(s, 0.016f);
     SUCCEED(); // Al menos smoke: no crash y orden fijo en el código.
 }
+
+// Hot-reload: el chunk nuevo corre en el mismo environment (el contador sigue, on_spawn
+// no se repite) y se llama a on_reload
+TEST(GameRunner, ReloadScriptKeepsState) {
+    const auto file = std::filesystem::temp_directory_path() / "gp_hotreload_test.lua";
+    auto write = [&](int step) {
+        std::ofstream(file) <<
+            "count = count or 0; spawns = spawns or 0; reloads = reloads or 0\n"
+            "function on_spawn() spawns = spawns + 1 end\n"
+            "function on_reload() reloads = reloads + 1 end\n"
+            "function on_update(dt)\n"
+            "  count = count + " << step << "\n"
+            "  ecs.set(this_id, 'Transform', { position = { x = count, y = spawns * 10 + reloads } })\n"
+            "end\n";
+    };
+    write(1);
+
+    Scene s;
+    auto e = s.CreateEntity();
+    s.transforms[e.id] = Transform{ {0,0},{1,1},0 };
+    s.scripts[e.id] = Script{ file.generic_string() };
+    GameRunner::EnterPlay(s);
+    GameRunner::Step(s, 0.016f);
+    GameRunner::Step(s, 0.016f);
+    EXPECT_FLOAT_EQ(s.transforms.at(e.id).position.x, 2.f);
+
+    write(10);
+    EXPECT_EQ(Systems::ScriptSystem::ReloadScript(s, file.generic_string()), 1);
+    GameRunner::Step(s, 0.016f);
+    EXPECT_FLOAT_EQ(s.transforms.at(e.id).position.x, 12.f);
+    EXPECT_FLOAT_EQ(s.transforms.at(e.id).position.y, 11.f);
+
+    GameRunner::ExitPlay(s);
+    std::filesystem::remove(file);
+}
+
+// gameReset() desde on_update reemplaza scene.scripts en medio de ScriptSystem::Update:
+// el frame termina ahí en vez de seguir recorriendo el pool viejo
+TEST(GameRunner, ResetFromUpdateStopsIteration) {
+    Scene s;
+    for (int i = 0; i < 8; ++i) {
+        auto e = s.CreateEntity();
+        s.transforms[e.id] = Transform{ {0,0},{1,1},0 };
+        Script sc;
+        sc.inlineCode = "function on_update(dt) gameReset() end";
+        s.scripts[e.id] = sc;
+    }
+    GameRunner::SetResetSnapshot(std::make_shared<const Scene>(s));
+    GameRunner::EnterPlay(s);
+    GameRunner::Step(s, 0.016f);
+    GameRunner::Step(s, 0.016f);
+
+    EXPECT_EQ(s.scripts.size(), 8u);
+    for (const auto& [id, sc] : std::as_const(s.scripts)) EXPECT_FALSE(sc.loaded); // recién reseteada
+
+    GameRunner::SetResetSnapshot(nullptr);
+    GameRunner::ExitPlay(s);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include "Systems/LuaAllocator.h"
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    void* Call(LuaAllocator& a, void* p, std::size_t osize, std::size_t nsize) {
+        return LuaAllocator::Alloc(&a, p, osize, nsize);
+    }
+}
+
+// Bloques chicos: alineados, reciclados por clase, y la cuenta de uso cierra en cero
+TEST(LuaAllocator, SmallBlocksAreRecycledPerClass) {
+    LuaAllocator a;
+    void* p = Call(a, nullptr, 5 /* tipo de objeto */, 40);
+    void* q = Call(a, nullptr, 0, 40);
+    ASSERT_TRUE(p && q);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % LuaAllocator::kGranule, 0u);
+    EXPECT_EQ(a.Used(), 80u);
+    EXPECT_EQ(a.Reserved(), LuaAllocator::kPageSize);
+
+    Call(a, p, 40, 0);
+    EXPECT_EQ(Call(a, nullptr, 0, 33), p); // misma clase (48): reusa el bloque liberado
+    EXPECT_EQ(Call(a, q, 40, 48), q);      // crecer dentro de la clase no mueve
+
+    Call(a, p, 33, 0);
+    Call(a, q, 48, 0);
+    EXPECT_EQ(a.Used(), 0u);
+    EXPECT_EQ(a.Peak(), 81u);
+}
+
+// Cambiar de clase o pasar a malloc conserva el contenido
+TEST(LuaAllocator, ReallocKeepsContents) {
+    LuaAllocator a;
+    char* p = static_cast<char*>(Call(a, nullptr, 0, 24));
+    std::memcpy(p, "0123456789abcdefghijklm", 24);
+
+    p = static_cast<char*>(Call(a, p, 24, 4096));  // chico -> grande
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(std::memcmp(p, "0123456789abcdefghijklm", 24), 0);
+    p = static_cast<char*>(Call(a, p, 4096, 100)); // grande -> chico
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(std::memcmp(p, "0123456789abcdefghijklm", 24), 0);
+    EXPECT_EQ(a.Used(), 100u);
+    Call(a, p, 100, 0);
+}
+
+// Con límite, crecer falla (y se cuenta); achicar y liberar siguen andando
+TEST(LuaAllocator, HardLimitRejectsGrowthOnly) {
+    LuaAllocator a;
+    a.SetLimit(1000);
+    void* p = Call(a, nullptr, 0, 800);
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(Call(a, nullptr, 0, 300), nullptr);
+    EXPECT_EQ(Call(a, p, 800, 1200), nullptr);
+    EXPECT_EQ(a.Failures(), 2u);
+    EXPECT_EQ(a.Used(), 800u);
+
+    p = Call(a, p, 800, 100);
+    ASSERT_NE(p, nullptr);
+    EXPECT_NE(Call(a, nullptr, 0, 300), nullptr); // ahora entra
+    EXPECT_EQ(a.Used(), 400u);
+}
+
+// Sin Enforce (el host pidiendo fuera de un script) el límite no rechaza nada; con
+// reserva, los pedidos bajo Enforce topan antes
+TEST(LuaAllocator, LimitOnlyWhileEnforced) {
+    LuaAllocator a;
+    a.SetLimit(1000);
+    a.SetReserve(200);
+    EXPECT_EQ(Call(a, nullptr, 0, 900), nullptr); // 900 > 1000 - 200
+    void* p = Call(a, nullptr, 0, 700);
+    ASSERT_NE(p, nullptr);
+
+    a.Enforce(false);
+    void* q = Call(a, nullptr, 0, 600);
+    ASSERT_NE(q, nullptr);
+    EXPECT_EQ(a.Used(), 1300u);
+    EXPECT_EQ(a.Failures(), 1u);
+
+    a.Enforce(true);
+    EXPECT_EQ(Call(a, nullptr, 0, 16), nullptr);
+    Call(a, q, 600, 0);
+    Call(a, p, 700, 0);
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "Systems/RenderQueue.h"
+#include <random>
+
+static Entity AddSprite(Scene& s, sf::Vector2f pos) {
+    Entity e = s.CreateEntity();
+    s.transforms[e.id] = Transform{ pos, {1,1}, 0 };
+    s.sprites[e.id] = Sprite{ { 32.f, 32.f }, sf::Color::White };
+    return e;
+}
+
+static std::vector<EntityID> DynamicIds(const RenderQueue& q) {
+    std::vector<EntityID> ids;
+    for (const auto& item : q.Dynamic()) ids.push_back(item.id);
+    return ids;
+}
+
+// Lo que dibuja Renderer2D, aplanado: chunks estáticos intercalados con lo dinámico
+static std::vector<EntityID> DrawOrder(const RenderQueue& q) {
+    std::vector<EntityID> ids;
+    q.ForEachInDrawOrder([&](const RenderQueue::Item& item) { ids.push_back(item.id); },
+                         [&](const RenderQueue::Chunk& ch) { for (const auto& m : ch.members) ids.push_back(m.id); });
+    return ids;
+}
+
+// Capa, después z; sin RenderLayer manda el orden de creación. Tiles estáticos van a chunks.
+TEST(RenderQueue, OrdersByLayerThenZ) {
+    Scene s;
+    const Entity bg = AddSprite(s, { 0.f, 0.f });
+    const Entity player = AddSprite(s, { 0.f, 0.f });
+    const Entity fx = AddSprite(s, { 0.f, 0.f });
+    const Entity tile = AddSprite(s, { 600.f, 0.f });
+    s.colliders[tile.id] = Collider{};
+    s.physics[player.id] = Physics2D{};
+    s.colliders[player.id] = Collider{};
+
+    RenderQueue q;
+    q.Sync(s);
+    EXPECT_EQ(DynamicIds(q), (std::vector<EntityID>{ bg.id, player.id, fx.id }));
+    ASSERT_EQ(q.StaticRuns().size(), 1u);
+    EXPECT_EQ(q.StaticRuns().begin()->second.size(), 1u);
+
+    s.renderLayers[bg.id] = RenderLayer{ -1, 0.f };
+    s.renderLayers[fx.id] = RenderLayer{ 0, -5.f };
+    q.Sync(s);
+    EXPECT_EQ(DynamicIds(q), (std::vector<EntityID>{ bg.id, fx.id, player.id }));
+
+    // Al tile le sacan el collider estático: pasa a la lista dinámica
+    s.physics[tile.id] = Physics2D{};
+    q.Sync(s);
+    EXPECT_TRUE(q.StaticRuns().empty());
+    EXPECT_EQ(DynamicIds(q), (std::vector<EntityID>{ bg.id, fx.id, player.id, tile.id }));
+}
+
+// Tras ediciones al azar (capas, texturas, altas, bajas) la lista incremental es
+// idéntica a una reconstruida desde cero; iterar physics no la invalida.
+TEST(RenderQueue, IncrementalMatchesRebuild) {
+    Scene s;
+    std::mt19937 rng(7);
+    std::vector<EntityID> ids;
+    for (int i = 0; i < 300; ++i) {
+        const Entity e = AddSprite(s, { (float)(i % 20) * 64.f, (float)(i / 20) * 64.f });
+        if (i % 3 == 0) s.colliders[e.id] = Collider{};
+        if (i % 7 == 0) s.physics[e.id] = Physics2D{};
+        ids.push_back(e.id);
+    }
+
+    RenderQueue q;
+    q.Sync(s);
+    for (int frame = 0; frame < 50; ++frame) {
+        for (int k = 0; k < 10; ++k) {
+            const EntityID id = ids[rng() % ids.size()];
+            switch (rng() % 6) {
+            case 0: s.renderLayers[id] = RenderLayer{ (int)(rng() % 3) - 1, (float)(rng() % 4) }; break;
+            case 1: s.textures[id] = Texture2D{ "t" + std::to_string(rng() % 3) + ".png" }; break;
+            case 2: s.transforms[id].position.x += 700.f; break;
+            case 3: s.colliders.erase(id); break;
+            case 4: s.DestroyEntity(Entity{ id }); break;
+            case 5: ids.push_back(AddSprite(s, { (float)(rng() % 2000), 0.f }).id); break;
+            }
+        }
+        for (auto& [id, ph] : s.physics) ph.velocity.x += 1.f; // como PhysicsSystem en Play
+        q.Sync(s);
+    }
+
+    RenderQueue fresh;
+    fresh.Rebuild(s);
+    EXPECT_EQ(DynamicIds(q), DynamicIds(fresh));
+    EXPECT_EQ(DrawOrder(q), DrawOrder(fresh));
+    ASSERT_EQ(q.StaticRuns().size(), fresh.StaticRuns().size());
+    for (const auto& [run, cells] : fresh.StaticRuns()) {
+        ASSERT_TRUE(q.StaticRuns().count(run));
+        const auto& mine = q.StaticRuns().at(run);
+        ASSERT_EQ(mine.size(), cells.size());
+        for (const auto& [cell, ch] : cells) {
+            ASSERT_TRUE(mine.count(cell));
+            std::vector<EntityID> a, b;
+            for (const auto& it : mine.at(cell).members) a.push_back(it.id);
+            for (const auto& it : ch.members) b.push_back(it.id);
+            EXPECT_EQ(a, b);
+        }
+    }
+}
+
+// Hornear no cambia el orden: un fondo sin Collider (dinámico) creado antes que el
+// suelo queda debajo; cada estática se dibuja entre las dinámicas que la rodean.
+TEST(RenderQueue, StaticRunsKeepCreationOrder) {
+    Scene s;
+    const Entity bg = AddSprite(s, { 0.f, 0.f });
+    const Entity ground = AddSprite(s, { 600.f, 0.f });
+    s.colliders[ground.id] = Collider{};
+    const Entity rock = AddSprite(s, { 0.f, 0.f }); // celda menor que el suelo, creada después
+    s.colliders[rock.id] = Collider{};
+    const Entity player = AddSprite(s, { 0.f, 0.f });
+    const Entity wall = AddSprite(s, { 0.f, 0.f });
+    s.colliders[wall.id] = Collider{};
+
+    RenderQueue q;
+    q.Sync(s);
+    EXPECT_EQ(DrawOrder(q), (std::vector<EntityID>{ bg.id, rock.id, ground.id, player.id, wall.id }));
+    ASSERT_EQ(q.StaticRuns().size(), 2u);
+
+    // Un spawn nuevo va arriba de todo; el jugador pasa al fondo de la capa y las
+    // tres estáticas quedan en una sola corrida (por celda: rock y wall, después ground)
+    const Entity bullet = AddSprite(s, { 0.f, 0.f });
+    s.renderLayers[player.id] = RenderLayer{ 0, -1.f };
+    q.Sync(s);
+    EXPECT_EQ(DrawOrder(q), (std::vector<EntityID>{ player.id, bg.id, rock.id, wall.id, ground.id, bullet.id }));
+    EXPECT_EQ(q.StaticRuns().size(), 1u);
+
+    s.DestroyEntity(bg);
+    q.Sync(s);
+    EXPECT_EQ(DrawOrder(q), (std::vector<EntityID>{ player.id, rock.id, wall.id, ground.id, bullet.id }));
+
+    RenderQueue fresh;
+    fresh.Rebuild(s);
+    EXPECT_EQ(DrawOrder(q), DrawOrder(fresh));
+}
+
+// Entre chunks de una misma corrida manda la z de RenderLayer, no la celda
+TEST(RenderQueue, StaticRunsFollowZ) {
+    Scene s;
+    const Entity hero = AddSprite(s, { 0.f, 0.f });
+    const Entity top = AddSprite(s, { 0.f, 0.f });
+    const Entity mid = AddSprite(s, { 600.f, 0.f });
+    const Entity low = AddSprite(s, { 1200.f, 0.f });
+    for (const Entity& e : { top, mid, low }) s.colliders[e.id] = Collider{};
+    s.renderLayers[top.id] = RenderLayer{ 0, 2.f };
+    s.renderLayers[mid.id] = RenderLayer{ 0, 1.f };
+    s.renderLayers[hero.id] = RenderLayer{ 0, 1.5f };
+
+    RenderQueue q;
+    q.Sync(s);
+    EXPECT_EQ(DrawOrder(q), (std::vector<EntityID>{ low.id, mid.id, hero.id, top.id }));
+
+    s.renderLayers[low.id] = RenderLayer{ 0, 3.f };
+    q.Sync(s);
+    EXPECT_EQ(DrawOrder(q), (std::vector<EntityID>{ mid.id, hero.id, top.id, low.id }));
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "Editor/ResponsePipeline.h"
+#include "Runtime/AssetStore.h"
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+// Ops válidas pasan tipadas; una op con tipos rotos se descarta sin tirar el resto
+TEST(ResponsePipeline, PreparesOpsAndSkipsInvalid) {
+    const json resp = {
+        {"kind", "ops"},
+        {"ops", json::array({
+            {{"op", "spawn_box"}, {"pos", {10, 20}}, {"size", {32, 16}}, {"colorHex", "#FF0000"}},
+            {{"op", "set_transform"}, {"entity", 7}, {"position", "no-es-un-array"}},
+            {{"op", "set_component"}, {"entity", 7}, {"component", "Sprite"}, {"value", {{"size", {4, 5}}}}},
+            {{"op", "remove_entity"}, {"entity", 3}},
+            {{"op", "set_component"}, {"entity", 7}, {"component", "PlayerController"}, {"value", {{"moveSpeed", 300}}}},
+            {{"op", "set_component"}, {"entity", 7}, {"component", "NoExiste"}, {"value", json::object()}},
+            {{"op", "desconocida"}}
+        })}
+    };
+
+    const PreparedResponse pr = ResponsePipeline::Prepare(resp);
+    ASSERT_EQ(pr.ops.size(), 4u);
+    EXPECT_EQ(pr.skippedOps, 1);
+
+    EXPECT_EQ(pr.ops[0].kind, PreparedOp::Kind::SpawnBox);
+    EXPECT_FLOAT_EQ(pr.ops[0].pos.x, 10.f);
+    EXPECT_FLOAT_EQ(pr.ops[0].size.y, 16.f);
+    EXPECT_EQ(pr.ops[0].color.r, 255);
+
+    EXPECT_EQ(pr.ops[1].kind, PreparedOp::Kind::SetSprite);
+    EXPECT_EQ(pr.ops[1].id, 7u);
+    ASSERT_TRUE(pr.ops[1].newSize.has_value());
+    EXPECT_FLOAT_EQ(pr.ops[1].newSize->y, 5.f);
+
+    EXPECT_EQ(pr.ops[2].kind, PreparedOp::Kind::RemoveEntity);
+    EXPECT_EQ(pr.ops[2].id, 3u);
+
+    // Componentes sin op dedicada: por reflexión (TypeId resuelto en el worker)
+    EXPECT_EQ(pr.ops[3].kind, PreparedOp::Kind::SetComponent);
+    EXPECT_EQ(pr.ops[3].component, Reflect::TypeIdOf<PlayerController>);
+    Scene scene;
+    ASSERT_TRUE(Reflect::PatchFromJson(scene, pr.ops[3].component, 7, pr.ops[3].value));
+    EXPECT_FLOAT_EQ(scene.playerControllers.at(7).moveSpeed, 300.f);
+    EXPECT_FLOAT_EQ(scene.playerControllers.at(7).jumpSpeed, PlayerController{}.jumpSpeed);
+}
+
+// Bundle: scripts se guardan antes de preparar las ops; el worker devuelve en orden
+TEST(ResponsePipeline, BundleWritesScriptsOffThread) {
+    const fs::path root = fs::temp_directory_path() / "gp_pipeline_test";
+    fs::remove_all(root);
+    AssetStore::SetRoot(root.generic_string());
+
+    ResponsePipeline pipe;
+    pipe.Submit({ {"kind", "delta"}, {"text", "hola"} });
+    pipe.Submit({
+        {"kind", "bundle"},
+        {"items", json::array({
+            {{"kind", "ops"}, {"ops", json::array({ {{"op", "remove_entity"}, {"entity", 1}} })}},
+            {{"kind", "script"}, {"fileName", "mover.lua"}, {"code", "function on_update(e, dt) end"}},
+            {{"kind", "text"}, {"message", "listo"}}
+        })}
+    });
+
+    std::vector<PreparedResponse> got;
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (got.size() < 2 && std::chrono::steady_clock::now() < until) {
+        PreparedResponse pr;
+        if (pipe.Poll(pr)) got.push_back(std::move(pr));
+        else std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(got.size(), 2u);
+    EXPECT_TRUE(pipe.Idle());
+
+    EXPECT_EQ(got[0].kind, "delta");
+    EXPECT_EQ(got[0].message, "hola");
+
+    const PreparedResponse& b = got[1];
+    EXPECT_EQ(b.kind, "bundle");
+    ASSERT_EQ(b.assignScripts.size(), 1u);
+    EXPECT_EQ(b.assignScripts[0], "Assets/Scripts/mover.lua");
+    EXPECT_TRUE(fs::exists(AssetStore::Resolve(b.assignScripts[0])));
+    ASSERT_EQ(b.ops.size(), 1u);
+    ASSERT_EQ(b.texts.size(), 1u);
+    EXPECT_EQ(b.texts[0], "listo");
+
+    AssetStore::SetRoot("Assets/Store");
+    fs::remove_all(root);
+}
@@ -0,0 +1,151 @@
+// Tests/test_scene.cpp
+#include <gtest/gtest.h>
+#include "ECS/Scene.h"
+#include "ECS/SceneDelta.h"
+
+TEST(Scene, CopyIsCopyOnWrite) {
+    Scene s;
+    auto e = s.CreateEntity();
+    s.transforms[e.id] = Transform{ {10,20},{1,1},0 };
+    s.sprites[e.id] = Sprite{ {32,32}, sf::Color::White };
+
+    Scene snap = s; // snapshot de Play
+    EXPECT_TRUE(s.transforms.IsShared());
+    EXPECT_TRUE(s.sprites.IsShared());
+
+    // La simulación sólo toca Transform: Sprite sigue compartido
+    s.transforms[e.id].position.x = 99.f;
+    EXPECT_FALSE(s.transforms.IsShared());
+    EXPECT_TRUE(s.sprites.IsShared());
+
+    const Scene& cs = s;
+    EXPECT_FLOAT_EQ(cs.transforms.at(e.id).position.x, 99.f);
+    EXPECT_FLOAT_EQ(snap.transforms.at(e.id).position.x, 10.f);
+
+    // Lecturas const no separan el pool
+    EXPECT_NE(cs.sprites.find(e.id), cs.sprites.end());
+    EXPECT_TRUE(s.sprites.IsShared());
+}
+
+// La lista de entidades también se comparte hasta que una de las dos escenas la toca
+TEST(Scene, EntityListIsCopyOnWrite) {
+    Scene s;
+    const Entity a = s.CreateEntity();
+    const Entity b = s.CreateEntity();
+
+    Scene snap = s;
+    EXPECT_EQ(&s.Entities(), &snap.Entities());
+
+    s.DestroyEntity(Entity{ 999 }); // no existe: no separa
+    EXPECT_EQ(&s.Entities(), &snap.Entities());
+
+    s.DestroyEntity(a);
+    EXPECT_NE(&s.Entities(), &snap.Entities());
+    ASSERT_EQ(s.Entities().size(), 1u);
+    EXPECT_EQ(s.Entities()[0].id, b.id);
+    EXPECT_EQ(snap.Entities().size(), 2u);
+
+    Scene moved = std::move(snap); // mover copia: el origen sigue válido
+    EXPECT_EQ(snap.Entities().size(), 2u);
+    EXPECT_EQ(moved.CreateEntity().id, 3u);
+    EXPECT_EQ(snap.Entities().size(), 2u);
+}
+
+TEST(Scene, ChangeLogKeepsRecentReaders) {
+    ComponentPool<Transform> pool;
+    pool[1] = Transform{};
+    auto live = pool.Head();
+    auto stale = pool.Head();
+
+    // Mucho más de lo que el registro retiene; 'live' lee cada tanto, 'stale' nunca
+    int seen = 0;
+    for (int i = 0; i < 5000; ++i) {
+        pool[1].position.x = (float)i;
+        if (i % 100 == 99) EXPECT_TRUE(pool.ForEachChangeSince(live, [&](EntityID) { ++seen; }));
+    }
+    EXPECT_EQ(seen, 5000);
+    EXPECT_FALSE(pool.ForEachChangeSince(stale, [](EntityID) {}));
+
+    // Editar valores o iterar no cambia quién tiene el componente
+    const auto keys = pool.KeysRevision();
+    for (auto& [id, t] : pool) t.rotationDeg = 1.f;
+    pool[1].scale = { 2.f, 2.f };
+    EXPECT_EQ(pool.KeysRevision(), keys);
+    pool[2] = Transform{};
+    EXPECT_NE(pool.KeysRevision(), keys);
+}
+
+TEST(SceneDelta, SendsOnlyChangesAfterAck) {
+    Scene s;
+    auto a = s.CreateEntity();
+    auto b = s.CreateEntity();
+    s.transforms[a.id] = Transform{ {0,0},{1,1},0 };
+    s.transforms[b.id] = Transform{ {5,5},{1,1},0 };
+
+    SceneDeltaTracker t;
+    auto p0 = t.Build(s);
+    EXPECT_FALSE(p0.isDelta);
+    EXPECT_EQ(p0.body["entities"].size(), 2u);
+
+    // Sin ack, sigue mandando completa
+    EXPECT_FALSE(t.Build(s).isDelta);
+    t.Acknowledge(42);
+
+    s.transforms[a.id].position.x = 7.f;
+    s.DestroyEntity(b);
+    auto c = s.CreateEntity();
+
+    auto p1 = t.Build(s);
+    ASSERT_TRUE(p1.isDelta);
+    EXPECT_EQ(p1.body["baseRev"].get<std::uint64_t>(), 42u);
+    ASSERT_EQ(p1.body["upserts"].size(), 2u); // a modificada + c nueva
+    EXPECT_EQ(p1.body["upserts"][0]["id"].get<EntityID>(), a.id);
+    EXPECT_EQ(p1.body["upserts"][1]["id"].get<EntityID>(), c.id);
+    ASSERT_EQ(p1.body["removed"].size(), 1u);
+    EXPECT_EQ(p1.body["removed"][0].get<EntityID>(), b.id);
+
+    t.Invalidate();
+    EXPECT_FALSE(t.Build(s).isDelta);
+}
+
+// Con base, sólo se serializa lo que tocaron los pools; si la escena se reemplaza
+// (cursores inválidos) se compara todo y el delta sigue siendo correcto
+TEST(SceneDelta, DumpsOnlyTouchedEntities) {
+    Scene s;
+    std::vector<EntityID> ids;
+    for (int i = 0; i < 100; ++i) {
+        auto e = s.CreateEntity();
+        s.transforms[e.id] = Transform{ {float(i), 0}, {1,1}, 0 };
+        ids.push_back(e.id);
+    }
+    SceneDeltaTracker t;
+    t.Build(s);
+    t.Acknowledge(1);
+
+    s.transforms[ids[10]].position.y = 3.f;
+    (void)s.transforms[ids[20]]; // acceso mutable sin cambio
+    auto p = t.Build(s);
+    ASSERT_TRUE(p.isDelta);
+    EXPECT_EQ(t.LastDumped(), 2u);
+    ASSERT_EQ(p.body["upserts"].size(), 1u);
+    EXPECT_EQ(p.body["upserts"][0]["id"].get<EntityID>(), ids[10]);
+
+    // Sin ack: el próximo delta vuelve a incluirla, más lo nuevo
+    s.transforms[ids[30]].position.y = 1.f;
+    p = t.Build(s);
+    EXPECT_EQ(p.body["upserts"].size(), 2u);
+    t.Acknowledge(2);
+    EXPECT_EQ(t.Build(s).body["upserts"].size(), 0u);
+    t.Acknowledge(3);
+
+    Scene other = s;
+    other.transforms[ids[5]].position.x = -1.f;
+    other.DestroyEntity(Entity{ ids[6] });
+    s = other;
+    p = t.Build(s);
+    EXPECT_EQ(t.LastDumped(), 99u);
+    ASSERT_EQ(p.body["upserts"].size(), 1u);
+    EXPECT_EQ(p.body["upserts"][0]["id"].get<EntityID>(), ids[5]);
+    ASSERT_EQ(p.body["removed"].size(), 1u);
+    EXPECT_EQ(p.body["removed"][0].get<EntityID>(), ids[6]);
+}
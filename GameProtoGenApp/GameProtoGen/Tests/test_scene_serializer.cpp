@@ -1,8 +1,10 @@
 // Tests/test_scene_serializer.cpp
 #include <gtest/gtest.h>
 #include <filesystem>
+#include <limits>
 #include "ECS/Scene.h"
 #include "ECS/SceneSerializer.h"
+#include "ECS/ComponentReflection.h"
 
 TEST(SceneSerializer, RoundTrip) {
     Scene s;
@@ -23,3 +25,58 @@ TEST(SceneSerializer, RoundTrip) {
     EXPECT_FLOAT_EQ(it->second.position.x, 10.f);
     EXPECT_FLOAT_EQ(it->second.scale.y, 3.f);
 }
+
+// El formato generado por reflexión es el histórico: vec2 [x,y], color {r,g,b,a},
+// strings vacíos y estado de runtime fuera
+TEST(SceneSerializer, ReflectedFormat) {
+    Scene s;
+    auto e = s.CreateEntity();
+    s.transforms[e.id] = Transform{ {1,2},{1,1},45 };
+    s.sprites[e.id] = Sprite{ {8,4}, sf::Color(10,20,30,40) };
+    s.physics[e.id] = Physics2D{ .velocity = {5,6}, .onGround = true };
+    s.textures[e.id] = Texture2D{};
+    s.scripts[e.id] = Script{ "Assets/Scripts/a.lua", "", true };
+
+    const auto je = SceneSerializer::DumpEntity(s, e.id);
+    EXPECT_EQ(je["Transform"]["position"], nlohmann::json({ 1.f, 2.f }));
+    EXPECT_FLOAT_EQ(je["Transform"]["rotation"].get<float>(), 45.f);
+    EXPECT_EQ(je["Sprite"]["color"]["a"].get<int>(), 40);
+    EXPECT_FALSE(je["Physics2D"].contains("onGround"));
+    EXPECT_FALSE(je.contains("Texture2D"));
+    EXPECT_EQ(je["Script"], nlohmann::json({ {"path", "Assets/Scripts/a.lua"} }));
+
+    Scene s2;
+    ASSERT_TRUE(SceneSerializer::LoadFromJson(s2, { {"entities", nlohmann::json::array({ je })} }));
+    EXPECT_FALSE(s2.physics.at(e.id).onGround);
+    EXPECT_FALSE(s2.scripts.at(e.id).loaded);
+    EXPECT_EQ(s2.sprites.at(e.id).color, sf::Color(10, 20, 30, 40));
+    EXPECT_EQ(SceneSerializer::DumpEntity(s2, e.id), je);
+
+    static_assert(Reflect::IdOf("PlayerController") == Reflect::TypeIdOf<PlayerController>);
+    EXPECT_EQ(Reflect::IdOf("Nope"), Reflect::kInvalidType);
+}
+
+// Números fuera de rango de un int (ej: layer = 1e30 en el JSON) se saturan; NaN/inf no
+// pisan el valor
+TEST(SceneSerializer, IntFieldsSaturate) {
+    int v = 7;
+    Reflect::ValueFromJson(nlohmann::json(1e30), v);
+    EXPECT_EQ(v, std::numeric_limits<int>::max());
+    Reflect::ValueFromJson(nlohmann::json(-1e30), v);
+    EXPECT_EQ(v, std::numeric_limits<int>::min());
+    Reflect::ValueFromJson(nlohmann::json(3.9), v);
+    EXPECT_EQ(v, 3);
+    Reflect::ValueFromJson(nlohmann::json(std::numeric_limits<double>::quiet_NaN()), v);
+    Reflect::ValueFromJson(nlohmann::json(std::numeric_limits<double>::infinity()), v);
+    EXPECT_EQ(v, 3);
+}
+
+// Canales de color: se recortan a 0..255 sin pasar por un cast fuera de rango
+TEST(SceneSerializer, ColorChannelsClamp) {
+    sf::Color c;
+    Reflect::ValueFromJson(nlohmann::json{ { "r", 1e30 }, { "g", -4 }, { "b", 127.8 },
+                                           { "a", std::numeric_limits<double>::quiet_NaN() } }, c);
+    EXPECT_EQ(c, sf::Color(255, 0, 127, 255));
+    EXPECT_EQ(Reflect::ColorChannel(300.0), 255);
+    EXPECT_EQ(Reflect::ColorChannel(-1e30), 0);
+}
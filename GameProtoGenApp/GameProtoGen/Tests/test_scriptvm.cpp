@@ -1,7 +1,9 @@
 // Tests/test_scriptvm.cpp
 #include <gtest/gtest.h>
 #include "Systems/ScriptVM.h"
+#include "Systems/ScriptCache.h"
 #include "ECS/Scene.h"
+#include <filesystem>
 
 TEST(ScriptVM, OnSpawnAndOnUpdateRun) {
     Scene sc;
@@ -21,3 +23,390 @@ TEST(ScriptVM, OnSpawnAndOnUpdateRun) {
     // (Acceder a variables desde C++ es más largo; acá alcanza con que no dé errores)
     SUCCEED();
 }
+
+// Mismo script en varias entidades: se compila una vez; cada una conserva su estado.
+// Con caché en disco, otra sesión (memoria vacía) no recompila.
+TEST(ScriptVM, SharedScriptCompiledOnce) {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "gp_luacache_test";
+    fs::remove_all(dir);
+    ScriptCache::SetDiskDir(dir.string());
+
+    Scene sc;
+    ScriptVM vm;
+    vm.BindScene(sc);
+    const std::string code = "n = (n or 0) + 1 -- " + dir.string(); // contenido único por corrida
+    const std::size_t before = ScriptCache::Compiles();
+    std::string err;
+    for (int i = 0; i < 10; ++i) {
+        auto e = sc.CreateEntity();
+        ASSERT_TRUE(vm.RunFor(e.id, code, "shared.lua", err)) << err;
+    }
+    EXPECT_EQ(ScriptCache::Compiles(), before + 1);
+
+    ScriptCache::Clear();
+    ASSERT_TRUE(vm.RunFor(sc.CreateEntity().id, code, "shared.lua", err)) << err;
+    EXPECT_EQ(ScriptCache::Compiles(), before + 1);
+
+    // Error de sintaxis: no compila ni queda en caché
+    EXPECT_FALSE(vm.RunFor(sc.CreateEntity().id, "function (", "bad.lua", err));
+    EXPECT_FALSE(err.empty());
+
+    ScriptCache::SetDiskDir("");
+    fs::remove_all(dir);
+}
+
+// Memoria: LRU por bytes. Disco: al configurar la carpeta se poda a su tope, lo más
+// viejo primero
+TEST(ScriptVM, ScriptCacheIsBounded) {
+    namespace fs = std::filesystem;
+    const fs::path dir = fs::temp_directory_path() / "gp_luacache_bounded";
+    fs::remove_all(dir);
+    ScriptCache::Clear();
+    ScriptCache::SetDiskDir(dir.string());
+
+    std::string err;
+    const std::string* first = ScriptCache::Get("return 1 -- " + dir.string(), "a.lua", err);
+    ASSERT_NE(first, nullptr) << err;
+    const std::size_t one = first->size();
+    ScriptCache::SetLimits(one * 3, one * 2);
+    for (int i = 2; i <= 6; ++i)
+        ASSERT_NE(ScriptCache::Get("return " + std::to_string(i) + " -- " + dir.string(), "a.lua", err), nullptr);
+    EXPECT_LE(ScriptCache::MemoryBytes(), one * 3 + one); // tamaños casi iguales
+
+    std::size_t files = 0;
+    for (const auto& f : fs::directory_iterator(dir)) { (void)f; ++files; }
+    EXPECT_EQ(files, 6u);
+    ScriptCache::SetDiskDir(dir.string()); // poda
+    files = 0;
+    for (const auto& f : fs::directory_iterator(dir)) { (void)f; ++files; }
+    EXPECT_LE(files, 2u);
+    EXPECT_GE(files, 1u);
+
+    ScriptCache::SetLimits(ScriptCache::kDefaultMemoryBytes, ScriptCache::kDefaultDiskBytes);
+    ScriptCache::SetDiskDir("");
+    ScriptCache::Clear();
+    fs::remove_all(dir);
+}
+
+// Script módulo: el chunk corre una vez; cada entidad tiene su propio self
+TEST(ScriptVM, ModuleScriptInstancesKeepOwnState) {
+    Scene sc;
+    ScriptVM vm;
+    vm.BindScene(sc);
+    const std::string code = R"(
+        local Coin = { bonus = 5 }
+        loads = (loads or 0) + 1
+        function Coin.on_spawn(self) self.hp = 3 end
+        function Coin.on_update(self, dt)
+            self.hp = self.hp - 1
+            ecs.set(self.id, "Transform", { position = { x = self.hp + self.bonus, y = loads } })
+        end
+        return Coin
+    )";
+    auto a = sc.CreateEntity();
+    auto b = sc.CreateEntity();
+    std::string err;
+    for (auto e : { a, b }) {
+        ASSERT_TRUE(vm.RunFor(e.id, code, "coin.lua", err)) << err;
+        ASSERT_TRUE(vm.CallOnSpawn(e.id, err)) << err;
+    }
+    ASSERT_TRUE(vm.CallOnUpdate(a.id, 0.016f, err)) << err;
+    ASSERT_TRUE(vm.CallOnUpdate(a.id, 0.016f, err)) << err;
+    ASSERT_TRUE(vm.CallOnUpdate(b.id, 0.016f, err)) << err;
+
+    EXPECT_FLOAT_EQ(sc.transforms.at(a.id).position.x, 6.f);
+    EXPECT_FLOAT_EQ(sc.transforms.at(b.id).position.x, 7.f);
+    EXPECT_FLOAT_EQ(sc.transforms.at(b.id).position.y, 1.f); // el chunk corrió una sola vez
+}
+
+// Lote: on_update_all recibe todas las instancias; sin él, el loop en Lua aísla los
+// errores por entidad
+TEST(ScriptVM, BatchedModuleUpdates) {
+    Scene sc;
+    ScriptVM vm;
+    vm.BindScene(sc);
+    const std::string all = R"(
+        local M = {}
+        function M.on_update_all(list, dt)
+            for i = 1, #list do
+                ecs.set(list[i].id, "Transform", { position = { x = #list, y = 0 } })
+            end
+        end
+        return M
+    )";
+    const std::string each = R"(
+        local M = {}
+        function M.on_update(self, dt)
+            if self.id % 2 == 0 then error("boom") end
+            ecs.set(self.id, "Transform", { position = { x = 1, y = 0 } })
+        end
+        return M
+    )";
+
+    std::string err;
+    std::vector<EntityID> batch, loop;
+    for (int i = 0; i < 3; ++i) {
+        auto e = sc.CreateEntity();
+        ASSERT_TRUE(vm.RunFor(e.id, all, "all.lua", err)) << err;
+        batch.push_back(e.id);
+    }
+    for (int i = 0; i < 4; ++i) {
+        auto e = sc.CreateEntity();
+        ASSERT_TRUE(vm.RunFor(e.id, each, "each.lua", err)) << err;
+        loop.push_back(e.id);
+    }
+
+    for (EntityID id : batch) ASSERT_TRUE(vm.QueueUpdate(id));
+    for (EntityID id : loop) ASSERT_TRUE(vm.QueueUpdate(id));
+    std::vector<std::string> errors;
+    vm.UpdateModules(0.016f, errors);
+
+    for (EntityID id : batch) EXPECT_FLOAT_EQ(sc.transforms.at(id).position.x, 3.f);
+    std::size_t updated = 0;
+    for (EntityID id : loop) updated += sc.transforms.contains(id);
+    EXPECT_EQ(updated, 2u);
+    EXPECT_EQ(errors.size(), 2u);
+}
+
+// La basura de los scripts la recolecta GcStep al final del frame; en modo generacional
+// GcStep no hace trabajo (sólo estadísticas)
+TEST(ScriptVM, GcStepCollectsGarbage) {
+    Scene sc;
+    auto e = sc.CreateEntity();
+    ScriptVM vm;
+    vm.BindScene(sc);
+    std::string err;
+    ASSERT_TRUE(vm.RunFor(e.id, R"(
+        function on_update(dt)
+            for i = 1, 20000 do local t = { i, i } end
+        end
+    )", "<gc>", err)) << err;
+
+    for (int frame = 0; frame < 60 && vm.GetGcStats().cycles == 0; ++frame) {
+        ASSERT_TRUE(vm.CallOnUpdate(e.id, 0.016f, err)) << err;
+        vm.GcStep(2.0);
+    }
+    EXPECT_GE(vm.GetGcStats().cycles, 1u);
+    EXPECT_LT(vm.GetGcStats().kb, 8192u);
+
+    vm.SetGcMode(ScriptVM::GcMode::Generational);
+    ASSERT_TRUE(vm.CallOnUpdate(e.id, 0.016f, err)) << err;
+    vm.GcStep(2.0);
+    EXPECT_EQ(vm.GetGcStats().steps, 0u);
+    EXPECT_GT(vm.GetGcStats().kb, 0u);
+}
+
+// Límite de memoria: el script desbocado recibe un error de Lua y el VM sigue usable
+TEST(ScriptVM, MemoryLimitStopsRunawayScript) {
+    Scene sc;
+    auto a = sc.CreateEntity();
+    auto b = sc.CreateEntity();
+    ScriptVM vm;
+    vm.BindScene(sc);
+    vm.SetMemoryLimit(vm.Memory().Used() + 4u * 1024 * 1024);
+
+    std::string err;
+    EXPECT_FALSE(vm.RunFor(a.id, "local t = {} while true do t[#t + 1] = {} end", "<runaway>", err));
+    EXPECT_NE(err.find("memory"), std::string::npos) << err;
+    EXPECT_GT(vm.Memory().Failures(), 0u);
+
+    err.clear();
+    EXPECT_TRUE(vm.RunFor(b.id, "x = 1", "<ok>", err)) << err;
+    EXPECT_LE(vm.Memory().Peak(), vm.Memory().Limit());
+}
+
+// Con el VM en el tope, sumar entidades con script no puede tirar un error de memoria
+// fuera de un pcall (panic): armar su environment/self y el hilo de on_spawn es del host
+// y siempre entra; lo que falle dentro del script se informa como error
+TEST(ScriptVM, SpawnAfterMemoryLimitIsReached) {
+    Scene sc;
+    auto hog = sc.CreateEntity();
+    ScriptVM vm;
+    vm.BindScene(sc);
+    vm.SetMemoryLimit(vm.Memory().Used() + 4u * 1024 * 1024);
+
+    const std::string classic = "function on_spawn() local t = {} wait_frames(1) end";
+    const std::string module = "return { on_spawn = function(self) self.t = {} end }";
+    std::string err;
+    std::vector<EntityID> loaded;
+    for (int i = 0; i < 20; ++i) {
+        auto e = sc.CreateEntity();
+        ASSERT_TRUE(vm.RunFor(e.id, classic, "<classic>", err)) << err;
+        loaded.push_back(e.id);
+    }
+    ASSERT_TRUE(vm.RunFor(sc.CreateEntity().id, module, "<module>", err)) << err;
+
+    // El global retiene lo asignado: la colección de emergencia no libera nada
+    EXPECT_FALSE(vm.RunFor(hog.id, "hold = {} while true do hold[#hold + 1] = {} end", "<hog>", err));
+    EXPECT_GT(vm.Memory().Failures(), 0u);
+
+    // En el tope: hilos de on_spawn, self de módulos ya cargados y environments nuevos
+    for (EntityID id : loaded) vm.CallOnSpawn(id, err);
+    for (int i = 0; i < 20; ++i) {
+        auto m = sc.CreateEntity();
+        ASSERT_TRUE(vm.RunFor(m.id, module, "<module>", err)) << err; // sólo BindInstance
+        vm.CallOnSpawn(m.id, err);
+        vm.RunFor(sc.CreateEntity().id, classic, "<classic>", err);  // puede fallar adentro
+    }
+    std::vector<std::string> errors;
+    vm.Tick(0.016f, errors);
+    EXPECT_LE(vm.Memory().Used(), vm.Memory().Limit());
+
+    // Soltando lo retenido, todo vuelve a andar (la colección de emergencia lo libera)
+    ASSERT_TRUE(vm.RunFor(hog.id, "hold = nil", "<hog>", err)) << err;
+    auto ok = sc.CreateEntity();
+    err.clear();
+    ASSERT_TRUE(vm.RunFor(ok.id, "function on_spawn() spawned = true end", "<ok>", err)) << err;
+    EXPECT_TRUE(vm.CallOnSpawn(ok.id, err)) << err;
+}
+
+// Presupuesto de frame agotado en medio de on_spawn: la corrutina cede y termina en un
+// Tick posterior en vez de perderse
+TEST(ScriptVM, SpawnCoroutineSurvivesFrameCut) {
+    Scene sc;
+    auto e = sc.CreateEntity();
+    sc.scripts[e.id];
+    ScriptVM vm;
+    vm.BindScene(sc);
+    vm.SetCallBudget(10000.0);
+    std::string err;
+    ASSERT_TRUE(vm.RunFor(e.id, R"(
+        function on_spawn()
+            local t = 0
+            for i = 1, 20000000 do t = t + i end
+            ecs.set(this_id, "Transform", { position = { x = 1, y = 0 } })
+        end
+    )", "<slow>", err)) << err;
+
+    vm.BeginFrame(1.0);
+    EXPECT_TRUE(vm.CallOnSpawn(e.id, err)) << err;
+    EXPECT_TRUE(vm.FrameCut());
+    vm.EndFrame();
+    EXPECT_EQ(vm.Sleeping(), 1u);
+    EXPECT_FALSE(sc.transforms.contains(e.id));
+
+    std::vector<std::string> errors;
+    vm.Tick(0.016f, errors); // sin presupuesto de frame: termina
+    EXPECT_TRUE(errors.empty()) << errors.front();
+    EXPECT_EQ(vm.Sleeping(), 0u);
+    EXPECT_TRUE(sc.transforms.contains(e.id));
+}
+
+// Lote de módulos: si el frame no alcanza, el siguiente sigue desde la entidad que quedó
+// afuera (la primera, lenta, no deja sin on_update a las demás para siempre) y el corte
+// no se reporta como error del script
+TEST(ScriptVM, ModuleUpdateResumesAfterFrameCut) {
+    Scene sc;
+    auto slow = sc.CreateEntity();
+    auto b = sc.CreateEntity();
+    auto c = sc.CreateEntity();
+    ScriptVM vm;
+    vm.BindScene(sc);
+    vm.SetCallBudget(10000.0);
+    const std::string code = "local SLOW = " + std::to_string(slow.id) + R"(
+        return {
+            on_update = function(self, dt)
+                if self.id == SLOW then
+                    local t = 0
+                    for i = 1, 1000000000 do t = t + i end
+                end
+                self.n = (self.n or 0) + 1
+                ecs.set(self.id, "Transform", { position = { x = self.n, y = 0 } })
+            end
+        }
+    )";
+    std::string err;
+    for (EntityID id : { slow.id, b.id, c.id }) ASSERT_TRUE(vm.RunFor(id, code, "<mod>", err)) << err;
+
+    std::vector<std::string> errors;
+    for (int frame = 0; frame < 3; ++frame) {
+        vm.BeginFrame(5.0);
+        for (EntityID id : { slow.id, b.id, c.id }) ASSERT_TRUE(vm.QueueUpdate(id));
+        vm.UpdateModules(0.016f, errors);
+        vm.EndFrame();
+    }
+    EXPECT_TRUE(errors.empty()) << errors.front(); // cortar por el frame no es un error
+    EXPECT_FALSE(vm.IsSuspended(slow.id));
+    ASSERT_TRUE(sc.transforms.contains(b.id));
+    ASSERT_TRUE(sc.transforms.contains(c.id));
+    EXPECT_GE(sc.transforms.at(b.id).position.x, 1.f);
+    EXPECT_GE(sc.transforms.at(c.id).position.x, 1.f);
+}
+
+// Watchdog: un on_update que no termina se corta, la entidad queda suspendida (las
+// demás siguen) y recargar su script la rehabilita
+TEST(ScriptVM, WatchdogSuspendsRunawayUpdate) {
+    Scene sc;
+    auto bad = sc.CreateEntity();
+    auto good = sc.CreateEntity();
+    ScriptVM vm;
+    vm.BindScene(sc);
+    vm.SetCallBudget(20.0);
+
+    std::string err;
+    ASSERT_TRUE(vm.RunFor(bad.id, "function on_update(dt) while true do end end", "<bad>", err)) << err;
+    ASSERT_TRUE(vm.RunFor(good.id, "n = 0 function on_update(dt) n = n + 1 end", "<good>", err)) << err;
+
+    EXPECT_FALSE(vm.CallOnUpdate(bad.id, 0.016f, err));
+    EXPECT_NE(err.find("suspendido"), std::string::npos) << err;
+    EXPECT_TRUE(vm.IsSuspended(bad.id));
+    EXPECT_TRUE(vm.CallOnUpdate(bad.id, 0.016f, err)); // ya no se llama
+    EXPECT_TRUE(vm.CallOnUpdate(good.id, 0.016f, err)) << err;
+    EXPECT_FALSE(vm.IsSuspended(good.id));
+
+    const auto top = vm.TopCosts(1);
+    ASSERT_EQ(top.size(), 1u);
+    EXPECT_EQ(top[0].id, bad.id);
+    EXPECT_GE(top[0].lastMs, 20.0);
+
+    ASSERT_TRUE(vm.RunFor(bad.id, "function on_update(dt) end", "<bad>", err)) << err;
+    EXPECT_FALSE(vm.IsSuspended(bad.id));
+    EXPECT_TRUE(vm.CallOnUpdate(bad.id, 0.016f, err)) << err;
+}
+
+// on_spawn como corrutina: cada wait* la duerme hasta que Tick la despierte
+TEST(ScriptVM, SpawnCoroutineWaits) {
+    Scene sc;
+    auto e = sc.CreateEntity();
+    sc.scripts[e.id];
+    ScriptVM vm;
+    vm.BindScene(sc);
+    std::string err;
+    ASSERT_TRUE(vm.RunFor(e.id, R"(
+        step = 0
+        function on_spawn()
+            step = 1
+            wait_frames(2)
+            step = 2
+            wait(0.5)
+            step = 3
+            wait_event("go")
+            step = 4
+            ecs.set(this_id, "Transform", { position = { x = step, y = 0 } })
+        end
+    )", "<co>", err)) << err;
+    ASSERT_TRUE(vm.CallOnSpawn(e.id, err)) << err;
+    EXPECT_EQ(vm.Sleeping(), 1u);
+
+    std::vector<std::string> errors;
+    vm.Tick(0.1f, errors);           // frame 1
+    vm.Tick(0.1f, errors);           // frame 2: -> step 2, wait(0.5) hasta t = 0.7
+    for (int i = 0; i < 4; ++i) vm.Tick(0.1f, errors);
+    EXPECT_FALSE(sc.transforms.contains(e.id));
+    vm.Tick(0.2f, errors);           // t = 0.8 -> step 3, espera "go"
+    vm.Tick(1.0f, errors);
+    EXPECT_EQ(vm.Sleeping(), 1u);
+
+    vm.Emit("go");
+    vm.Tick(0.016f, errors);
+    EXPECT_TRUE(errors.empty()) << errors.front();
+    ASSERT_TRUE(sc.transforms.contains(e.id));
+    EXPECT_FLOAT_EQ(sc.transforms.at(e.id).position.x, 4.f);
+    EXPECT_EQ(vm.Sleeping(), 0u);
+
+    // Fuera de on_spawn no hay corrutina a la que ceder
+    ASSERT_TRUE(vm.RunFor(e.id, "function on_update(dt) wait(1) end", "<co>", err)) << err;
+    EXPECT_FALSE(vm.CallOnUpdate(e.id, 0.016f, err));
+    EXPECT_NE(err.find("on_spawn"), std::string::npos) << err;
+}
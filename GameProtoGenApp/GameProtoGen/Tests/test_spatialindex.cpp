@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include "ECS/SpatialIndex.h"
+#include <algorithm>
+
+static Entity AddTile(Scene& s, sf::Vector2f pos, sf::Vector2f size = { 32.f, 32.f }) {
+    Entity e = s.CreateEntity();
+    s.transforms[e.id] = Transform{ pos, {1,1}, 0 };
+    s.sprites[e.id] = Sprite{ size, sf::Color::White };
+    return e;
+}
+
+// Mismo resultado que recorrer todas las entidades, la de más arriba primero
+TEST(SpatialIndex, MatchesBruteForce) {
+    Scene s;
+    for (int y = 0; y < 40; ++y)
+        for (int x = 0; x < 40; ++x) AddTile(s, { x * 32.f, y * 32.f });
+    const Entity ground = AddTile(s, { 600.f, 1400.f }, { 4000.f, 160.f }); // va a la lista 'big'
+    const Entity over = AddTile(s, { 320.f, 320.f }, { 64.f, 64.f });        // tapa a 4 tiles
+
+    SpatialIndex idx(64.f);
+    idx.Sync(s);
+    EXPECT_EQ(idx.Size(), s.Entities().size());
+
+    EXPECT_EQ(idx.PickTopmost({ 330.f, 330.f }), over.id);
+    EXPECT_EQ(idx.PickTopmost({ -1000.f, 1400.f }), ground.id);
+    EXPECT_EQ(idx.PickTopmost({ 5000.f, 5000.f }), 0u);
+
+    const sf::FloatRect box({ 100.f, 90.f }, { 230.f, 170.f });
+    std::vector<EntityID> brute;
+    for (auto it = s.Entities().rbegin(); it != s.Entities().rend(); ++it) {
+        auto b = SpatialIndex::ComputeAABB(s, it->id);
+        if (b && b->position.x <= box.position.x + box.size.x && b->position.x + b->size.x >= box.position.x &&
+            b->position.y <= box.position.y + box.size.y && b->position.y + b->size.y >= box.position.y)
+            brute.push_back(it->id);
+    }
+    EXPECT_EQ(idx.Query(box), brute);
+}
+
+// Mover / borrar / agregar sólo reprocesa lo tocado; copia o escena nueva reconstruye
+TEST(SpatialIndex, IncrementalUpdates) {
+    Scene s;
+    const Entity a = AddTile(s, { 0.f, 0.f });
+    const Entity b = AddTile(s, { 500.f, 0.f });
+    SpatialIndex idx;
+    idx.Sync(s);
+    ASSERT_EQ(idx.PickTopmost({ 0.f, 0.f }), a.id);
+
+    s.transforms[a.id].position = { 1000.f, 1000.f };
+    s.sprites[b.id].size = { 200.f, 200.f };
+    const Entity c = AddTile(s, { -300.f, 0.f });
+    idx.Sync(s);
+    EXPECT_EQ(idx.PickTopmost({ 0.f, 0.f }), 0u);
+    EXPECT_EQ(idx.PickTopmost({ 1000.f, 1000.f }), a.id);
+    EXPECT_EQ(idx.PickTopmost({ 590.f, 90.f }), b.id);
+    EXPECT_EQ(idx.PickTopmost({ -300.f, 0.f }), c.id);
+
+    s.DestroyEntity(b);
+    idx.Sync(s);
+    EXPECT_EQ(idx.PickTopmost({ 590.f, 90.f }), 0u);
+    EXPECT_EQ(idx.Bounds(b.id), nullptr);
+
+    // Snapshot (copia) modificado por separado: el índice no se queda con datos viejos
+    Scene copy = s;
+    copy.transforms[c.id].position = { 0.f, 0.f };
+    idx.Sync(copy);
+    EXPECT_EQ(idx.PickTopmost({ 0.f, 0.f }), c.id);
+    idx.Sync(s);
+    EXPECT_EQ(idx.PickTopmost({ 0.f, 0.f }), 0u);
+}
+
+// "La de más arriba" sigue el orden de dibujo: RenderLayer manda sobre la creación
+TEST(SpatialIndex, PickFollowsRenderLayer) {
+    Scene s;
+    const Entity back = AddTile(s, { 0.f, 0.f });
+    const Entity front = AddTile(s, { 0.f, 0.f });
+
+    SpatialIndex idx(64.f);
+    idx.Sync(s);
+    EXPECT_EQ(idx.PickTopmost({ 0.f, 0.f }), front.id);
+
+    s.renderLayers[back.id] = RenderLayer{ 1, 0.f };
+    idx.Sync(s);
+    EXPECT_EQ(idx.PickTopmost({ 0.f, 0.f }), back.id);
+    EXPECT_EQ(idx.Query(sf::FloatRect({ -1.f, -1.f }, { 2.f, 2.f })), (std::vector<EntityID>{ back.id, front.id }));
+
+    s.renderLayers[front.id] = RenderLayer{ 1, 2.f };
+    idx.Sync(s);
+    EXPECT_EQ(idx.PickTopmost({ 0.f, 0.f }), front.id);
+}
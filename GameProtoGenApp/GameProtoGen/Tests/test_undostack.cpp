@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "Editor/UndoStack.h"
+#include "ECS/Scene.h"
+
+static Entity AddBox(Scene& s, sf::Vector2f pos) {
+    Entity e = s.CreateEntity();
+    s.transforms[e.id] = Transform{ pos, {1,1}, 0 };
+    s.sprites[e.id] = Sprite{ {32,32}, sf::Color::White };
+    return e;
+}
+
+// Una respuesta del chat = una entrada: spawn + modificar + borrar se deshacen juntos
+TEST(UndoStack, UndoRedoSpawnModifyRemove) {
+    Scene s;
+    const Entity keep = AddBox(s, { 0, 0 });
+    const Entity gone = AddBox(s, { 50, 0 });
+
+    UndoStack h;
+    auto tx = h.Begin("IA");
+    Entity spawned = s.CreateEntity();
+    tx.TouchNew(spawned.id);
+    s.transforms[spawned.id] = Transform{ {9, 9}, {1,1}, 0 };
+    tx.Touch(s, keep.id);
+    s.transforms[keep.id].position = { 100, 200 };
+    s.physics[keep.id] = Physics2D{};
+    tx.Touch(s, gone.id);
+    s.DestroyEntity(gone);
+
+    auto gesture = h.Begin("Drag"); // otra transacción abierta: no se deshace en el medio
+    EXPECT_FALSE(h.Undo(s));
+    h.Cancel(gesture);
+    ASSERT_TRUE(h.Commit(tx, s));
+
+    ASSERT_TRUE(h.Undo(s));
+    EXPECT_FALSE(s.transforms.contains(spawned.id));
+    EXPECT_FLOAT_EQ(s.transforms.at(keep.id).position.x, 0.f);
+    EXPECT_FALSE(s.physics.contains(keep.id));
+    ASSERT_TRUE(s.sprites.contains(gone.id));
+    EXPECT_EQ(s.Entities().size(), 2u);
+
+    ASSERT_TRUE(h.Redo(s));
+    EXPECT_FLOAT_EQ(s.transforms.at(spawned.id).position.y, 9.f);
+    EXPECT_FLOAT_EQ(s.transforms.at(keep.id).position.y, 200.f);
+    EXPECT_TRUE(s.physics.contains(keep.id));
+    EXPECT_FALSE(s.transforms.contains(gone.id));
+    EXPECT_EQ(s.Entities().size(), 2u);
+    EXPECT_FALSE(h.CanRedo());
+}
+
+// Drag del inspector: misma clave -> una sola entrada con el "antes" original
+TEST(UndoStack, CoalescesAndSkipsNoOps) {
+    Scene s;
+    const Entity e = AddBox(s, { 0, 0 });
+    UndoStack h;
+
+    for (int i = 1; i <= 5; ++i) {
+        auto tx = h.Begin("Inspector", /*coalesceKey*/ 42);
+        tx.Touch(s, e.id);
+        s.transforms[e.id].position.x = (float)i;
+        h.Commit(tx, s);
+    }
+    auto tx = h.Begin("Nada");
+    tx.Touch(s, e.id);
+    EXPECT_FALSE(h.Commit(tx, s)); // sin cambios: no se apila
+
+    EXPECT_EQ(h.Size(), 1u);
+    ASSERT_TRUE(h.Undo(s));
+    EXPECT_FLOAT_EQ(s.transforms.at(e.id).position.x, 0.f);
+}
+
+// Memoria O(cambiado) y presupuesto respetado en escenas grandes
+TEST(UndoStack, CompactOnLargeScenesAndBudget) {
+    Scene s;
+    for (int i = 0; i < 50000; ++i) AddBox(s, { (float)i, 0 });
+
+    UndoStack h;
+    h.SetBudget(16 * 1024, 1000);
+    for (EntityID id = 1; id <= 200; ++id) {
+        auto tx = h.Begin("Mover");
+        tx.Touch(s, id);
+        s.transforms[id].position.y += 1.f;
+        h.Commit(tx, s);
+    }
+    EXPECT_LE(h.Bytes(), 16u * 1024u);
+    EXPECT_LT(h.Size(), 200u);
+    EXPECT_GT(h.Size(), 0u);
+
+    // La entrada más reciente pesa un componente, no la escena
+    const std::size_t before = h.Bytes();
+    ASSERT_TRUE(h.Undo(s));
+    EXPECT_EQ(h.Bytes(), before); // pasa a redo, mismo costo
+    EXPECT_FLOAT_EQ(s.transforms.at(200).position.y, 0.f);
+}
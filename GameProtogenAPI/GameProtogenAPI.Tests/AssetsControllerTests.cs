@@ -0,0 +1,41 @@
+﻿using FluentAssertions;
+using GameProtogenAPI.Services;
+using GameProtogenAPI.Tests.Infra;
+using Microsoft.Extensions.DependencyInjection;
+using System.Net;
+
+namespace GameProtogenAPI.Tests
+{
+    public class AssetsControllerTests : IClassFixture<CustomWebApplicationFactory>
+    {
+        private readonly CustomWebApplicationFactory _factory;
+
+        public AssetsControllerTests(CustomWebApplicationFactory factory)
+        {
+            _factory = factory;
+        }
+
+        [Fact]
+        public async Task Get_Should_Return_Stored_Bytes_By_Hash()
+        {
+            var store = _factory.Services.GetRequiredService<AssetBlobStore>();
+            var bytes = new byte[] { 0x89, 0x50, 0x4E, 0x47, 1, 2, 3, 4 };
+            var id = store.Put(bytes);
+            id.Should().HaveLength(64);
+
+            var client = _factory.CreateAuthenticatedClient();
+            var resp = await client.GetAsync($"/api/assets/{id}");
+            resp.EnsureSuccessStatusCode();
+            resp.Content.Headers.ContentType!.MediaType.Should().Be("image/png");
+            (await resp.Content.ReadAsByteArrayAsync()).Should().Equal(bytes);
+        }
+
+        [Fact]
+        public async Task Get_Unknown_Should_Return_404()
+        {
+            var client = _factory.CreateAuthenticatedClient();
+            var resp = await client.GetAsync($"/api/assets/{new string('0', 64)}");
+            resp.StatusCode.Should().Be(HttpStatusCode.NotFound);
+        }
+    }
+}
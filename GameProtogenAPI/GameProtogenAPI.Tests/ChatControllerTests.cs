@@ -1,11 +1,16 @@
 ﻿using FluentAssertions;
+using GameProtogenAPI.AI.Orchestration.Contracts;
 using GameProtogenAPI.Tests.Infra;
+using Microsoft.AspNetCore.TestHost;
+using Microsoft.Extensions.DependencyInjection;
 using System;
 using System.Collections.Generic;
 using System.Linq;
 using System.Net;
+using System.Net.Http.Headers;
 using System.Net.Http.Json;
 using System.Text;
+using System.Text.Json;
 using System.Threading.Tasks;
 
 namespace GameProtogenAPI.Tests
@@ -76,6 +81,83 @@ namespace GameProtogenAPI.Tests
             s.Should().Contain("Healthy");
         }
 
+        [Fact]
+        public async Task Command_With_SceneDelta_Unknown_Base_Should_Return_409()
+        {
+            var client = _factory.CreateAuthenticatedClient();
+            var body = new
+            {
+                prompt = "hola",
+                sceneDelta = new { baseRev = 12345UL, upserts = Array.Empty<object>(), removed = Array.Empty<uint>() }
+            };
+
+            var resp = await client.PostAsJsonAsync("/api/chat/command", body);
+            resp.StatusCode.Should().Be(HttpStatusCode.Conflict);
+        }
+
+        [Fact]
+        public async Task Command_With_SceneDelta_After_Full_Should_Succeed()
+        {
+            var client = _factory.CreateAuthenticatedClient();
+            var full = new { prompt = "hola", scene = new { entities = new object[] { new { id = 1 } } } };
+
+            var r1 = await client.PostAsJsonAsync("/api/chat/command", full);
+            r1.EnsureSuccessStatusCode();
+            r1.Headers.TryGetValues("X-Scene-Rev", out var revs).Should().BeTrue();
+            var rev = ulong.Parse(revs!.First());
+
+            var delta = new
+            {
+                prompt = "hola",
+                sceneDelta = new { baseRev = rev, upserts = new object[] { new { id = 2 } }, removed = new[] { 1u } }
+            };
+            var r2 = await client.PostAsJsonAsync("/api/chat/command", delta);
+            r2.EnsureSuccessStatusCode();
+            r2.Headers.Contains("X-Scene-Rev").Should().BeTrue();
+        }
+
+        [Fact]
+        public async Task CommandStream_Should_Return_Ndjson_Ending_With_Done()
+        {
+            var client = _factory.CreateAuthenticatedClient();
+            var body = new { prompt = "¿cómo balanceo el salto y la gravedad?", scene = (object?)null };
+
+            var resp = await client.PostAsJsonAsync("/api/chat/command/stream", body);
+            resp.EnsureSuccessStatusCode();
+            resp.Content.Headers.ContentType!.MediaType.Should().Be("application/x-ndjson");
+
+            var lines = (await resp.Content.ReadAsStringAsync())
+                .Split('\n', StringSplitOptions.RemoveEmptyEntries);
+            lines.Should().HaveCountGreaterThan(1);
+            lines.Should().Contain(l => l.Contains("\"kind\":\"text\""));
+            lines.Last().Should().Be("{\"kind\":\"done\"}");
+        }
+
+        [Fact]
+        public async Task CommandStream_Should_Write_MultiLine_Items_As_Single_Lines()
+        {
+            var client = _factory
+                .WithWebHostBuilder(b => b.ConfigureTestServices(s =>
+                    s.AddSingleton<ISkSceneEditOrchestrator, PrettyJsonOrchestrator>()))
+                .CreateClient();
+            client.DefaultRequestHeaders.Authorization = new AuthenticationHeaderValue("Test", "faketoken");
+
+            var resp = await client.PostAsJsonAsync("/api/chat/command/stream", new { prompt = "hola", scene = (object?)null });
+            resp.EnsureSuccessStatusCode();
+
+            var lines = (await resp.Content.ReadAsStringAsync())
+                .Split('\n', StringSplitOptions.RemoveEmptyEntries);
+            lines.Should().HaveCount(PrettyJsonOrchestrator.Items.Length + 1);
+            foreach (var l in lines)
+            {
+                using var doc = JsonDocument.Parse(l); // cada línea es un JSON completo
+                doc.RootElement.TryGetProperty("kind", out _).Should().BeTrue();
+            }
+            lines[0].Should().Contain("\"message\":\"hola\"");
+            lines[1].Should().Contain("\"kind\":\"ops\"").And.Contain("remove_entity");
+            lines.Last().Should().Be("{\"kind\":\"done\"}");
+        }
+
         [Fact]
         public async Task Chat_Requires_Authorization()
         {
@@ -0,0 +1,28 @@
+﻿using GameProtogenAPI.AI.Orchestration.Contracts;
+using System.Runtime.CompilerServices;
+
+namespace GameProtogenAPI.Tests.Infra
+{
+    // Orquestador que devuelve items con JSON indentado (multi-línea), como a veces
+    // responde el modelo. Sirve para comprobar que el stream NDJSON los compacta.
+    public class PrettyJsonOrchestrator : ISkSceneEditOrchestrator
+    {
+        public static readonly string[] Items =
+        {
+            "{\n  \"kind\": \"text\",\n  \"message\": \"hola\"\n}",
+            "{\n  \"ops\": [\n    {\n      \"op\": \"remove_entity\",\n      \"entity\": 3\n    }\n  ]\n}"
+        };
+
+        public Task<string> RunAsync(string prompt, string sceneJson, CancellationToken ct)
+            => Task.FromResult(Items[0]);
+
+        public async IAsyncEnumerable<string> StreamAsync(string prompt, string sceneJson, [EnumeratorCancellation] CancellationToken ct)
+        {
+            foreach (var item in Items)
+            {
+                await Task.Yield();
+                yield return item;
+            }
+        }
+    }
+}
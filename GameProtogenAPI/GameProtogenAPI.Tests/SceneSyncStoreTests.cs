@@ -0,0 +1,64 @@
+﻿using FluentAssertions;
+using GameProtogenAPI.Services;
+using System;
+using System.Text.Json;
+
+namespace GameProtogenAPI.Tests
+{
+    public class SceneSyncStoreTests
+    {
+        private sealed class ManualClock : TimeProvider
+        {
+            public DateTimeOffset Now = new(2025, 1, 1, 0, 0, 0, TimeSpan.Zero);
+            public override DateTimeOffset GetUtcNow() => Now;
+        }
+
+        private static JsonElement Scene(uint id) =>
+            JsonDocument.Parse($"{{\"entities\":[{{\"id\":{id}}}]}}").RootElement.Clone();
+
+        private static JsonElement Delta(ulong baseRev) =>
+            JsonDocument.Parse($"{{\"baseRev\":{baseRev},\"upserts\":[{{\"id\":9}}],\"removed\":[]}}").RootElement.Clone();
+
+        [Fact]
+        public void Empty_User_Is_Never_Stored()
+        {
+            var store = new SceneSyncStore();
+            store.StoreFull("", Scene(1)).Should().BeNull();
+            store.Count.Should().Be(0);
+            store.TryApplyDelta("", Delta(0), out _).Should().BeFalse();
+        }
+
+        [Fact]
+        public void Expired_Base_Requires_Resync()
+        {
+            var clock = new ManualClock();
+            var store = new SceneSyncStore(ttl: TimeSpan.FromMinutes(10), clock: clock);
+            var rev = store.StoreFull("a", Scene(1))!.Value;
+
+            clock.Now += TimeSpan.FromMinutes(5);
+            store.TryApplyDelta("a", Delta(rev), out var rev2).Should().BeTrue();
+
+            clock.Now += TimeSpan.FromMinutes(11);
+            store.TryApplyDelta("a", Delta(rev2), out _).Should().BeFalse();
+            store.Count.Should().Be(0);
+        }
+
+        [Fact]
+        public void Least_Recently_Used_Is_Evicted_Over_Capacity()
+        {
+            var clock = new ManualClock();
+            var store = new SceneSyncStore(maxUsers: 2, clock: clock);
+            var ra = store.StoreFull("a", Scene(1))!.Value;
+            clock.Now += TimeSpan.FromSeconds(1);
+            store.StoreFull("b", Scene(1));
+            clock.Now += TimeSpan.FromSeconds(1);
+            store.TryApplyDelta("a", Delta(ra), out var ra2).Should().BeTrue(); // 'a' usada hace menos
+            clock.Now += TimeSpan.FromSeconds(1);
+            store.StoreFull("c", Scene(1));
+
+            store.Count.Should().Be(2);
+            store.GetSceneJson("b").Should().Be("{}");
+            store.TryApplyDelta("a", Delta(ra2), out _).Should().BeTrue();
+        }
+    }
+}
@@ -3,5 +3,8 @@
     public interface ISkSceneEditOrchestrator
     {
         Task<string> RunAsync(string prompt, string sceneJson, CancellationToken ct);
+
+        // Mismo resultado que RunAsync pero item por item (un JSON por agente, a medida que termina)
+        IAsyncEnumerable<string> StreamAsync(string prompt, string sceneJson, CancellationToken ct);
     }
 }
@@ -1,6 +1,7 @@
 ﻿using GameProtogenAPI.AI.AgentPlugins;
 using GameProtogenAPI.AI.Orchestration.Contracts;
 using Microsoft.SemanticKernel;
+using System.Runtime.CompilerServices;
 using System.Text;
 using System.Text.Json;
 
@@ -32,6 +33,23 @@ namespace GameProtogenAPI.AI.Orchestration
             return await ExecuteAgentsBundleAsync(agents, prompt, sceneJson, ct, assetMode);
         }
 
+        public async IAsyncEnumerable<string> StreamAsync(string prompt, string sceneJson, [EnumeratorCancellation] CancellationToken ct)
+        {
+            var routeJson = await InvokeRouterAsync(prompt, sceneJson, ct);
+
+            var agents = ParseAgentsOrDefault(routeJson);
+            var assetMode = ExtractAssetMode(routeJson);
+            if (agents.Length <= 1)
+            {
+                yield return await ExecuteSingleAgentAsync(agents.First(), prompt, sceneJson, ct, assetMode);
+                yield break;
+            }
+
+            // multi-agente → cada item apenas está listo (el cliente aplica ops sin esperar al resto)
+            await foreach (var item in ExecuteAgentsItemsAsync(agents, prompt, sceneJson, ct, assetMode))
+                yield return item.GetRawText();
+        }
+
         // ───────────────────────── Router ─────────────────────────
         private async Task<string> InvokeRouterAsync(string prompt, string sceneJson, CancellationToken ct)
         {
@@ -97,6 +115,26 @@ namespace GameProtogenAPI.AI.Orchestration
         private async Task<string> ExecuteAgentsBundleAsync(string[] agents, string prompt, string sceneJson, CancellationToken ct, string? assetMode)
         {
             var items = new List<JsonElement>();
+            await foreach (var item in ExecuteAgentsItemsAsync(agents, prompt, sceneJson, ct, assetMode))
+                items.Add(item);
+
+            // { kind:"bundle", items:[...] }
+            using var msb = new MemoryStream();
+            using (var wb = new Utf8JsonWriter(msb))
+            {
+                wb.WriteStartObject();
+                wb.WriteString("kind", KIND_BUNDLE);
+                wb.WritePropertyName("items");
+                wb.WriteStartArray();
+                foreach (var it in items) it.WriteTo(wb);
+                wb.WriteEndArray();
+                wb.WriteEndObject();
+            }
+            return Encoding.UTF8.GetString(msb.ToArray());
+        }
+
+        private async IAsyncEnumerable<JsonElement> ExecuteAgentsItemsAsync(string[] agents, string prompt, string sceneJson, [EnumeratorCancellation] CancellationToken ct, string? assetMode)
+        {
             var assetPaths = new List<string>();
             var scriptPaths = new List<string>();
 
@@ -107,7 +145,7 @@ namespace GameProtogenAPI.AI.Orchestration
                 {
                     var json = await RunAssetGenAsync(prompt, assetMode, ct);
                     var item = JsonDocument.Parse(json).RootElement.Clone();
-                    items.Add(item);
+                    yield return item;
                     assetPaths.AddRange(ExtractAssetPathsFromItem(item));
                 }
             }
@@ -119,7 +157,7 @@ namespace GameProtogenAPI.AI.Orchestration
                 {
                     var json = await RunScriptGenAsync(prompt, sceneJson, ct);
                     var item = JsonDocument.Parse(json).RootElement.Clone();
-                    items.Add(item);
+                    yield return item;
                     scriptPaths.AddRange(ExtractScriptPathsFromItem(item)); // ← NUEVO
                 }
             }
@@ -129,8 +167,7 @@ namespace GameProtogenAPI.AI.Orchestration
             {
                 if (string.Equals(a, "design_qa", StringComparison.OrdinalIgnoreCase))
                 {
-                    var item = await TryRunDesignQaAsItemAsync(prompt, ct);
-                    items.Add(item);
+                    yield return await TryRunDesignQaAsItemAsync(prompt, ct);
                 }
                 else if (string.Equals(a, "scene_edit", StringComparison.OrdinalIgnoreCase))
                 {
@@ -150,23 +187,10 @@ namespace GameProtogenAPI.AI.Orchestration
                     }
 
                     var json = await RunSceneEditAsync(augmentedPrompt, sceneJson, ct);
-                    items.Add(JsonDocument.Parse(json).RootElement.Clone());
+                    yield return JsonDocument.Parse(json).RootElement.Clone();
                 }
             }
 
-            // { kind:"bundle", items:[...] }
-            using var msb = new MemoryStream();
-            using (var wb = new Utf8JsonWriter(msb))
-            {
-                wb.WriteStartObject();
-                wb.WriteString("kind", KIND_BUNDLE);
-                wb.WritePropertyName("items");
-                wb.WriteStartArray();
-                foreach (var it in items) it.WriteTo(wb);
-                wb.WriteEndArray();
-                wb.WriteEndObject();
-            }
-            return Encoding.UTF8.GetString(msb.ToArray());
         }
 
         // ───────────────────────── design_qa ─────────────────────────
@@ -0,0 +1,33 @@
+﻿using GameProtogenAPI.Services;
+using Microsoft.AspNetCore.Authorization;
+using Microsoft.AspNetCore.Mvc;
+using Microsoft.Net.Http.Headers;
+
+namespace GameProtogenAPI.Controllers
+{
+    [Route("api/[controller]")]
+    [ApiController]
+    [Authorize]
+    public class AssetsController : ControllerBase
+    {
+        private readonly AssetBlobStore _blobs;
+
+        public AssetsController(AssetBlobStore blobs)
+        {
+            _blobs = blobs;
+        }
+
+        // Binario crudo del asset. El id es el SHA-256 del contenido, así que sirve de ETag
+        // y la respuesta es inmutable.
+        [HttpGet("{id}")]
+        public IActionResult Get(string id)
+        {
+            if (!_blobs.TryGet(id, out var bytes))
+                return NotFound();
+
+            Response.Headers[HeaderNames.CacheControl] = "private, max-age=31536000, immutable";
+            var etag = new EntityTagHeaderValue($"\"{id.ToLowerInvariant()}\"");
+            return File(bytes, "image/png", lastModified: null, entityTag: etag);
+        }
+    }
+}
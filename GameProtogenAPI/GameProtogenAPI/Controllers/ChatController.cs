@@ -1,8 +1,11 @@
 ﻿using GameProtogenAPI.AI.Orchestration.Contracts;
+using GameProtogenAPI.Services;
 using GameProtogenAPI.Services.Contracts;
 using GameProtogenAPI.Validators;
 using Microsoft.AspNetCore.Authorization;
+using Microsoft.AspNetCore.Http.Features;
 using Microsoft.AspNetCore.Mvc;
+using System.Security.Claims;
 using System.Text;
 using System.Text.Json;
 using static GameProtogenAPI.Models.ChatModels;
@@ -15,10 +18,12 @@ namespace GameProtogenAPI.Controllers
     public class ChatController : ControllerBase
     {
         private readonly ISkSceneEditOrchestrator _orchestrator;
+        private readonly SceneSyncStore _scenes;
 
-        public ChatController(ISkSceneEditOrchestrator orchestrator)
+        public ChatController(ISkSceneEditOrchestrator orchestrator, SceneSyncStore scenes)
         {
             _orchestrator = orchestrator;
+            _scenes = scenes;
         }
 
         [HttpPost("command")]
@@ -27,30 +32,11 @@ namespace GameProtogenAPI.Controllers
             if (string.IsNullOrWhiteSpace(req.prompt))
                 return BadRequest("prompt vacío");
 
-            string sceneJson = "{}";
-            try
-            {
-                var v = req.scene.Value;
-                if (v.ValueKind != JsonValueKind.Undefined && v.ValueKind != JsonValueKind.Null)
-                    sceneJson = v.GetRawText() ?? "{}";
-            }
-            catch { }
-
-            // 🔹 Si hay selected, agregamos un bloque de “scope” al prompt
-            string finalPrompt = req.prompt;
-            if (req.selected is { Count: > 0 })
-            {
-                var ids = string.Join(", ", req.selected);
-                finalPrompt +=
-                    $"""
+            var sceneJson = ResolveSceneJson(req);
+            if (sceneJson is null)
+                return Conflict(new { kind = "resync", message = "Base de escena desconocida; reenviar completa." });
 
-                    [IMPORTANTE]
-                    Solo modifica entidades con estos IDs: [{ids}].
-                    Si la operación apunta a otros IDs, ignórala.
-                    No generes ni borres entidades fuera de ese conjunto.
-                    [/IMPORTANTE]
-                    """;
-            }
+            string finalPrompt = BuildFinalPrompt(req);
 
             string result;
             try
@@ -86,26 +72,7 @@ namespace GameProtogenAPI.Controllers
 
                     var outItems = new List<JsonElement>();
                     foreach (var item in arr.EnumerateArray())
-                    {
-                        if (item.ValueKind == JsonValueKind.Object &&
-                            item.TryGetProperty("kind", out var ik) &&
-                            ik.ValueKind == JsonValueKind.String &&
-                            ik.GetString() == "ops")
-                        {
-                            if (!OpsValidator.TryValidateOps(item, out string err))
-                            {
-                                var replaced = JsonDocument
-                                    .Parse(JsonSerializer.Serialize(new { kind = "text", message = $"Ops inválidas: {err}" }))
-                                    .RootElement.Clone();
-                                outItems.Add(replaced);
-                            }
-                            else outItems.Add(item.Clone());
-                        }
-                        else
-                        {
-                            outItems.Add(item.Clone());
-                        }
-                    }
+                        outItems.Add(ValidateItem(item));
 
                     using var msb = new MemoryStream();
                     using (var wb = new Utf8JsonWriter(msb))
@@ -180,5 +147,161 @@ namespace GameProtogenAPI.Controllers
                 return Content(asText, "application/json");
             }
         }
+
+        // Streaming NDJSON: un objeto JSON por línea, a medida que cada agente termina.
+        // Mismos 'kind' que /command (ops, text, asset, script) y al final {"kind":"done"}.
+        [HttpPost("command/stream")]
+        public async Task CommandStream([FromBody] ChatCommandRequest req, CancellationToken ct)
+        {
+            if (string.IsNullOrWhiteSpace(req.prompt))
+            {
+                Response.StatusCode = StatusCodes.Status400BadRequest;
+                await Response.WriteAsync("prompt vacío", ct);
+                return;
+            }
+
+            var sceneJson = ResolveSceneJson(req);
+            if (sceneJson is null)
+            {
+                Response.StatusCode = StatusCodes.Status409Conflict;
+                await Response.WriteAsJsonAsync(new { kind = "resync", message = "Base de escena desconocida; reenviar completa." }, ct);
+                return;
+            }
+
+            Response.ContentType = "application/x-ndjson";
+            Response.Headers["Cache-Control"] = "no-cache";
+            HttpContext.Features.Get<IHttpResponseBodyFeature>()?.DisableBuffering();
+
+            try
+            {
+                await foreach (var raw in _orchestrator.StreamAsync(BuildFinalPrompt(req), sceneJson, ct))
+                    await WriteLineAsync(NormalizeItem(raw), ct);
+            }
+            catch (OperationCanceledException) when (ct.IsCancellationRequested)
+            {
+                return; // el cliente canceló
+            }
+            catch (Exception ex)
+            {
+                await WriteLineAsync(JsonSerializer.Serialize(new { kind = "text", message = $"Error en orquestación: {ex.Message}" }), ct);
+            }
+
+            await WriteLineAsync("{\"kind\":\"done\"}", ct);
+        }
+
+        private async Task WriteLineAsync(string json, CancellationToken ct)
+        {
+            await Response.WriteAsync(json, ct);
+            await Response.WriteAsync("\n", ct);
+            await Response.Body.FlushAsync(ct);
+        }
+
+        private string CurrentUser() =>
+            User.FindFirst("oid")?.Value
+            ?? User.FindFirst(ClaimTypes.NameIdentifier)?.Value
+            ?? User.Identity?.Name
+            ?? "";
+
+        // Escena de la request: completa o delta sobre la última guardada (setea X-Scene-Rev).
+        // null si el delta no aplica sobre la base que tenemos → el cliente tiene que reenviar completa.
+        private string? ResolveSceneJson(ChatCommandRequest req)
+        {
+            var user = CurrentUser();
+
+            if (req.sceneDelta is { ValueKind: JsonValueKind.Object } delta)
+            {
+                if (!_scenes.TryApplyDelta(user, delta, out var rev))
+                    return null;
+
+                Response.Headers["X-Scene-Rev"] = rev.ToString();
+                return _scenes.GetSceneJson(user);
+            }
+
+            string sceneJson = "{}";
+            try
+            {
+                var v = req.scene.Value;
+                if (v.ValueKind != JsonValueKind.Undefined && v.ValueKind != JsonValueKind.Null)
+                {
+                    sceneJson = v.GetRawText() ?? "{}";
+                    // Sin usuario no hay base: el cliente sigue mandando la escena completa
+                    if (_scenes.StoreFull(user, v) is ulong fullRev)
+                        Response.Headers["X-Scene-Rev"] = fullRev.ToString();
+                }
+            }
+            catch { }
+            return sceneJson;
+        }
+
+        // 🔹 Si hay selected, agregamos un bloque de “scope” al prompt
+        private static string BuildFinalPrompt(ChatCommandRequest req)
+        {
+            string finalPrompt = req.prompt;
+            if (req.selected is { Count: > 0 })
+            {
+                var ids = string.Join(", ", req.selected);
+                finalPrompt +=
+                    $"""
+
+                    [IMPORTANTE]
+                    Solo modifica entidades con estos IDs: [{ids}].
+                    Si la operación apunta a otros IDs, ignórala.
+                    No generes ni borres entidades fuera de ese conjunto.
+                    [/IMPORTANTE]
+                    """;
+            }
+            return finalPrompt;
+        }
+
+        // Items 'ops' inválidos se reemplazan por un 'text' con el error; el resto pasa tal cual
+        private static JsonElement ValidateItem(JsonElement item)
+        {
+            if (item.ValueKind == JsonValueKind.Object &&
+                item.TryGetProperty("kind", out var ik) &&
+                ik.ValueKind == JsonValueKind.String &&
+                ik.GetString() == "ops" &&
+                !OpsValidator.TryValidateOps(item, out string err))
+            {
+                return JsonDocument
+                    .Parse(JsonSerializer.Serialize(new { kind = "text", message = $"Ops inválidas: {err}" }))
+                    .RootElement.Clone();
+            }
+            return item.Clone();
+        }
+
+        // Un item del stream → una línea JSON (mismas reglas que /command para un item suelto).
+        // Siempre se re-serializa compacto: GetRawText() conserva los saltos de línea que el
+        // modelo haya puesto (JSON "pretty") y partiría el item en varias líneas NDJSON.
+        private static string NormalizeItem(string raw)
+        {
+            try
+            {
+                using var doc = JsonDocument.Parse(string.IsNullOrWhiteSpace(raw) ? "{}" : raw);
+                var root = doc.RootElement;
+
+                if (root.ValueKind == JsonValueKind.Object && root.TryGetProperty("kind", out _))
+                    return JsonSerializer.Serialize(ValidateItem(root));
+
+                if (root.ValueKind == JsonValueKind.Object && root.TryGetProperty("ops", out _))
+                {
+                    using var ms = new MemoryStream();
+                    using (var w = new Utf8JsonWriter(ms))
+                    {
+                        w.WriteStartObject();
+                        w.WriteString("kind", "ops");
+                        foreach (var p in root.EnumerateObject()) p.WriteTo(w);
+                        w.WriteEndObject();
+                    }
+                    using var doc2 = JsonDocument.Parse(ms.ToArray());
+                    return JsonSerializer.Serialize(ValidateItem(doc2.RootElement));
+                }
+
+                return JsonSerializer.Serialize(new { kind = "text", message = root.ToString() });
+            }
+            catch
+            {
+                return JsonSerializer.Serialize(new { kind = "text", message = raw ?? "" });
+            }
+        }
     }
 }
@@ -9,7 +9,8 @@ namespace GameProtogenAPI.Models
         public record ChatCommandRequest(
             string prompt,
             JsonElement? scene,
-            IReadOnlyList<uint>? selected // IDs a los que debe limitarse
+            IReadOnlyList<uint>? selected, // IDs a los que debe limitarse
+            JsonElement? sceneDelta = null // { baseRev, upserts, removed } respecto de la última escena (X-Scene-Rev)
         );
 
         // Opcional: estructura de la respuesta
@@ -6,6 +6,7 @@ using GameProtogenAPI.AI.Orchestration.Contracts;
 using GameProtogenAPI.Services;
 using GameProtogenAPI.Services.Contracts;
 using Microsoft.AspNetCore.Authentication.JwtBearer;
+using Microsoft.AspNetCore.ResponseCompression;
 using Microsoft.IdentityModel.Tokens;
 using Microsoft.SemanticKernel;
 using OpenAI.Images;
@@ -35,6 +36,16 @@ builder.Services
     });
 
 builder.Services.AddControllers();
+
+// Bodies gzip desde el editor (Content-Encoding) y respuestas comprimidas (escenas/ops grandes)
+builder.Services.AddRequestDecompression();
+builder.Services.AddResponseCompression(options =>
+{
+    options.EnableForHttps = true;
+    options.Providers.Add<BrotliCompressionProvider>();
+    options.Providers.Add<GzipCompressionProvider>();
+});
+
 // Learn more about configuring Swagger/OpenAPI at https://aka.ms/aspnetcore/swashbuckle
 builder.Services.AddEndpointsApiExplorer();
 builder.Services.AddSwaggerGen();
@@ -74,6 +85,12 @@ builder.Services.AddSingleton<ISkSceneEditOrchestrator, SkSceneEditOrchestrator>
 
 builder.Services.AddSingleton<IImageService, OpenAIImageGenService>();
 
+// Última escena por usuario (deltas de escena desde el editor)
+builder.Services.AddSingleton(_ => new SceneSyncStore());
+
+// Binarios de assets generados (el chat devuelve sólo assetId)
+builder.Services.AddSingleton<AssetBlobStore>();
+
 // 4) Tu servicio de LLM (se usa adentro de los plugins)
 var useMock = builder.Configuration.GetValue("LLM:USE_MOCK", false);
 if (useMock)
@@ -91,6 +108,9 @@ if (app.Environment.IsDevelopment())
     app.UseSwaggerUI();
 }
 
+app.UseRequestDecompression();
+app.UseResponseCompression();
+
 app.MapGet("/health", () => Results.Ok(new { status = "Healthy" }));
 
 app.UseAuthentication();
@@ -0,0 +1,48 @@
+﻿using System.Collections.Concurrent;
+using System.Security.Cryptography;
+
+namespace GameProtogenAPI.Services
+{
+    // Bytes de assets generados, direccionados por su SHA-256 (hex minúscula).
+    // El chat sólo devuelve la referencia (assetId); el editor baja el binario
+    // aparte por GET api/assets/{id} y verifica el hash.
+    public class AssetBlobStore
+    {
+        private readonly ConcurrentDictionary<string, byte[]> _blobs = new();
+        private readonly ConcurrentQueue<string> _order = new();
+        private readonly long _capacityBytes;
+        private long _totalBytes;
+
+        public AssetBlobStore(IConfiguration? cfg = null)
+        {
+            var mb = cfg?.GetValue<long?>("Assets:StoreCapacityMB") ?? 256;
+            _capacityBytes = Math.Max(1, mb) * 1024 * 1024;
+        }
+
+        // Guarda (o reutiliza si ya estaba) y devuelve el id
+        public string Put(byte[] bytes)
+        {
+            var id = Convert.ToHexString(SHA256.HashData(bytes)).ToLowerInvariant();
+            if (_blobs.TryAdd(id, bytes))
+            {
+                _order.Enqueue(id);
+                Interlocked.Add(ref _totalBytes, bytes.LongLength);
+                Evict();
+            }
+            return id;
+        }
+
+        public bool TryGet(string id, out byte[] bytes)
+            => _blobs.TryGetValue(id.ToLowerInvariant(), out bytes!);
+
+        // Se descartan los más viejos; el cliente ya los tiene en disco
+        private void Evict()
+        {
+            while (Interlocked.Read(ref _totalBytes) > _capacityBytes && _order.TryDequeue(out var old))
+            {
+                if (_blobs.TryRemove(old, out var b))
+                    Interlocked.Add(ref _totalBytes, -b.LongLength);
+            }
+        }
+    }
+}
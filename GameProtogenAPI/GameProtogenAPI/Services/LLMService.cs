@@ -14,11 +14,13 @@ namespace GameProtogenAPI.Services
         private readonly Kernel _kernel;
         private readonly ILogger<LLMService> _logger;
         private readonly IImageService _images;
+        private readonly AssetBlobStore? _blobs; // null: el asset viaja inline en base64 (tests online)
 
-        public LLMService(ILogger<LLMService> logger, IImageService images, IConfiguration cfg)
+        public LLMService(ILogger<LLMService> logger, IImageService images, IConfiguration cfg, AssetBlobStore? blobs = null)
         { 
             _logger = logger;
             _images = images;
+            _blobs = blobs;
 
             var azureAIInferenceEndpoint =
                 cfg["AzureAI:InferenceEndpoint"] ??
@@ -537,6 +539,22 @@ namespace GameProtogenAPI.Services
 
             var fileName = MakeSafeFileName($"{DateTime.UtcNow:yyyyMMdd_HHmmssfff}.png");
             var path = $"Assets/Generated/{fileName}"; // mismo contrato que venía usando el cliente
+
+            // Con store: sólo la referencia; el editor baja el binario por api/assets/{assetId}
+            if (_blobs is not null)
+            {
+                var assetId = _blobs.Put(bytes);
+                return System.Text.Json.JsonSerializer.Serialize(new
+                {
+                    kind = "asset",
+                    fileName,
+                    path,
+                    assetId,
+                    sha256 = assetId,
+                    size = bytes.Length
+                });
+            }
+
             var b64 = Convert.ToBase64String(bytes);
 
             return System.Text.Json.JsonSerializer.Serialize(new
@@ -555,13 +573,30 @@ namespace GameProtogenAPI.Services
                             Output ONLY JSON (DO NOT INCLUDE ANY OTHER COMMENT OR THING LIKE QUOTES EXPRESSING IT'S A JSON):
                                 { "kind":"script", "fileName":"<suggested>.lua", "code":"<lua source>" }
 
-                            Target VM (Lua 5.4, sol2). Scripts run in an environment with:
-                              - Global: this_id (uint)
-                              - Global function: gameReset()  -- Reloads the current scene from disk and restarts play. Call at end-of-game.
-                              - Optional callbacks:
-                                  function on_spawn() end
-                                  function on_update(dt) end   -- dt in seconds (float)
-                                  function on_trigger_enter(other_id) end -- Use this if user asks for something collectible, like a coin.
+                            Target VM (Lua 5.4, sol2). Global function: gameReset()  -- Reloads the current scene from disk and restarts play. Call at end-of-game.
+                            Two script styles:
+                              A) Module (PREFERRED, especially for anything spawned many times: coins, enemies, bullets).
+                                 The chunk returns a table. It runs once and each entity gets its own `self` table
+                                 ({ id = <uint> }, falls back to the module for fields and functions):
+                                  local M = {}
+                                  function M.on_spawn(self) self.hp = 3 end
+                                  function M.on_update(self, dt) end             -- dt in seconds (float)
+                                  function M.on_trigger_enter(self, other_id) end -- Use this if user asks for something collectible, like a coin.
+                                  return M
+                                 Keep per-entity state in self (self.hp, self.timer). Top-level locals are shared by all entities.
+                                 Optional: function M.on_update_all(list, dt) end -- replaces on_update; called once per frame with
+                                 every instance (list[i] is a self). Use it for swarms (hundreds of enemies/platforms).
+                              B) Classic (no return): the whole script runs once per entity, in its own environment with
+                                 global this_id (uint) and global callbacks: on_spawn(), on_update(dt), on_trigger_enter(other_id).
+
+                            Delays and sequences: on_spawn runs as a coroutine and may pause itself. A waiting entity costs
+                            nothing per frame, so prefer this over counting dt in on_update for timers, patrols and cutscenes:
+                              wait(seconds)        -- resumes after that much game time
+                              wait_frames(n)       -- resumes after n frames (default 1)
+                              wait_event(name)     -- resumes after some script calls emit(name)
+                              emit(name)           -- wakes every on_spawn waiting on that event (next frame at the latest)
+                            wait* only work inside on_spawn (directly or in functions it calls), never in on_update.
+                              e.g. function M.on_spawn(self) while true do move_left(self); wait(2); move_right(self); wait(2) end end
 
                             Engine API (exposed as global table `ecs`):
                               -- Entity ops
@@ -574,6 +609,7 @@ namespace GameProtogenAPI.Services
                               ecs.get(id, "Collider")  => { halfExtents={ x:number, y:number }, offset={ x:number, y:number } }
                               ecs.get(id, "Physics2D") => { velocity={ x:number, y:number }, gravity:number, gravityEnabled:boolean, onGround:boolean }
                               ecs.get(id, "PlayerController") => { moveSpeed:number, jumpSpeed:number }
+                              ecs.get(id, "RenderLayer") => { layer:int, z:number }   -- higher layer draws on top; z orders within a layer
 
                               -- SET also expects named tables (NOT arrays):
                               ecs.set(id, "Transform", { position={ x:number, y:number }?, scale={ x:number, y:number }?, rotation:number? })
@@ -581,11 +617,12 @@ namespace GameProtogenAPI.Services
                               ecs.set(id, "Collider",  { halfExtents={ x:number, y:number }?, offset={ x:number, y:number }? })
                               ecs.set(id, "Physics2D", { velocity={ x:number, y:number }?, gravity:number?, gravityEnabled:boolean?, onGround:boolean? })
                               ecs.set(id, "PlayerController", { moveSpeed:number?, jumpSpeed:number? })
+                              ecs.set(id, "RenderLayer", { layer:int?, z:number? })
 
                             Rules:
                               - When reading positions/sizes, ALWAYS use named fields: p.x, p.y (never p[1], p[2]).
                               - When writing positions/sizes, ALWAYS send named fields: { x=..., y=... }.
-                              - Always define at least one of: on_spawn, on_update.
+                              - Always define at least one of: on_spawn, on_update (on_trigger_enter for pickups).
                               - No require/io/os/debug/loadstring.
                               - Use multiples of 32 for platform placement.
                               - Prefer ecs.get/ecs.set.
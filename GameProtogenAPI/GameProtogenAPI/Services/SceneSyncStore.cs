@@ -0,0 +1,131 @@
+﻿using System.Collections.Concurrent;
+using System.Security.Cryptography;
+using System.Text.Json;
+using System.Text.Json.Nodes;
+
+namespace GameProtogenAPI.Services
+{
+    // Última escena conocida por usuario, para que el editor mande sólo deltas.
+    // Cada estado tiene una revisión aleatoria; el cliente la recibe en X-Scene-Rev
+    // y la usa como baseRev del próximo delta.
+    // Acotado: una escena sin usar por 'ttl' se descarta, y con más de 'maxUsers' se
+    // descartan las usadas hace más tiempo (el cliente recibe 409 y reenvía completa).
+    // Sin usuario identificado no se guarda nada: cada request va con escena completa.
+    public class SceneSyncStore
+    {
+        private sealed class Entry
+        {
+            public ulong Rev;
+            public DateTimeOffset LastUsed;
+            public SortedDictionary<uint, JsonNode> Entities = new();
+        }
+
+        private readonly ConcurrentDictionary<string, Entry> _scenes = new();
+        private readonly int _maxUsers;
+        private readonly TimeSpan _ttl;
+        private readonly TimeProvider _clock;
+
+        public SceneSyncStore(int maxUsers = 1000, TimeSpan? ttl = null, TimeProvider? clock = null)
+        {
+            _maxUsers = Math.Max(1, maxUsers);
+            _ttl = ttl ?? TimeSpan.FromHours(2);
+            _clock = clock ?? TimeProvider.System;
+        }
+
+        public int Count => _scenes.Count;
+
+        // Escena completa: reemplaza lo guardado. null si no hay usuario (no se guarda).
+        public ulong? StoreFull(string user, JsonElement scene)
+        {
+            if (string.IsNullOrEmpty(user)) return null;
+
+            var e = new Entry { Rev = NewRev(), LastUsed = _clock.GetUtcNow() };
+            if (scene.ValueKind == JsonValueKind.Object &&
+                scene.TryGetProperty("entities", out var arr) && arr.ValueKind == JsonValueKind.Array)
+            {
+                foreach (var je in arr.EnumerateArray())
+                    if (TryGetId(je, out var id)) e.Entities[id] = JsonNode.Parse(je.GetRawText())!;
+            }
+            _scenes[user] = e;
+            Prune();
+            return e.Rev;
+        }
+
+        // Delta { baseRev, upserts, removed }. Devuelve false si la base no coincide (-> resync).
+        public bool TryApplyDelta(string user, JsonElement delta, out ulong newRev)
+        {
+            newRev = 0;
+            if (delta.ValueKind != JsonValueKind.Object ||
+                !delta.TryGetProperty("baseRev", out var br) || !br.TryGetUInt64(out var baseRev))
+                return false;
+
+            if (string.IsNullOrEmpty(user) || !TryGetLive(user, out var cur) || cur.Rev != baseRev)
+                return false;
+
+            var next = new Entry { Rev = NewRev(), LastUsed = _clock.GetUtcNow(), Entities = new(cur.Entities) };
+
+            if (delta.TryGetProperty("removed", out var rem) && rem.ValueKind == JsonValueKind.Array)
+                foreach (var r in rem.EnumerateArray())
+                    if (r.TryGetUInt32(out var id)) next.Entities.Remove(id);
+
+            if (delta.TryGetProperty("upserts", out var ups) && ups.ValueKind == JsonValueKind.Array)
+                foreach (var je in ups.EnumerateArray())
+                    if (TryGetId(je, out var id)) next.Entities[id] = JsonNode.Parse(je.GetRawText())!;
+
+            // Si otra request del mismo usuario avanzó la base en el medio, pedir resync
+            if (!_scenes.TryUpdate(user, next, cur))
+                return false;
+
+            newRev = next.Rev;
+            return true;
+        }
+
+        // Reconstruye { "entities": [...] } para el orquestador
+        public string GetSceneJson(string user)
+        {
+            if (string.IsNullOrEmpty(user) || !TryGetLive(user, out var e)) return "{}";
+            var arr = new JsonArray();
+            foreach (var n in e.Entities.Values) arr.Add(n.DeepClone());
+            return new JsonObject { ["entities"] = arr }.ToJsonString();
+        }
+
+        private bool Expired(Entry e, DateTimeOffset now) => now - e.LastUsed > _ttl;
+
+        private bool TryGetLive(string user, out Entry e)
+        {
+            if (!_scenes.TryGetValue(user, out var found)) { e = null!; return false; }
+            e = found;
+            if (!Expired(found, _clock.GetUtcNow())) return true;
+            _scenes.TryRemove(new KeyValuePair<string, Entry>(user, found));
+            return false;
+        }
+
+        // Vencidas afuera; si igual sobran, las menos usadas recientemente
+        private void Prune()
+        {
+            var now = _clock.GetUtcNow();
+            foreach (var kv in _scenes)
+                if (Expired(kv.Value, now)) _scenes.TryRemove(kv);
+
+            int excess = _scenes.Count - _maxUsers;
+            if (excess <= 0) return;
+            foreach (var kv in _scenes.OrderBy(kv => kv.Value.LastUsed).Take(excess).ToList())
+                _scenes.TryRemove(kv);
+        }
+
+        private static bool TryGetId(JsonElement je, out uint id)
+        {
+            id = 0;
+            return je.ValueKind == JsonValueKind.Object &&
+                   je.TryGetProperty("id", out var v) && v.TryGetUInt32(out id);
+        }
+
+        // 48 bits para que el cliente lo lea sin problemas como número
+        private static ulong NewRev()
+        {
+            Span<byte> b = stackalloc byte[8];
+            RandomNumberGenerator.Fill(b);
+            return BitConverter.ToUInt64(b) & 0xFFFF_FFFF_FFFFUL;
+        }
+    }
+}